@@ -32,8 +32,13 @@
 #include "network/Sockets.h"
 #include "crypto/ConsensusBLSSigShare.h"
 #include <utils/Time.h>
+#include "threads/TimerWheel.h"
 
 void Agent::notifyAllConditionVariables() {
+    {
+        // a thread that has just checked the exit flag is now waiting
+        lock_guard< mutex > lock( messageMutex );
+    }
     messageCond.notify_all();
 
     for ( auto&& item : queueCond ) {
@@ -62,6 +67,28 @@ ptr< Node > Agent::getNode() {
     return getSchain()->getNode();
 }
 
+void Agent::waitUntilTime( uint64_t _deadlineMs ) {
+    bool expired = false;  // protected by messageMutex
+
+    auto timerId = TimerWheel::getShared().schedule( _deadlineMs, [this, &expired]() {
+        {
+            lock_guard< mutex > lock( messageMutex );
+            expired = true;
+        }
+        messageCond.notify_all();
+    } );
+
+    {
+        unique_lock< mutex > lock( messageMutex );
+        messageCond.wait(
+            lock, [this, &expired]() { return expired || getNode()->isExitRequested(); } );
+    }
+
+    // waits for a running callback, since it references expired
+    TimerWheel::getShared().cancel( timerId );
+}
+
+
 void Agent::waitOnGlobalStartBarrier() {
     if ( isServer )
         getSchain()->getNode()->waitOnGlobalServerStartBarrier( this );
@@ -65,5 +65,9 @@ public:
 
     void waitOnGlobalStartBarrier();
 
+    // sleeps until _deadlineMs using the shared timer wheel, or until the node exits.
+    // Uses messageMutex and messageCond
+    void waitUntilTime( uint64_t _deadlineMs );
+
     void logConnectionRefused( ConnectionRefusedException& _e, schain_index _index );
 };
@@ -0,0 +1,476 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file Consensusb.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <sys/resource.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "chains/Schain.h"
+#include "network/IO.h"
+#include "network/Network.h"
+#include "network/NetworkEmulator.h"
+#include "node/ConsensusEngine.h"
+#include "node/Node.h"
+#include "pendingqueue/LoadGenerator.h"
+#include "protocols/blockconsensus/MessageReplayer.h"
+
+#include "Consensusb.h"
+
+
+Consensusb::Consensusb( const ptr< LoadGenerator >& _generator, uint64_t _maxPending )
+    : generator( _generator ), maxPending( _maxPending ) {
+    CHECK_ARGUMENT( _generator );
+    CHECK_ARGUMENT( _maxPending > 0 );
+}
+
+
+Consensusb::~Consensusb() {
+    stopLoad();
+}
+
+
+uint64_t Consensusb::getCurrentTimeUs() {
+    return chrono::duration_cast< chrono::microseconds >(
+        chrono::steady_clock::now().time_since_epoch() )
+        .count();
+}
+
+
+uint64_t Consensusb::getCpuTimeUs() {
+    rusage usage{};
+    CHECK_STATE( getrusage( RUSAGE_SELF, &usage ) == 0 );
+    return ( usage.ru_utime.tv_sec + usage.ru_stime.tv_sec ) * 1000000ULL +
+           usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+
+void Consensusb::startLoad() {
+    CHECK_STATE( !generatorThread );
+    startTimeUs = getCurrentTimeUs();
+    measureStartTimeUs = startTimeUs;
+    generatorThread = make_shared< thread >( [this]() { generateLoop(); } );
+}
+
+
+void Consensusb::startMeasurement() {
+    lock_guard< mutex > lock( pendingLock );
+    measureStartTimeUs = getCurrentTimeUs();
+}
+
+
+void Consensusb::stopLoad() {
+    stopRequested = true;
+
+    if ( generatorThread && generatorThread->joinable() ) {
+        generatorThread->join();
+    }
+
+    lock_guard< mutex > lock( pendingLock );
+    if ( measureEndTimeUs == 0 )
+        measureEndTimeUs = getCurrentTimeUs();
+}
+
+
+void Consensusb::generateLoop() {
+    while ( !stopRequested ) {
+        auto now = getCurrentTimeUs();
+        auto arrivalTimeUs = startTimeUs + generator->getNextArrivalUs();
+
+        if ( arrivalTimeUs > now ) {
+            this_thread::sleep_for(
+                chrono::microseconds( min< uint64_t >( arrivalTimeUs - now, 10000 ) ) );
+            continue;
+        }
+
+        lock_guard< mutex > lock( pendingLock );
+
+        // latency is measured from the scheduled arrival, so a generator that falls behind
+        // does not hide queueing delay
+        while ( arrivalTimeUs <= now ) {
+            auto transaction = generator->next();
+            submittedTransactions++;
+
+            if ( pending.size() >= maxPending ) {
+                droppedTransactions++;
+            } else {
+                pending.emplace( LoadGenerator::getSequence( transaction ),
+                    PendingTransaction{ std::move( transaction ), arrivalTimeUs } );
+            }
+
+            arrivalTimeUs = startTimeUs + generator->getNextArrivalUs();
+        }
+    }
+}
+
+
+ConsensusExtFace::transactions_vector Consensusb::pendingTransactions(
+    size_t _limit, u256& /*_stateRoot*/ ) {
+    transactions_vector result;
+
+    lock_guard< mutex > lock( pendingLock );
+
+    for ( auto it = pending.begin(); it != pending.end() && result.size() < _limit; it++ ) {
+        result.push_back( it->second.data );
+    }
+
+    return result;
+}
+
+
+void Consensusb::createBlock( const transactions_vector& _approvedTransactions,
+    uint64_t _timeStamp, uint32_t _timeStampMillis, uint64_t _blockID, u256, u256, uint64_t ) {
+    auto commitTimeUs = getCurrentTimeUs();
+
+    lock_guard< mutex > lock( pendingLock );
+
+    // every node commits every block, the first commit counts
+    if ( _blockID <= lastCommittedBlockID )
+        return;
+
+    lastCommittedBlockID = _blockID;
+
+    auto blockTimeStampMs = _timeStamp * 1000 + _timeStampMillis;
+    auto previousTimeStampMs = lastBlockTimeStampMs;
+    lastBlockTimeStampMs = blockTimeStampMs;
+
+    bool measured = commitTimeUs >= measureStartTimeUs &&
+                    ( measureEndTimeUs == 0 || commitTimeUs <= measureEndTimeUs );
+
+    for ( auto&& transaction : _approvedTransactions ) {
+        if ( transaction.size() < LoadGenerator::MIN_TRANSACTION_SIZE )
+            continue;
+
+        auto it = pending.find( LoadGenerator::getSequence( transaction ) );
+
+        if ( it == pending.end() )
+            continue;
+
+        if ( measured && it->second.submitTimeUs >= measureStartTimeUs ) {
+            latenciesUs.push_back( commitTimeUs - it->second.submitTimeUs );
+        }
+
+        pending.erase( it );
+    }
+
+    if ( !measured )
+        return;
+
+    committedBlocks++;
+    committedTransactions += _approvedTransactions.size();
+
+    for ( auto&& transaction : _approvedTransactions ) {
+        committedBytes += transaction.size();
+    }
+
+    if ( _approvedTransactions.empty() )
+        emptyBlocks++;
+
+    if ( previousTimeStampMs > 0 && blockTimeStampMs >= previousTimeStampMs )
+        blockTimesMs.push_back( blockTimeStampMs - previousTimeStampMs );
+}
+
+
+nlohmann::json Consensusb::getPercentiles( vector< uint64_t >& _values, double _scale ) {
+    auto result = nlohmann::json::object();
+
+    if ( _values.empty() )
+        return result;
+
+    sort( _values.begin(), _values.end() );
+
+    auto percentile = [&]( double _q ) {
+        auto index = min< uint64_t >( ( uint64_t )( _q * _values.size() ), _values.size() - 1 );
+        return _values[index] / _scale;
+    };
+
+    double sum = 0;
+    for ( auto value : _values )
+        sum += value;
+
+    result["mean"] = sum / _values.size() / _scale;
+    result["p50"] = percentile( 0.5 );
+    result["p90"] = percentile( 0.9 );
+    result["p99"] = percentile( 0.99 );
+    result["p999"] = percentile( 0.999 );
+    result["max"] = _values.back() / _scale;
+
+    return result;
+}
+
+
+nlohmann::json Consensusb::getReport() {
+    lock_guard< mutex > lock( pendingLock );
+
+    CHECK_STATE( measureEndTimeUs > measureStartTimeUs );
+
+    auto seconds = ( measureEndTimeUs - measureStartTimeUs ) / 1000000.0;
+
+    auto result = nlohmann::json::object();
+
+    result["measuredS"] = seconds;
+    result["submitted"] = submittedTransactions;
+    result["dropped"] = droppedTransactions;
+    result["pending"] = pending.size();
+    result["committed"] = committedTransactions;
+    result["tps"] = committedTransactions / seconds;
+    result["committedBytesPerS"] = committedBytes / seconds;
+    result["blocks"] = committedBlocks;
+    result["emptyBlocks"] = emptyBlocks;
+    result["lastBlockID"] = lastCommittedBlockID;
+    result["blockTimeMs"] = getPercentiles( blockTimesMs, 1 );
+    result["latencyMs"] = getPercentiles( latenciesUs, 1000 );
+
+    return result;
+}
+
+
+static nlohmann::json getNodeTraffic( ConsensusEngine& _engine ) {
+    auto result = nlohmann::json::array();
+
+    for ( auto&& item : _engine.getNodes() ) {
+        auto node = item.second;
+        CHECK_STATE( node );
+        auto schain = node->getSchain();
+        CHECK_STATE( schain );
+
+        auto traffic = nlohmann::json::object();
+        traffic["nodeID"] = ( uint64_t ) item.first;
+        traffic["ioRead"] = schain->getIo()->getNodeBytesRead();
+        traffic["ioWritten"] = schain->getIo()->getNodeBytesWritten();
+        traffic["messagesRead"] = node->getNetwork()->getMessageBytesReceived();
+        traffic["messagesWritten"] = node->getNetwork()->getMessageBytesSent();
+        result.push_back( traffic );
+    }
+
+    return result;
+}
+
+
+// replays a trace recorded with recordMessageTrace into the node that recorded it
+static nlohmann::json replayTrace( ConsensusEngine& _engine, const string& _traceFile ) {
+    auto nodeID = MessageReplayer::readNodeID( _traceFile );
+
+    auto it = _engine.getNodes().find( nodeID );
+
+    if ( it == _engine.getNodes().end() ) {
+        cerr << "Node " << nodeID << " that recorded the trace is not in the config" << endl;
+        exit( 1 );
+    }
+
+    auto startCpuUs = Consensusb::getCpuTimeUs();
+
+    nlohmann::json report;
+
+    {
+        MessageReplayer replayer( *it->second->getSchain() );
+        replayer.replay( _traceFile );
+        report = replayer.getReport();
+    }
+
+    report["cpuS"] = ( Consensusb::getCpuTimeUs() - startCpuUs ) / 1000000.0;
+    report["nodeID"] = ( uint64_t ) nodeID;
+
+    // the nodes were never started, so there is no block boundary to wait for
+    for ( auto&& item : _engine.getNodes() )
+        item.second->exitImmediately();
+
+    return report;
+}
+
+
+static void writeReport( const nlohmann::json& _report, const string& _output ) {
+    if ( _output == "-" ) {
+        cout << _report.dump() << endl;
+    } else {
+        ofstream file( _output );
+        file << _report.dump( 4 ) << endl;
+    }
+}
+
+
+static string getArgument(
+    const map< string, string >& _arguments, const string& _name, const string& _default ) {
+    auto it = _arguments.find( _name );
+    return it == _arguments.end() ? _default : it->second;
+}
+
+
+int main( int argc, char** argv ) {
+    signal( SIGPIPE, SIG_IGN );
+
+    if ( argc < 2 ) {
+        printf(
+            "Usage: consensusb nodes_dir [name=value ...]\n"
+            "  replay=message_trace.log\n"
+            "  duration_s=30 warmup_s=5 seed=1 max_pending=1000000\n"
+            "  arrival=constant|poisson|burst tps=1000 burst=100\n"
+            "  size=fixed|uniform|lognormal size_bytes=500 size_min=64 size_max=4096 "
+            "size_sigma=0.5\n"
+            "  network=emulation_config.json\n"
+            "  output=- min_tps=0 max_p99_ms=0\n" );
+        exit( 1 );
+    }
+
+    map< string, string > arguments;
+
+    for ( int i = 2; i < argc; i++ ) {
+        string argument( argv[i] );
+        auto separator = argument.find( '=' );
+        if ( separator == string::npos ) {
+            cerr << "Invalid argument:" << argument << endl;
+            exit( 1 );
+        }
+        arguments[argument.substr( 0, separator )] = argument.substr( separator + 1 );
+    }
+
+    auto arg = [&]( const string& _name, const string& _default ) {
+        return getArgument( arguments, _name, _default );
+    };
+
+    auto durationS = stoull( arg( "duration_s", "30" ) );
+    auto warmupS = stoull( arg( "warmup_s", "5" ) );
+    auto seed = stoull( arg( "seed", "1" ) );
+    auto tps = stod( arg( "tps", "1000" ) );
+    auto minTps = stod( arg( "min_tps", "0" ) );
+    auto maxP99Ms = stod( arg( "max_p99_ms", "0" ) );
+    auto output = arg( "output", "-" );
+
+    auto generator = make_shared< LoadGenerator >(
+        LoadGenerator::parseArrivalProcess( arg( "arrival", "poisson" ) ), tps,
+        stoull( arg( "burst", "100" ) ),
+        LoadGenerator::parseSizeDistribution( arg( "size", "fixed" ) ),
+        stoull( arg( "size_bytes", "500" ) ), stoull( arg( "size_min", "64" ) ),
+        stoull( arg( "size_max", "4096" ) ), stod( arg( "size_sigma", "0.5" ) ), seed );
+
+    // the benchmark always starts from block zero, so use fresh databases
+    if ( !getenv( "DATA_DIR" ) ) {
+        char dataDir[] = "/tmp/consensusb.XXXXXX";
+        CHECK_STATE( mkdtemp( dataDir ) );
+        setenv( "DATA_DIR", dataDir, 1 );
+    }
+
+    auto network = arg( "network", "" );
+
+    // picked up when the nodes are created
+    if ( !network.empty() ) {
+        setenv( "NETWORK_EMULATION_CONFIG", network.c_str(), 1 );
+    }
+
+    Consensusb benchmark( generator, stoull( arg( "max_pending", "1000000" ) ) );
+
+    ConsensusEngine engine( benchmark, 0, 0, 0, {}, 1000000000 );
+
+    fs_path dirPath( boost::filesystem::system_complete( fs_path( argv[1] ) ) );
+
+    engine.parseTestConfigsAndCreateAllNodes( dirPath );
+
+    auto trace = arg( "replay", "" );
+
+    if ( !trace.empty() ) {
+        auto report = replayTrace( engine, trace );
+        report["config"] = arguments;
+        report["config"]["nodes_dir"] = dirPath.string();
+
+        engine.exitGracefully();
+
+        while ( engine.getStatus() != CONSENSUS_EXITED ) {
+            usleep( 100 * 1000 );
+        }
+
+        writeReport( report, output );
+
+        return report["mismatchedBlocks"].empty() ? 0 : 2;
+    }
+
+    engine.slowStartBootStrapTest();
+
+    benchmark.startLoad();
+
+    sleep( warmupS );
+
+    benchmark.startMeasurement();
+    auto startCpuUs = Consensusb::getCpuTimeUs();
+    auto startTraffic = getNodeTraffic( engine );
+
+    sleep( durationS );
+
+    auto endCpuUs = Consensusb::getCpuTimeUs();
+    auto endTraffic = getNodeTraffic( engine );
+    benchmark.stopLoad();
+
+    auto report = benchmark.getReport();
+
+    uint64_t nodeCount = ( uint64_t ) engine.nodesCount();
+    double measuredS = report["measuredS"];
+
+    report["config"] = arguments;
+    report["config"]["nodes_dir"] = dirPath.string();
+    report["nodes"] = nodeCount;
+
+    // all nodes share the process, so CPU is reported for the process and per node on average
+    auto cpuS = ( endCpuUs - startCpuUs ) / 1000000.0;
+    report["cpu"]["processS"] = cpuS;
+    report["cpu"]["perNodeS"] = cpuS / nodeCount;
+    report["cpu"]["cores"] = cpuS / measuredS;
+
+    if ( auto emulator = NetworkEmulator::getShared() ) {
+        // transfers/lost/blocked
+        report["networkEmulation"] = emulator->getStats();
+    }
+
+    report["perNode"] = nlohmann::json::array();
+
+    for ( uint64_t i = 0; i < endTraffic.size(); i++ ) {
+        auto traffic = nlohmann::json::object();
+        traffic["nodeID"] = endTraffic[i]["nodeID"];
+        for ( auto&& key : { "ioRead", "ioWritten", "messagesRead", "messagesWritten" } ) {
+            uint64_t end = endTraffic[i][key];
+            uint64_t start = startTraffic[i][key];
+            traffic[string( key ) + "BytesPerS"] = ( end - start ) / measuredS;
+        }
+        report["perNode"].push_back( traffic );
+    }
+
+    engine.exitGracefully();
+
+    while ( engine.getStatus() != CONSENSUS_EXITED ) {
+        usleep( 100 * 1000 );
+    }
+
+    writeReport( report, output );
+
+    int result = 0;
+
+    if ( minTps > 0 && ( double ) report["tps"] < minTps ) {
+        cerr << "TPS " << report["tps"] << " is below " << minTps << endl;
+        result = 2;
+    }
+
+    if ( maxP99Ms > 0 && ( report["latencyMs"].count( "p99" ) == 0 ||
+                             ( double ) report["latencyMs"]["p99"] > maxP99Ms ) ) {
+        cerr << "p99 latency is above " << maxP99Ms << " ms" << endl;
+        result = 2;
+    }
+
+    return result;
+}
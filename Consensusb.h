@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file Consensusb.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "node/ConsensusInterface.h"
+#include "thirdparty/json.hpp"
+
+class ConsensusEngine;
+class LoadGenerator;
+
+/*
+ * Consensus benchmark.
+ *
+ * Plays the role of skaled for all nodes of a test config running in one process. Transactions
+ * from a LoadGenerator go to a pending pool shared by the nodes, like a mempool that every
+ * transaction is broadcast to, and are removed from it when the first node commits them.
+ */
+class Consensusb : public ConsensusExtFace {
+    class PendingTransaction {
+    public:
+        vector< uint8_t > data;
+
+        uint64_t submitTimeUs;
+    };
+
+    const ptr< LoadGenerator > generator;
+
+    const uint64_t maxPending;
+
+    uint64_t startTimeUs = 0;
+
+    uint64_t measureStartTimeUs = 0;
+
+    uint64_t measureEndTimeUs = 0;
+
+    atomic< bool > stopRequested = false;
+
+    ptr< thread > generatorThread;
+
+    mutex pendingLock;
+
+    // the fields below are protected by pendingLock
+
+    map< uint64_t, PendingTransaction > pending;
+
+    uint64_t submittedTransactions = 0;
+
+    uint64_t droppedTransactions = 0;
+
+    uint64_t lastCommittedBlockID = 0;
+
+    uint64_t lastBlockTimeStampMs = 0;
+
+    uint64_t committedTransactions = 0;
+
+    uint64_t committedBytes = 0;
+
+    uint64_t committedBlocks = 0;
+
+    uint64_t emptyBlocks = 0;
+
+    vector< uint64_t > latenciesUs;
+
+    vector< uint64_t > blockTimesMs;
+
+    void generateLoop();
+
+    static nlohmann::json getPercentiles( vector< uint64_t >& _values, double _scale );
+
+public:
+    static uint64_t getCurrentTimeUs();
+
+    // process user plus system CPU time
+    static uint64_t getCpuTimeUs();
+
+    Consensusb( const ptr< LoadGenerator >& _generator, uint64_t _maxPending );
+
+    ~Consensusb() override;
+
+    transactions_vector pendingTransactions( size_t _limit, u256& _stateRoot ) override;
+
+    void createBlock( const transactions_vector& _approvedTransactions, uint64_t _timeStamp,
+        uint32_t _timeStampMillis, uint64_t _blockID, u256 _gasPrice, u256 _stateRoot,
+        uint64_t _winningNodeIndex ) override;
+
+    void startLoad();
+
+    // only commits after this call are counted
+    void startMeasurement();
+
+    void stopLoad();
+
+    nlohmann::json getReport();
+};
@@ -41,6 +41,9 @@
 #include "Log.h"
 #include "crypto/CryptoManager.h"
 #include "node/ConsensusEngine.h"
+#include "node/Node.h"
+#include "chains/Schain.h"
+#include "blockproposal/server/BlockProposalServerAgent.h"
 
 #include "iostream"
 #include "time.h"
@@ -195,3 +198,11 @@ void exit_check() {
 
 #include "unittests/consensus_tests.cpp"
 #include "unittests/sgx_tests.cpp"
+#include "unittests/oracle_tests.cpp"
+#include "unittests/pendingqueue_tests.cpp"
+#include "unittests/pricing_tests.cpp"
+#include "unittests/blockproposal_tests.cpp"
+#include "unittests/executor_tests.cpp"
+#include "unittests/compression_tests.cpp"
+#include "unittests/timerwheel_tests.cpp"
+#include "unittests/crypto_tests.cpp"
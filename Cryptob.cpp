@@ -0,0 +1,218 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file Cryptob.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <random>
+
+#include <openssl/ecdsa.h>
+#include <openssl/obj_mac.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "crypto/OpenSSLECDSAKey.h"
+#include "crypto/OpenSSLEdDSAKey.h"
+#include "thirdparty/json.hpp"
+
+/*
+ * Crypto microbenchmark.
+ *
+ * Measures the verification throughput of the consensus message signatures: Ed25519 session
+ * signatures with the public key parsed for each message, with a parsed key, and in batches
+ * of one key, and SGX ECDSA signatures with and without a parsed key.
+ */
+
+static uint64_t getCurrentTimeUs() {
+    return chrono::duration_cast< chrono::microseconds >(
+        chrono::steady_clock::now().time_since_epoch() )
+        .count();
+}
+
+
+static string bnToHex64( const BIGNUM* _bn ) {
+    auto hex = BN_bn2hex( _bn );
+    CHECK_STATE( hex );
+    string result( hex );
+    OPENSSL_free( hex );
+    CHECK_STATE( result.size() <= 64 );
+    return string( 64 - result.size(), '0' ) + result;
+}
+
+
+// a secp256k1 key and a signature in the format used by the SGX server
+static pair< string, string > sgxSign( const array< uint8_t, 32 >& _hash ) {
+    auto key = EC_KEY_new_by_curve_name( NID_secp256k1 );
+    CHECK_STATE( key );
+    CHECK_STATE( EC_KEY_generate_key( key ) == 1 );
+
+    auto x = BN_new();
+    auto y = BN_new();
+    CHECK_STATE( EC_POINT_get_affine_coordinates_GFp(
+                     EC_KEY_get0_group( key ), EC_KEY_get0_public_key( key ), x, y, nullptr ) );
+    auto publicKey = bnToHex64( x ) + bnToHex64( y );
+    BN_free( x );
+    BN_free( y );
+
+    auto sig = ECDSA_do_sign( _hash.data(), 32, key );
+    CHECK_STATE( sig );
+    const BIGNUM* r = nullptr;
+    const BIGNUM* s = nullptr;
+    ECDSA_SIG_get0( sig, &r, &s );
+    auto signature = "27:" + bnToHex64( r ) + ":" + bnToHex64( s );
+    ECDSA_SIG_free( sig );
+    EC_KEY_free( key );
+
+    return { publicKey, signature };
+}
+
+
+template < typename F >
+static nlohmann::json measure( uint64_t _verifications, F&& _f ) {
+    auto startUs = getCurrentTimeUs();
+    _f();
+    auto elapsedUs = max( getCurrentTimeUs() - startUs, ( uint64_t ) 1 );
+
+    nlohmann::json result;
+    result["verifications"] = _verifications;
+    result["timeMs"] = elapsedUs / 1000.0;
+    result["verificationsPerS"] = _verifications * 1000000.0 / elapsedUs;
+    return result;
+}
+
+
+int main( int argc, char** argv ) {
+    map< string, string > arguments;
+
+    for ( int i = 1; i < argc; i++ ) {
+        string argument( argv[i] );
+        auto separator = argument.find( '=' );
+        if ( separator == string::npos ) {
+            printf( "Usage: cryptob [messages=20000] [keys=16] [batch=64]\n" );
+            exit( 1 );
+        }
+        arguments[argument.substr( 0, separator )] = argument.substr( separator + 1 );
+    }
+
+    auto arg = [&]( const string& _name, uint64_t _default ) {
+        auto it = arguments.find( _name );
+        return it == arguments.end() ? _default : ( uint64_t ) stoull( it->second );
+    };
+
+    auto messageCount = arg( "messages", 20000 );
+    auto keyCount = arg( "keys", 16 );
+    auto batchSize = arg( "batch", 64 );
+
+    CHECK_ARGUMENT( messageCount > 0 && keyCount > 0 && batchSize > 0 );
+
+    mt19937_64 rng( 1 );
+
+    vector< array< uint8_t, 32 > > hashes( messageCount );
+    for ( auto&& hash : hashes )
+        for ( auto&& byte : hash )
+            byte = ( uint8_t ) rng();
+
+    // like a block burst, every key signs a share of the messages
+    vector< ptr< OpenSSLEdDSAKey > > privateKeys;
+    vector< string > publicKeys;
+    for ( uint64_t i = 0; i < keyCount; i++ ) {
+        privateKeys.push_back( OpenSSLEdDSAKey::generateKey() );
+        publicKeys.push_back( privateKeys.back()->serializePubKey() );
+    }
+
+    vector< string > signatures;
+    for ( uint64_t i = 0; i < messageCount; i++ )
+        signatures.push_back(
+            privateKeys.at( i % keyCount )->sign( ( const char* ) hashes.at( i ).data() ) );
+
+    nlohmann::json report;
+
+    report["config"]["messages"] = messageCount;
+    report["config"]["keys"] = keyCount;
+    report["config"]["batch"] = batchSize;
+
+    report["ed25519"]["parsePerMessage"] = measure( messageCount, [&]() {
+        for ( uint64_t i = 0; i < messageCount; i++ ) {
+            auto key = OpenSSLEdDSAKey::importPubKey( publicKeys.at( i % keyCount ) );
+            key->verifySig( signatures.at( i ), ( const char* ) hashes.at( i ).data() );
+        }
+    } );
+
+    vector< ptr< OpenSSLEdDSAKey > > parsedKeys;
+    for ( auto&& publicKey : publicKeys )
+        parsedKeys.push_back( OpenSSLEdDSAKey::importPubKey( publicKey ) );
+
+    report["ed25519"]["parsedKey"] = measure( messageCount, [&]() {
+        for ( uint64_t i = 0; i < messageCount; i++ ) {
+            parsedKeys.at( i % keyCount )
+                ->verifySig( signatures.at( i ), ( const char* ) hashes.at( i ).data() );
+        }
+    } );
+
+    report["ed25519"]["batch"] = measure( messageCount, [&]() {
+        for ( uint64_t start = 0; start < messageCount; start += batchSize ) {
+            auto end = min( start + batchSize, messageCount );
+            // group the burst by key, like CryptoManager::verifyNetworkMsgs
+            for ( uint64_t k = 0; k < keyCount; k++ ) {
+                vector< pair< string, const char* > > sigsAndHashes;
+                for ( auto i = start; i < end; i++ ) {
+                    if ( i % keyCount == k )
+                        sigsAndHashes.emplace_back(
+                            signatures.at( i ), ( const char* ) hashes.at( i ).data() );
+                }
+                if ( sigsAndHashes.empty() )
+                    continue;
+                for ( auto verified : parsedKeys.at( k )->verifySigs( sigsAndHashes ) )
+                    CHECK_STATE( verified );
+            }
+        }
+    } );
+
+    // SGX ECDSA signatures certify the session keys, one per node and block
+    auto ecdsaCount = max( messageCount / 10, ( uint64_t ) 1 );
+
+    vector< pair< string, string > > ecdsaKeysAndSigs;
+    for ( uint64_t i = 0; i < keyCount; i++ )
+        ecdsaKeysAndSigs.push_back( sgxSign( hashes.at( i % messageCount ) ) );
+
+    report["ecdsa"]["parsePerMessage"] = measure( ecdsaCount, [&]() {
+        for ( uint64_t i = 0; i < ecdsaCount; i++ ) {
+            auto& [publicKey, signature] = ecdsaKeysAndSigs.at( i % keyCount );
+            OpenSSLECDSAKey::importSGXPubKey( publicKey )
+                ->verifySGXSig( signature, ( const char* ) hashes.at( i % keyCount ).data() );
+        }
+    } );
+
+    vector< ptr< OpenSSLECDSAKey > > parsedECDSAKeys;
+    for ( auto&& item : ecdsaKeysAndSigs )
+        parsedECDSAKeys.push_back( OpenSSLECDSAKey::importSGXPubKey( item.first ) );
+
+    report["ecdsa"]["parsedKey"] = measure( ecdsaCount, [&]() {
+        for ( uint64_t i = 0; i < ecdsaCount; i++ ) {
+            parsedECDSAKeys.at( i % keyCount )
+                ->verifySGXSig( ecdsaKeysAndSigs.at( i % keyCount ).second,
+                    ( const char* ) hashes.at( i % keyCount ).data() );
+        }
+    } );
+
+    cout << report.dump( 4 ) << endl;
+
+    return 0;
+}
@@ -157,6 +157,12 @@ static const uint64_t MAX_CONSENSUS_HISTORY = 2 * MAX_ACTIVE_CONSENSUSES;
 
 static const uint64_t SESSION_KEY_CACHE_SIZE = 2;
 static const uint64_t SESSION_PUBLIC_KEY_CACHE_SIZE = 16;
+// parsed OpenSSL keys, so that a key is not parsed again for each message
+static const uint64_t PARSED_PUBLIC_KEY_CACHE_SIZE = 128;
+// consensus messages that are already waiting are read and verified together, up to this many
+static const uint64_t MAX_MESSAGE_VERIFY_BATCH = 64;
+// session keys are created and SGX-certified this many blocks ahead
+static const uint64_t SESSION_KEY_PREGENERATION_BLOCKS = 4;
 
 // catchup happens in chunks of 32 MB MAX
 static constexpr uint64_t MAX_CATCHUP_DOWNLOAD_BYTES = 64 * 1024 * 1024;
@@ -183,6 +189,17 @@ static constexpr uint64_t WAIT_AFTER_NETWORK_ERROR_MS = 3000;
 
 static constexpr uint64_t CONNECTION_REFUSED_LOG_INTERVAL_MS = 10 * 60 * 1000;
 
+// time a peer has to send magic and request header to a TCP server
+static constexpr uint64_t SERVER_REQUEST_READ_TIMEOUT_MS = 30000;
+
+// time a peer has to complete a body read or a response write that a TCP server runs for it
+static constexpr uint64_t SERVER_TRANSFER_TIMEOUT_MS = 30000;
+
+// requests that waited for a worker longer than this are dropped, the peer has timed out anyway
+static constexpr uint64_t SERVER_QUEUE_TIMEOUT_MS = 10000;
+
+static constexpr uint64_t MAX_PENDING_SERVER_CONNECTIONS = 1024;
+
 // Non-tunable params
 
 static constexpr uint32_t SOCKET_BACKLOG = 64;
@@ -321,11 +338,14 @@ static const num_threads NUM_SCHAIN_THREADS = num_threads( 1 );
 
 static const num_threads NUM_DISPATCH_THREADS = num_threads( 1 );
 
-static const num_threads NUM_ORACLE_THREADS = num_threads( 1 );
-
-static const uint64_t ORACLE_QUEUE_TIMEOUT_MS = 1000;
 static const uint64_t ORACLE_TIMEOUT_MS = 30000;
 static const uint64_t ORACLE_REQUEST_AGE_ON_RECEIPT_MS = 10000;
+static const uint64_t ORACLE_HTTP_TIMEOUT_MS = 2000;
+static const uint64_t ORACLE_MAX_CONCURRENT_REQUESTS = 64;
+static const uint64_t ORACLE_MAX_CONNECTIONS_PER_HOST = 8;
+static const uint64_t ORACLE_MAX_REQUESTS_PER_SECOND_PER_HOST = 20;
+static const uint64_t ORACLE_RESPONSE_CACHE_TTL_MS = 1000;
+static const uint64_t ORACLE_RESPONSE_CACHE_SIZE = 1024;
 
 
 static const uint64_t DEFAULT_DB_STORAGE_LIMIT = 5000000000;  // 5Gbyte
@@ -344,6 +364,12 @@ static const uint64_t ZMQ_RECEIVE_RETRY_MS = 10;
 
 static const uint64_t DEFAULT_MIN_PRICE = 100000;
 
+// prices and randoms of this many recent blocks are kept in memory, a power of 2
+static const uint64_t RECENT_BLOCK_VALUES = 1024;
+
+// prices are written to the price db once this many are pending
+static const uint64_t PRICE_DB_WRITE_BATCH = 16;
+
 static const uint64_t COMMON_COIN_ROUND = 4;
 
 static const uint64_t ORACLE_RECEIPTS_MAP_SIZE = 100000;
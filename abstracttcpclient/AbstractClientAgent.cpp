@@ -46,6 +46,7 @@ blic License as published
 
 #include "datastructures/BlockProposal.h"
 #include "datastructures/DAProof.h"
+#include "threads/TaskExecutor.h"
 #include "utils/Time.h"
 
 
@@ -60,13 +61,8 @@ AbstractClientAgent::AbstractClientAgent( Schain& _sChain, port_type _portType )
         ( itemQueue ).emplace( schain_index( i ), make_shared< queue< ptr< SendableItem > > >() );
         ( queueCond ).emplace( schain_index( i ), make_shared< condition_variable >() );
         ( queueMutex ).emplace( schain_index( i ), make_shared< std::mutex >() );
+        sending.emplace( schain_index( i ), false );
     }
-
-    threadCounter = 0;
-}
-
-uint64_t AbstractClientAgent::incrementAndReturnThreadCounter() {
-    return threadCounter++;  // l_sergiy: increment/return-prev of atomic variable
 }
 
 
@@ -123,100 +119,82 @@ void AbstractClientAgent::enqueueItemImpl( const ptr< SendableItem >& _item ) {
                  dynamic_pointer_cast< BlockProposal >( _item ) );
 
 
+    CHECK_STATE( sendExecutor );
+
     for ( uint64_t i = 1; i <= ( uint64_t ) getSchain()->getNodeCount(); i++ ) {
-        {
-            lock_guard< std::mutex > lock( *queueMutex[schain_index( i )] );
-            auto q = itemQueue[schain_index( i )];
-            CHECK_STATE( q );
-            CHECK_STATE( dynamic_pointer_cast< DAProof >( _item ) ||
-                         dynamic_pointer_cast< BlockProposal >( _item ) );
-            q->push( _item );
-
-            if ( q->size() > MAX_PROPOSAL_QUEUE_SIZE ) {
-                // the destination is not accepting proposals, remove older
-                q->pop();
-            }
-        }
-        queueCond.at( schain_index( i ) )->notify_all();
-    }
-}
+        auto dstIndex = schain_index( i );
 
+        if ( dstIndex == getSchain()->getSchainIndex() )
+            continue;
 
-void AbstractClientAgent::workerThreadItemSendLoop( AbstractClientAgent* agent ) {
-    CHECK_STATE( agent );
+        lock_guard< std::mutex > lock( *queueMutex[dstIndex] );
+        auto q = itemQueue[dstIndex];
+        CHECK_STATE( q );
+        q->push( _item );
 
-    setThreadName( "BlockPopClnt", agent->getSchain()->getNode()->getConsensusEngine() );
+        if ( q->size() > MAX_PROPOSAL_QUEUE_SIZE ) {
+            // the destination is not accepting proposals, remove older
+            q->pop();
+        }
 
-    agent->waitOnGlobalStartBarrier();
+        // a destination has at most one send task, so that its items are sent in order
+        if ( !sending[dstIndex] ) {
+            sending[dstIndex] = true;
+            sendExecutor->submit( [this, dstIndex]() { sendQueuedItems( dstIndex ); } );
+        }
+    }
+}
 
-    auto destinationSchainIndex = schain_index( agent->incrementAndReturnThreadCounter() + 1 );
 
-    ptr< SendableItem > proposal = nullptr;
+void AbstractClientAgent::sendQueuedItems( schain_index _dstIndex ) {
+    waitOnGlobalStartBarrier();
 
     try {
-        while ( !agent->getSchain()->getNode()->isExitRequested() ) {
-            {
-                std::unique_lock< std::mutex > mlock( *agent->queueMutex[destinationSchainIndex] );
+        while ( !getNode()->isExitRequested() ) {
+            ptr< SendableItem > item = nullptr;
 
-                while ( agent->itemQueue[destinationSchainIndex]->empty() ) {
-                    if ( agent->getSchain()->getNode()->isExitRequested() )
-                        return;
-                    agent->getSchain()->getNode()->exitCheck();
-                    agent->queueCond[destinationSchainIndex]->wait( mlock );
-                }
-
-
-                CHECK_STATE( agent->itemQueue[destinationSchainIndex] );
-
-                proposal = agent->itemQueue[destinationSchainIndex]->front();
+            {
+                lock_guard< std::mutex > lock( *queueMutex[_dstIndex] );
 
-                CHECK_STATE( proposal );
+                auto q = itemQueue[_dstIndex];
 
-                CHECK_STATE( dynamic_pointer_cast< DAProof >( proposal ) ||
-                             dynamic_pointer_cast< BlockProposal >( proposal ) );
+                // the next enqueued item starts a new task
+                if ( q->empty() ) {
+                    sending[_dstIndex] = false;
+                    return;
+                }
 
-                agent->itemQueue[destinationSchainIndex]->pop();
+                item = q->front();
+                q->pop();
             }
 
+            CHECK_STATE( item );
 
-            if ( ( uint64_t ) destinationSchainIndex !=
-                 ( uint64_t ) agent->getSchain()->getSchainIndex() ) {
-                bool sent = false;
-
-                while ( !sent ) {
-                    if ( agent->getSchain()->getNode()->isExitRequested() )
-                        return;
-                    try {
-                        agent->sendItem( proposal, destinationSchainIndex );
-                        sent = true;
-                    } catch ( ConnectionRefusedException& e ) {
-                        agent->logConnectionRefused( e, destinationSchainIndex );
+            bool sent = false;
 
-                        if ( agent->getNode()->isExitRequested() )
-                            return;
-
-                        usleep( agent->getNode()->getWaitAfterNetworkErrorMs() * 1000 );
-                    } catch ( exception& e ) {
-                        SkaleException::logNested( e );
-
-                        if ( agent->getNode()->isExitRequested() )
-                            return;
-
-                        usleep( agent->getNode()->getWaitAfterNetworkErrorMs() * 1000 );
-                    }
+            while ( !sent && !getNode()->isExitRequested() ) {
+                try {
+                    sendItem( item, _dstIndex );
+                    sent = true;
+                } catch ( ConnectionRefusedException& e ) {
+                    logConnectionRefused( e, _dstIndex );
+                    usleep( getNode()->getWaitAfterNetworkErrorMs() * 1000 );
+                } catch ( exception& e ) {
+                    SkaleException::logNested( e );
+                    usleep( getNode()->getWaitAfterNetworkErrorMs() * 1000 );
                 }
             }
-        };
-    }
-
-    catch ( FatalError& e ) {
+        }
+    } catch ( FatalError& e ) {
         SkaleException::logNested( e );
-        agent->getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
-    } catch ( ExitRequestedException& e ) {
-        return;
+        getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
+    } catch ( ExitRequestedException& ) {
     } catch ( exception& e ) {
         SkaleException::logNested( e );
     }
+
+    lock_guard< std::mutex > lock( *queueMutex[_dstIndex] );
+    sending[_dstIndex] = false;
 }
 
 void AbstractClientAgent::enqueueItem( const ptr< BlockProposal >& _item ) {
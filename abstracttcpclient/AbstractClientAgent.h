@@ -36,12 +36,18 @@ class DataStructure;
 class BlockProposal;
 class DAProof;
 class ClientSocket;
+class TaskExecutor;
 
 class AbstractClientAgent : public Agent {
 protected:
     port_type portType;
 
-    atomic< uint64_t > threadCounter;
+    // runs one send task per destination that has queued items. Created and reset by
+    // subclasses, since the tasks call sendItemImpl
+    ptr< TaskExecutor > sendExecutor;
+
+    // true while a send task runs for the destination, protected by queueMutex
+    map< schain_index, bool > sending;
 
     explicit AbstractClientAgent( Schain& _sChain, port_type _portType );
 
@@ -54,12 +60,12 @@ protected:
 
     std::map< schain_index, ptr< queue< ptr< SendableItem > > > > itemQueue;  // thread safe
 
-    uint64_t incrementAndReturnThreadCounter();
-
     void enqueueItemImpl( const ptr< SendableItem >& _item );
 
+    // sends the queued items of the destination until its queue is empty
+    void sendQueuedItems( schain_index _dstIndex );
+
 public:
-    static void workerThreadItemSendLoop( AbstractClientAgent* agent );
 
     void enqueueItem( const ptr< BlockProposal >& _item );
 
@@ -30,6 +30,8 @@
 #include "chains/Schain.h"
 #include "Agent.h"
 
+#include "exceptions/ExitRequestedException.h"
+#include "exceptions/FatalError.h"
 #include "exceptions/OldBlockIDException.h"
 
 
@@ -42,13 +44,18 @@
 #include "network/ServerConnection.h"
 #include "network/Sockets.h"
 #include "network/TCPServerSocket.h"
+#include "utils/Time.h"
 
 
 #include "AbstractServerAgent.h"
+#include "TCPServerReactor.h"
 
 void AbstractServerAgent::pushToQueueAndNotifyWorkers(
     const ptr< ServerConnection >& _connectionEnvelope ) {
     CHECK_ARGUMENT( _connectionEnvelope );
+    // a deferred request keeps the time it was first queued
+    if ( _connectionEnvelope->getQueuedTimeMs() == 0 )
+        _connectionEnvelope->setQueuedTimeMs( Time::getCurrentTimeMs() );
     lock_guard< mutex > lock( incomingTCPConnectionsMutex );
     incomingTCPConnections.push( _connectionEnvelope );
     incomingTCPConnectionsCond.notify_all();
@@ -95,6 +102,19 @@ void AbstractServerAgent::workerThreadConnectionProcessingLoop( void* _params )
             if ( server->getNode()->isExitRequested() )
                 return;  // notice - connection is nullptr in this case
             CHECK_STATE( connection );
+
+            // the next step of a request after a transfer the reactor ran for it
+            auto continuation = connection->takeContinuation();
+            if ( continuation ) {
+                continuation();
+                continue;
+            }
+
+            if ( Time::getCurrentTimeMs() > connection->getDeadlineMs() ) {
+                LOG( warn, server->name << ": dropping request that waited too long in queue from:"
+                                        << connection->getIP() );
+                continue;
+            }
             server->processNextAvailableConnection( connection );
         } catch ( PingException& e ) {
             LOG( info, e.what() );
@@ -115,6 +135,66 @@ void AbstractServerAgent::send(
     getSchain()->getIo()->writeBuf( _connectionEnvelope->getDescriptor(), buf );
 }
 
+void AbstractServerAgent::readAsync( const ptr< ServerConnection >& _connection,
+    const ptr< vector< uint8_t > >& _buffer, uint64_t _len, function< void() >&& _next,
+    function< void() >&& _failed ) {
+    CHECK_ARGUMENT( _connection );
+    CHECK_ARGUMENT( _buffer && _buffer->size() >= _len );
+    CHECK_STATE( reactor );
+
+    if ( _len == 0 ) {
+        _next();
+        return;
+    }
+
+    auto transfer = make_shared< TCPServerReactor::Transfer >();
+    transfer->kind = TCPServerReactor::Transfer::READ_BYTES;
+    transfer->buffer = _buffer;
+    transfer->length = _len;
+    transfer->deadlineMs = Time::getCurrentTimeMs() + SERVER_TRANSFER_TIMEOUT_MS;
+    transfer->onDone = std::move( _next );
+    transfer->onFailed = std::move( _failed );
+
+    reactor->submit( _connection, transfer );
+}
+
+void AbstractServerAgent::readHeaderAsync( const ptr< ServerConnection >& _connection,
+    function< void( const string& ) >&& _next, function< void() >&& _failed ) {
+    CHECK_ARGUMENT( _connection );
+    CHECK_STATE( reactor );
+
+    auto buffer = make_shared< vector< uint8_t > >();
+
+    auto transfer = make_shared< TCPServerReactor::Transfer >();
+    transfer->kind = TCPServerReactor::Transfer::READ_HEADER;
+    transfer->buffer = buffer;
+    transfer->deadlineMs = Time::getCurrentTimeMs() + SERVER_TRANSFER_TIMEOUT_MS;
+    transfer->onDone = [buffer, next = std::move( _next )]() {
+        next( string( buffer->begin(), buffer->end() ) );
+    };
+    transfer->onFailed = std::move( _failed );
+
+    reactor->submit( _connection, transfer );
+}
+
+void AbstractServerAgent::writeAsync( const ptr< ServerConnection >& _connection,
+    vector< iovec >&& _iovecs, const ptr< void >& _buffers, function< void() >&& _next,
+    function< void() >&& _failed ) {
+    CHECK_ARGUMENT( _connection );
+    CHECK_ARGUMENT( !_iovecs.empty() );
+    CHECK_STATE( reactor );
+
+    auto transfer = make_shared< TCPServerReactor::Transfer >();
+    transfer->kind = TCPServerReactor::Transfer::WRITE;
+    transfer->iovecs = std::move( _iovecs );
+    transfer->buffers = _buffers;
+    transfer->deadlineMs = Time::getCurrentTimeMs() + SERVER_TRANSFER_TIMEOUT_MS;
+    transfer->onDone = std::move( _next );
+    transfer->onFailed = std::move( _failed );
+
+    reactor->submit( _connection, transfer );
+}
+
 AbstractServerAgent::AbstractServerAgent(
     const string& _name, Schain& _schain, const ptr< TCPServerSocket >& _socket )
     : Agent( _schain, true ), name( _name ), socket( _socket ), networkReadThread( nullptr ) {
@@ -130,32 +210,12 @@ void AbstractServerAgent::acceptTCPConnectionsLoop() {
 
     waitOnGlobalStartBarrier();
 
-    struct sockaddr_in clientAddress;
-    socklen_t sizeOfClientAddress = sizeof( clientAddress );
-    CHECK_STATE( this->socket > 0 );
-    auto s = dynamic_pointer_cast< TCPServerSocket >( this->socket )->getDescriptor();
-    CHECK_STATE( s > 0 );
-    try {
-        while ( !getSchain()->getNode()->isExitRequested() ) {
-            int newConnection = accept( s, ( sockaddr* ) &clientAddress, &sizeOfClientAddress );
-
-            // static  int one = 1;
-            // CHECK_STATE(setsockopt(newConnection, SOL_TCP, TCP_NODELAY, &one, sizeof(one)) == 0);
-
-            if ( getSchain()->getNode()->isExitRequested() ) {
-                return;
-            }
-
-            if ( newConnection < 0 ) {
-                BOOST_THROW_EXCEPTION( NetworkProtocolException(
-                    "accept failed:" + string( strerror( errno ) ), __CLASS_NAME__ ) );
-            }
-
-            string ip( inet_ntoa( clientAddress.sin_addr ) );
+    CHECK_STATE( reactor );
 
-            this->pushToQueueAndNotifyWorkers(
-                make_shared< ServerConnection >( newConnection, ip ) );
-        }
+    try {
+        reactor->run();
+    } catch ( ExitRequestedException& ) {
+        return;
     } catch ( FatalError& e ) {
         SkaleException::logNested( e );
         getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
@@ -164,6 +224,10 @@ void AbstractServerAgent::acceptTCPConnectionsLoop() {
 
 void AbstractServerAgent::createNetworkReadThread() {
     LOG( trace, name << " Starting TCP server network read loop" );
+    CHECK_STATE( this->socket > 0 );
+    auto s = dynamic_pointer_cast< TCPServerSocket >( this->socket )->getDescriptor();
+    CHECK_STATE( s > 0 );
+    reactor = make_shared< TCPServerReactor >( *this, s, socket->getPortType() );
     networkReadThread =
         make_shared< thread >( std::bind( &AbstractServerAgent::acceptTCPConnectionsLoop, this ) );
     LOG( trace, name << " Started TCP server network read loop" );
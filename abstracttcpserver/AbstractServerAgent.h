@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <sys/uio.h>
+
 #include "Agent.h"
 
 class ServerConnection;
@@ -32,6 +34,7 @@ class TCPServerSocket;
 class ServerSocket;
 class Header;
 class PartialHashesList;
+class TCPServerReactor;
 
 
 class AbstractServerAgent : public Agent {
@@ -42,6 +45,8 @@ protected:
 
     ptr< thread > networkReadThread;
 
+    ptr< TCPServerReactor > reactor;
+
     mutex incomingTCPConnectionsMutex;
 
     condition_variable incomingTCPConnectionsCond;
@@ -50,6 +55,22 @@ protected:
 
     void send( const ptr< ServerConnection >& _connectionEnvelope, const ptr< Header >& _header );
 
+    // hands the connection to the reactor, which reads _len bytes into _buffer without blocking
+    // a worker thread. _next runs on a worker thread once they arrived, _failed if the peer
+    // closes the connection or does not send them within SERVER_TRANSFER_TIMEOUT_MS.
+    // The connection must not be used by the caller after this call
+    void readAsync( const ptr< ServerConnection >& _connection,
+        const ptr< vector< uint8_t > >& _buffer, uint64_t _len, function< void() >&& _next,
+        function< void() >&& _failed );
+
+    // the same for a header length and a JSON header, _next gets the header
+    void readHeaderAsync( const ptr< ServerConnection >& _connection,
+        function< void( const string& ) >&& _next, function< void() >&& _failed );
+
+    // the same for sending _iovecs, _buffers keeps their memory until they are sent
+    void writeAsync( const ptr< ServerConnection >& _connection, vector< iovec >&& _iovecs,
+        const ptr< void >& _buffers, function< void() >&& _next, function< void() >&& _failed );
+
 
 public:
     AbstractServerAgent(
@@ -77,6 +98,8 @@ public:
         const ptr< ServerConnection >& _connectionEnvelope, transaction_count _txCount );
 
 
+    // accepts connections and reads their requests in an epoll reactor,
+    // then hands them over to the worker threads
     void acceptTCPConnectionsLoop();
 
 
@@ -63,6 +63,7 @@ enum ConnectionSubStatus {
     CONNECTION_ERROR_TIME_TOO_FAR_IN_THE_FUTURE = 25,
     CONNECTION_PROPOSAL_STATE_ROOT_DOES_NOT_MATCH = 26,
     CONNECTION_ALREADY_HAVE_ENOUGH_PROPOSALS_FOR_THIS_BLOCK_ID = 27,
-    CONNECTION_FINALIZER_CLIENT_ASKING_FOR_INCORRECT_PROPOSER_INDEX = 28
+    CONNECTION_FINALIZER_CLIENT_ASKING_FOR_INCORRECT_PROPOSER_INDEX = 28,
+    CONNECTION_SERVER_BUSY = 29
 
 };
\ No newline at end of file
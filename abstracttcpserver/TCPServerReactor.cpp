@@ -0,0 +1,519 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TCPServerReactor.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <climits>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/ExitRequestedException.h"
+#include "exceptions/FatalError.h"
+#include "exceptions/NetworkProtocolException.h"
+#include "thirdparty/json.hpp"
+
+#include "chains/Schain.h"
+#include "network/IO.h"
+#include "network/ServerConnection.h"
+#include "network/ZeroCopyCompletions.h"
+#include "node/Node.h"
+#include "utils/Time.h"
+
+#include "AbstractServerAgent.h"
+#include "TCPServerReactor.h"
+
+
+TCPServerReactor::TCPServerReactor(
+    AbstractServerAgent& _server, int _listenDescriptor, port_type _portType )
+    : server( _server ), listenDescriptor( _listenDescriptor ), portType( _portType ) {
+    CHECK_ARGUMENT( _listenDescriptor > 0 );
+
+    epollDescriptor = epoll_create1( EPOLL_CLOEXEC );
+
+    if ( epollDescriptor < 0 ) {
+        BOOST_THROW_EXCEPTION( FatalError( "Could not create epoll:" + string( strerror( errno ) ) ) );
+    }
+
+    auto flags = fcntl( listenDescriptor, F_GETFL, 0 );
+    CHECK_STATE( fcntl( listenDescriptor, F_SETFL, flags | O_NONBLOCK ) == 0 );
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = listenDescriptor;
+
+    CHECK_STATE( epoll_ctl( epollDescriptor, EPOLL_CTL_ADD, listenDescriptor, &event ) == 0 );
+
+    wakeDescriptor = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+
+    if ( wakeDescriptor < 0 ) {
+        BOOST_THROW_EXCEPTION(
+            FatalError( "Could not create eventfd:" + string( strerror( errno ) ) ) );
+    }
+
+    event.data.fd = wakeDescriptor;
+
+    CHECK_STATE( epoll_ctl( epollDescriptor, EPOLL_CTL_ADD, wakeDescriptor, &event ) == 0 );
+}
+
+TCPServerReactor::~TCPServerReactor() {
+    pending.clear();
+    if ( epollDescriptor >= 0 )
+        close( epollDescriptor );
+    if ( wakeDescriptor >= 0 )
+        close( wakeDescriptor );
+}
+
+
+void TCPServerReactor::submit(
+    const ptr< ServerConnection >& _connection, const ptr< Transfer >& _transfer ) {
+    CHECK_ARGUMENT( _connection );
+    CHECK_ARGUMENT( _transfer );
+    CHECK_ARGUMENT( _transfer->onDone );
+
+    {
+        lock_guard< mutex > lock( submittedLock );
+        submitted.emplace_back( _connection, _transfer );
+    }
+
+    uint64_t one = 1;
+    CHECK_STATE( write( wakeDescriptor, &one, sizeof( one ) ) == sizeof( one ) );
+}
+
+
+void TCPServerReactor::startSubmittedTransfers() {
+    uint64_t count;
+    while ( read( wakeDescriptor, &count, sizeof( count ) ) > 0 ) {
+    }
+
+    vector< pair< ptr< ServerConnection >, ptr< Transfer > > > transfers;
+
+    {
+        lock_guard< mutex > lock( submittedLock );
+        transfers.swap( submitted );
+    }
+
+    for ( auto&& [connection, transfer] : transfers ) {
+        auto descriptor = ( int ) connection->getDescriptor();
+
+        auto flags = fcntl( descriptor, F_GETFL, 0 );
+        CHECK_STATE( fcntl( descriptor, F_SETFL, flags | O_NONBLOCK ) == 0 );
+
+        auto pendingConnection = make_shared< PendingConnection >();
+        pendingConnection->connection = connection;
+        pendingConnection->transfer = transfer;
+        pendingConnection->deadlineMs = transfer->deadlineMs;
+
+        pending[descriptor] = pendingConnection;
+        deadlines.insert( { pendingConnection->deadlineMs, descriptor } );
+
+        if ( transfer->kind == Transfer::WRITE ) {
+            uint64_t totalBytes = 0;
+            for ( auto&& item : transfer->iovecs )
+                totalBytes += item.iov_len;
+
+            if ( transfer->buffers && totalBytes >= IO::ZEROCOPY_THRESHOLD &&
+                 IO::isZeroCopyEnabled( file_descriptor( descriptor ) ) ) {
+                transfer->zeroCopySocket =
+                    server.getSchain()->getIo()->getZeroCopyCompletions()->beginWrite(
+                        descriptor );
+            }
+        }
+
+        epoll_event event{};
+        event.events =
+            ( transfer->kind == Transfer::WRITE ? EPOLLOUT : EPOLLIN ) | EPOLLRDHUP | EPOLLET;
+        event.data.fd = descriptor;
+
+        if ( epoll_ctl( epollDescriptor, EPOLL_CTL_ADD, descriptor, &event ) != 0 ) {
+            LOG( err, "Could not add connection to epoll:" << strerror( errno ) );
+            finishTransfer( descriptor, false );
+            continue;
+        }
+
+        // the data may be there already
+        readAvailable( descriptor );
+    }
+}
+
+
+void TCPServerReactor::run() {
+    epoll_event events[EPOLL_BATCH_SIZE];
+
+    while ( !server.getSchain()->getNode()->isExitRequested() ) {
+        auto waitMs = EPOLL_WAIT_MS;
+
+        if ( !deadlines.empty() ) {
+            auto now = Time::getCurrentTimeMs();
+            auto nextDeadline = deadlines.begin()->first;
+            waitMs = nextDeadline > now ? ( int ) min< uint64_t >( nextDeadline - now, waitMs ) : 0;
+        }
+
+        auto count = epoll_wait( epollDescriptor, events, EPOLL_BATCH_SIZE, waitMs );
+
+        if ( server.getSchain()->getNode()->isExitRequested() )
+            return;
+
+        if ( count < 0 && errno != EINTR ) {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "epoll_wait failed:" + string( strerror( errno ) ),
+                    __CLASS_NAME__ ) );
+        }
+
+        for ( int i = 0; i < count; i++ ) {
+            auto descriptor = events[i].data.fd;
+            if ( descriptor == listenDescriptor ) {
+                acceptConnections();
+            } else if ( descriptor == wakeDescriptor ) {
+                startSubmittedTransfers();
+            } else {
+                readAvailable( descriptor );
+            }
+        }
+
+        expireDeadlines();
+    }
+}
+
+
+void TCPServerReactor::acceptConnections() {
+    while ( true ) {
+        struct sockaddr_in clientAddress;
+        socklen_t sizeOfClientAddress = sizeof( clientAddress );
+
+        int newConnection = accept4( listenDescriptor, ( sockaddr* ) &clientAddress,
+            &sizeOfClientAddress, SOCK_NONBLOCK | SOCK_CLOEXEC );
+
+        if ( newConnection < 0 ) {
+            if ( errno == EAGAIN || errno == EWOULDBLOCK )
+                return;
+            if ( errno == EINTR || errno == ECONNABORTED )
+                continue;
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "accept failed:" + string( strerror( errno ) ), __CLASS_NAME__ ) );
+        }
+
+        string ip( inet_ntoa( clientAddress.sin_addr ) );
+
+        auto connection = make_shared< ServerConnection >( newConnection, ip );
+
+        if ( pending.size() >= MAX_PENDING_SERVER_CONNECTIONS ) {
+            LOG( warn, "Too many pending connections, dropping connection from:" << ip );
+            continue;
+        }
+
+        IO::tagDescriptor( file_descriptor( newConnection ), portType );
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+        event.data.fd = newConnection;
+
+        if ( epoll_ctl( epollDescriptor, EPOLL_CTL_ADD, newConnection, &event ) != 0 ) {
+            LOG( err, "Could not add connection to epoll:" << strerror( errno ) );
+            continue;
+        }
+
+        auto pendingConnection = make_shared< PendingConnection >();
+        pendingConnection->connection = connection;
+        pendingConnection->deadlineMs = Time::getCurrentTimeMs() + SERVER_REQUEST_READ_TIMEOUT_MS;
+
+        pending[newConnection] = pendingConnection;
+        deadlines.insert( { pendingConnection->deadlineMs, newConnection } );
+
+        // data may have arrived together with the connection
+        readAvailable( newConnection );
+    }
+}
+
+
+void TCPServerReactor::readAvailable( int _descriptor ) {
+    auto it = pending.find( _descriptor );
+
+    if ( it == pending.end() )
+        return;
+
+    auto pendingConnection = it->second;
+
+    try {
+        if ( pendingConnection->transfer ) {
+            if ( runTransfer( _descriptor, *pendingConnection->transfer ) )
+                finishTransfer( _descriptor, true );
+        } else if ( readRequest( *pendingConnection ) ) {
+            dispatch( _descriptor );
+        }
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( exception& e ) {
+        LOG( debug, "Dropping connection from " << pendingConnection->connection->getIP() << ":"
+                                                << e.what() );
+        if ( pendingConnection->transfer ) {
+            finishTransfer( _descriptor, false );
+        } else {
+            remove( _descriptor );
+        }
+    }
+}
+
+
+bool TCPServerReactor::runTransfer( int _descriptor, Transfer& _transfer ) {
+    if ( _transfer.kind == Transfer::WRITE )
+        return writeAvailable( _descriptor, _transfer );
+
+    if ( _transfer.kind == Transfer::READ_HEADER &&
+         _transfer.headerLenBytes < sizeof( _transfer.headerLen ) ) {
+        if ( !receive( _descriptor, ( uint8_t* ) &_transfer.headerLen,
+                 sizeof( _transfer.headerLen ), _transfer.headerLenBytes ) )
+            return false;
+
+        if ( _transfer.headerLen < 2 || _transfer.headerLen > MAX_HEADER_SIZE ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Invalid Header len:" + to_string( _transfer.headerLen ), __CLASS_NAME__ ) );
+        }
+
+        _transfer.buffer->resize( _transfer.headerLen );
+        _transfer.length = _transfer.headerLen;
+    }
+
+    CHECK_STATE( _transfer.buffer && _transfer.buffer->size() >= _transfer.length );
+
+    return receive(
+        _descriptor, _transfer.buffer->data(), _transfer.length, _transfer.transferred );
+}
+
+
+bool TCPServerReactor::writeAvailable( int _descriptor, Transfer& _transfer ) {
+    auto& iovecs = _transfer.iovecs;
+
+    // transferred counts the iovecs that are fully sent
+    while ( _transfer.transferred < iovecs.size() ) {
+        auto current = _transfer.transferred;
+
+        msghdr msg{};
+        msg.msg_iov = iovecs.data() + current;
+        msg.msg_iovlen = min< uint64_t >( iovecs.size() - current, IOV_MAX );
+
+        int zeroCopyFlag = 0;
+#ifdef MSG_ZEROCOPY
+        if ( _transfer.zeroCopySocket != 0 )
+            zeroCopyFlag = MSG_ZEROCOPY;
+#endif
+
+        auto result = sendmsg( _descriptor, &msg, MSG_NOSIGNAL | MSG_DONTWAIT | zeroCopyFlag );
+
+        if ( result < 0 ) {
+            if ( errno == EAGAIN || errno == EWOULDBLOCK )
+                return false;
+            if ( errno == EINTR )
+                continue;
+            if ( errno == ENOBUFS && zeroCopyFlag != 0 ) {
+                // out of optmem for pinned pages, the rest is sent with copying sends
+                server.getSchain()->getIo()->getZeroCopyCompletions()->endWrite(
+                    _transfer.zeroCopySocket, _transfer.zeroCopySends, _transfer.buffers );
+                _transfer.zeroCopySocket = 0;
+                continue;
+            }
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Write returned error:" + string( strerror( errno ) ), __CLASS_NAME__ ) );
+        }
+
+        if ( zeroCopyFlag != 0 )
+            _transfer.zeroCopySends++;
+
+        server.getSchain()->getIo()->addBytesTransferred(
+            file_descriptor( _descriptor ), 0, result );
+
+        uint64_t written = result;
+        while ( current < iovecs.size() && written >= iovecs[current].iov_len ) {
+            written -= iovecs[current].iov_len;
+            current++;
+        }
+
+        if ( current < iovecs.size() ) {
+            iovecs[current].iov_base = ( uint8_t* ) iovecs[current].iov_base + written;
+            iovecs[current].iov_len -= written;
+        }
+
+        _transfer.transferred = current;
+    }
+
+    return true;
+}
+
+
+bool TCPServerReactor::receive( int _descriptor, uint8_t* _data, uint64_t _need, uint64_t& _have ) {
+    while ( _have < _need ) {
+        auto result = recv( _descriptor, _data + _have, _need - _have, 0 );
+
+        if ( result == 0 ) {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "The peer shut down the socket", __CLASS_NAME__ ) );
+        }
+
+        if ( result < 0 ) {
+            if ( errno == EAGAIN || errno == EWOULDBLOCK )
+                return false;
+            if ( errno == EINTR )
+                continue;
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Read returned error:" + string( strerror( errno ) ), __CLASS_NAME__ ) );
+        }
+
+        _have += result;
+
+        server.getSchain()->getIo()->addBytesTransferred(
+            file_descriptor( _descriptor ), result, 0 );
+    }
+
+    return true;
+}
+
+
+bool TCPServerReactor::readRequest( PendingConnection& _pending ) {
+    auto descriptor = ( int ) _pending.connection->getDescriptor();
+
+    if ( _pending.state == READ_MAGIC ) {
+        if ( !receive( descriptor, ( uint8_t* ) &_pending.magic, sizeof( _pending.magic ),
+                 _pending.stateBytes ) )
+            return false;
+
+        if ( _pending.magic == TEST_MAGIC_NUMBER ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException( "Got ping", __CLASS_NAME__ ) );
+        }
+
+        if ( _pending.magic != MAGIC_NUMBER ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Incorrect magic number" + to_string( _pending.magic ), __CLASS_NAME__ ) );
+        }
+
+        _pending.state = READ_HEADER_LEN;
+        _pending.stateBytes = 0;
+    }
+
+    if ( _pending.state == READ_HEADER_LEN ) {
+        if ( !receive( descriptor, ( uint8_t* ) &_pending.headerLen, sizeof( _pending.headerLen ),
+                 _pending.stateBytes ) )
+            return false;
+
+        if ( _pending.headerLen < 2 || _pending.headerLen > MAX_HEADER_SIZE ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Invalid Header len:" + to_string( _pending.headerLen ), __CLASS_NAME__ ) );
+        }
+
+        _pending.header.resize( _pending.headerLen );
+        _pending.state = READ_HEADER;
+        _pending.stateBytes = 0;
+    }
+
+    CHECK_STATE( _pending.state == READ_HEADER );
+
+    return receive( descriptor, ( uint8_t* ) _pending.header.data(), _pending.headerLen,
+        _pending.stateBytes );
+}
+
+
+void TCPServerReactor::dispatch( int _descriptor ) {
+    auto pendingConnection = pending.at( _descriptor );
+
+    epoll_ctl( epollDescriptor, EPOLL_CTL_DEL, _descriptor, nullptr );
+    deadlines.erase( { pendingConnection->deadlineMs, _descriptor } );
+    pending.erase( _descriptor );
+
+    // the rest of the protocol is run by a worker thread with blocking IO
+    auto flags = fcntl( _descriptor, F_GETFL, 0 );
+    CHECK_STATE( fcntl( _descriptor, F_SETFL, flags & ~O_NONBLOCK ) == 0 );
+
+    auto connection = pendingConnection->connection;
+    connection->setRequestHeader( pendingConnection->header );
+    connection->setDeadlineMs( Time::getCurrentTimeMs() + SERVER_QUEUE_TIMEOUT_MS );
+
+    server.pushToQueueAndNotifyWorkers( connection );
+}
+
+
+void TCPServerReactor::finishTransfer( int _descriptor, bool _succeeded ) {
+    auto pendingConnection = pending.at( _descriptor );
+    auto transfer = pendingConnection->transfer;
+    auto connection = pendingConnection->connection;
+
+    CHECK_STATE( transfer );
+
+    remove( _descriptor );
+
+    // the buffers of zerocopy sends are released when their completions arrive
+    if ( transfer->zeroCopySocket != 0 ) {
+        server.getSchain()->getIo()->getZeroCopyCompletions()->endWrite(
+            transfer->zeroCopySocket, transfer->zeroCopySends, transfer->buffers );
+        transfer->zeroCopySocket = 0;
+    }
+
+    // the workers use blocking IO
+    auto flags = fcntl( _descriptor, F_GETFL, 0 );
+    fcntl( _descriptor, F_SETFL, flags & ~O_NONBLOCK );
+
+    auto next = _succeeded ? std::move( transfer->onDone ) : std::move( transfer->onFailed );
+
+    if ( !next )
+        return;
+
+    connection->setContinuation( std::move( next ) );
+    server.pushToQueueAndNotifyWorkers( connection );
+}
+
+
+void TCPServerReactor::remove( int _descriptor ) {
+    auto it = pending.find( _descriptor );
+
+    if ( it == pending.end() )
+        return;
+
+    epoll_ctl( epollDescriptor, EPOLL_CTL_DEL, _descriptor, nullptr );
+    deadlines.erase( { it->second->deadlineMs, _descriptor } );
+
+    // the descriptor is closed when the connection object is destroyed
+    pending.erase( it );
+}
+
+
+void TCPServerReactor::expireDeadlines() {
+    auto now = Time::getCurrentTimeMs();
+
+    while ( !deadlines.empty() && deadlines.begin()->first <= now ) {
+        auto descriptor = deadlines.begin()->second;
+        auto pendingConnection = pending.at( descriptor );
+
+        if ( pendingConnection->transfer ) {
+            LOG( debug, "Transfer timeout, dropping connection from "
+                            << pendingConnection->connection->getIP() );
+            finishTransfer( descriptor, false );
+        } else {
+            LOG( debug, "Request read timeout, dropping connection from "
+                            << pendingConnection->connection->getIP() );
+            remove( descriptor );
+        }
+    }
+}
+
+
+uint64_t TCPServerReactor::getPendingCount() const {
+    return pending.size();
+}
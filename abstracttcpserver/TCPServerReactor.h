@@ -0,0 +1,169 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TCPServerReactor.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <sys/uio.h>
+
+/*
+ * Edge-triggered epoll loop that accepts TCP connections for a server agent
+ * and reads the request (magic number, header length and JSON header) of each connection
+ * without blocking. A connection is handed to the worker threads only once its
+ * request has fully arrived, so slow or silent peers never pin a worker thread.
+ * Each connection has a deadline to deliver its request, after which it is dropped.
+ *
+ * The protocols then run as state machines: a worker that needs a body from the peer, or
+ * has a large response to send, submits a Transfer and returns. The reactor runs it without
+ * blocking, and queues the next step of the request for the workers when it completes, or
+ * its failure step if the peer closes the connection or misses the transfer deadline.
+ */
+
+class AbstractServerAgent;
+class ServerConnection;
+
+
+class TCPServerReactor {
+public:
+    class Transfer {
+    public:
+        enum Kind { READ_BYTES, READ_HEADER, WRITE };
+
+        Kind kind = READ_BYTES;
+
+        // READ_BYTES reads length bytes into buffer. READ_HEADER reads a header length and
+        // then the header into buffer
+        ptr< vector< uint8_t > > buffer;
+
+        uint64_t length = 0;
+
+        // WRITE sends iovecs, buffers keeps their memory
+        vector< iovec > iovecs;
+
+        ptr< void > buffers;
+
+        uint64_t deadlineMs = 0;
+
+        function< void() > onDone;
+
+        function< void() > onFailed;
+
+        // progress
+        uint64_t transferred = 0;
+
+        uint64_t headerLen = 0;
+
+        uint64_t headerLenBytes = 0;
+
+        uint64_t zeroCopySocket = 0;
+
+        uint64_t zeroCopySends = 0;
+    };
+
+private:
+    enum ReadState { READ_MAGIC, READ_HEADER_LEN, READ_HEADER };
+
+    class PendingConnection {
+    public:
+        ptr< ServerConnection > connection;
+
+        // set if the connection runs a transfer of a request, not reads a new request
+        ptr< Transfer > transfer;
+
+        ReadState state = READ_MAGIC;
+
+        uint64_t magic = 0;
+
+        uint64_t headerLen = 0;
+
+        string header;
+
+        // bytes read so far in the current state
+        uint64_t stateBytes = 0;
+
+        uint64_t deadlineMs = 0;
+    };
+
+    static constexpr int EPOLL_BATCH_SIZE = 64;
+
+    static constexpr int EPOLL_WAIT_MS = 1000;
+
+    AbstractServerAgent& server;
+
+    int listenDescriptor = -1;
+
+    int epollDescriptor = -1;
+
+    // wakes up the loop when a worker submits a transfer
+    int wakeDescriptor = -1;
+
+    port_type portType;
+
+    // pending connections by descriptor
+    map< int, ptr< PendingConnection > > pending;
+
+    // deadline, descriptor
+    set< pair< uint64_t, int > > deadlines;
+
+    mutex submittedLock;
+
+    vector< pair< ptr< ServerConnection >, ptr< Transfer > > > submitted;  // protected
+
+    void acceptConnections();
+
+    void startSubmittedTransfers();
+
+    void readAvailable( int _descriptor );
+
+    // returns true once the whole request has been read, false if the socket has no more data
+    bool readRequest( PendingConnection& _pending );
+
+    // returns true once the transfer is complete, false if the socket can not take more
+    bool runTransfer( int _descriptor, Transfer& _transfer );
+
+    bool writeAvailable( int _descriptor, Transfer& _transfer );
+
+    // returns true once _need bytes are read into _data, false if the socket has no more data
+    bool receive( int _descriptor, uint8_t* _data, uint64_t _need, uint64_t& _have );
+
+    void dispatch( int _descriptor );
+
+    // queues the next step of the request of a finished transfer for the workers
+    void finishTransfer( int _descriptor, bool _succeeded );
+
+    void remove( int _descriptor );
+
+    void expireDeadlines();
+
+public:
+    TCPServerReactor( AbstractServerAgent& _server, int _listenDescriptor, port_type _portType );
+
+    ~TCPServerReactor();
+
+    // runs until exit is requested
+    void run();
+
+    // thread safe, the connection must not be used until one of the steps of the transfer runs
+    void submit( const ptr< ServerConnection >& _connection, const ptr< Transfer >& _transfer );
+
+    [[nodiscard]] uint64_t getPendingCount() const;
+};
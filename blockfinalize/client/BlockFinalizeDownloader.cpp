@@ -31,6 +31,7 @@
 
 #include "chains/TestConfig.h"
 #include "network/ClientSocket.h"
+#include "network/CompressionPolicy.h"
 #include "network/IO.h"
 #include "network/Network.h"
 #include "node/Node.h"
@@ -49,8 +50,8 @@
 #include "utils/Time.h"
 
 #include "BlockFinalizeDownloader.h"
-#include "BlockFinalizeDownloaderThreadPool.h"
 #include "crypto/CryptoManager.h"
+#include "threads/TaskExecutor.h"
 
 
 BlockFinalizeDownloader::BlockFinalizeDownloader(
@@ -96,6 +97,7 @@ uint64_t BlockFinalizeDownloader::downloadFragment(
     try {
         auto header = make_shared< BlockFinalizeRequestHeader >(
             *sChain, blockId, proposerIndex, this->getNode()->getNodeID(), _fragmentIndex );
+        header->setCompressionLevel( getSchain()->getCompressionPolicy()->getLevel( _dstIndex ) );
         CHECK_STATE( _dstIndex != ( uint64_t ) getSchain()->getSchainIndex() )
         if ( getSchain()->getDeathTimeMs( ( uint64_t ) _dstIndex ) + NODE_DEATH_INTERVAL_MS >
              Time::getCurrentTimeMs() ) {
@@ -105,19 +107,18 @@ uint64_t BlockFinalizeDownloader::downloadFragment(
         }
         auto socket = make_shared< ClientSocket >( *sChain, _dstIndex, CATCHUP );
 
-        auto io = getSchain()->getIo();
+        auto descriptor = ( int ) socket->getDescriptor();
 
-        try {
-            io->writeMagic( socket );
-        } catch ( ExitRequestedException& ) {
-            throw;
-        } catch ( ... ) {
-            throw_with_nested( NetworkProtocolException(
-                "BlockFinalizec: Server disconnect sending magic", __CLASS_NAME__ ) );
-        }
+        addActiveSocket( descriptor );
+
+        // the socket is shut down if the download is cancelled while this task reads from it
+        auto guard = shared_ptr< void >(
+            nullptr, [this, descriptor]( void* ) { removeActiveSocket( descriptor ); } );
+
+        auto io = getSchain()->getIo();
 
         try {
-            io->writeHeader( socket, header );
+            io->writeMagicAndHeader( socket, header );
         } catch ( ExitRequestedException& ) {
             throw;
         } catch ( ... ) {
@@ -158,7 +159,8 @@ uint64_t BlockFinalizeDownloader::downloadFragment(
 
         try {
             blockFragment =
-                readBlockFragment( socket, response, _fragmentIndex, getSchain()->getNodeCount() );
+                readBlockFragment( socket, response, _fragmentIndex, getSchain()->getNodeCount(),
+                    _dstIndex );
             CHECK_ARGUMENT( blockFragment )
         } catch ( ExitRequestedException& ) {
             throw;
@@ -218,7 +220,7 @@ string BlockFinalizeDownloader::readDAProofSig( nlohmann::json _responseHeader )
 
 ptr< BlockProposalFragment > BlockFinalizeDownloader::readBlockFragment(
     const ptr< ClientSocket >& _socket, nlohmann::json _responseHeader,
-    fragment_index _fragmentIndex, node_count _nodeCount ) {
+    fragment_index _fragmentIndex, node_count _nodeCount, schain_index _dstIndex ) {
     CHECK_ARGUMENT( _socket )
 
     CHECK_ARGUMENT( _responseHeader > 0 )
@@ -256,8 +258,12 @@ ptr< BlockProposalFragment > BlockFinalizeDownloader::readBlockFragment(
     auto serializedFragment = make_shared< vector< uint8_t > >( fragmentSize );
 
     try {
-        getSchain()->getIo()->readBytes(
-            _socket->getDescriptor(), serializedFragment, msg_len( fragmentSize ), 30 );
+        auto readStartTimeMs = Time::getCurrentTimeMs();
+        auto wireBytes = getSchain()->getIo()->readPossiblyCompressedBytes(
+            _socket->getDescriptor(), serializedFragment, msg_len( fragmentSize ), _responseHeader,
+            30 );
+        getSchain()->getCompressionPolicy()->recordDownload( _dstIndex, wireBytes, fragmentSize,
+            Time::getCurrentTimeMs() - readStartTimeMs );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -294,8 +300,6 @@ void BlockFinalizeDownloader::workerThreadFragmentDownloadLoop(
     auto sChainIndex = sChain->getSchainIndex();
     bool testFinalizationDownloadOnly = node->getTestConfig()->isFinalizationDownloadOnly();
 
-    setThreadName( "BlckFinLoop", node->getConsensusEngine() );
-
     node->waitOnGlobalClientStartBarrier();
     if ( node->isExitRequested() )
         return;
@@ -314,7 +318,8 @@ void BlockFinalizeDownloader::workerThreadFragmentDownloadLoop(
     }
 
     try {
-        while ( !node->isExitRequested() && !_agent->fragmentList.isComplete() ) {
+        while ( !node->isExitRequested() && !_agent->cancelled &&
+                !_agent->fragmentList.isComplete() ) {
             if ( !testFinalizationDownloadOnly ) {
                 // take into account that the block can
                 //  be in parallel committed through catchup
@@ -342,13 +347,13 @@ void BlockFinalizeDownloader::workerThreadFragmentDownloadLoop(
                 return;
             } catch ( ConnectionRefusedException& e ) {
                 _agent->logConnectionRefused( e, _dstIndex );
-                if ( _agent->fragmentList.isComplete() )
+                if ( _agent->cancelled || _agent->fragmentList.isComplete() )
                     return;
                 usleep( static_cast< __useconds_t >( node->getWaitAfterNetworkErrorMs() * 1000 ) );
             } catch ( exception& e ) {
-                SkaleException::logNested( e );
-                if ( _agent->fragmentList.isComplete() )
+                if ( _agent->cancelled || _agent->fragmentList.isComplete() )
                     return;
+                SkaleException::logNested( e );
                 usleep( static_cast< __useconds_t >( node->getWaitAfterNetworkErrorMs() * 1000 ) );
             }
         }
@@ -362,10 +367,26 @@ ptr< BlockProposal > BlockFinalizeDownloader::downloadProposal() {
     MONITOR( __CLASS_NAME__, __FUNCTION__ )
 
     {
-        threadPool = make_shared< BlockFinalizeDownloaderThreadPool >(
-            ( uint64_t ) getSchain()->getNodeCount(), this );
-        threadPool->startService();
-        threadPool->joinAll();
+        // one download task per peer, run on the executor shared by all downloads
+        vector< future< void > > tasks;
+
+        auto executor = getSchain()->getFinalizeDownloadExecutor();
+
+        for ( uint64_t i = 1; i <= ( uint64_t ) getSchain()->getNodeCount(); i++ ) {
+            // the node does not download from itself
+            if ( i == ( uint64_t ) getSchain()->getSchainIndex() )
+                continue;
+            tasks.push_back( executor->submit(
+                [this, i]() { workerThreadFragmentDownloadLoop( this, schain_index( i ) ); } ) );
+        }
+
+        // tasks use this object, so wait for all of them to finish
+        for ( auto&& task : tasks ) {
+            while ( task.wait_for( chrono::milliseconds( 100 ) ) != future_status::ready ) {
+                if ( !cancelled && isDownloadFinished() )
+                    cancel();
+            }
+        }
     }
 
     try {
@@ -393,6 +414,46 @@ ptr< BlockProposal > BlockFinalizeDownloader::downloadProposal() {
     }
 }
 
+void BlockFinalizeDownloader::addActiveSocket( int _descriptor ) {
+    LOCK( m )
+    activeSockets.insert( _descriptor );
+    // the download may have been cancelled before the socket was added
+    if ( cancelled )
+        shutdown( _descriptor, SHUT_RDWR );
+}
+
+
+void BlockFinalizeDownloader::removeActiveSocket( int _descriptor ) {
+    LOCK( m )
+    activeSockets.erase( _descriptor );
+}
+
+
+void BlockFinalizeDownloader::cancel() {
+    LOCK( m )
+    cancelled = true;
+    for ( auto&& descriptor : activeSockets ) {
+        shutdown( descriptor, SHUT_RDWR );
+    }
+}
+
+
+bool BlockFinalizeDownloader::isDownloadFinished() {
+    if ( fragmentList.isComplete() || getNode()->isExitRequested() )
+        return true;
+
+    if ( getNode()->getTestConfig()->isFinalizationDownloadOnly() )
+        return false;
+
+    if ( getSchain()->getLastCommittedBlockID() >= blockId )
+        return true;
+
+    auto proposal = getNode()->getBlockProposalDB()->getBlockProposal( blockId, proposerIndex );
+
+    return proposal && getNode()->getDaProofDB()->haveDAProof( proposal );
+}
+
+
 BlockFinalizeDownloader::~BlockFinalizeDownloader() {}
 
 block_id BlockFinalizeDownloader::getBlockId() {
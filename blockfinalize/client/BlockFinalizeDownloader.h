@@ -32,7 +32,6 @@ class BlockFinalizeResponseHeader;
 class BlockProposalFragment;
 class BlockProposalFragmentList;
 class BlockProposal;
-class BlockFinalizeDownloaderThreadPool;
 class BlockProposalSet;
 class ThresholdSignature;
 
@@ -51,11 +50,24 @@ private:
 
     recursive_mutex m;
 
+    // set once enough fragments are in, or the block is committed or finalized otherwise
+    atomic< bool > cancelled = false;
+
+    // descriptors of sockets that fragment downloads currently use, protected by m
+    set< int > activeSockets;
+
+    void addActiveSocket( int _descriptor );
+
+    void removeActiveSocket( int _descriptor );
+
+    // stops the download tasks, including the ones blocked on network reads
+    void cancel();
+
+    bool isDownloadFinished();
+
 public:
     ptr< ThresholdSignature > getDaSig( uint64_t _blockTimeStampS );
 
-    ptr< BlockFinalizeDownloaderThreadPool > threadPool = nullptr;
-
     BlockFinalizeDownloader( Schain* _sChain, block_id _blockId, schain_index _proposerIndex );
 
 
@@ -71,7 +83,8 @@ public:
 
 
     ptr< BlockProposalFragment > readBlockFragment( const ptr< ClientSocket >& _socket,
-        nlohmann::json responseHeader, fragment_index _fragmentIndex, node_count _nodeCount );
+        nlohmann::json responseHeader, fragment_index _fragmentIndex, node_count _nodeCount,
+        schain_index _dstIndex );
 
     static uint64_t readFragmentSize( nlohmann::json _responseHeader );
 
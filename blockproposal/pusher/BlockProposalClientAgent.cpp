@@ -29,6 +29,7 @@
 
 #include "abstracttcpserver/ConnectionStatus.h"
 #include "crypto/BLAKE3Hash.h"
+#include "datastructures/PartialHashSketch.h"
 #include "datastructures/PartialHashesList.h"
 #include "datastructures/Transaction.h"
 #include "datastructures/TransactionList.h"
@@ -53,11 +54,13 @@
 #include "network/ServerConnection.h"
 #include "node/Node.h"
 #include "node/NodeInfo.h"
+#include "pendingqueue/AdaptiveBlockAssembler.h"
 #include "pendingqueue/PendingTransactionsAgent.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
 #include "utils/Time.h"
 
 #include "BlockProposalClientAgent.h"
-#include "BlockProposalPusherThreadPool.h"
 #include "abstracttcpclient/AbstractClientAgent.h"
 #include "exceptions/ExitRequestedException.h"
 #include "exceptions/PingException.h"
@@ -67,9 +70,12 @@ BlockProposalClientAgent::BlockProposalClientAgent( Schain& _sChain )
     try {
         LOG( info, "Constructing blockProposalPushAgent" );
 
-        this->blockProposalThreadPool = make_shared< BlockProposalPusherThreadPool >(
-            num_threads( ( uint64_t ) _sChain.getNodeCount() ), this );
-        blockProposalThreadPool->startService();
+        for ( uint64_t i = 0; i <= ( uint64_t ) _sChain.getNodeCount(); i++ ) {
+            lastMissingCounts.push_back( make_shared< atomic< uint64_t > >( 0 ) );
+        }
+
+        // sending blocks on the network and sleeps between retries
+        sendExecutor = make_shared< TaskExecutor >( "BlockPropClnt", BlockingIOPool::getShared() );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -78,6 +84,12 @@ BlockProposalClientAgent::BlockProposalClientAgent( Schain& _sChain )
 }
 
 
+BlockProposalClientAgent::~BlockProposalClientAgent() {
+    // waits for the send tasks while this object can still run them
+    sendExecutor = nullptr;
+}
+
+
 ptr< MissingTransactionsRequestHeader >
 BlockProposalClientAgent::readMissingTransactionsRequestHeader(
     const ptr< ClientSocket >& _socket ) {
@@ -92,6 +104,9 @@ BlockProposalClientAgent::readMissingTransactionsRequestHeader(
     auto count = ( uint64_t ) Header::getUint64( js, "count" );
     mtrh->setMissingTransactionsCount( count );
 
+    if ( js.count( "fullHashes" ) > 0 )
+        mtrh->setFullHashesRequested( Header::getUint64( js, "fullHashes" ) > 0 );
+
     mtrh->setComplete();
     LOG( trace, "Push agent processed missing transactions header" );
     return mtrh;
@@ -146,6 +161,20 @@ ptr< BlockProposal > BlockProposalClientAgent::corruptProposal(
 }
 
 
+ptr< vector< uint8_t > > BlockProposalClientAgent::encodePartialHashes(
+    const ptr< PartialHashesList >& _list, schain_index _index ) {
+    CHECK_ARGUMENT( _list );
+
+    // leave room for twice the transactions missing last time, plus a share of the block for
+    // the transactions that arrived since
+    auto expectedDifference = 2 * lastMissingCounts.at( ( uint64_t ) _index )->load() +
+                              ( uint64_t ) _list->getTransactionCount() / 128;
+
+    return PartialHashSketch::encodeProposal(
+        *_list, PartialHashSketch::getCellCount( expectedDifference ) );
+}
+
+
 pair< ConnectionStatus, ConnectionSubStatus > BlockProposalClientAgent::sendBlockProposal(
     const ptr< BlockProposal >& _proposal, const ptr< ClientSocket >& _socket,
     schain_index _index ) {
@@ -154,6 +183,9 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalClientAgent::sendBloc
 
     auto proposalCopy = _proposal;
 
+    auto startTimeMs = Time::getCurrentTimeMs();
+    uint64_t sentBytes = 0;
+
 
     INJECT_TEST( CORRUPT_PROPOSAL_TEST, proposalCopy = corruptProposal( _proposal, _index ) )
 
@@ -203,35 +235,59 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalClientAgent::sendBloc
 
     CHECK_STATE( partialHashesList );
 
-    if ( partialHashesList->getTransactionCount() > 0 ) {
+    // older servers do not send it
+    auto sketchAccepted =
+        response.count( "sketch" ) > 0 && Header::getUint64( response, "sketch" ) > 0;
+
+    auto writePartialHashes = [&]( const ptr< vector< uint8_t > >& _bytes ) {
         try {
-            getSchain()->getIo()->writeBytesVector(
-                _socket->getDescriptor(), partialHashesList->getPartialHashes() );
+            getSchain()->getIo()->writeBytesVector( _socket->getDescriptor(), _bytes );
+            sentBytes += _bytes->size();
         } catch ( ExitRequestedException& ) {
             throw;
         } catch ( ... ) {
             auto errStr = "Unexpected disconnect writing block data";
             throw_with_nested( NetworkProtocolException( errStr, __CLASS_NAME__ ) );
         }
+    };
+
+    if ( partialHashesList->getTransactionCount() > 0 ) {
+        writePartialHashes( sketchAccepted ? encodePartialHashes( partialHashesList, _index ) :
+                                             partialHashesList->getPartialHashes() );
     }
 
 
     LOG( trace, "Proposal step 3: sent partial hashes" );
 
-    ptr< MissingTransactionsRequestHeader > missingTransactionHeader;
+    auto readMissingHeader = [&]() {
+        try {
+            auto missingHeader = readMissingTransactionsRequestHeader( _socket );
+            CHECK_STATE( missingHeader );
+            return missingHeader;
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( ... ) {
+            auto errStr = "Could not read missing transactions request header";
+            throw_with_nested( NetworkProtocolException( errStr, __CLASS_NAME__ ) );
+        }
+    };
+
+    auto missingTransactionHeader = readMissingHeader();
 
-    try {
-        missingTransactionHeader = readMissingTransactionsRequestHeader( _socket );
-        CHECK_STATE( missingTransactionHeader );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        auto errStr = "Could not read missing transactions request header";
-        throw_with_nested( NetworkProtocolException( errStr, __CLASS_NAME__ ) );
+    if ( missingTransactionHeader->isFullHashesRequested() ) {
+        // the server could not decode the sketch
+        if ( !sketchAccepted ) {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "Unexpected full hashes request", __CLASS_NAME__ ) );
+        }
+        writePartialHashes( partialHashesList->getPartialHashes() );
+        missingTransactionHeader = readMissingHeader();
     }
 
     auto count = missingTransactionHeader->getMissingTransactionsCount();
 
+    lastMissingCounts.at( ( uint64_t ) _index )->store( count );
+
     if ( count == 0 ) {
         LOG( trace, "Proposal complete::no missing transactions" );
 
@@ -271,33 +327,22 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalClientAgent::sendBloc
 
         auto mtrh = make_shared< MissingTransactionsResponseHeader >( missingTransactionsSizes );
 
-        try {
-            getSchain()->getIo()->writeHeader( _socket, mtrh );
-        } catch ( ExitRequestedException& ) {
-            throw;
-        } catch ( ... ) {
-            auto errString =
-                "Proposal: unexpected server disconnect writing missing txs response header";
-            throw_with_nested( NetworkProtocolException( errString, __CLASS_NAME__ ) );
-        }
-
-
-        LOG( trace, "Proposal step 5: sent missing transactions header" );
-
-
         auto missingTransactionsList = make_shared< TransactionList >( missingTransactions );
 
         try {
-            getSchain()->getIo()->writeBytesVector(
-                _socket->getDescriptor(), missingTransactionsList->serialize( false ) );
+            auto serializedTransactions = missingTransactionsList->serialize( false );
+            sentBytes += serializedTransactions->size();
+            getSchain()->getIo()->writeHeaderAndBytes(
+                _socket->getDescriptor(), mtrh, serializedTransactions );
         } catch ( ExitRequestedException& ) {
             throw;
         } catch ( ... ) {
-            auto errString = "Proposal: unexpected server disconnect  writing missing hashes";
+            auto errString =
+                "Proposal: unexpected server disconnect writing missing transactions";
             throw_with_nested( NetworkProtocolException( errString, __CLASS_NAME__ ) );
         }
 
-        LOG( trace, "Proposal step 6: sent missing transactions" );
+        LOG( trace, "Proposal step 5: sent missing transactions header and transactions" );
     }
 
     auto finalHeader = readAndProcessFinalProposalResponseHeader( _socket );
@@ -317,6 +362,13 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalClientAgent::sendBloc
     if ( finalResult.first != ConnectionStatus::CONNECTION_SUCCESS )
         return finalResult;
 
+    auto blockAssembler = getSchain()->getPendingTransactionsAgent()->getBlockAssembler();
+
+    if ( blockAssembler ) {
+        blockAssembler->proposalPushed( ( uint64_t ) partialHashesList->getTransactionCount(),
+            sentBytes, Time::getCurrentTimeMs() - startTimeMs );
+    }
+
 
     auto sigShare = getSchain()->getCryptoManager()->createDAProofSigShare(
         finalHeader->getSigShare(), _proposal->getSchainID(), _proposal->getBlockID(), _index,
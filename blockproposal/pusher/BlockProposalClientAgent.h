@@ -31,16 +31,16 @@
 
 class ClientSocket;
 class Schain;
-class BlockProposalPusherThreadPool;
 class BlockProposal;
 class DAProof;
 class MissingTransactionsRequestHeader;
 class FinalProposalResponseHeader;
+class PartialHashesList;
 
 class BlockProposalClientAgent : public AbstractClientAgent {
-    ptr< BlockProposalPusherThreadPool > blockProposalThreadPool = nullptr;
-
-    friend class BlockProposalPusherThreadPool;
+    // transactions missing on each server in the last push, by schain index, used to size
+    // the sketch of the partial hashes
+    vector< ptr< atomic< uint64_t > > > lastMissingCounts;
 
 
     ptr< MissingTransactionsRequestHeader > readMissingTransactionsRequestHeader(
@@ -63,6 +63,10 @@ class BlockProposalClientAgent : public AbstractClientAgent {
         const ptr< BlockProposal >& _proposal, const ptr< ClientSocket >& _socket,
         schain_index _index );
 
+    // the short ids and sketch of the partial hashes, see PartialHashSketch::encodeProposal
+    ptr< vector< uint8_t > > encodePartialHashes(
+        const ptr< PartialHashesList >& _list, schain_index _index );
+
     ptr< BlockProposal > corruptProposal(
         const ptr< BlockProposal >& _proposal, schain_index _index );
 
@@ -78,4 +82,6 @@ class BlockProposalClientAgent : public AbstractClientAgent {
 
 public:
     explicit BlockProposalClientAgent( Schain& _sChain );
+
+    ~BlockProposalClientAgent() override;
 };
@@ -68,6 +68,7 @@
 
 #include "datastructures/BlockProposal.h"
 #include "datastructures/CommittedBlock.h"
+#include "datastructures/PartialHashSketch.h"
 #include "datastructures/PartialHashesList.h"
 #include "datastructures/ReceivedBlockProposal.h"
 #include "datastructures/Transaction.h"
@@ -79,19 +80,19 @@
 #include "headers/SubmitDAProofResponseHeader.h"
 
 
+#include "threads/WorkStealingPool.h"
+
 #include "BlockProposalServerAgent.h"
 #include "BlockProposalWorkerThreadPool.h"
+#include "ProposalExchange.h"
+#include "ProposerRequestLimiter.h"
 #include "crypto/ConsensusBLSSigShare.h"
 #include "headers/BlockFinalizeResponseHeader.h"
 #include "monitoring/LivelinessMonitor.h"
 
 
-ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >, PendingTransactionsAgent::Hasher,
-    PendingTransactionsAgent::Equal > >
-BlockProposalServerAgent::readMissingTransactions(
-    const ptr< ServerConnection >& _connectionEnvelope,
+ptr< vector< uint64_t > > BlockProposalServerAgent::getMissingTransactionSizes(
     nlohmann::json missingTransactionsResponseHeader ) {
-    CHECK_ARGUMENT( _connectionEnvelope );
     CHECK_STATE( missingTransactionsResponseHeader > 0 );
 
     auto transactionSizes = make_shared< vector< uint64_t > >();
@@ -103,28 +104,22 @@ BlockProposalServerAgent::readMissingTransactions(
             NetworkProtocolException( "jsonSizes is not an array", __CLASS_NAME__ ) );
     };
 
-
-    size_t totalSize = 2;  // account for starting and ending < >
-
     for ( auto&& size : jsonSizes ) {
         transactionSizes->push_back( size );
-        totalSize += ( size_t ) size;
     }
 
-    auto serializedTransactions = make_shared< vector< uint8_t > >( totalSize );
+    return transactionSizes;
+}
 
 
-    try {
-        getSchain()->getIo()->readBytes(
-            _connectionEnvelope, serializedTransactions, msg_len( totalSize ), 30 );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        BOOST_THROW_EXCEPTION(
-            NetworkProtocolException( "Could not read serialized exceptions", __CLASS_NAME__ ) );
-    }
+ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >, PendingTransactionsAgent::Hasher,
+    PendingTransactionsAgent::Equal > >
+BlockProposalServerAgent::deserializeMissingTransactions(
+    const ptr< vector< uint64_t > >& _sizes, const ptr< vector< uint8_t > >& _serialized ) {
+    CHECK_ARGUMENT( _sizes );
+    CHECK_ARGUMENT( _serialized );
 
-    auto list = TransactionList::deserialize( transactionSizes, serializedTransactions, 0, false );
+    auto list = TransactionList::deserialize( _sizes, _serialized, 0, false );
 
     CHECK_STATE( list );
 
@@ -173,14 +168,38 @@ BlockProposalServerAgent::getPresentAndMissingTransactions(
 BlockProposalServerAgent::BlockProposalServerAgent(
     Schain& _schain, const ptr< TCPServerSocket >& _s )
     : AbstractServerAgent( "BlockPropSrv", _schain, _s ) {
+    // proposals from different proposers are processed in parallel
+    auto workerCount =
+        min< uint64_t >( max< uint64_t >( ( uint64_t ) _schain.getNodeCount() - 1, 1 ),
+            max< uint64_t >( thread::hardware_concurrency(), 1 ) );
+
+    requestLimiter = make_shared< ProposerRequestLimiter >(
+        ( uint64_t ) _schain.getNodeCount(), MAX_REQUESTS_IN_PROCESSING_PER_PROPOSER,
+        MAX_DEFERRED_REQUESTS_PER_PROPOSER );
+
     blockProposalWorkerThreadPool =
-        make_shared< BlockProposalWorkerThreadPool >( num_threads( 1 ), this );
+        make_shared< BlockProposalWorkerThreadPool >( num_threads( workerCount ), this );
     blockProposalWorkerThreadPool->startService();
+    // ECDSA verification is CPU bound
+    signatureVerifier =
+        make_shared< TaskExecutor >( "ProposalVerify", WorkStealingPool::getShared() );
     createNetworkReadThread();
 }
 
 BlockProposalServerAgent::~BlockProposalServerAgent() {}
 
+atomic< uint64_t > BlockProposalServerAgent::proposalsProcessed = 0;
+
+atomic< uint64_t > BlockProposalServerAgent::proposalProcessingTimeMs = 0;
+
+atomic< uint64_t > BlockProposalServerAgent::sketchesDecoded = 0;
+
+atomic< uint64_t > BlockProposalServerAgent::sketchesFailed = 0;
+
+mutex BlockProposalServerAgent::queueDelayStatsLock;
+
+map< uint64_t, pair< uint64_t, uint64_t > > BlockProposalServerAgent::queueDelayStats;
+
 
 void BlockProposalServerAgent::processNextAvailableConnection(
     const ptr< ServerConnection >& _connection ) {
@@ -188,23 +207,12 @@ void BlockProposalServerAgent::processNextAvailableConnection(
 
     CHECK_ARGUMENT( _connection );
 
-    try {
-        sChain->getIo()->readMagic( _connection->getDescriptor() );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( PingException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested( NetworkProtocolException(
-            "Could not read magic number from:" + _connection->getIP(), __CLASS_NAME__ ) );
-    }
-
-
+    // magic number and request header have already been read by the reactor
     nlohmann::json clientRequest = nullptr;
 
     try {
-        clientRequest = getSchain()->getIo()->readJsonHeader(
-            _connection->getDescriptor(), "Read proposal req", 30, _connection->getIP() );
+        clientRequest = IO::parseJsonHeader(
+            _connection->getRequestHeader(), "Read proposal req", _connection->getIP() );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -217,14 +225,100 @@ void BlockProposalServerAgent::processNextAvailableConnection(
 
     CHECK_STATE( !type.empty() );
 
+    auto proposerIndex = Header::getUint64( clientRequest, "proposerIndex" );
+
+    if ( proposerIndex == 0 || proposerIndex > ( uint64_t ) getSchain()->getNodeCount() ) {
+        BOOST_THROW_EXCEPTION( InvalidSchainIndexException(
+            "Invalid proposer index:" + to_string( proposerIndex ), __CLASS_NAME__ ) );
+    }
+
+    // the proposer index is not authenticated here. A proposal is only accepted if it is
+    // signed by the proposer, and a DA proof if it carries a valid threshold signature
+
+    // extra requests from the same proposer wait until its earlier requests finish,
+    // so that one peer can not occupy all worker threads
+    auto admission = requestLimiter->admit( proposerIndex, _connection );
+
+    if ( admission == ProposerRequestLimiter::DEFERRED ) {
+        LOG( debug, "Deferring request from proposer " << proposerIndex );
+        return;
+    }
+
+    if ( admission == ProposerRequestLimiter::BUSY ) {
+        LOG( debug, "Too many requests from proposer " << proposerIndex );
+        sendBusyResponse( _connection, type );
+        return;
+    }
+
+    recordQueueDelay( proposerIndex, Time::getCurrentTimeMs() - _connection->getQueuedTimeMs() );
+
     if ( strcmp( type.data(), Header::BLOCK_PROPOSAL_REQ ) == 0 ) {
-        processProposalRequest( _connection, clientRequest );
-    } else if ( strcmp( type.data(), Header::DA_PROOF_REQ ) == 0 ) {
-        processDAProofRequest( _connection, clientRequest );
+        // the proposal steps finish the request once the exchange is over
+        processProposalRequest( _connection, clientRequest, proposerIndex );
+        return;
+    }
+
+    try {
+        if ( strcmp( type.data(), Header::DA_PROOF_REQ ) == 0 ) {
+            processDAProofRequest( _connection, clientRequest );
+        } else {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "Uknown request type:" + type, __CLASS_NAME__ ) );
+        }
+    } catch ( ... ) {
+        finishRequest( proposerIndex );
+        throw;
+    }
+
+    finishRequest( proposerIndex );
+}
+
+
+void BlockProposalServerAgent::sendBusyResponse(
+    const ptr< ServerConnection >& _connection, const string& _type ) {
+    ptr< Header > responseHeader;
+
+    if ( strcmp( _type.data(), Header::DA_PROOF_REQ ) == 0 ) {
+        responseHeader = make_shared< SubmitDAProofResponseHeader >();
     } else {
-        BOOST_THROW_EXCEPTION(
-            NetworkProtocolException( "Uknown request type:" + type, __CLASS_NAME__ ) );
+        responseHeader = make_shared< BlockProposalResponseHeader >();
     }
+
+    // the proposer retries later
+    responseHeader->setStatusSubStatus( CONNECTION_RETRY_LATER, CONNECTION_SERVER_BUSY );
+    responseHeader->setComplete();
+    send( _connection, responseHeader );
+}
+
+
+void BlockProposalServerAgent::finishRequest( uint64_t _proposerIndex ) {
+    auto next = requestLimiter->finish( _proposerIndex );
+    if ( next )
+        pushToQueueAndNotifyWorkers( next );
+}
+
+
+void BlockProposalServerAgent::recordQueueDelay( uint64_t _proposerIndex, uint64_t _delayMs ) {
+    lock_guard< mutex > lock( queueDelayStatsLock );
+    auto& stats = queueDelayStats[_proposerIndex];
+    stats.first += _delayMs;
+    stats.second++;
+}
+
+
+string BlockProposalServerAgent::getQueueDelayStats() {
+    lock_guard< mutex > lock( queueDelayStatsLock );
+
+    string result;
+
+    for ( auto&& [proposerIndex, stats] : queueDelayStats ) {
+        if ( !result.empty() )
+            result += ",";
+        result += to_string( proposerIndex ) + "/" +
+                  to_string( stats.second > 0 ? stats.first / stats.second : 0 );
+    }
+
+    return result;
 }
 
 
@@ -261,63 +355,135 @@ void BlockProposalServerAgent::processDAProofRequest(
     LOG( trace, "Got DA proof" );
 }
 
-pair< ConnectionStatus, ConnectionSubStatus > BlockProposalServerAgent::processProposalRequest(
-    const ptr< ServerConnection >& _connection, nlohmann::json _proposalRequest ) {
+void BlockProposalServerAgent::processProposalRequest( const ptr< ServerConnection >& _connection,
+    nlohmann::json _proposalRequest, uint64_t _proposerIndex ) {
     CHECK_ARGUMENT( _connection );
 
-    ptr< BlockProposalRequestHeader > requestHeader = nullptr;
-    ptr< Header > responseHeader = nullptr;
+    auto exchange = make_shared< ProposalExchange >();
+    exchange->connection = _connection;
+    exchange->proposerIndex = _proposerIndex;
+    exchange->startTimeMs = Time::getCurrentTimeMs();
 
-    try {
-        requestHeader = make_shared< BlockProposalRequestHeader >(
-            _proposalRequest, getSchain()->getNodeCount() );
-        responseHeader = createProposalResponseHeader( _connection, *requestHeader );
-        CHECK_STATE( responseHeader );
+    runProposalStep( exchange, [&]() {
+        try {
+            exchange->requestHeader = make_shared< BlockProposalRequestHeader >(
+                _proposalRequest, getSchain()->getNodeCount() );
+            exchange->headerHash = BLAKE3Hash::fromHex( exchange->requestHeader->getHash() );
+            exchange->responseHeader =
+                createProposalResponseHeader( _connection, *exchange->requestHeader );
+            CHECK_STATE( exchange->responseHeader );
 
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested(
-            NetworkProtocolException( "Couldnt create proposal response header", __CLASS_NAME__ ) );
-    }
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( ... ) {
+            throw_with_nested( NetworkProtocolException(
+                "Couldnt create proposal response header", __CLASS_NAME__ ) );
+        }
 
-    try {
-        send( _connection, responseHeader );
-        if ( responseHeader->getStatusSubStatus().first != CONNECTION_PROCEED ) {
-            return responseHeader->getStatusSubStatus();
+        try {
+            send( _connection, exchange->responseHeader );
+            if ( exchange->responseHeader->getStatusSubStatus().first != CONNECTION_PROCEED ) {
+                finishProposal( exchange );
+                return;
+            }
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( ... ) {
+            throw_with_nested( NetworkProtocolException(
+                "Couldnt send proposal response header", __CLASS_NAME__ ) );
         }
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested(
-            NetworkProtocolException( "Couldnt send proposal response header", __CLASS_NAME__ ) );
-    }
 
-    ptr< PartialHashesList > partialHashesList = nullptr;
+        // The header carries the proposal hash signed by the proposer. Verify the signature
+        // in the background, while the transactions are exchanged over the network.
+        // The DA proof share is only signed after the received transactions are checked
+        // to hash to the same value
+        exchange->verification =
+            startSignatureVerification( *exchange->requestHeader, exchange->headerHash );
+
+        auto sketchAccepted = dynamic_pointer_cast< BlockProposalResponseHeader >(
+            exchange->responseHeader )
+                                  ->isSketchAccepted();
 
+        if ( sketchAccepted ) {
+            readSketchCellCount( exchange );
+        } else {
+            readFullPartialHashes( exchange );
+        }
+    } );
+}
+
+
+void BlockProposalServerAgent::runProposalStep(
+    const ptr< ProposalExchange >& _exchange, const function< void() >& _step ) {
+    CHECK_ARGUMENT( _exchange );
     try {
-        partialHashesList = readPartialHashes( _connection, requestHeader->getTxCount() );
-        CHECK_STATE( partialHashesList );
-    } catch ( ExitRequestedException& ) {
-        throw;
+        _step();
     } catch ( ... ) {
-        throw_with_nested(
-            NetworkProtocolException( "Could not read partial hashes", __CLASS_NAME__ ) );
+        finishProposal( _exchange );
+        throw;
     }
+}
 
-    auto result = getPresentAndMissingTransactions( *sChain, responseHeader, partialHashesList );
 
-    auto presentTransactions = result.first;
-    auto missingTransactionHashes = result.second;
+function< void() > BlockProposalServerAgent::proposalStep(
+    const ptr< ProposalExchange >& _exchange, function< void() >&& _step ) {
+    return [this, _exchange, step = std::move( _step )]() { runProposalStep( _exchange, step ); };
+}
 
-    CHECK_STATE( presentTransactions );
-    CHECK_STATE( missingTransactionHashes );
+
+function< void() > BlockProposalServerAgent::proposalTransferFailed(
+    const ptr< ProposalExchange >& _exchange ) {
+    return [this, _exchange]() {
+        LOG( debug, "Proposal transfer from proposer " << _exchange->proposerIndex
+                                                       << " failed or timed out" );
+        finishProposal( _exchange );
+    };
+}
+
+
+void BlockProposalServerAgent::finishProposal( const ptr< ProposalExchange >& _exchange ) {
+    CHECK_ARGUMENT( _exchange );
+    if ( !_exchange->finished.exchange( true ) )
+        finishRequest( _exchange->proposerIndex );
+}
+
+
+void BlockProposalServerAgent::readFullPartialHashes( const ptr< ProposalExchange >& _exchange ) {
+    auto txCount = _exchange->requestHeader->getTxCount();
+
+    if ( txCount > ( uint64_t ) getNode()->getMaxTransactionsPerBlock() ) {
+        BOOST_THROW_EXCEPTION(
+            NetworkProtocolException( "Too many transactions", __CLASS_NAME__ ) );
+    }
+
+    _exchange->partialHashesList = make_shared< PartialHashesList >( txCount );
+
+    readAsync( _exchange->connection, _exchange->partialHashesList->getPartialHashes(),
+        ( uint64_t ) txCount * PARTIAL_HASH_LEN,
+        proposalStep( _exchange, [this, _exchange]() { partialHashesArrived( _exchange ); } ),
+        proposalTransferFailed( _exchange ) );
+}
+
+
+void BlockProposalServerAgent::partialHashesArrived( const ptr< ProposalExchange >& _exchange ) {
+    CHECK_STATE( _exchange->partialHashesList );
+
+    auto& connection = _exchange->connection;
+
+    auto result = getPresentAndMissingTransactions(
+        *sChain, _exchange->responseHeader, _exchange->partialHashesList );
+
+    _exchange->presentTransactions = result.first;
+    _exchange->missingTransactionHashes = result.second;
+
+    CHECK_STATE( _exchange->presentTransactions );
+    CHECK_STATE( _exchange->missingTransactionHashes );
 
     auto missingHashesRequestHeader =
-        make_shared< MissingTransactionsRequestHeader >( missingTransactionHashes );
+        make_shared< MissingTransactionsRequestHeader >( _exchange->missingTransactionHashes );
 
     try {
-        send( _connection, missingHashesRequestHeader );
+        send( connection, missingHashesRequestHeader );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -325,43 +491,84 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalServerAgent::processP
             "Could not send missing hashes request requestHeader", __CLASS_NAME__ ) );
     }
 
+    if ( _exchange->missingTransactionHashes->size() == 0 ) {
+        LOG( debug, "Server: No missing partial hashes" );
+        completeProposal( _exchange, nullptr );
+        return;
+    }
 
-    ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >,
-        PendingTransactionsAgent::Hasher, PendingTransactionsAgent::Equal > >
-        missingTransactions = nullptr;
+    LOG( debug, "Server: missing partial hashes" );
+    try {
+        getSchain()->getIo()->writePartialHashes(
+            connection->getDescriptor(), _exchange->missingTransactionHashes );
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( ... ) {
+        BOOST_THROW_EXCEPTION( CouldNotSendMessageException(
+            "Could not send missing hashes  requestHeader", __CLASS_NAME__ ) );
+    }
 
-    if ( missingTransactionHashes->size() == 0 ) {
-        LOG( debug, "Server: No missing partial hashes" );
-    } else {
-        LOG( debug, "Server: missing partial hashes" );
-        try {
-            getSchain()->getIo()->writePartialHashes(
-                _connection->getDescriptor(), missingTransactionHashes );
-        } catch ( ExitRequestedException& ) {
-            throw;
-        } catch ( ... ) {
-            BOOST_THROW_EXCEPTION( CouldNotSendMessageException(
-                "Could not send missing hashes  requestHeader", __CLASS_NAME__ ) );
-        }
+    readHeaderAsync(
+        connection,
+        [this, _exchange]( const string& _header ) {
+            runProposalStep(
+                _exchange, [&]() { missingTransactionsHeaderArrived( _exchange, _header ); } );
+        },
+        proposalTransferFailed( _exchange ) );
+}
 
 
-        auto missingMessagesResponseHeader =
-            this->readMissingTransactionsResponseHeader( _connection );
+void BlockProposalServerAgent::missingTransactionsHeaderArrived(
+    const ptr< ProposalExchange >& _exchange, const string& _header ) {
+    auto missingTransactionsResponseHeader = IO::parseJsonHeader(
+        _header, "Read missing trans response", _exchange->connection->getIP() );
 
-        missingTransactions = readMissingTransactions( _connection, missingMessagesResponseHeader );
+    auto sizes = getMissingTransactionSizes( missingTransactionsResponseHeader );
 
-        if ( missingTransactions == nullptr ) {
-            BOOST_THROW_EXCEPTION( CouldNotReadPartialDataHashesException(
-                "Null missing transactions", __CLASS_NAME__ ) );
-        }
+    size_t totalSize = 2;  // account for starting and ending < >
+
+    for ( auto&& size : *sizes ) {
+        totalSize += size;
+    }
 
+    auto serializedTransactions = make_shared< vector< uint8_t > >( totalSize );
 
-        for ( auto&& item : *missingTransactions ) {
-            CHECK_STATE( item.second );
-            sChain->getPendingTransactionsAgent()->pushKnownTransaction( item.second );
-        }
+    readAsync( _exchange->connection, serializedTransactions, totalSize,
+        proposalStep( _exchange,
+            [this, _exchange, sizes, serializedTransactions]() {
+                missingTransactionsArrived( _exchange, sizes, serializedTransactions );
+            } ),
+        proposalTransferFailed( _exchange ) );
+}
+
+
+void BlockProposalServerAgent::missingTransactionsArrived(
+    const ptr< ProposalExchange >& _exchange, const ptr< vector< uint64_t > >& _sizes,
+    const ptr< vector< uint8_t > >& _serialized ) {
+    auto missingTransactions = deserializeMissingTransactions( _sizes, _serialized );
+
+    if ( missingTransactions == nullptr ) {
+        BOOST_THROW_EXCEPTION( CouldNotReadPartialDataHashesException(
+            "Null missing transactions", __CLASS_NAME__ ) );
     }
 
+    for ( auto&& item : *missingTransactions ) {
+        CHECK_STATE( item.second );
+        sChain->getPendingTransactionsAgent()->pushKnownTransaction( item.second );
+    }
+
+    completeProposal( _exchange, missingTransactions );
+}
+
+
+void BlockProposalServerAgent::completeProposal( const ptr< ProposalExchange >& _exchange,
+    const ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >,
+        PendingTransactionsAgent::Hasher, PendingTransactionsAgent::Equal > >&
+        _missingTransactions ) {
+    auto& requestHeader = _exchange->requestHeader;
+    auto& partialHashesList = _exchange->partialHashesList;
+    auto& presentTransactions = _exchange->presentTransactions;
+
     LOG( debug, "Storing block proposal" );
 
     auto transactions = make_shared< vector< ptr< Transaction > > >();
@@ -376,15 +583,15 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalServerAgent::processP
 
         if ( presentTransactions->count( i ) > 0 ) {
             transaction = presentTransactions->at( i );
-        } else {
-            transaction = ( *missingTransactions )[partialHash];
+        } else if ( _missingTransactions ) {
+            transaction = ( *_missingTransactions )[partialHash];
         };
 
         if ( transaction == nullptr ) {
             checkForOldBlock( requestHeader->getBlockId() );
-            CHECK_STATE( missingTransactions );
+            CHECK_STATE( _missingTransactions );
 
-            if ( missingTransactions->count( partialHash ) > 0 ) {
+            if ( _missingTransactions->count( partialHash ) > 0 ) {
                 LOG( err, "Found in missing" );
             }
 
@@ -410,16 +617,21 @@ pair< ConnectionStatus, ConnectionSubStatus > BlockProposalServerAgent::processP
 
     try {
         try {
-            getSchain()->getCryptoManager()->verifyProposalECDSA(
-                proposal, requestHeader->getHash(), requestHeader->getSignature() );
+            // default proposal is not signed using ECDSA
+            CHECK_STATE( proposal->getProposerIndex() != 0 );
+            CHECK_STATE2( proposal->getHash().toHex() == requestHeader->getHash(),
+                "Incorrect proposal hash" );
+            waitForSignatureVerification( _exchange->verification );
+            finalResponseHeader = createFinalResponseHeader(
+                _exchange->headerHash, requestHeader->getBlockId(), requestHeader->getTimeStamp() );
+        } catch ( ExitRequestedException& ) {
+            throw;
         } catch ( ... ) {
             finalResponseHeader = make_shared< FinalProposalResponseHeader >(
                 CONNECTION_ERROR, CONNECTION_SIGNATURE_DID_NOT_VERIFY );
             goto err;
         }
 
-        finalResponseHeader = createFinalResponseHeader( proposal );
-
         CHECK_STATE( finalResponseHeader );
         CHECK_STATE( proposal );
 
@@ -437,9 +649,139 @@ err:
 
     CHECK_STATE( finalResponseHeader );
 
-    send( _connection, finalResponseHeader );
+    send( _exchange->connection, finalResponseHeader );
+
+    proposalsProcessed++;
+    proposalProcessingTimeMs += Time::getCurrentTimeMs() - _exchange->startTimeMs;
 
-    return finalResponseHeader->getStatusSubStatus();
+    finishProposal( _exchange );
+}
+
+
+future< void > BlockProposalServerAgent::startSignatureVerification(
+    BlockProposalRequestHeader& _header, const BLAKE3Hash& _hash ) {
+    auto signature = _header.getSignature();
+    auto proposerNodeId = _header.getProposerNodeId();
+    auto timeStampS = _header.getTimeStamp();
+
+    return signatureVerifier->submit( [this, _hash, signature, proposerNodeId, timeStampS]() {
+        auto hash = _hash;
+        getSchain()->getCryptoManager()->verifyProposalECDSA(
+            hash, signature, proposerNodeId, timeStampS );
+    } );
+}
+
+
+void BlockProposalServerAgent::waitForSignatureVerification( future< void >& _verification ) {
+    while ( _verification.wait_for( chrono::milliseconds( 100 ) ) != future_status::ready ) {
+        if ( getSchain()->getNode()->isExitRequested() )
+            BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
+    }
+    _verification.get();
+}
+
+
+void BlockProposalServerAgent::readSketchCellCount( const ptr< ProposalExchange >& _exchange ) {
+    auto cellCountBytes = make_shared< vector< uint8_t > >( sizeof( uint64_t ) );
+    readAsync( _exchange->connection, cellCountBytes, cellCountBytes->size(),
+        proposalStep( _exchange,
+            [this, _exchange, cellCountBytes]() {
+                sketchCellCountArrived( _exchange, cellCountBytes );
+            } ),
+        proposalTransferFailed( _exchange ) );
+}
+
+
+void BlockProposalServerAgent::sketchCellCountArrived(
+    const ptr< ProposalExchange >& _exchange, const ptr< vector< uint8_t > >& _cellCount ) {
+    uint64_t cellCount;
+    memcpy( &cellCount, _cellCount->data(), sizeof( uint64_t ) );
+
+    // the proposer sends the full partial hashes if a sketch would not be smaller
+    if ( cellCount == 0 ) {
+        readFullPartialHashes( _exchange );
+        return;
+    }
+
+    uint64_t txCount = _exchange->requestHeader->getTxCount();
+
+    if ( !PartialHashSketch::isWorthSending( txCount, cellCount ) ) {
+        BOOST_THROW_EXCEPTION( NetworkProtocolException(
+            "Invalid sketch cell count:" + to_string( cellCount ), __CLASS_NAME__ ) );
+    }
+
+    auto encoded = make_shared< vector< uint8_t > >(
+        PartialHashSketch::getEncodedSize( txCount, cellCount ) );
+
+    readAsync( _exchange->connection, encoded, encoded->size(),
+        proposalStep( _exchange,
+            [this, _exchange, encoded, cellCount]() {
+                sketchArrived( _exchange, encoded, cellCount );
+            } ),
+        proposalTransferFailed( _exchange ) );
+}
+
+
+void BlockProposalServerAgent::sketchArrived( const ptr< ProposalExchange >& _exchange,
+    const ptr< vector< uint8_t > >& _encoded, uint64_t _cellCount ) {
+    uint64_t txCount = _exchange->requestHeader->getTxCount();
+
+    auto shortIds = PartialHashSketch::readShortIds( *_encoded, txCount );
+    PartialHashSketch sketch(
+        _encoded->data() + txCount * PartialHashSketch::SHORT_ID_LEN, _cellCount );
+
+    // only the known transactions that match a short id of the proposal take part
+    unordered_set< uint32_t > proposalShortIds( shortIds.begin(), shortIds.end() );
+    vector< uint64_t > knownKeys;
+
+    getSchain()->getPendingTransactionsAgent()->forEachKnownPartialHash( [&]( uint64_t _key ) {
+        if ( proposalShortIds.count( PartialHashSketch::getShortId( _key ) ) > 0 )
+            knownKeys.push_back( _key );
+    } );
+
+    auto partialHashesList = PartialHashSketch::recoverProposal( shortIds, sketch, knownKeys );
+
+    if ( partialHashesList ) {
+        sketchesDecoded++;
+        _exchange->partialHashesList = partialHashesList;
+        partialHashesArrived( _exchange );
+        return;
+    }
+
+    sketchesFailed++;
+    LOG( debug, "Proposal sketch did not decode, requesting full partial hashes" );
+
+    auto fullHashesRequestHeader = make_shared< MissingTransactionsRequestHeader >();
+    fullHashesRequestHeader->setFullHashesRequested( true );
+    fullHashesRequestHeader->setComplete();
+
+    try {
+        send( _exchange->connection, fullHashesRequestHeader );
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( ... ) {
+        throw_with_nested( NetworkProtocolException(
+            "Could not request full partial hashes", __CLASS_NAME__ ) );
+    }
+
+    readFullPartialHashes( _exchange );
+}
+
+
+string BlockProposalServerAgent::getSketchStats() {
+    return to_string( sketchesDecoded.load() ) + "/" + to_string( sketchesFailed.load() );
+}
+
+
+uint64_t BlockProposalServerAgent::getProposalsProcessed() {
+    return proposalsProcessed;
+}
+
+
+string BlockProposalServerAgent::getProposalStats() {
+    uint64_t count = proposalsProcessed;
+    uint64_t timeMs = proposalProcessingTimeMs;
+    return to_string( count ) + "/" + to_string( count > 0 ? timeMs / count : 0 );
 }
 
 
@@ -585,6 +927,14 @@ ptr< Header > BlockProposalServerAgent::createProposalResponseHeader(
         responseHeader->setComplete();
         return responseHeader;
     }
+    auto node = sChain->getNode();
+    auto txCount = _header.getTxCount();
+
+    // the proposer sends a sketch of the partial hashes if both sides support it
+    responseHeader->setSketchAccepted( _header.isSketchOffered() &&
+                                       node->isProposalReconciliationEnabled() && txCount > 0 &&
+                                       txCount <= node->getMaxTransactionsPerBlock() );
+
     responseHeader->setStatusSubStatus( CONNECTION_PROCEED, CONNECTION_OK );
     responseHeader->setComplete();
     return responseHeader;
@@ -730,8 +1080,16 @@ ptr< Header > BlockProposalServerAgent::createFinalResponseHeader(
     const ptr< ReceivedBlockProposal >& _proposal ) {
     CHECK_ARGUMENT( _proposal );
 
+    auto hash = _proposal->getHash();
+
+    return createFinalResponseHeader( hash, _proposal->getBlockID(), _proposal->getTimeStampS() );
+}
+
+
+ptr< Header > BlockProposalServerAgent::createFinalResponseHeader(
+    BLAKE3Hash& _hash, block_id _blockId, uint64_t _timeStampS ) {
     auto [sigShare, signature, pubKey, pubKeySig] =
-        getSchain()->getCryptoManager()->signDAProof( _proposal );
+        getSchain()->getCryptoManager()->signDAProof( _hash, _blockId, _timeStampS );
 
     auto responseHeader = make_shared< FinalProposalResponseHeader >(
         sigShare->toString(), signature, pubKey, pubKeySig );
@@ -741,14 +1099,6 @@ ptr< Header > BlockProposalServerAgent::createFinalResponseHeader(
 }
 
 
-nlohmann::json BlockProposalServerAgent::readMissingTransactionsResponseHeader(
-    const ptr< ServerConnection >& _connectionEnvelope ) {
-    auto js = sChain->getIo()->readJsonHeader( _connectionEnvelope->getDescriptor(),
-        "Read missing trans response", 30, _connectionEnvelope->getIP() );
-
-    return js;
-}
-
 ptr< PartialHashesList > AbstractServerAgent::readPartialHashes(
     const ptr< ServerConnection >& _connectionEnvelope, transaction_count _txCount ) {
     CHECK_ARGUMENT( _connectionEnvelope );
@@ -26,12 +26,16 @@
 #include "abstracttcpserver/AbstractServerAgent.h"
 #include "abstracttcpserver/ConnectionStatus.h"
 #include "pendingqueue/PendingTransactionsAgent.h"
+#include "threads/TaskExecutor.h"
 
 class BlockProposalWorkerThreadPool;
+class ProposerRequestLimiter;
 class BlockFinalizeResponseHeader;
 class BlockProposalRequestHeader;
 class SubmitDAProofRequestHeader;
 class ReceivedBlockProposal;
+class BLAKE3Hash;
+struct ProposalExchange;
 
 
 class Transaction;
@@ -56,9 +60,81 @@ public:
 class BlockProposalServerAgent : public AbstractServerAgent {
     ptr< BlockProposalWorkerThreadPool > blockProposalWorkerThreadPool;
 
+    // verifies proposer signatures off the connection threads
+    ptr< TaskExecutor > signatureVerifier;
 
-    pair< ConnectionStatus, ConnectionSubStatus > processProposalRequest(
-        const ptr< ServerConnection >& _connection, nlohmann::json _proposalRequest );
+    static atomic< uint64_t > proposalsProcessed;
+
+    static atomic< uint64_t > proposalProcessingTimeMs;
+
+    static atomic< uint64_t > sketchesDecoded;
+
+    static atomic< uint64_t > sketchesFailed;
+
+    static constexpr uint64_t MAX_REQUESTS_IN_PROCESSING_PER_PROPOSER = 2;
+
+    static constexpr uint64_t MAX_DEFERRED_REQUESTS_PER_PROPOSER = 16;
+
+    ptr< ProposerRequestLimiter > requestLimiter;
+
+    static mutex queueDelayStatsLock;
+
+    // total queue delay ms and request count, by proposer index, over all server agents
+    static map< uint64_t, pair< uint64_t, uint64_t > > queueDelayStats;
+
+    static void recordQueueDelay( uint64_t _proposerIndex, uint64_t _delayMs );
+
+    // answers a request that the proposer limiter turned away
+    void sendBusyResponse( const ptr< ServerConnection >& _connection, const string& _type );
+
+    // queues the next deferred request of the proposer, if any
+    void finishRequest( uint64_t _proposerIndex );
+
+    future< void > startSignatureVerification(
+        BlockProposalRequestHeader& _header, const BLAKE3Hash& _hash );
+
+    void waitForSignatureVerification( future< void >& _verification );
+
+    // the steps of a proposal request. Each step runs on a worker thread and hands the
+    // connection to the reactor for the next read, so no worker waits for the proposer
+    void runProposalStep(
+        const ptr< ProposalExchange >& _exchange, const function< void() >& _step );
+
+    function< void() > proposalStep(
+        const ptr< ProposalExchange >& _exchange, function< void() >&& _step );
+
+    function< void() > proposalTransferFailed( const ptr< ProposalExchange >& _exchange );
+
+    void finishProposal( const ptr< ProposalExchange >& _exchange );
+
+    void readSketchCellCount( const ptr< ProposalExchange >& _exchange );
+
+    void sketchCellCountArrived(
+        const ptr< ProposalExchange >& _exchange, const ptr< vector< uint8_t > >& _cellCount );
+
+    // decodes the short ids and sketch of the partial hashes of a proposal, requests the full
+    // partial hashes if the sketch did not decode
+    void sketchArrived( const ptr< ProposalExchange >& _exchange,
+        const ptr< vector< uint8_t > >& _encoded, uint64_t _cellCount );
+
+    void readFullPartialHashes( const ptr< ProposalExchange >& _exchange );
+
+    void partialHashesArrived( const ptr< ProposalExchange >& _exchange );
+
+    void missingTransactionsHeaderArrived(
+        const ptr< ProposalExchange >& _exchange, const string& _header );
+
+    void missingTransactionsArrived( const ptr< ProposalExchange >& _exchange,
+        const ptr< vector< uint64_t > >& _sizes, const ptr< vector< uint8_t > >& _serialized );
+
+    void completeProposal( const ptr< ProposalExchange >& _exchange,
+        const ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >,
+            PendingTransactionsAgent::Hasher, PendingTransactionsAgent::Equal > >&
+            _missingTransactions );
+
+    // starts the proposal steps, the last step finishes the request for the proposer
+    void processProposalRequest( const ptr< ServerConnection >& _connection,
+        nlohmann::json _proposalRequest, uint64_t _proposerIndex );
 
     void processDAProofRequest(
         const ptr< ServerConnection >& _connection, nlohmann::json _daProofRequest );
@@ -69,11 +145,15 @@ public:
 
     ~BlockProposalServerAgent() override;
 
-    ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >,
-        PendingTransactionsAgent::Hasher, PendingTransactionsAgent::Equal > >
-    readMissingTransactions( const ptr< ServerConnection >& _connectionEnvelope,
+    // the sizes of the missing transactions in a missing transactions response header
+    static ptr< vector< uint64_t > > getMissingTransactionSizes(
         nlohmann::json missingTransactionsResponseHeader );
 
+    static ptr< unordered_map< ptr< partial_sha_hash >, ptr< Transaction >,
+        PendingTransactionsAgent::Hasher, PendingTransactionsAgent::Equal > >
+    deserializeMissingTransactions(
+        const ptr< vector< uint64_t > >& _sizes, const ptr< vector< uint8_t > >& _serialized );
+
 
     pair< ptr< map< uint64_t, ptr< Transaction > > >,
         ptr< map< uint64_t, ptr< partial_sha_hash > > > >
@@ -90,12 +170,22 @@ public:
 
     ptr< Header > createFinalResponseHeader( const ptr< ReceivedBlockProposal >& _proposal );
 
-    ptr< Header > createDAProofResponseHeader( const ptr< ServerConnection >& _connectionEnvelope,
-        const ptr< SubmitDAProofRequestHeader >& _header );
+    ptr< Header > createFinalResponseHeader(
+        BLAKE3Hash& _hash, block_id _blockId, uint64_t _timeStampS );
+
+    // proposals processed and average processing time in ms, over all server agents
+    static string getProposalStats();
 
+    static uint64_t getProposalsProcessed();
 
-    nlohmann::json readMissingTransactionsResponseHeader(
-        const ptr< ServerConnection >& _connectionEnvelope );
+    // proposal sketches decoded/failed to decode, over all server agents
+    static string getSketchStats();
+
+    // average time in ms that requests waited for a worker thread, by proposer index
+    static string getQueueDelayStats();
+
+    ptr< Header > createDAProofResponseHeader( const ptr< ServerConnection >& _connectionEnvelope,
+        const ptr< SubmitDAProofRequestHeader >& _header );
 
 
     void processNextAvailableConnection( const ptr< ServerConnection >& _connection ) override;
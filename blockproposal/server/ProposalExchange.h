@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ProposalExchange.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "crypto/BLAKE3Hash.h"
+
+class ServerConnection;
+class Header;
+class BlockProposalRequestHeader;
+class PartialHashesList;
+class Transaction;
+
+// the state of a proposal request between the steps that the server agent runs on worker
+// threads, while the reactor reads the proposal data from the connection
+struct ProposalExchange {
+    ptr< ServerConnection > connection;
+
+    uint64_t proposerIndex = 0;
+
+    uint64_t startTimeMs = 0;
+
+    ptr< BlockProposalRequestHeader > requestHeader;
+
+    ptr< Header > responseHeader;
+
+    BLAKE3Hash headerHash;
+
+    future< void > verification;
+
+    ptr< PartialHashesList > partialHashesList;
+
+    ptr< map< uint64_t, ptr< Transaction > > > presentTransactions;
+
+    ptr< map< uint64_t, ptr< partial_sha_hash > > > missingTransactionHashes;
+
+    // set once the request is finished, so that the proposer limiter is released only once
+    atomic< bool > finished = false;
+};
@@ -0,0 +1,162 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ProposerRequestLimiter.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+#include "network/ServerConnection.h"
+#include "threads/TimerWheel.h"
+#include "utils/Time.h"
+
+#include "ProposerRequestLimiter.h"
+
+
+ProposerRequestLimiter::ProposerRequestLimiter(
+    uint64_t _proposerCount, uint64_t _maxInProcessing, uint64_t _maxDeferred )
+    : maxInProcessing( _maxInProcessing ),
+      maxDeferred( _maxDeferred ),
+      inProcessing( _proposerCount + 1, 0 ),
+      deferred( _proposerCount + 1 ) {
+    CHECK_ARGUMENT( _proposerCount > 0 );
+    CHECK_ARGUMENT( _maxInProcessing > 0 );
+}
+
+
+ProposerRequestLimiter::~ProposerRequestLimiter() {
+    uint64_t timerId;
+    {
+        lock_guard< mutex > lock( requestsLock );
+        stopped = true;
+        timerId = expiryTimerId;
+    }
+    if ( timerId != 0 )
+        TimerWheel::getShared().cancel( timerId );
+}
+
+
+ProposerRequestLimiter::Admission ProposerRequestLimiter::admit(
+    uint64_t _proposerIndex, const ptr< ServerConnection >& _connection ) {
+    CHECK_ARGUMENT( _connection );
+
+    lock_guard< mutex > lock( requestsLock );
+
+    auto& count = inProcessing.at( _proposerIndex );
+
+    if ( count < maxInProcessing ) {
+        count++;
+        return ADMITTED;
+    }
+
+    auto& proposerQueue = deferred.at( _proposerIndex );
+
+    if ( proposerQueue.size() >= maxDeferred )
+        return BUSY;
+
+    proposerQueue.push_back( _connection );
+
+    if ( _connection->getDeadlineMs() != 0 )
+        scheduleExpiry( _connection->getDeadlineMs() );
+
+    return DEFERRED;
+}
+
+
+void ProposerRequestLimiter::scheduleExpiry( uint64_t _deadlineMs ) {
+    // deadlines grow with arrival time, so the scheduled timer is never later than needed
+    if ( expiryTimerId != 0 || stopped )
+        return;
+
+    expiryTimerId =
+        TimerWheel::getShared().schedule( _deadlineMs + 1, [this]() { expireDeferred(); } );
+}
+
+
+void ProposerRequestLimiter::expireDeferred() {
+    // closed after the lock is released
+    vector< ptr< ServerConnection > > expired;
+
+    {
+        lock_guard< mutex > lock( requestsLock );
+
+        expiryTimerId = 0;
+
+        if ( stopped )
+            return;
+
+        auto now = Time::getCurrentTimeMs();
+        uint64_t nextDeadlineMs = 0;
+
+        for ( auto&& proposerQueue : deferred ) {
+            for ( auto it = proposerQueue.begin(); it != proposerQueue.end(); ) {
+                auto deadlineMs = ( *it )->getDeadlineMs();
+                if ( deadlineMs != 0 && now > deadlineMs ) {
+                    expired.push_back( *it );
+                    it = proposerQueue.erase( it );
+                    continue;
+                }
+                if ( deadlineMs != 0 && ( nextDeadlineMs == 0 || deadlineMs < nextDeadlineMs ) )
+                    nextDeadlineMs = deadlineMs;
+                it++;
+            }
+        }
+
+        if ( nextDeadlineMs != 0 )
+            scheduleExpiry( nextDeadlineMs );
+    }
+
+    if ( !expired.empty() )
+        LOG( debug, "Closed " << expired.size() << " deferred proposer requests" );
+}
+
+
+ptr< ServerConnection > ProposerRequestLimiter::finish( uint64_t _proposerIndex ) {
+    lock_guard< mutex > lock( requestsLock );
+
+    auto& count = inProcessing.at( _proposerIndex );
+    CHECK_STATE( count > 0 );
+    count--;
+
+    auto& proposerQueue = deferred.at( _proposerIndex );
+    auto now = Time::getCurrentTimeMs();
+
+    while ( !proposerQueue.empty() ) {
+        auto connection = proposerQueue.front();
+        proposerQueue.pop_front();
+        if ( connection->getDeadlineMs() == 0 || now <= connection->getDeadlineMs() )
+            return connection;
+    }
+
+    return nullptr;
+}
+
+
+uint64_t ProposerRequestLimiter::getInProcessingCount( uint64_t _proposerIndex ) {
+    lock_guard< mutex > lock( requestsLock );
+    return inProcessing.at( _proposerIndex );
+}
+
+
+uint64_t ProposerRequestLimiter::getDeferredCount( uint64_t _proposerIndex ) {
+    lock_guard< mutex > lock( requestsLock );
+    return deferred.at( _proposerIndex ).size();
+}
@@ -0,0 +1,83 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ProposerRequestLimiter.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+class ServerConnection;
+
+/*
+ * Limits the requests that each proposer has in processing on a server.
+ *
+ * An honest proposer sends one request at a time, so a proposer with more requests in
+ * processing can not occupy more worker threads. Its extra requests are deferred and
+ * handed back one by one as its requests in processing finish. A proposer has at most
+ * maxDeferred deferred requests, further ones are answered as busy. A timer closes deferred
+ * requests that pass their queue deadline.
+ */
+class ProposerRequestLimiter {
+public:
+    enum Admission { ADMITTED, DEFERRED, BUSY };
+
+private:
+    const uint64_t maxInProcessing;
+
+    const uint64_t maxDeferred;
+
+    mutex requestsLock;
+
+    // the fields below are protected by requestsLock
+
+    // indexed by proposer index
+    vector< uint64_t > inProcessing;
+
+    // indexed by proposer index
+    vector< deque< ptr< ServerConnection > > > deferred;
+
+    // the timer that expires deferred requests, 0 if none is scheduled
+    uint64_t expiryTimerId = 0;
+
+    bool stopped = false;
+
+    // requestsLock must be held
+    void scheduleExpiry( uint64_t _deadlineMs );
+
+    void expireDeferred();
+
+public:
+    ProposerRequestLimiter(
+        uint64_t _proposerCount, uint64_t _maxInProcessing, uint64_t _maxDeferred );
+
+    ~ProposerRequestLimiter();
+
+    // ADMITTED if the request can be processed now. DEFERRED if the connection is kept
+    // until a request of the same proposer finishes, BUSY if the proposer has too many
+    // deferred requests and the caller should turn the request away
+    Admission admit( uint64_t _proposerIndex, const ptr< ServerConnection >& _connection );
+
+    // returns the next deferred request of the proposer to queue for processing, or nullptr
+    ptr< ServerConnection > finish( uint64_t _proposerIndex );
+
+    uint64_t getInProcessingCount( uint64_t _proposerIndex );
+
+    uint64_t getDeferredCount( uint64_t _proposerIndex );
+};
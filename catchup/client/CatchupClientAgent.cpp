@@ -31,7 +31,6 @@
 #include "crypto/CryptoManager.h"
 
 #include "CatchupClientAgent.h"
-#include "CatchupClientThreadPool.h"
 #include "chains/Schain.h"
 #include "datastructures/CommittedBlock.h"
 #include "datastructures/CommittedBlockList.h"
@@ -41,10 +40,14 @@
 #include "headers/CatchupRequestHeader.h"
 #include "headers/CatchupResponseHeader.h"
 #include "network/ClientSocket.h"
+#include "network/CompressionPolicy.h"
 #include "network/IO.h"
 #include "network/Network.h"
 #include "pendingqueue/PendingTransactionsAgent.h"
 #include "sys/random.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
+#include "threads/TimerWheel.h"
 #include "utils/Time.h"
 
 
@@ -54,8 +57,21 @@ CatchupClientAgent::CatchupClientAgent( Schain& _sChain ) : Agent( _sChain, fals
         this->sChain = &_sChain;
 
         if ( _sChain.getNodeCount() > 1 ) {
-            this->catchupClientThreadPool = make_shared< CatchupClientThreadPool >( 1, this );
-            catchupClientThreadPool->startService();
+            // start with a random index and then to round-robin
+            auto nodeCount = ( uint64_t ) _sChain.getNodeCount();
+            uint64_t startIndex;
+
+            do {
+                uint64_t random;
+                getrandom( &random, sizeof( random ), 0 );
+                startIndex = random % nodeCount + 1;
+            } while ( startIndex == ( uint64_t ) _sChain.getSchainIndex() );
+
+            destinationSchainIndex = schain_index( startIndex );
+
+            syncExecutor =
+                make_shared< TaskExecutor >( "CatchupClient", BlockingIOPool::getShared() );
+            scheduleSync( getNode()->getCatchupIntervalMs() );
         }
 
         for (int i = 0; i < _sChain.getNodeCount(); i++) {
@@ -88,6 +104,8 @@ nlohmann::json CatchupClientAgent::readCatchupResponseHeader(
     auto catchupDownloadStartTimeMs = Time::getCurrentTimeMs();
 
     auto requestHeader = make_shared< CatchupRequestHeader >( *sChain, _dstIndex );
+    requestHeader->setCompressionLevel(
+        getSchain()->getCompressionPolicy()->getLevel( _dstIndex ) );
     CHECK_STATE( _dstIndex != ( uint64_t ) getSchain()->getSchainIndex() )
 
     if ( getSchain()->getDeathTimeMs( ( uint64_t ) _dstIndex ) + NODE_DEATH_INTERVAL_MS >
@@ -101,16 +119,7 @@ nlohmann::json CatchupClientAgent::readCatchupResponseHeader(
     CHECK_STATE( io )
 
     try {
-        io->writeMagic( socket );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested( NetworkProtocolException(
-            "Catchupc: Server disconnect sending magic", __CLASS_NAME__ ) );
-    }
-
-    try {
-        io->writeHeader( socket, requestHeader );
+        io->writeMagicAndHeader( socket, requestHeader );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -161,7 +170,7 @@ nlohmann::json CatchupClientAgent::readCatchupResponseHeader(
     lastStartingBlock = getSchain()->getLastCommittedBlockID();
 
     try {
-        blocks = readMissingBlocks( socket, response, requestHeader );
+        blocks = readMissingBlocks( socket, response, requestHeader, _dstIndex );
 
         CHECK_STATE( blocks )
     } catch ( ExitRequestedException& ) {
@@ -235,7 +244,8 @@ size_t CatchupClientAgent::parseBlockSizes( nlohmann::json _responseHeader,
 
 
 ptr< CommittedBlockList > CatchupClientAgent::readMissingBlocks( ptr< ClientSocket >& _socket,
-    nlohmann::json& _responseHeader, ptr< CatchupRequestHeader > _requestHeader ) {
+    nlohmann::json& _responseHeader, ptr< CatchupRequestHeader > _requestHeader,
+    schain_index _dstIndex ) {
     CHECK_ARGUMENT( _responseHeader > 0 )
     CHECK_ARGUMENT( _socket )
     CHECK_ARGUMENT( _requestHeader )
@@ -247,8 +257,11 @@ ptr< CommittedBlockList > CatchupClientAgent::readMissingBlocks( ptr< ClientSock
     auto serializedBlocks = make_shared< vector< uint8_t > >( totalSize );
 
     try {
-        getSchain()->getIo()->readBytes(
-            _socket->getDescriptor(), serializedBlocks, msg_len( totalSize ), 30 );
+        auto readStartTimeMs = Time::getCurrentTimeMs();
+        auto wireBytes = getSchain()->getIo()->readPossiblyCompressedBytes(
+            _socket->getDescriptor(), serializedBlocks, msg_len( totalSize ), _responseHeader, 30 );
+        getSchain()->getCompressionPolicy()->recordDownload(
+            _dstIndex, wireBytes, totalSize, Time::getCurrentTimeMs() - readStartTimeMs );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -283,61 +296,68 @@ ptr< CommittedBlockList > CatchupClientAgent::readMissingBlocks( ptr< ClientSock
 }
 
 
-void CatchupClientAgent::workerThreadItemSendLoop( CatchupClientAgent* _agent ) {
-    setThreadName( "CatchupClient", _agent->getNode()->getConsensusEngine() );
+CatchupClientAgent::~CatchupClientAgent() {
+    uint64_t timerId;
 
-    CHECK_ARGUMENT( _agent )
+    {
+        lock_guard< mutex > lock( syncTimerLock );
+        stopped = true;
+        timerId = syncTimerId;
+    }
 
-    _agent->waitOnGlobalStartBarrier();
+    if ( timerId != 0 )
+        TimerWheel::getShared().cancel( timerId );
 
-    // wait until the schain state is fully initialized
-    // otherwise the chain can not accept catchup blocks
-    while ( !_agent->getSchain()->getIsStateInitialized() ) {
-        usleep( 100 * 1000 );
-    }
+    // waits for a running sync
+    syncExecutor = nullptr;
+}
 
 
-    // start with a random index and then to round-robin
+void CatchupClientAgent::scheduleSync( uint64_t _delayMs ) {
+    lock_guard< mutex > lock( syncTimerLock );
 
+    if ( stopped )
+        return;
 
-    auto nodeCount = ( uint64_t ) _agent->getSchain()->getNodeCount();
-    auto selfIndex = _agent->getSchain()->getSchainIndex();
+    // timer callbacks must not block, so the callback only submits the sync
+    syncTimerId = TimerWheel::getShared().schedule( Time::getCurrentTimeMs() + _delayMs,
+        [this]() { syncExecutor->submit( [this]() { syncWithNextNode(); } ); } );
+}
 
-    uint64_t startIndex;
 
-    auto lastBlockCount = 0;
+void CatchupClientAgent::syncWithNextNode() {
+    waitOnGlobalStartBarrier();
 
-    do {
-        uint64_t random;
-        getrandom( &random, sizeof( random ), 0 );
-        startIndex = random % nodeCount + 1;
-    } while ( startIndex == ( uint64_t ) selfIndex );
+    if ( getNode()->isExitRequested() )
+        return;
 
-    auto destinationSchainIndex = schain_index( startIndex );
+    // wait until the schain state is fully initialized
+    // otherwise the chain can not accept catchup blocks
+    if ( !getSchain()->getIsStateInitialized() ) {
+        scheduleSync( 100 );
+        return;
+    }
 
-    try {
-        while ( !_agent->getSchain()->getNode()->isExitRequested() ) {
-            // sleep if previous iteration did not result in blocks
-            if ( lastBlockCount == 0 )
-                std::this_thread::sleep_for(
-                    std::chrono::milliseconds( _agent->getNode()->getCatchupIntervalMs() ) );
-
-            try {
-                lastBlockCount = _agent->sync( destinationSchainIndex );
-            } catch ( ExitRequestedException& ) {
-                return;
-            } catch ( ConnectionRefusedException& e ) {
-                _agent->logConnectionRefused( e, destinationSchainIndex );
-            } catch ( exception& e ) {
-                SkaleException::logNested( e );
-            }
+    uint64_t blockCount = 0;
 
-            destinationSchainIndex = nextSyncNodeIndex( _agent, destinationSchainIndex );
-        }
+    try {
+        blockCount = sync( destinationSchainIndex );
+    } catch ( ExitRequestedException& ) {
+        return;
+    } catch ( ConnectionRefusedException& e ) {
+        logConnectionRefused( e, destinationSchainIndex );
     } catch ( FatalError& e ) {
         SkaleException::logNested( e );
-        _agent->getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
+        getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
+        return;
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
     }
+
+    destinationSchainIndex = nextSyncNodeIndex( this, destinationSchainIndex );
+
+    // sync again right away if the previous sync brought blocks
+    scheduleSync( blockCount > 0 ? 0 : getNode()->getCatchupIntervalMs() );
 }
 
 schain_index CatchupClientAgent::nextSyncNodeIndex(
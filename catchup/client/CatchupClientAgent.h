@@ -29,7 +29,7 @@ class ClientSocket;
 
 class Schain;
 
-class CatchupClientThreadPool;
+class TaskExecutor;
 
 class CatchupRequestHeader;
 
@@ -40,7 +40,23 @@ class PeerStateInfo;
 
 class CatchupClientAgent : public Agent {
 
-    ptr<CatchupClientThreadPool> catchupClientThreadPool = nullptr;
+    // runs one sync at a time. The next sync is started by a timer, so that no thread
+    // waits between syncs
+    ptr<TaskExecutor> syncExecutor = nullptr;
+
+    mutex syncTimerLock;
+
+    // the fields below are protected by syncTimerLock
+    uint64_t syncTimerId = 0;
+    bool stopped = false;
+
+    // the node to sync with next, only used by the sync task
+    schain_index destinationSchainIndex;
+
+    void scheduleSync(uint64_t _delayMs);
+
+    // syncs with the next node and schedules the next sync
+    void syncWithNextNode();
 
     // vector of information on the state of peer nodes
     vector<ptr<PeerStateInfo>> peerStateInfos;
@@ -52,9 +68,9 @@ class CatchupClientAgent : public Agent {
 public:
     explicit CatchupClientAgent(Schain &_sChain);
 
-    [[nodiscard]] uint64_t sync(schain_index _dstIndex);
+    ~CatchupClientAgent() override;
 
-    static void workerThreadItemSendLoop(CatchupClientAgent *_agent);
+    [[nodiscard]] uint64_t sync(schain_index _dstIndex);
 
     [[nodiscard]] nlohmann::json readCatchupResponseHeader(
             const ptr<ClientSocket> &_socket, ptr<CatchupRequestHeader> _requestHeader);
@@ -62,7 +78,8 @@ public:
 
     [[nodiscard]] ptr<CommittedBlockList> readMissingBlocks(ptr<ClientSocket> &_socket,
                                                             nlohmann::json &_responseHeader,
-                                                            ptr<CatchupRequestHeader> _requestHeader);
+                                                            ptr<CatchupRequestHeader> _requestHeader,
+                                                            schain_index _dstIndex);
 
 
     [[nodiscard]] size_t parseBlockSizes(nlohmann::json _responseHeader,
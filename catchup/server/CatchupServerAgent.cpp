@@ -37,6 +37,7 @@
 
 
 #include "db/BlockDB.h"
+#include "db/BlockSegmentStore.h"
 #include "db/DAProofDB.h"
 
 #include "abstracttcpserver/ConnectionStatus.h"
@@ -54,6 +55,7 @@
 #include "headers/BlockProposalHeader.h"
 #include "headers/CatchupRequestHeader.h"
 #include "headers/CatchupResponseHeader.h"
+#include "network/Compression.h"
 #include "network/IO.h"
 #include "network/Network.h"
 #include "network/ServerConnection.h"
@@ -82,22 +84,12 @@ void CatchupServerAgent::processNextAvailableConnection(
 
     CHECK_ARGUMENT( _connection );
 
-    try {
-        sChain->getIo()->readMagic( _connection->getDescriptor() );
-    } catch ( PingException& ) {
-        throw;
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested( NetworkProtocolException( "Incorrect magic number", __CLASS_NAME__ ) );
-    }
-
-
+    // magic number and request header have already been read by the reactor
     nlohmann::json jsonRequest = nullptr;
 
     try {
-        jsonRequest = sChain->getIo()->readJsonHeader(
-                _connection->getDescriptor(), "Read catchup request", 10, _connection->getIP() );
+        jsonRequest = IO::parseJsonHeader(
+                _connection->getRequestHeader(), "Read catchup request", _connection->getIP() );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -120,10 +112,11 @@ void CatchupServerAgent::processNextAvailableConnection(
     }
 
     ptr< vector< uint8_t > > serializedBinary = nullptr;
+    ptr< vector< SegmentView > > blockViews = nullptr;
 
     try {
-        serializedBinary =
-                this->createResponseHeaderAndBinary( _connection, jsonRequest, responseHeader );
+        serializedBinary = this->createResponseHeaderAndBinary(
+                _connection, jsonRequest, responseHeader, blockViews );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -140,26 +133,39 @@ void CatchupServerAgent::processNextAvailableConnection(
     }
 
 
-    try {
-        send( _connection, responseHeader );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested(
-                CouldNotSendMessageException( "Could not send response", __CLASS_NAME__ ) );
-    }
-
+    if ( serializedBinary == nullptr && blockViews == nullptr ) {
+        try {
+            send( _connection, responseHeader );
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( ... ) {
+            throw_with_nested(
+                    CouldNotSendMessageException( "Could not send response", __CLASS_NAME__ ) );
+        }
 
-    LOG( debug, "Server step 2: sent catchup response header" );
+        LOG( debug, "Server step 3: response completed: no blocks sent" );
+        return;
+    }
 
+    auto level = getCompressionLevel( jsonRequest, serializedBinary, blockViews );
 
-    if ( serializedBinary == nullptr ) {
-        LOG( debug, "Server step 3: response completed: no blocks sent" );
+    if ( level > 0 ) {
+        sendCompressedResponse(
+                _connection, jsonRequest, responseHeader, serializedBinary, blockViews, level );
         return;
     }
 
+    // header and blocks go out in a single scatter/gather write, which the reactor
+    // runs without holding a worker thread while a slow peer drains its socket
+    ptr< void > buffers;
+    vector< iovec > iovecs;
+
     try {
-        getSchain()->getIo()->writeBytesVector( _connection->getDescriptor(), serializedBinary );
+        if ( blockViews ) {
+            iovecs = IO::makeSegmentViewIOVecs( blockViews, responseHeader, buffers );
+        } else {
+            iovecs = IO::makeHeaderAndBytesIOVecs( responseHeader, serializedBinary, buffers );
+        }
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -167,15 +173,150 @@ void CatchupServerAgent::processNextAvailableConnection(
                 CouldNotSendMessageException( "Could not send serialized binary", __CLASS_NAME__ ) );
     }
 
-    LOG( debug, "Server step 3: response completed: blocks sent" );
+    auto ip = _connection->getIP();
 
-    return;
+    writeAsync(
+            _connection, std::move( iovecs ), buffers,
+            []() { LOG( debug, "Server step 3: response completed: blocks sent" ); },
+            [ip]() { LOG( debug, "Could not send catchup response to:" << ip ); } );
+}
+
+
+uint64_t CatchupServerAgent::getCompressionLevel( nlohmann::json& _jsonRequest,
+        const ptr< vector< uint8_t > >& _serializedBinary,
+        const ptr< vector< SegmentView > >& _blockViews ) {
+    // clients that do not support compression do not send the level
+    if ( _jsonRequest.count( "cmp" ) == 0 )
+        return 0;
+
+    // the brackets of the JSON array are added to the views on the wire
+    uint64_t payloadSize = 2;
+
+    if ( _blockViews ) {
+        for ( auto&& view : *_blockViews ) {
+            payloadSize += view.getSize();
+        }
+    } else {
+        CHECK_STATE( _serializedBinary );
+        payloadSize = _serializedBinary->size();
+    }
+
+    if ( payloadSize < Compression::MIN_COMPRESSED_PAYLOAD_SIZE )
+        return 0;
+
+    return min< uint64_t >(
+            Header::getUint64( _jsonRequest, "cmp" ), ( uint64_t ) Compression::MAX_LEVEL );
+}
+
+
+void CatchupServerAgent::sendCompressedResponse( const ptr< ServerConnection >& _connection,
+        nlohmann::json& _jsonRequest, const ptr< Header >& _responseHeader,
+        const ptr< vector< uint8_t > >& _serializedBinary,
+        const ptr< vector< SegmentView > >& _blockViews, uint64_t _level ) {
+    CHECK_ARGUMENT( _connection );
+    CHECK_ARGUMENT( _responseHeader );
+
+    auto response = make_shared< CompressedResponse >();
+    response->connection = _connection;
+    response->serializedBinary = _serializedBinary;
+    response->blockViews = _blockViews;
+    response->level = _level;
+
+    auto blockDB = getSchain()->getNode()->getBlockDB();
+
+    ptr< vector< uint8_t > > firstBytes = nullptr;
+
+    if ( auto catchupHeader = dynamic_pointer_cast< CatchupResponseHeader >( _responseHeader ) ) {
+        catchupHeader->setCompressionLevel( _level );
+        response->firstBlock = Header::getUint64( _jsonRequest, "blockID" ) + 1;
+        response->lastBlock = response->firstBlock + catchupHeader->getBlockCount() - 1;
+        // peers that lag by the same number of blocks ask for the same range, the whole
+        // cached response goes out in one write
+        firstBytes = blockDB->getCompressedBlockRange(
+                response->firstBlock, response->lastBlock, _level );
+        if ( !firstBytes )
+            response->sentFrames = make_shared< vector< uint8_t > >();
+    } else {
+        auto finalizeHeader =
+                dynamic_pointer_cast< BlockFinalizeResponseHeader >( _responseHeader );
+        CHECK_STATE( finalizeHeader );
+        finalizeHeader->setCompressionLevel( _level );
+    }
+
+    if ( !firstBytes ) {
+        static const uint8_t openBracket = '[';
+        static const uint8_t closeBracket = ']';
+
+        vector< pair< const uint8_t*, uint64_t > > chunks;
+
+        if ( _blockViews ) {
+            chunks.reserve( _blockViews->size() + 2 );
+            chunks.emplace_back( &openBracket, 1 );
+            for ( auto&& view : *_blockViews ) {
+                chunks.emplace_back( view.getData(), view.getSize() );
+            }
+            chunks.emplace_back( &closeBracket, 1 );
+        } else {
+            CHECK_STATE( _serializedBinary );
+            chunks.emplace_back( _serializedBinary->data(), _serializedBinary->size() );
+        }
+
+        response->compressor =
+                make_shared< Compression::FrameCompressor >( std::move( chunks ), ( int ) _level );
+
+        // the first frame goes out with the header
+        firstBytes = takeCompressedFrame( response );
+    }
+
+    ptr< void > buffers;
+    auto iovecs = IO::makeHeaderAndBytesIOVecs( _responseHeader, firstBytes, buffers );
+
+    writeAsync( _connection, std::move( iovecs ), buffers,
+            [this, response]() { compressedFrameSent( response ); },
+            compressedTransferFailed( response ) );
+}
+
+
+ptr< vector< uint8_t > > CatchupServerAgent::takeCompressedFrame(
+        const ptr< CompressedResponse >& _response ) {
+    auto frame = _response->compressor->nextFrame();
+
+    if ( _response->sentFrames )
+        _response->sentFrames->insert( _response->sentFrames->end(), frame->begin(), frame->end() );
+
+    return frame;
+}
+
+
+void CatchupServerAgent::compressedFrameSent( const ptr< CompressedResponse >& _response ) {
+    if ( !_response->compressor || _response->compressor->isFinished() ) {
+        if ( _response->sentFrames ) {
+            getSchain()->getNode()->getBlockDB()->putCompressedBlockRange( _response->firstBlock,
+                    _response->lastBlock, _response->level, _response->sentFrames );
+        }
+        LOG( debug, "Server step 3: response completed: compressed blocks sent" );
+        return;
+    }
+
+    // the next frame is compressed while the previous one drains from the socket buffer
+    auto frame = takeCompressedFrame( _response );
+
+    writeAsync( _response->connection, { { frame->data(), frame->size() } }, frame,
+            [this, _response]() { compressedFrameSent( _response ); },
+            compressedTransferFailed( _response ) );
+}
+
+
+function< void() > CatchupServerAgent::compressedTransferFailed(
+        const ptr< CompressedResponse >& _response ) {
+    auto ip = _response->connection->getIP();
+    return [ip]() { LOG( debug, "Could not send compressed catchup response to:" << ip ); };
 }
 
 
 ptr< vector< uint8_t > > CatchupServerAgent::createResponseHeaderAndBinary(
         const ptr< ServerConnection >& _connection, nlohmann::json _jsonRequest,
-        const ptr< Header >& _responseHeader ) {
+        const ptr< Header >& _responseHeader, ptr< vector< SegmentView > >& _blockViews ) {
     CHECK_ARGUMENT( _responseHeader );
 
     try {
@@ -198,7 +339,8 @@ ptr< vector< uint8_t > > CatchupServerAgent::createResponseHeaderAndBinary(
 
         if ( type.compare( Header::BLOCK_CATCHUP_REQ ) == 0 ) {
             serializedBinary = createBlockCatchupResponse( _connection, _jsonRequest,
-                                                           dynamic_pointer_cast< CatchupResponseHeader >( _responseHeader ), blockID );
+                                                           dynamic_pointer_cast< CatchupResponseHeader >( _responseHeader ), blockID,
+                                                           _blockViews );
 
         } else if ( type.compare( Header::BLOCK_FINALIZE_REQ ) == 0 ) {
             ptr< NodeInfo > nmi = sChain->getNode()->getNodeInfoById( nodeID );
@@ -228,7 +370,8 @@ ptr< vector< uint8_t > > CatchupServerAgent::createResponseHeaderAndBinary(
 
 ptr< vector< uint8_t > > CatchupServerAgent::createBlockCatchupResponse(
         const ptr< ServerConnection >& _connectionEnvelope, nlohmann::json /*_jsonRequest */,
-        const ptr< CatchupResponseHeader >& _responseHeader, block_id _blockID ) {
+        const ptr< CatchupResponseHeader >& _responseHeader, block_id _blockID,
+        ptr< vector< SegmentView > >& _blockViews ) {
     CHECK_ARGUMENT( _responseHeader );
 
     MONITOR( __CLASS_NAME__, __FUNCTION__ );
@@ -257,14 +400,23 @@ ptr< vector< uint8_t > > CatchupServerAgent::createBlockCatchupResponse(
         }
 
 
-        auto serializedBlocks =
-                getSchain()->getNode()->getBlockDB()->getSerializedBlocksFromLevelDB(
-                        ( uint64_t ) _blockID + 1, lastCommittedBlockID, blockSizes );
+        auto blockDB = getSchain()->getNode()->getBlockDB();
+
+        // serve from the mapped segment store if it has the range, otherwise from LevelDB
+        ptr< vector< uint8_t > > serializedBlocks = nullptr;
+
+        _blockViews = blockDB->getSerializedBlockViews(
+                ( uint64_t ) _blockID + 1, lastCommittedBlockID, blockSizes );
+
+        if ( _blockViews == nullptr ) {
+            serializedBlocks = blockDB->getSerializedBlocksFromLevelDB(
+                    ( uint64_t ) _blockID + 1, lastCommittedBlockID, blockSizes );
+        }
 
         CHECK_STATE( blockSizes->size() > 0 );
 
 
-        if ( serializedBlocks == nullptr ) {
+        if ( serializedBlocks == nullptr && _blockViews == nullptr ) {
             _responseHeader->setStatusSubStatus(
                     CONNECTION_DISCONNECT, CONNECTION_CATCHUP_DONT_HAVE_THIS_BLOCK );
             _responseHeader->setComplete();
@@ -35,23 +35,44 @@
 
 #include "Agent.h"
 #include "CatchupWorkerThreadPool.h"
+#include "CompressedResponse.h"
 
 class CommittedBlock;
 class CommittedBlockList;
 class CatchupResponseHeader;
 class BlockFinalizeResponseHeader;
+class SegmentView;
 
 class CatchupServerAgent : public AbstractServerAgent {
     ptr< CatchupWorkerThreadPool > catchupWorkerThreadPool;
 
+    // if the blocks are served from the segment store, returns nullptr and sets _blockViews
     ptr< vector< uint8_t > > createBlockCatchupResponse( const ptr< ServerConnection >& _connectionEnvelope,
         nlohmann::json _jsonRequest, const ptr< CatchupResponseHeader >& _responseHeader,
-        block_id _blockID );
+        block_id _blockID, ptr< vector< SegmentView > >& _blockViews );
 
 
     ptr< vector< uint8_t > > createBlockFinalizeResponse( nlohmann::json _jsonRequest,
         const ptr< BlockFinalizeResponseHeader >& _responseHeader, block_id _blockID );
 
+    // compression level for the response, 0 if the client did not ask for compression or
+    // the payload is too small
+    static uint64_t getCompressionLevel( nlohmann::json& _jsonRequest,
+        const ptr< vector< uint8_t > >& _serializedBinary,
+        const ptr< vector< SegmentView > >& _blockViews );
+
+    // sends the header with the first frame, then the remaining frames as they are compressed.
+    // Catchup responses are served from the block cache if they were compressed before
+    void sendCompressedResponse( const ptr< ServerConnection >& _connection,
+        nlohmann::json& _jsonRequest, const ptr< Header >& _responseHeader,
+        const ptr< vector< uint8_t > >& _serializedBinary,
+        const ptr< vector< SegmentView > >& _blockViews, uint64_t _level );
+
+    ptr< vector< uint8_t > > takeCompressedFrame( const ptr< CompressedResponse >& _response );
+
+    void compressedFrameSent( const ptr< CompressedResponse >& _response );
+
+    function< void() > compressedTransferFailed( const ptr< CompressedResponse >& _response );
 
 public:
     CatchupServerAgent( Schain& _schain, const ptr< TCPServerSocket >& _s );
@@ -60,7 +81,7 @@ public:
 
     ptr< vector< uint8_t > > createResponseHeaderAndBinary(
         const ptr< ServerConnection >& _connectionEnvelope, nlohmann::json _jsonRequest,
-        const ptr< Header >& _responseHeader );
+        const ptr< Header >& _responseHeader, ptr< vector< SegmentView > >& _blockViews );
 
     void processNextAvailableConnection( const ptr< ServerConnection >& _connection ) override;
 };
@@ -0,0 +1,52 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file CompressedResponse.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "network/Compression.h"
+
+class ServerConnection;
+class SegmentView;
+
+// the state of a compressed catchup or finalize response between the frames that the server
+// agent compresses on worker threads, while the reactor sends the previous frame
+struct CompressedResponse {
+    ptr< ServerConnection > connection;
+
+    // the uncompressed payload, which the compressor reads
+    ptr< vector< uint8_t > > serializedBinary;
+
+    ptr< vector< SegmentView > > blockViews;
+
+    ptr< Compression::FrameCompressor > compressor;
+
+    uint64_t level = 0;
+
+    // frames sent so far, cached once the response is complete. nullptr if the response
+    // is not cached
+    ptr< vector< uint8_t > > sentFrames;
+
+    uint64_t firstBlock = 0;
+
+    uint64_t lastBlock = 0;
+};
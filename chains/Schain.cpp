@@ -41,6 +41,7 @@
 #include "exceptions/InvalidStateException.h"
 #include "headers/BlockProposalRequestHeader.h"
 #include "network/Network.h"
+#include "network/OutgoingMsgArena.h"
 #include "network/Utils.h"
 #include "node/ConsensusEngine.h"
 #include "node/Node.h"
@@ -86,6 +87,7 @@
 #include "monitoring/StuckDetectionAgent.h"
 #include "monitoring/OptimizerAgent.h"
 #include "network/ClientSocket.h"
+#include "network/CompressionPolicy.h"
 #include "network/IO.h"
 #include "network/Sockets.h"
 #include "network/ZMQSockets.h"
@@ -94,14 +96,18 @@
 #include "oracle/OracleMessageThreadPool.h"
 #include "oracle/OracleResultAssemblyAgent.h"
 #include "oracle/OracleServerAgent.h"
-#include "oracle/OracleThreadPool.h"
 #include "pricing/PricingAgent.h"
+#include "datastructures/BlockValueRing.h"
 #include "protocols/ProtocolInstance.h"
 #include "protocols/blockconsensus/BlockConsensusAgent.h"
+#include "protocols/blockconsensus/MessageReplayer.h"
+#include "protocols/blockconsensus/MessageTrace.h"
 
 
 #include "Schain.h"
 #include "SchainMessageThreadPool.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
 #include "SchainTest.h"
 #include "TestConfig.h"
 #include "crypto/CryptoManager.h"
@@ -113,6 +119,8 @@
 #include "libBLS/bls/BLSPrivateKeyShare.h"
 #include "monitoring/LivelinessMonitor.h"
 #include "monitoring/TimeoutAgent.h"
+#include "crypto/SessionKeyAgent.h"
+#include "pendingqueue/AdaptiveBlockAssembler.h"
 #include "pendingqueue/TestMessageGeneratorAgent.h"
 
 template < class M >
@@ -199,6 +207,9 @@ void Schain::messageThreadProcessingLoop( Schain* _sChain ) {
                 CHECK_STATE( ( uint64_t ) m->getMessage()->getBlockId() != 0 );
 
                 try {
+                    if ( _sChain->messageTrace )
+                        _sChain->messageTrace->recordMessage( m );
+
                     _sChain->getBlockConsensusInstance()->routeAndProcessMessage( m );
 
                 } catch ( exception& e ) {
@@ -224,6 +235,8 @@ void Schain::startThreads() {
     }
     CHECK_STATE( consensusMessageThreadPool )
     this->consensusMessageThreadPool->startService();
+    finalizeDownloadExecutor =
+        make_shared< TaskExecutor >( "BlckFinLoop", BlockingIOPool::getShared() );
 }
 
 const string& Schain::getSchainName() const {
@@ -241,9 +254,12 @@ Schain::Schain( weak_ptr< Node > _node, schain_index _schainIndex, const schain_
       consensusMessageThreadPool( new SchainMessageThreadPool( this ) ),
       node( _node ),
       schainIndex( _schainIndex ) {
+    createdTimeMs = Time::getCurrentTimeMs();
     lastCommittedBlockTimeStamp = TimeStamp( 0, 0 );
     setTimeStampValuesFromConfig();
 
+    recentRandoms = make_shared< BlockValueRing >( RECENT_BLOCK_VALUES );
+
     // construct monitoring, timeout and stuck detection agents early
     monitoringAgent = make_shared< MonitoringAgent >( *this );
     if ( !getNode()->isSyncOnlyNode() ) {
@@ -282,8 +298,16 @@ Schain::Schain( weak_ptr< Node > _node, schain_index _schainIndex, const schain_
 
         CHECK_STATE( getNodeCount() > 0 );
 
+        compressionPolicy = make_shared< CompressionPolicy >( ( uint64_t ) getNodeCount() );
+
         constructChildAgents();
 
+        if ( getNode()->isRecordMessageTrace() ) {
+            messageTrace = make_shared< MessageTrace >(
+                getNode()->getConsensusEngine()->getDbDir() + "/message_trace_" +
+                to_string( getNode()->getNodeID() ) + ".log" );
+        }
+
         startStatusServer();
 
         string none = SchainTest::NONE;
@@ -316,6 +340,9 @@ void Schain::constructChildAgents() {
             return;
         }
 
+        if ( getNode()->isSgxEnabled() )
+            sessionKeyAgent = make_shared< SessionKeyAgent >( *this );
+
         pendingTransactionsAgent = make_shared< PendingTransactionsAgent >( *this );
         blockProposalClient = make_shared< BlockProposalClientAgent >( *this );
 
@@ -545,6 +572,13 @@ void Schain::proposeNextBlock( bool _isCalledAfterCatchup ) {
         CHECK_STATE( myProposal->getProposerIndex() == getSchainIndex() );
         CHECK_STATE( myProposal->getSignature() != "" );
 
+        uint64_t noDelay = 0;
+        if ( firstProposalDelayMs.compare_exchange_strong(
+                 noDelay, max( Time::getCurrentTimeMs() - createdTimeMs, ( uint64_t ) 1 ) ) ) {
+            LOG( info, "First proposal " << firstProposalDelayMs << " ms after start, databases "
+                                         << getNode()->getDBOpenTimeMs() << " ms" );
+        }
+
 
         proposedBlockArrived( myProposal );
 
@@ -646,11 +680,19 @@ void Schain::printBlockLog( const ptr< CommittedBlock >& _block ) {
            << ":FDS:" << ConsensusEngine::getOpenDescriptors() << ":PRT:" << proposalReceiptTime
            << ":BTA:" << blockTimeAverageMs << ":BSA:" << blockSizeAverage << ":TPS:" << tpsAverage
            << ":LWT:" << CacheLevelDB::getWriteStats() << ":LRT:" << CacheLevelDB::getReadStats()
-           << ":LWC:" << CacheLevelDB::getWrites() << ":LRC:" << CacheLevelDB::getReads();
+           << ":LWC:" << CacheLevelDB::getWrites() << ":LRC:" << CacheLevelDB::getReads()
+           << ":IOS:" << IO::getStats()
+           << ":PRS:" << BlockProposalServerAgent::getProposalStats()
+           << ":PQD:" << BlockProposalServerAgent::getQueueDelayStats()
+           << ":PSK:" << BlockProposalServerAgent::getSketchStats()
+           << ":EXP:" << ExecutorPool::getAllStats()
+           << ":CMP:" << compressionPolicy->getSavedPercentage()
+           << ":SBC:" << getNode()->getBlockDB()->getBlockCacheStats();
 
 
     if ( !getNode()->isSyncOnlyNode() ) {
         output << ":KNWN:" << pendingTransactionsAgent->getKnownTransactionsSize()
+               << ":KNL:" << pendingTransactionsAgent->getKnownTransactionsLookupStats()
                << ":CONS:" << ServerConnection::getTotalObjects()
                << ":DSDS:" << getSchain()->getNode()->getNetwork()->computeTotalDelayedSends()
                << ":SET:" << CryptoManager::getEcdsaStats()
@@ -658,6 +700,9 @@ void Schain::printBlockLog( const ptr< CommittedBlock >& _block ) {
                << ":SEC:" << CryptoManager::getECDSATotals()
                << ":SBC:" << CryptoManager::getBLSTotals()
                << ":ZSC:" << getCryptoManager()->getZMQSocketCount()
+               << ":SKS:" << getCryptoManager()->getSessionKeyStats()
+               << ":RBV:" << pricingAgent->getStats() << "/" << recentRandoms->getStats()
+               << ":ORC:" << ( oracleServer ? oracleServer->getStats() : "" )
                << ":EPT:" << lastCommittedBlockEvmProcessingTimeMs;
     }
 
@@ -675,6 +720,8 @@ void Schain::printBlockLog( const ptr< CommittedBlock >& _block ) {
         output << ":PROPS:" << getNode()->getBlockProposalDB()->getMemoryUsed();
         output << ":DAPS:" << getNode()->getDaProofDB()->getMemoryUsed();
         output << ":OMS:" << getNode()->getOutgoingMsgDB()->getMemoryUsed();
+        if ( !getNode()->isSyncOnlyNode() )
+            output << ":OMA:" << getNode()->getNetwork()->getOutgoingMessages()->getStats();
         output << ":PHS:" << getNode()->getProposalHashDB()->getMemoryUsed();
         output << ":PVS:" << getNode()->getProposalVectorDB()->getMemoryUsed();
         output << ":BSS:" << getNode()->getBlockSigShareDB()->getMemoryUsed();
@@ -736,6 +783,23 @@ void Schain::processCommittedBlock( const ptr< CommittedBlock >& _block ) {
         updateLastCommittedBlockInfo( ( uint64_t ) _block->getBlockID(), stamp,
             _block->getTransactionList()->size(), evmProcessingTimeMs );
 
+        if ( messageTrace )
+            messageTrace->recordCommit( _block->getBlockID(), _block->getProposerIndex(), stamp );
+
+        if ( sessionKeyAgent )
+            sessionKeyAgent->blockCommitted();
+
+        if ( !getNode()->isSyncOnlyNode() )
+            getNode()->getNetwork()->getOutgoingMessages()->blockCommitted( _block->getBlockID() );
+
+        if ( pendingTransactionsAgent && pendingTransactionsAgent->getBlockAssembler() ) {
+            uint64_t bytes = 0;
+            for ( auto&& transaction : *_block->getTransactionList()->getItems() )
+                bytes += transaction->getData()->size();
+            pendingTransactionsAgent->getBlockAssembler()->blockCommitted(
+                _block->getTransactionList()->size(), bytes, evmProcessingTimeMs );
+        }
+
         // the last thing is to run analyzers to log any errors that happened during
         // block processing
 
@@ -1054,6 +1118,11 @@ void Schain::bootstrap( block_id _lastCommittedBlockID, uint64_t _lastCommittedB
         TimeStamp stamp( _lastCommittedBlockTimeStamp, _lastCommittedBlockTimeStampMs );
         initLastCommittedBlockInfo( ( uint64_t ) _lastCommittedBlockID, stamp );
 
+        if ( messageTrace ) {
+            messageTrace->start( getNode()->getNodeID(), getSchainIndex(), getNodeCount(),
+                _lastCommittedBlockID, stamp );
+        }
+
 
         LOG( info, "Jump starting the system with block:" << to_string( _lastCommittedBlockID ) );
 
@@ -1066,6 +1135,8 @@ void Schain::bootstrap( block_id _lastCommittedBlockID, uint64_t _lastCommittedB
         if ( getNode()->isSyncOnlyNode() )
             return;
 
+        getNode()->getNetwork()->getOutgoingMessages()->blockCommitted( _lastCommittedBlockID );
+
         {
             lock_guard< timed_mutex > lock( ( blockProcessMutex ) );
             auto emptyBlockInterval = getNode()->getEmptyBlockIntervalMs();
@@ -1092,7 +1163,8 @@ void Schain::ifIncompleteConsensusDetectedRestartAndRebroadcastAllMessagesForCur
         startConsensus( lastCommittedBlockID + 1, proposalVector );
         LOG( info, "Incompleted consensus detected." );
 
-        auto messages = getNode()->getOutgoingMsgDB()->getMessages( lastCommittedBlockID + 1 );
+        auto messages = getNode()->getNetwork()->getOutgoingMessages()->getMessages(
+            lastCommittedBlockID + 1 );
         CHECK_STATE( messages );
         LOG( info, "Rebroadcasting " << to_string( messages->size() ) << " messages for block "
                                      << to_string( lastCommittedBlockID + 1 ) );
@@ -1103,7 +1175,8 @@ void Schain::ifIncompleteConsensusDetectedRestartAndRebroadcastAllMessagesForCur
 }
 
 void Schain::rebroadcastAllMessagesForCurrentBlock() {
-    auto messages = getNode()->getOutgoingMsgDB()->getMessages( lastCommittedBlockID + 1 );
+    auto messages =
+        getNode()->getNetwork()->getOutgoingMessages()->getMessages( lastCommittedBlockID + 1 );
     CHECK_STATE( messages );
     LOG( info, "Rebroadcasting " << to_string( messages->size() ) << " messages for block "
                                  << to_string( lastCommittedBlockID + 1 ) );
@@ -1257,6 +1330,12 @@ void Schain::finalizeDecidedAndSignedBlock( block_id _blockId, schain_index _pro
         return;
     }
 
+    // a replay has no proposals, it only checks the decision
+    if ( replayer ) {
+        replayer->blockDecided( _blockId, _proposerIndex, _thresholdSig );
+        return;
+    }
+
 
     try {
         if ( _proposerIndex == 0 ) {
@@ -1430,6 +1509,11 @@ void Schain::writeToVisualizationStream( string& _s ) {
 
 
 u256 Schain::getRandomForBlockId( block_id _blockId ) {
+    u256 random;
+
+    if ( recentRandoms->get( _blockId, random ) )
+        return random;
+
     auto block = getBlock( _blockId );
     CHECK_STATE( block );
     auto signature = block->getThresholdSig();
@@ -1441,7 +1525,12 @@ u256 Schain::getRandomForBlockId( block_id _blockId ) {
     }
 
     auto hash = BLAKE3Hash::calculateHash( data );
-    return u256( "0x" + hash.toHex() );
+    random = u256( "0x" + hash.toHex() );
+
+    if ( _blockId > 0 )
+        recentRandoms->put( _blockId, random );
+
+    return random;
 }
 
 ptr< ofstream > Schain::visualizationDataStream = nullptr;
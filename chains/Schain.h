@@ -44,10 +44,10 @@ class PartialHashesList;
 class DAProof;
 
 class BlockProposalClientAgent;
-class BlockProposalPusherThreadPool;
 
 class BlockFinalizeDownloader;
-class BlockFinalizeDownloaderThreadPool;
+class TaskExecutor;
+class CompressionPolicy;
 
 
 class SchainMessageThreadPool;
@@ -61,6 +61,7 @@ class CatchupServerAgent;
 class MonitoringAgent;
 class TimeoutAgent;
 class StuckDetectionAgent;
+class SessionKeyAgent;
 class OptimizerAgent;
 
 class BlockProposalServerAgent;
@@ -73,7 +74,6 @@ class PendingTransactionsAgent;
 class BlockConsensusAgent;
 
 class OracleServerAgent;
-class OracleThreadPool;
 
 class PricingAgent;
 class IO;
@@ -89,6 +89,9 @@ class CryptoManager;
 class StatusServer;
 class OracleClient;
 class OracleResultAssemblyAgent;
+class MessageTrace;
+class BlockValueRing;
+class MessageReplayer;
 
 class Schain : public Agent {
     queue< ptr< MessageEnvelope > > messageQueue;
@@ -113,6 +116,11 @@ class Schain : public Agent {
 
     uint64_t startTimeMs = 0;
 
+    uint64_t createdTimeMs = 0;
+
+    // time from the creation of the chain to its first proposal, 0 until it proposes
+    atomic< uint64_t > firstProposalDelayMs = 0;
+
     ptr< BlockProposalServerAgent > blockProposalServerAgent;
 
     ptr< CatchupServerAgent > catchupServerAgent;
@@ -122,6 +130,7 @@ class Schain : public Agent {
     ptr< TimeoutAgent > timeoutAgent;
 
     ptr< StuckDetectionAgent > stuckDetectionAgent;
+    ptr< SessionKeyAgent > sessionKeyAgent;  // only exists if SGX is enabled
 
     ptr< PendingTransactionsAgent > pendingTransactionsAgent;
 
@@ -133,6 +142,21 @@ class Schain : public Agent {
 
     ptr< SchainMessageThreadPool > consensusMessageThreadPool;
 
+    // runs fragment downloads of all block finalize downloads
+    ptr< TaskExecutor > finalizeDownloadExecutor;
+
+    // compression levels requested from peers for catchup and finalize downloads
+    ptr< CompressionPolicy > compressionPolicy;
+
+    // records the messages processed by the block consensus agent, if enabled in the config
+    ptr< MessageTrace > messageTrace;
+
+    // set while a recorded message trace is replayed
+    MessageReplayer* replayer = nullptr;
+
+    // randoms of the recent blocks, so that EVM queries do not read blocks
+    ptr< BlockValueRing > recentRandoms;
+
 
     ptr< OracleResultAssemblyAgent > oracleResultAssemblyAgent;
 
@@ -276,6 +300,8 @@ public:
 
     uint64_t getStartTimeMs() const;
 
+    uint64_t getFirstProposalDelayMs() const;
+
     void proposedBlockArrived( const ptr< BlockProposal >& _proposal );
 
     void daProofArrived( const ptr< DAProof >& _daProof );
@@ -300,6 +326,10 @@ public:
 
     ptr< PendingTransactionsAgent > getPendingTransactionsAgent() const;
 
+    ptr< TaskExecutor > getFinalizeDownloadExecutor() const;
+
+    ptr< CompressionPolicy > getCompressionPolicy() const;
+
     ptr< MonitoringAgent > getMonitoringAgent() const;
 
     schain_index getSchainIndex() const;
@@ -371,6 +401,8 @@ public:
     void stopStatusServer();
     void setLastCommittedBlockId( uint64_t lastCommittedBlockId );
 
+    void setReplayer( MessageReplayer* _replayer );
+
     block_id readLastCommittedBlockIDFromDb();
 
     void lockWithDeadLockCheck( const char* _functionName );
@@ -381,6 +413,8 @@ public:
 
     u256 getRandomForBlockId( block_id _blockid );
 
+    const ptr< PricingAgent >& getPricingAgent() const;
+
     const ptr< OracleClient > getOracleClient() const;
 
     const string& getSchainName() const;
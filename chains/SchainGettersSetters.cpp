@@ -37,6 +37,7 @@
 
 
 #include "SchainMessageThreadPool.h"
+#include "threads/TaskExecutor.h"
 #include "crypto/ConsensusBLSSigShare.h"
 #include "crypto/CryptoManager.h"
 #include "db/BlockProposalDB.h"
@@ -76,6 +77,18 @@ ptr< PendingTransactionsAgent > Schain::getPendingTransactionsAgent() const {
 }
 
 
+ptr< TaskExecutor > Schain::getFinalizeDownloadExecutor() const {
+    CHECK_STATE( finalizeDownloadExecutor )
+    return finalizeDownloadExecutor;
+}
+
+
+ptr< CompressionPolicy > Schain::getCompressionPolicy() const {
+    CHECK_STATE( compressionPolicy )
+    return compressionPolicy;
+}
+
+
 ptr< MonitoringAgent > Schain::getMonitoringAgent() const {
     CHECK_STATE( monitoringAgent )
     return monitoringAgent;
@@ -85,6 +98,10 @@ uint64_t Schain::getStartTimeMs() const {
     return startTimeMs;
 }
 
+uint64_t Schain::getFirstProposalDelayMs() const {
+    return firstProposalDelayMs;
+}
+
 block_id Schain::getLastCommittedBlockID() const {
     return lastCommittedBlockID.load();
 }
@@ -223,6 +240,10 @@ uint64_t Schain::getRequiredSigners() {
 }
 
 
+const ptr< PricingAgent >& Schain::getPricingAgent() const {
+    return pricingAgent;
+}
+
 u256 Schain::getPriceForBlockId( uint64_t _blockId ) {
     CHECK_STATE( pricingAgent );
     return pricingAgent->readPrice( _blockId );
@@ -250,7 +271,6 @@ uint64_t Schain::getMaxExternalBlockProcessingTime() const {
 
 void Schain::joinMonitorAndTimeoutThreads() {
     CHECK_STATE( monitoringAgent );
-    monitoringAgent->join();
 
     if ( getNode()->isSyncOnlyNode() )
         return;
@@ -334,6 +354,10 @@ void Schain::setLastCommittedBlockId( uint64_t _lastCommittedBlockId ) {
     lastCommittedBlockID = _lastCommittedBlockId;
 }
 
+void Schain::setReplayer( MessageReplayer* _replayer ) {
+    replayer = _replayer;
+}
+
 const ptr< OracleClient > Schain::getOracleClient() const {
     return oracleClient;
 }
@@ -162,7 +162,10 @@ string CryptoManager::getSgxBlsKeyName() {
 CryptoManager::CryptoManager( uint64_t _totalSigners, uint64_t _requiredSigners, bool _isSGXEnabled,
     string _sgxURL, string _sgxSslKeyFileFullPath, string _sgxSslCertFileFullPath,
     string _sgxEcdsaKeyName, ptr< vector< string > > _sgxEcdsaPublicKeys )
-    : sessionKeys( SESSION_KEY_CACHE_SIZE ), sessionPublicKeys( SESSION_PUBLIC_KEY_CACHE_SIZE ) {
+    : sessionKeys( SESSION_KEY_CACHE_SIZE ),
+      sessionPublicKeys( SESSION_PUBLIC_KEY_CACHE_SIZE ),
+      parsedSessionPublicKeys( PARSED_PUBLIC_KEY_CACHE_SIZE ),
+      parsedECDSAPublicKeys( PARSED_PUBLIC_KEY_CACHE_SIZE ) {
     CHECK_ARGUMENT( _totalSigners >= _requiredSigners );
 
 
@@ -229,6 +232,8 @@ pair< string, uint64_t > CryptoManager::parseSGXDomainAndPort( const string& _ur
 CryptoManager::CryptoManager( Schain& _sChain )
     : sessionKeys( SESSION_KEY_CACHE_SIZE ),
       sessionPublicKeys( SESSION_PUBLIC_KEY_CACHE_SIZE ),
+      parsedSessionPublicKeys( PARSED_PUBLIC_KEY_CACHE_SIZE ),
+      parsedECDSAPublicKeys( PARSED_PUBLIC_KEY_CACHE_SIZE ),
       sChain( &_sChain ) {
     totalSigners = getSchain()->getTotalSigners();
     requiredSigners = getSchain()->getRequiredSigners();
@@ -366,39 +371,136 @@ std::tuple< ptr< OpenSSLEdDSAKey >, string > CryptoManager::localGenerateFastKey
 }
 
 
+tuple< ptr< OpenSSLEdDSAKey >, string, string > CryptoManager::generateSessionKey(
+    block_id _blockID ) {
+    auto [privateKey, publicKey] = localGenerateFastKey();
+
+    BLAKE3Hash pKeyHash = calculatePublicKeyHash( publicKey, _blockID );
+
+    CHECK_STATE( sgxECDSAKeyName != "" );
+    auto pkSig = sgxSignECDSA( pKeyHash, sgxECDSAKeyName );
+    CHECK_STATE( pkSig != "" );
+
+    return { privateKey, publicKey, pkSig };
+}
+
+
+void CryptoManager::pregenerateSessionKey( block_id _blockID ) {
+    {
+        LOCK( sessionKeysLock );
+        if ( preparedSessionKeys.count( ( uint64_t ) _blockID ) > 0 ||
+             sessionKeys.exists( ( uint64_t ) _blockID ) )
+            return;
+    }
+
+    auto key = generateSessionKey( _blockID );
+
+    LOCK( sessionKeysLock );
+    // the block may have started while the key was certified
+    if ( !sessionKeys.exists( ( uint64_t ) _blockID ) )
+        preparedSessionKeys.emplace( ( uint64_t ) _blockID, key );
+}
+
+
+void CryptoManager::pruneSessionKeys( block_id _blockID ) {
+    LOCK( sessionKeysLock );
+    preparedSessionKeys.erase(
+        preparedSessionKeys.begin(), preparedSessionKeys.lower_bound( ( uint64_t ) _blockID ) );
+}
+
+
+string CryptoManager::getSessionKeyStats() {
+    return to_string( sessionKeyHits ) + "/" + to_string( sessionKeyMisses ) + "/" +
+           to_string( firstSessionSignDelayMs );
+}
+
+
+nlohmann::json CryptoManager::getSessionKeyStatus() {
+    auto status = nlohmann::json::object();
+
+    status["sgxEnabled"] = isSGXEnabled;
+    status["hits"] = sessionKeyHits.load();
+    status["misses"] = sessionKeyMisses.load();
+
+    {
+        LOCK( sessionKeysLock );
+        status["preparedKeys"] = preparedSessionKeys.size();
+    }
+
+    uint64_t signs = firstSessionSigns;
+    status["timeToFirstMessageMs"]["last"] = firstSessionSignDelayMs.load();
+    status["timeToFirstMessageMs"]["average"] =
+        signs > 0 ? totalFirstSessionSignDelayMs / signs : 0;
+    status["timeToFirstMessageMs"]["max"] = maxFirstSessionSignDelayMs.load();
+    status["timeToFirstMessageMs"]["blocks"] = signs;
+
+    return status;
+}
+
+
 tuple< string, string, string > CryptoManager::signSessionECDSA(
     BLAKE3Hash& _hash, block_id _blockID ) {
     ptr< OpenSSLEdDSAKey > privateKey = nullptr;
     string publicKey = "";
     string pkSig = "";
 
+    bool isFirstUse = false;
 
     {
         LOCK( sessionKeysLock );
 
-
         if ( auto result = sessionKeys.getIfExists( ( uint64_t ) _blockID ); result.has_value() ) {
             tie( privateKey, publicKey, pkSig ) =
                 any_cast< tuple< ptr< OpenSSLEdDSAKey >, string, string > >( result );
-            CHECK_STATE( privateKey );
-            CHECK_STATE( publicKey != "" );
-            CHECK_STATE( pkSig != "" );
-
-        } else {
-            tie( privateKey, publicKey ) = localGenerateFastKey();
+        } else if ( auto it = preparedSessionKeys.find( ( uint64_t ) _blockID );
+                    it != preparedSessionKeys.end() ) {
+            tie( privateKey, publicKey, pkSig ) = it->second;
+            sessionKeys.put( ( uint64_t ) _blockID, it->second );
+            preparedSessionKeys.erase( it );
+            sessionKeyHits++;
+            isFirstUse = true;
+        }
+    }
 
-            BLAKE3Hash pKeyHash = calculatePublicKeyHash( publicKey, _blockID );
+    if ( !privateKey ) {
+        // certify outside of the lock, so that signers of other blocks do not wait for SGX
+        auto key = generateSessionKey( _blockID );
+        sessionKeyMisses++;
 
-            CHECK_STATE( sgxECDSAKeyName != "" );
-            pkSig = sgxSignECDSA( pKeyHash, sgxECDSAKeyName );
-            CHECK_STATE( pkSig != "" );
+        LOCK( sessionKeysLock );
 
-            sessionKeys.put( ( uint64_t ) _blockID, { privateKey, publicKey, pkSig } );
+        // another thread may have created a key for this block meanwhile, use that one
+        if ( auto result = sessionKeys.getIfExists( ( uint64_t ) _blockID ); result.has_value() ) {
+            key = any_cast< tuple< ptr< OpenSSLEdDSAKey >, string, string > >( result );
+        } else {
+            sessionKeys.put( ( uint64_t ) _blockID, key );
+            isFirstUse = true;
         }
+
+        tie( privateKey, publicKey, pkSig ) = key;
     }
 
+    CHECK_STATE( privateKey );
+    CHECK_STATE( publicKey != "" );
+    CHECK_STATE( pkSig != "" );
+
     auto ret = privateKey->sign( ( const char* ) _hash.data() );
 
+    if ( isFirstUse && sChain && _blockID == sChain->getLastCommittedBlockID() + 1 ) {
+        auto blockStartTimeMs = max( sChain->getLastCommitTimeMs(), sChain->getStartTimeMs() );
+        auto now = Time::getCurrentTimeMs();
+        if ( blockStartTimeMs > 0 && now >= blockStartTimeMs ) {
+            auto delayMs = now - blockStartTimeMs;
+            firstSessionSignDelayMs = delayMs;
+            firstSessionSigns++;
+            totalFirstSessionSignDelayMs += delayMs;
+            auto maxMs = maxFirstSessionSignDelayMs.load();
+            while ( delayMs > maxMs &&
+                    !maxFirstSessionSignDelayMs.compare_exchange_weak( maxMs, delayMs ) ) {
+            }
+        }
+    }
+
     return { ret, publicKey, pkSig };
 }
 
@@ -455,8 +557,28 @@ string CryptoManager::sgxSignECDSA( BLAKE3Hash& _hash, string& _keyName ) {
 }
 
 
-void CryptoManager::verifyECDSA( BLAKE3Hash& _hash, const string& _sig, const string& _publicKey ) {
+ptr< OpenSSLEdDSAKey > CryptoManager::getParsedSessionPublicKey( const string& _publicKey ) {
+    if ( auto result = parsedSessionPublicKeys.getIfExists( _publicKey ); result.has_value() )
+        return any_cast< ptr< OpenSSLEdDSAKey > >( result );
+
+    auto key = OpenSSLEdDSAKey::importPubKey( _publicKey );
+    parsedSessionPublicKeys.put( _publicKey, key );
+    return key;
+}
+
+
+ptr< OpenSSLECDSAKey > CryptoManager::getParsedECDSAPublicKey( const string& _publicKey ) {
+    if ( auto result = parsedECDSAPublicKeys.getIfExists( _publicKey ); result.has_value() )
+        return any_cast< ptr< OpenSSLECDSAKey > >( result );
+
     auto key = OpenSSLECDSAKey::importSGXPubKey( _publicKey );
+    parsedECDSAPublicKeys.put( _publicKey, key );
+    return key;
+}
+
+
+void CryptoManager::verifyECDSA( BLAKE3Hash& _hash, const string& _sig, const string& _publicKey ) {
+    auto key = getParsedECDSAPublicKey( _publicKey );
 
     try {
         key->verifySGXSig( _sig, ( const char* ) _hash.data() );
@@ -544,7 +666,7 @@ void CryptoManager::verifySessionEdDSASig(
 
 
         if ( isSGXEnabled ) {
-            auto pkey = OpenSSLEdDSAKey::importPubKey( _publicKey );
+            auto pkey = getParsedSessionPublicKey( _publicKey );
             try {
                 pkey->verifySig( _sig, ( const char* ) _hash.data() );
             } catch ( ... ) {
@@ -722,11 +844,17 @@ tuple< ptr< ThresholdSigShare >, string, string, string > CryptoManager::signDAP
 
     auto h = _p->getHash();
 
-    auto sigShare = signDAProofSigShare( h, _p->getBlockID(), _p->getTimeStampS(), false );
+    return signDAProof( h, _p->getBlockID(), _p->getTimeStampS() );
+}
+
+
+tuple< ptr< ThresholdSigShare >, string, string, string > CryptoManager::signDAProof(
+    BLAKE3Hash& _hash, block_id _blockId, uint64_t _timeStampS ) {
+    auto sigShare = signDAProofSigShare( _hash, _blockId, _timeStampS, false );
     CHECK_STATE( sigShare );
 
-    auto combinedHash = BLAKE3Hash::merkleTreeMerge( _p->getHash(), sigShare->computeHash() );
-    auto [ecdsaSig, pubKey, pubKeySig] = signSession( combinedHash, _p->getBlockID() );
+    auto combinedHash = BLAKE3Hash::merkleTreeMerge( _hash, sigShare->computeHash() );
+    auto [ecdsaSig, pubKey, pubKeySig] = signSession( combinedHash, _blockId );
     return { sigShare, ecdsaSig, pubKey, pubKeySig };
 }
 
@@ -1077,6 +1205,41 @@ void CryptoManager::verifyNetworkMsg( NetworkMessage& _msg ) {
 }
 
 
+void CryptoManager::verifySessionPublicKey( const string& _publicKey, const string& _pkSig,
+    block_id _blockID, pair< node_id, node_id > _nodeId, uint64_t _timeStamp ) {
+    LOCK( publicSessionKeysLock )
+
+    if ( auto result = sessionPublicKeys.getIfExists( _pkSig ); result.has_value() ) {
+        auto publicKey2 = any_cast< string >( result );
+        CHECK_STATE( publicKey2 == _publicKey )
+    } else {
+        if ( isSGXEnabled ) {
+            auto pkeyHash = calculatePublicKeyHash( _publicKey, _blockID );
+            try {
+                verifyECDSASig( pkeyHash, _pkSig, _nodeId.first, _timeStamp );
+            } catch ( ... ) {
+                LOG( err, "PubKey ECDSA sig did not verify NODE_ID:"
+                              << to_string( ( uint64_t ) _nodeId.first )
+                              << string( ". Probably because of rotation, trying second key" ) );
+                if ( _nodeId.second != node_id( -1 ) ) {  // default value
+                    try {
+                        verifyECDSASig( pkeyHash, _pkSig, _nodeId.second, _timeStamp );
+                    } catch ( ... ) {
+                        LOG( err, "PubKey ECDSA sig did not verify NODE_ID:"
+                                      << to_string( ( uint64_t ) _nodeId.second )
+                                      << string( ". Pubkey ECDSA wasn't verified." ) );
+                        throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
+                    }
+                } else {
+                    throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
+                }
+            }
+            sessionPublicKeys.put( _pkSig, _publicKey );
+        }
+    }
+}
+
+
 void CryptoManager::verifySessionSigAndKey( BLAKE3Hash& _hash, const string& _sig,
     const string& _publicKey, const string& pkSig, block_id _blockID,
     pair< node_id, node_id > _nodeId, uint64_t _timeStamp ) {
@@ -1085,41 +1248,7 @@ void CryptoManager::verifySessionSigAndKey( BLAKE3Hash& _hash, const string& _si
 
     CHECK_STATE( !_sig.empty() );
 
-
-    {
-        LOCK( publicSessionKeysLock )
-
-        if ( auto result = sessionPublicKeys.getIfExists( pkSig ); result.has_value() ) {
-            auto publicKey2 = any_cast< string >( result );
-            CHECK_STATE( publicKey2 == _publicKey )
-        } else {
-            if ( isSGXEnabled ) {
-                auto pkeyHash = calculatePublicKeyHash( _publicKey, _blockID );
-                try {
-                    verifyECDSASig( pkeyHash, pkSig, _nodeId.first, _timeStamp );
-                } catch ( ... ) {
-                    LOG(
-                        err, "PubKey ECDSA sig did not verify NODE_ID:"
-                                 << to_string( ( uint64_t ) _nodeId.first )
-                                 << string( ". Probably because of rotation, trying second key" ) );
-                    if ( _nodeId.second != node_id( -1 ) ) {  // default value
-                        try {
-                            verifyECDSASig( pkeyHash, pkSig, _nodeId.second, _timeStamp );
-                        } catch ( ... ) {
-                            LOG( err, "PubKey ECDSA sig did not verify NODE_ID:"
-                                          << to_string( ( uint64_t ) _nodeId.second )
-                                          << string( ". Pubkey ECDSA wasn't verified." ) );
-                            throw_with_nested(
-                                InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
-                        }
-                    } else {
-                        throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
-                    }
-                }
-                sessionPublicKeys.put( pkSig, _publicKey );
-            }
-        }
-    }
+    verifySessionPublicKey( _publicKey, pkSig, _blockID, _nodeId, _timeStamp );
 
     try {
         verifySessionEdDSASig( _hash, _sig, _publicKey );
@@ -1129,6 +1258,84 @@ void CryptoManager::verifySessionSigAndKey( BLAKE3Hash& _hash, const string& _si
     }
 }
 
+
+vector< bool > CryptoManager::verifyNetworkMsgs( const vector< ptr< NetworkMessage > >& _msgs ) {
+    MONITOR( __CLASS_NAME__, __FUNCTION__ );
+
+    vector< bool > result( _msgs.size(), false );
+
+    if ( !isSGXEnabled ) {
+        // mockup signatures, nothing to batch
+        for ( uint64_t i = 0; i < _msgs.size(); i++ ) {
+            try {
+                verifyNetworkMsg( *_msgs.at( i ) );
+                result.at( i ) = true;
+            } catch ( exception& e ) {
+                SkaleException::logNested( e );
+            }
+        }
+        return result;
+    }
+
+    auto timeStamp = getSchain()->getLastCommittedBlockTimeStamp().getLinuxTimeMs();
+
+    vector< string > publicKeys( _msgs.size() );
+    vector< string > sigs( _msgs.size() );
+    vector< BLAKE3Hash > hashes( _msgs.size() );
+
+    for ( uint64_t i = 0; i < _msgs.size(); i++ ) {
+        auto& msg = *_msgs.at( i );
+        try {
+            CHECK_STATE( !msg.getECDSASig().empty() );
+            verifySessionPublicKey( msg.getPublicKey(), msg.getPkSig(), msg.getBlockID(),
+                { msg.getSrcNodeID(), node_id( -1 ) }, timeStamp );
+            hashes.at( i ) = msg.getHash();
+            sigs.at( i ) = msg.getECDSASig();
+            publicKeys.at( i ) = msg.getPublicKey();
+        } catch ( exception& e ) {
+            SkaleException::logNested( e );
+        }
+    }
+
+    return verifySessionSigsByKey( publicKeys, sigs, hashes );
+}
+
+
+vector< bool > CryptoManager::verifySessionSigsByKey( const vector< string >& _publicKeys,
+    const vector< string >& _sigs, vector< BLAKE3Hash >& _hashes ) {
+    CHECK_ARGUMENT( _sigs.size() == _publicKeys.size() );
+    CHECK_ARGUMENT( _hashes.size() == _publicKeys.size() );
+
+    vector< bool > result( _publicKeys.size(), false );
+
+    // indices of the messages by session public key. A node signs all messages of a block
+    // with one key, so a burst has few keys
+    map< string, vector< uint64_t > > messagesByKey;
+
+    for ( uint64_t i = 0; i < _publicKeys.size(); i++ ) {
+        if ( !_publicKeys.at( i ).empty() )
+            messagesByKey[_publicKeys.at( i )].push_back( i );
+    }
+
+    for ( auto&& [publicKey, indices] : messagesByKey ) {
+        vector< pair< string, const char* > > sigsAndHashes;
+
+        for ( auto i : indices ) {
+            sigsAndHashes.emplace_back( _sigs.at( i ), ( const char* ) _hashes.at( i ).data() );
+        }
+
+        try {
+            auto verified = getParsedSessionPublicKey( publicKey )->verifySigs( sigsAndHashes );
+            for ( uint64_t j = 0; j < indices.size(); j++ )
+                result.at( indices.at( j ) ) = verified.at( j );
+        } catch ( exception& e ) {
+            SkaleException::logNested( e );
+        }
+    }
+
+    return result;
+}
+
 void CryptoManager::verifyProposalECDSA(
     const ptr< BlockProposal >& _proposal, const string& _hashStr, const string& _signature ) {
     CHECK_ARGUMENT( _proposal );
@@ -1141,9 +1348,17 @@ void CryptoManager::verifyProposalECDSA(
 
     CHECK_STATE2( hash.toHex() == _hashStr, "Incorrect proposal hash" );
 
+    verifyProposalECDSA(
+        hash, _signature, _proposal->getProposerNodeID(), _proposal->getTimeStampS() );
+}
+
+
+void CryptoManager::verifyProposalECDSA(
+    BLAKE3Hash& _hash, const string& _signature, node_id _proposerNodeId, uint64_t _timeStampS ) {
+    CHECK_ARGUMENT( _signature != "" )
+
     try {
-        verifyECDSASig(
-            hash, _signature, _proposal->getProposerNodeID(), _proposal->getTimeStampS() );
+        verifyECDSASig( _hash, _signature, _proposerNodeId, _timeStampS );
     } catch ( ... ) {
         LOG( err, "verifyProposalECDSA:  ECDSA sig did not verify" );
         throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
@@ -1430,7 +1645,5 @@ void CryptoManager::checkZMQStatusIfUnknownBLS() {
 }
 
 uint64_t CryptoManager::sgxBlockProcessingTime() {
-    uint64_t retVal = sgxBlockProcessingTimeMs;
-    sgxBlockProcessingTimeMs = 0;
-    return retVal;
+    return sgxBlockProcessingTimeMs.exchange( 0 );
 }
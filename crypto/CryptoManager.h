@@ -32,6 +32,7 @@
 
 #define USER_SPACE 1
 
+#include "thirdparty/json.hpp"
 #include "thirdparty/lru_ordered_cache.hpp"
 #include "thirdparty/lrucache.hpp"
 
@@ -100,6 +101,12 @@ class CryptoManager {
     cache::lru_cache< uint64_t, tuple< ptr< OpenSSLEdDSAKey >, string, string > >
         sessionKeys;                                               // tsafe
     cache::lru_ordered_cache< string, string > sessionPublicKeys;  // tsafe
+    // keys of the next blocks, created ahead of time by the SessionKeyAgent
+    map< uint64_t, tuple< ptr< OpenSSLEdDSAKey >, string, string > > preparedSessionKeys;
+    // parsed session and SGX ECDSA public keys by their string form
+    cache::lru_cache< string, ptr< OpenSSLEdDSAKey > > parsedSessionPublicKeys;  // tsafe
+    cache::lru_cache< string, ptr< OpenSSLECDSAKey > > parsedECDSAPublicKeys;    // tsafe
+    // protects sessionKeys and preparedSessionKeys. Never held during SGX calls
     recursive_mutex sessionKeysLock;
     recursive_mutex publicSessionKeysLock;
 
@@ -157,12 +164,26 @@ class CryptoManager {
 
     uint64_t simulateBLSSigFailBlock = 0;
 
-    uint64_t sgxBlockProcessingTimeMs = 0;
+    atomic< uint64_t > sgxBlockProcessingTimeMs = 0;
+
+    // session keys that were ready on first use of a block, and keys created on first use
+    atomic< uint64_t > sessionKeyHits = 0;
+    atomic< uint64_t > sessionKeyMisses = 0;
+
+    // time from the start of a block to its first session signature, that is the time to the
+    // first consensus message of the block
+    atomic< uint64_t > firstSessionSignDelayMs = 0;
+    atomic< uint64_t > firstSessionSigns = 0;
+    atomic< uint64_t > totalFirstSessionSignDelayMs = 0;
+    atomic< uint64_t > maxFirstSessionSignDelayMs = 0;
 
     ptr< StubClient > getSgxClient();
 
     tuple< ptr< OpenSSLEdDSAKey >, string > localGenerateFastKey();
 
+    // creates a session key for the block and certifies it with the SGX ECDSA key
+    tuple< ptr< OpenSSLEdDSAKey >, string, string > generateSessionKey( block_id _blockID );
+
     string sign( BLAKE3Hash& _hash );
 
     tuple< string, string, string > signSession( BLAKE3Hash& _hash, block_id _blockId );
@@ -170,6 +191,14 @@ class CryptoManager {
     void verifyECDSASig(
         BLAKE3Hash& _hash, const string& _sig, node_id _nodeId, uint64_t _timeStamp );
 
+    ptr< OpenSSLEdDSAKey > getParsedSessionPublicKey( const string& _publicKey );
+
+    ptr< OpenSSLECDSAKey > getParsedECDSAPublicKey( const string& _publicKey );
+
+    // verifies the SGX signature of a session public key, unless it was verified before
+    void verifySessionPublicKey( const string& _publicKey, const string& _pkSig,
+        block_id _blockID, pair< node_id, node_id > _nodeId, uint64_t _timeStamp );
+
     ptr< ThresholdSigShare > signSigShare(
         BLAKE3Hash& _hash, block_id _blockId, bool _forceMockup );
 
@@ -221,6 +250,10 @@ public:
     void verifyProposalECDSA(
         const ptr< BlockProposal >& _proposal, const string& _hashStr, const string& _signature );
 
+    // verifies the proposer signature over a proposal hash before the proposal body is known
+    void verifyProposalECDSA(
+        BLAKE3Hash& _hash, const string& _signature, node_id _proposerNodeId, uint64_t _timeStampS );
+
     void verifyECDSA( BLAKE3Hash& _hash, const string& _sig, const string& _publicKey );
 
     void verifySessionSigAndKey( BLAKE3Hash& _hash, const string& _sig, const string& _publicKey,
@@ -247,6 +280,9 @@ public:
     tuple< ptr< ThresholdSigShare >, string, string, string > signDAProof(
         const ptr< BlockProposal >& _p );
 
+    tuple< ptr< ThresholdSigShare >, string, string, string > signDAProof(
+        BLAKE3Hash& _hash, block_id _blockId, uint64_t _timeStampS );
+
     ptr< ThresholdSigShare > signBinaryConsensusSigShare(
         BLAKE3Hash& _hash, block_id _blockId, uint64_t _round );
 
@@ -256,6 +292,15 @@ public:
 
     void verifyNetworkMsg( NetworkMessage& _msg );
 
+    // verifies a burst of messages. Session signatures made with the same key are verified
+    // together. Returns a flag per message instead of throwing
+    vector< bool > verifyNetworkMsgs( const vector< ptr< NetworkMessage > >& _msgs );
+
+    // verifies session signatures with one parsed key per session public key. Entries with an
+    // empty public key are rejected
+    vector< bool > verifySessionSigsByKey( const vector< string >& _publicKeys,
+        const vector< string >& _sigs, vector< BLAKE3Hash >& _hashes );
+
     static ptr< void > decodeSGXPublicKey( const string& _keyHex );
 
     static pair< string, string > generateSGXECDSAKey( const ptr< StubClient >& _c );
@@ -271,6 +316,17 @@ public:
 
     tuple< string, string, string > signSessionECDSA( BLAKE3Hash& _hash, block_id _blockID );
 
+    // creates the session key of a future block, unless it already exists
+    void pregenerateSessionKey( block_id _blockID );
+
+    // drops prepared keys of blocks before _blockID
+    void pruneSessionKeys( block_id _blockID );
+
+    // hits/misses/firstSignDelayMs
+    string getSessionKeyStats();
+
+    nlohmann::json getSessionKeyStatus();
+
 
     pair< ptr< BLSPublicKey >, ptr< BLSPublicKey > > getSgxBlsPublicKey( uint64_t _timestamp = 0 );
 
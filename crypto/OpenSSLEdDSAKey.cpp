@@ -237,6 +237,44 @@ void OpenSSLEdDSAKey::verifySig( const string& _encodedSignature, const char* _h
 }
 
 
+vector< bool > OpenSSLEdDSAKey::verifySigs(
+    const vector< pair< string, const char* > >& _sigsAndHashes ) const {
+    vector< bool > result( _sigsAndHashes.size(), false );
+
+    EVP_MD_CTX* verifyCtx = EVP_MD_CTX_new();
+
+    CHECK_STATE( verifyCtx );
+
+    vector< unsigned char > decodedSig;
+
+    for ( uint64_t i = 0; i < _sigsAndHashes.size(); i++ ) {
+        auto& [encodedSignature, hash] = _sigsAndHashes.at( i );
+
+        if ( !hash || encodedSignature.empty() )
+            continue;
+
+        decodedSig.assign( encodedSignature.size(), 0 );
+
+        auto decodedLen = EVP_DecodeBlock( decodedSig.data(),
+            ( const unsigned char* ) encodedSignature.c_str(), encodedSignature.size() );
+
+        if ( decodedLen < 64 )
+            continue;
+
+        if ( EVP_MD_CTX_reset( verifyCtx ) != 1 ||
+             EVP_DigestVerifyInit( verifyCtx, NULL, NULL, NULL, edKey ) <= 0 )
+            continue;
+
+        result.at( i ) = EVP_DigestVerify( verifyCtx, decodedSig.data(), 64,
+                             ( const unsigned char* ) hash, 32 ) == 1;
+    }
+
+    EVP_MD_CTX_free( verifyCtx );
+
+    return result;
+}
+
+
 ptr< OpenSSLEdDSAKey > OpenSSLEdDSAKey::importPubKey( const string& _publicKey ) {
     auto pubKey = deserializeFastPubKey( _publicKey );
     return make_shared< OpenSSLEdDSAKey >( pubKey, false );
@@ -50,6 +50,10 @@ public:
 
     void verifySig( const string& _encodedSignature, const char* _hash ) const;
 
+    // verifies signatures made with this key reusing one verification context.
+    // Returns a flag per signature instead of throwing
+    vector< bool > verifySigs( const vector< pair< string, const char* > >& _sigsAndHashes ) const;
+
     static ptr< OpenSSLEdDSAKey > generateKey();
 };
 
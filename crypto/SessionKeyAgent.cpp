@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file SessionKeyAgent.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/ExitRequestedException.h"
+#include "exceptions/FatalError.h"
+#include "thirdparty/json.hpp"
+
+#include "chains/Schain.h"
+#include "node/ConsensusEngine.h"
+#include "node/Node.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
+#include "CryptoManager.h"
+#include "SessionKeyAgent.h"
+
+
+// registered, so that the node wakes it up on exit
+SessionKeyAgent::SessionKeyAgent( Schain& _sChain ) : Agent( _sChain, false ) {
+    try {
+        logThreadLocal_ = _sChain.getNode()->getLog();
+        this->sChain = &_sChain;
+        keyExecutor = make_shared< TaskExecutor >( "SessionKeys", BlockingIOPool::getShared() );
+        schedulePreparation();
+    } catch ( ... ) {
+        throw_with_nested( FatalError( __FUNCTION__, __CLASS_NAME__ ) );
+    }
+}
+
+
+SessionKeyAgent::~SessionKeyAgent() {
+    // waits for a running preparation
+    keyExecutor = nullptr;
+}
+
+
+void SessionKeyAgent::schedulePreparation() {
+    if ( preparationScheduled.exchange( true ) )
+        return;
+
+    try {
+        keyExecutor->submit( [this]() { prepareKeys(); } );
+    } catch ( ExitRequestedException& ) {
+        preparationScheduled = false;
+    }
+}
+
+
+void SessionKeyAgent::prepareKeys() {
+    // a commit from now on schedules another run
+    preparationScheduled = false;
+
+    waitOnGlobalStartBarrier();
+
+    auto node = getSchain()->getNode();
+
+    if ( node->isExitRequested() || keyExecutor->isExitRequested() )
+        return;
+
+    uint64_t lastCommittedBlockID = ( uint64_t ) sChain->getLastCommittedBlockID();
+
+    try {
+        auto cryptoManager = sChain->getCryptoManager();
+        cryptoManager->pruneSessionKeys( block_id( lastCommittedBlockID + 1 ) );
+
+        for ( uint64_t i = 1; i <= SESSION_KEY_PREGENERATION_BLOCKS; i++ ) {
+            // the run scheduled by the new commit starts over from the new block
+            if ( node->isExitRequested() ||
+                 ( uint64_t ) sChain->getLastCommittedBlockID() != lastCommittedBlockID )
+                break;
+            cryptoManager->pregenerateSessionKey( block_id( lastCommittedBlockID + i ) );
+        }
+    } catch ( ExitRequestedException& ) {
+        return;
+    } catch ( FatalError& e ) {
+        SkaleException::logNested( e );
+        node->initiateApplicationExitOnFatalConsensusError( e.what() );
+    } catch ( exception& e ) {
+        // the keys that could not be prepared are created on first use
+        SkaleException::logNested( e );
+    }
+}
+
+
+void SessionKeyAgent::blockCommitted() {
+    schedulePreparation();
+}
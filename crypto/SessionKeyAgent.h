@@ -0,0 +1,57 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file SessionKeyAgent.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "Agent.h"
+
+class Schain;
+class TaskExecutor;
+
+/*
+ * Creates and SGX-certifies the EdDSA session keys of the next blocks ahead of time.
+ *
+ * A session key is bound to its block id, so after each commit the agent makes sure that the
+ * CryptoManager holds keys for the next SESSION_KEY_PREGENERATION_BLOCKS blocks. The first
+ * consensus message of a block then signs with a ready key instead of waiting for an SGX call.
+ *
+ * SGX calls block, so the preparation runs as a task of the blocking IO pool. At most one task
+ * is queued, commits that arrive while it runs schedule one more.
+ */
+class SessionKeyAgent : public Agent {
+    ptr< TaskExecutor > keyExecutor;
+
+    atomic< bool > preparationScheduled = false;
+
+    void schedulePreparation();
+
+    void prepareKeys();
+
+public:
+    explicit SessionKeyAgent( Schain& _sChain );
+
+    ~SessionKeyAgent() override;
+
+    // prepares keys for the blocks after the committed one
+    void blockCommitted();
+};
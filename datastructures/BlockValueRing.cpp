@@ -0,0 +1,100 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockValueRing.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+
+#include "BlockValueRing.h"
+
+
+BlockValueRing::BlockValueRing( uint64_t _capacity ) : mask( _capacity - 1 ), slots( _capacity ) {
+    CHECK_ARGUMENT( _capacity > 0 && ( _capacity & mask ) == 0 );
+}
+
+
+void BlockValueRing::put( block_id _blockID, const u256& _value ) {
+    CHECK_ARGUMENT( _blockID > 0 );
+
+    lock_guard< mutex > guard( writeLock );
+
+    auto& slot = slots[( uint64_t ) _blockID & mask];
+
+    auto sequence = slot.sequence.load( memory_order_relaxed );
+
+    slot.sequence.store( sequence + 1, memory_order_relaxed );
+    atomic_thread_fence( memory_order_release );
+
+    slot.blockID.store( ( uint64_t ) _blockID, memory_order_relaxed );
+
+    for ( uint64_t i = 0; i < slot.words.size(); i++ ) {
+        slot.words[i].store( ( uint64_t ) ( _value >> ( 64 * i ) ), memory_order_relaxed );
+    }
+
+    slot.sequence.store( sequence + 2, memory_order_release );
+}
+
+
+bool BlockValueRing::get( block_id _blockID, u256& _value ) {
+    auto& slot = slots[( uint64_t ) _blockID & mask];
+
+    array< uint64_t, 4 > words;
+
+    while ( true ) {
+        auto sequence = slot.sequence.load( memory_order_acquire );
+
+        if ( sequence % 2 == 1 )
+            continue;
+
+        auto blockID = slot.blockID.load( memory_order_relaxed );
+
+        for ( uint64_t i = 0; i < words.size(); i++ ) {
+            words[i] = slot.words[i].load( memory_order_relaxed );
+        }
+
+        atomic_thread_fence( memory_order_acquire );
+
+        if ( slot.sequence.load( memory_order_relaxed ) != sequence )
+            continue;
+
+        if ( blockID != ( uint64_t ) _blockID || blockID == 0 ) {
+            misses++;
+            return false;
+        }
+
+        break;
+    }
+
+    _value = 0;
+
+    for ( uint64_t i = words.size(); i > 0; i-- ) {
+        _value = ( _value << 64 ) | words[i - 1];
+    }
+
+    hits++;
+    return true;
+}
+
+
+string BlockValueRing::getStats() {
+    return to_string( hits ) + "/" + to_string( misses );
+}
@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockValueRing.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+/*
+ * Per block u256 values, such as prices and randoms, of the most recent blocks.
+ *
+ * A fixed size ring indexed by block id. Each slot keeps the value as four 64-bit words
+ * and is guarded by a sequence number (seqlock), so reads do not take locks: a reader
+ * retries if the sequence number changed while it copied the slot, and misses if the slot
+ * holds another block. Writers are serialized by a mutex.
+ */
+class BlockValueRing {
+    class alignas( 64 ) Slot {
+    public:
+        // odd while a writer updates the slot
+        atomic< uint64_t > sequence = 0;
+
+        atomic< uint64_t > blockID = 0;  // 0 if the slot is empty
+
+        array< atomic< uint64_t >, 4 > words;
+    };
+
+    const uint64_t mask;
+
+    vector< Slot > slots;
+
+    atomic< uint64_t > hits = 0;
+
+    atomic< uint64_t > misses = 0;
+
+    mutex writeLock;
+
+public:
+    // the capacity has to be a power of 2
+    explicit BlockValueRing( uint64_t _capacity );
+
+    void put( block_id _blockID, const u256& _value );
+
+    // does not take locks. Returns false if the value is not in the ring
+    bool get( block_id _blockID, u256& _value );
+
+    // hits/misses
+    string getStats();
+};
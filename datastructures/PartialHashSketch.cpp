@@ -0,0 +1,306 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file PartialHashSketch.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+
+#include "PartialHashesList.h"
+
+#include "PartialHashSketch.h"
+
+
+PartialHashSketch::PartialHashSketch( uint64_t _cellCount ) : cells( _cellCount ) {
+    CHECK_ARGUMENT( _cellCount > 0 && _cellCount % HASH_COUNT == 0 );
+}
+
+
+PartialHashSketch::PartialHashSketch( const uint8_t* _serialized, uint64_t _cellCount )
+    : PartialHashSketch( _cellCount ) {
+    CHECK_ARGUMENT( _serialized );
+
+    for ( auto&& cell : cells ) {
+        memcpy( &cell.count, _serialized, sizeof( cell.count ) );
+        memcpy( &cell.checkSum, _serialized + 4, sizeof( cell.checkSum ) );
+        memcpy( &cell.keySum, _serialized + 8, sizeof( cell.keySum ) );
+        _serialized += CELL_SIZE;
+    }
+}
+
+
+uint64_t PartialHashSketch::mix( uint64_t _key, uint64_t _seed ) {
+    // splitmix64 finalizer
+    uint64_t h = _key + _seed * 0x9E3779B97F4A7C15ULL;
+    h = ( h ^ ( h >> 30 ) ) * 0xBF58476D1CE4E5B9ULL;
+    h = ( h ^ ( h >> 27 ) ) * 0x94D049BB133111EBULL;
+    return h ^ ( h >> 31 );
+}
+
+
+uint32_t PartialHashSketch::getCheckSum( uint64_t _key ) {
+    return ( uint32_t ) mix( _key, HASH_COUNT + 1 );
+}
+
+
+uint64_t PartialHashSketch::getCellIndex( uint64_t _key, uint64_t _hashIndex ) const {
+    auto partSize = cells.size() / HASH_COUNT;
+    return _hashIndex * partSize + mix( _key, _hashIndex + 1 ) % partSize;
+}
+
+
+bool PartialHashSketch::isPure( uint64_t _cellIndex ) const {
+    auto& cell = cells[_cellIndex];
+    return ( cell.count == 1 || cell.count == -1 ) && cell.checkSum == getCheckSum( cell.keySum );
+}
+
+
+void PartialHashSketch::update( uint64_t _key, int32_t _delta ) {
+    auto checkSum = getCheckSum( _key );
+
+    for ( uint64_t i = 0; i < HASH_COUNT; i++ ) {
+        auto& cell = cells[getCellIndex( _key, i )];
+        cell.count += _delta;
+        cell.checkSum ^= checkSum;
+        cell.keySum ^= _key;
+    }
+}
+
+
+void PartialHashSketch::insert( uint64_t _key ) {
+    update( _key, 1 );
+}
+
+
+void PartialHashSketch::erase( uint64_t _key ) {
+    update( _key, -1 );
+}
+
+
+bool PartialHashSketch::decode( vector< uint64_t >& _inserted, vector< uint64_t >& _erased ) {
+    vector< uint64_t > pureCells;
+
+    for ( uint64_t i = 0; i < cells.size(); i++ ) {
+        if ( isPure( i ) )
+            pureCells.push_back( i );
+    }
+
+    while ( !pureCells.empty() ) {
+        auto index = pureCells.back();
+        pureCells.pop_back();
+
+        // peeling another key may have changed the cell
+        if ( !isPure( index ) )
+            continue;
+
+        auto key = cells[index].keySum;
+        auto count = cells[index].count;
+
+        ( count > 0 ? _inserted : _erased ).push_back( key );
+
+        // a crafted sketch could otherwise peel forever
+        if ( _inserted.size() + _erased.size() > cells.size() )
+            return false;
+
+        update( key, -count );
+
+        for ( uint64_t i = 0; i < HASH_COUNT; i++ ) {
+            auto cellIndex = getCellIndex( key, i );
+            if ( isPure( cellIndex ) )
+                pureCells.push_back( cellIndex );
+        }
+    }
+
+    for ( auto&& cell : cells ) {
+        if ( cell.count != 0 || cell.checkSum != 0 || cell.keySum != 0 )
+            return false;
+    }
+
+    return true;
+}
+
+
+uint64_t PartialHashSketch::getCellCount() const {
+    return cells.size();
+}
+
+
+void PartialHashSketch::serialize( uint8_t* _out ) const {
+    CHECK_ARGUMENT( _out );
+
+    for ( auto&& cell : cells ) {
+        memcpy( _out, &cell.count, sizeof( cell.count ) );
+        memcpy( _out + 4, &cell.checkSum, sizeof( cell.checkSum ) );
+        memcpy( _out + 8, &cell.keySum, sizeof( cell.keySum ) );
+        _out += CELL_SIZE;
+    }
+}
+
+
+uint64_t PartialHashSketch::toKey( const uint8_t* _partialHash ) {
+    // same as the keys of the known transaction index
+    uint64_t key;
+    memcpy( &key, _partialHash, sizeof( key ) );
+    return key;
+}
+
+
+uint32_t PartialHashSketch::getShortId( uint64_t _key ) {
+    return ( uint32_t ) _key;
+}
+
+
+uint64_t PartialHashSketch::getCellCount( uint64_t _expectedDifference ) {
+    // small sketches fail mostly on keys that share all their cells, hence the fixed slack
+    auto cellCount = 2 * _expectedDifference + MIN_CELLS;
+    return ( cellCount + HASH_COUNT - 1 ) / HASH_COUNT * HASH_COUNT;
+}
+
+
+uint64_t PartialHashSketch::getEncodedSize( uint64_t _transactionCount, uint64_t _cellCount ) {
+    return _transactionCount * SHORT_ID_LEN + _cellCount * CELL_SIZE;
+}
+
+
+bool PartialHashSketch::isWorthSending( uint64_t _transactionCount, uint64_t _cellCount ) {
+    return _cellCount > 0 && _cellCount % HASH_COUNT == 0 &&
+           getEncodedSize( _transactionCount, _cellCount ) < _transactionCount * PARTIAL_HASH_LEN;
+}
+
+
+ptr< vector< uint8_t > > PartialHashSketch::encodeProposal(
+    const PartialHashesList& _list, uint64_t _cellCount ) {
+    auto count = ( uint64_t ) _list.getTransactionCount();
+    auto partialHashes = _list.getPartialHashes();
+
+    auto fullList = [&]() {
+        auto result = make_shared< vector< uint8_t > >( sizeof( uint64_t ), 0 );
+        result->insert( result->end(), partialHashes->begin(), partialHashes->end() );
+        return result;
+    };
+
+    if ( !isWorthSending( count, _cellCount ) )
+        return fullList();
+
+    auto result = make_shared< vector< uint8_t > >(
+        sizeof( uint64_t ) + getEncodedSize( count, _cellCount ) );
+    memcpy( result->data(), &_cellCount, sizeof( uint64_t ) );
+
+    auto shortIds = result->data() + sizeof( uint64_t );
+
+    PartialHashSketch sketch( _cellCount );
+    unordered_set< uint32_t > usedShortIds;
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        auto key = toKey( partialHashes->data() + i * PARTIAL_HASH_LEN );
+        auto shortId = getShortId( key );
+
+        // the receiver could not tell the order of transactions with equal short ids
+        if ( !usedShortIds.insert( shortId ).second )
+            return fullList();
+
+        memcpy( shortIds + i * SHORT_ID_LEN, &shortId, SHORT_ID_LEN );
+        sketch.insert( key );
+    }
+
+    sketch.serialize( shortIds + count * SHORT_ID_LEN );
+
+    return result;
+}
+
+
+vector< uint32_t > PartialHashSketch::readShortIds(
+    const vector< uint8_t >& _encoded, uint64_t _count ) {
+    CHECK_ARGUMENT( _encoded.size() >= _count * SHORT_ID_LEN );
+
+    vector< uint32_t > result( _count );
+
+    for ( uint64_t i = 0; i < _count; i++ )
+        memcpy( &result[i], _encoded.data() + i * SHORT_ID_LEN, SHORT_ID_LEN );
+
+    return result;
+}
+
+
+ptr< PartialHashesList > PartialHashSketch::recoverProposal( const vector< uint32_t >& _shortIds,
+    PartialHashSketch& _sketch, const vector< uint64_t >& _knownKeys ) {
+    auto count = _shortIds.size();
+
+    unordered_map< uint32_t, uint64_t > positions;
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        if ( !positions.emplace( _shortIds[i], i ).second )
+            return nullptr;
+    }
+
+    vector< uint64_t > keys( count, 0 );
+    vector< uint64_t > matches( count, 0 );
+
+    for ( auto key : _knownKeys ) {
+        auto it = positions.find( getShortId( key ) );
+        if ( it != positions.end() ) {
+            keys[it->second] = key;
+            matches[it->second]++;
+        }
+    }
+
+    // known keys are distinct, a position with more than one match is left to the sketch
+    vector< bool > resolved( count, false );
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        if ( matches[i] == 1 ) {
+            _sketch.erase( keys[i] );
+            resolved[i] = true;
+        }
+    }
+
+    vector< uint64_t > inserted;
+    vector< uint64_t > erased;
+
+    if ( !_sketch.decode( inserted, erased ) )
+        return nullptr;
+
+    // erased keys were matched by short id, but are not in the proposal
+    for ( auto key : erased ) {
+        auto it = positions.find( getShortId( key ) );
+        if ( it == positions.end() || !resolved[it->second] || keys[it->second] != key )
+            return nullptr;
+        resolved[it->second] = false;
+    }
+
+    for ( auto key : inserted ) {
+        auto it = positions.find( getShortId( key ) );
+        if ( it == positions.end() || resolved[it->second] )
+            return nullptr;
+        keys[it->second] = key;
+        resolved[it->second] = true;
+    }
+
+    auto partialHashes = make_shared< vector< uint8_t > >( count * PARTIAL_HASH_LEN );
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        if ( !resolved[i] )
+            return nullptr;
+        memcpy( partialHashes->data() + i * PARTIAL_HASH_LEN, &keys[i], PARTIAL_HASH_LEN );
+    }
+
+    return make_shared< PartialHashesList >( transaction_count( count ), partialHashes );
+}
@@ -0,0 +1,116 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file PartialHashSketch.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+class PartialHashesList;
+
+/*
+ * Invertible Bloom lookup table of the partial hashes of a block proposal.
+ *
+ * A proposer sends a sketch of its partial hashes together with 4-byte short ids of the
+ * transactions in proposal order, instead of the full 8-byte partial hashes. The receiver
+ * matches the short ids against the transactions it knows and subtracts the matched partial
+ * hashes from the sketch. What is left are the partial hashes it does not know or matched by
+ * mistake, and they decode as long as there are not more of them than about half the cells.
+ *
+ * Every partial hash is added to one cell in each of HASH_COUNT equal parts of the table.
+ * A cell holds the count, the xor of the partial hashes and the xor of their checksums.
+ */
+class PartialHashSketch {
+public:
+    static constexpr uint64_t HASH_COUNT = 5;
+
+    static constexpr uint64_t CELL_SIZE = 16;
+
+    static constexpr uint64_t SHORT_ID_LEN = 4;
+
+    static constexpr uint64_t MIN_CELLS = 32;
+
+private:
+    class Cell {
+    public:
+        int32_t count = 0;
+
+        uint32_t checkSum = 0;
+
+        uint64_t keySum = 0;
+    };
+
+    vector< Cell > cells;
+
+    static uint64_t mix( uint64_t _key, uint64_t _seed );
+
+    static uint32_t getCheckSum( uint64_t _key );
+
+    uint64_t getCellIndex( uint64_t _key, uint64_t _hashIndex ) const;
+
+    bool isPure( uint64_t _cellIndex ) const;
+
+    void update( uint64_t _key, int32_t _delta );
+
+public:
+    // the cell count has to be a multiple of HASH_COUNT
+    explicit PartialHashSketch( uint64_t _cellCount );
+
+    PartialHashSketch( const uint8_t* _serialized, uint64_t _cellCount );
+
+    static uint64_t toKey( const uint8_t* _partialHash );
+
+    static uint32_t getShortId( uint64_t _key );
+
+    // cells enough to decode the expected number of differing partial hashes
+    static uint64_t getCellCount( uint64_t _expectedDifference );
+
+    // size of the short ids and the sketch, without the cell count
+    static uint64_t getEncodedSize( uint64_t _transactionCount, uint64_t _cellCount );
+
+    // true if the cell count is valid and the encoding is smaller than the partial hashes
+    static bool isWorthSending( uint64_t _transactionCount, uint64_t _cellCount );
+
+    // The cell count, followed by the short ids in proposal order and the sketch. If the
+    // short ids collide or the sketch is not smaller, a zero cell count followed by the
+    // partial hashes
+    static ptr< vector< uint8_t > > encodeProposal(
+        const PartialHashesList& _list, uint64_t _cellCount );
+
+    static vector< uint32_t > readShortIds( const vector< uint8_t >& _encoded, uint64_t _count );
+
+    // Recovers the partial hashes of a proposal from its short ids and sketch and the partial
+    // hashes known to the receiver. The sketch is consumed. Returns nullptr if the result is
+    // ambiguous or the difference does not decode
+    static ptr< PartialHashesList > recoverProposal( const vector< uint32_t >& _shortIds,
+        PartialHashSketch& _sketch, const vector< uint64_t >& _knownKeys );
+
+    void insert( uint64_t _key );
+
+    void erase( uint64_t _key );
+
+    // Peels the sketch into the keys inserted more than erased and the other way round.
+    // The sketch is consumed. Returns false if it does not decode completely
+    bool decode( vector< uint64_t >& _inserted, vector< uint64_t >& _erased );
+
+    uint64_t getCellCount() const;
+
+    void serialize( uint8_t* _out ) const;
+};
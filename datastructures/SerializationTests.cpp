@@ -44,6 +44,8 @@
 
 #include "BlockProposalFragment.h"
 #include "BlockProposalFragmentList.h"
+#include "PartialHashSketch.h"
+#include "PartialHashesList.h"
 
 
 #define BOOST_PENDING_INTEGER_LOG2_HPP
@@ -324,6 +326,62 @@ TEST_CASE( "Test committed block fragment/defragment", "[committed-block-defragm
 }
 
 
+TEST_CASE( "Proposal partial hashes are recovered from a sketch", "[partial-hash-sketch]" ) {
+    const uint64_t txCount = 2000;
+    const uint64_t missingCount = 30;
+
+    boost::random::mt19937_64 gen;
+
+    auto partialHashes = make_shared< vector< uint8_t > >( txCount * PARTIAL_HASH_LEN );
+    vector< uint64_t > keys( txCount );
+
+    for ( uint64_t i = 0; i < txCount; i++ ) {
+        keys[i] = gen();
+        memcpy( partialHashes->data() + i * PARTIAL_HASH_LEN, &keys[i], PARTIAL_HASH_LEN );
+    }
+
+    PartialHashesList list( txCount, partialHashes );
+
+    // the receiver misses some transactions, knows unrelated ones, and one known transaction
+    // has the short id of a proposal transaction
+    vector< uint64_t > knownKeys( keys.begin() + missingCount, keys.end() );
+    for ( uint64_t i = 0; i < 500; i++ )
+        knownKeys.push_back( gen() );
+    knownKeys.push_back( keys[0] ^ ( 1ULL << 40 ) );
+
+    auto recover = [&]( uint64_t _expectedDifference ) {
+        auto cells = PartialHashSketch::getCellCount( _expectedDifference );
+        auto encoded = PartialHashSketch::encodeProposal( list, cells );
+        uint64_t cellCount;
+        memcpy( &cellCount, encoded->data(), sizeof( uint64_t ) );
+        REQUIRE( cellCount > 0 );
+
+        auto payload = vector< uint8_t >( encoded->begin() + sizeof( uint64_t ), encoded->end() );
+        REQUIRE( payload.size() == PartialHashSketch::getEncodedSize( txCount, cellCount ) );
+
+        auto shortIds = PartialHashSketch::readShortIds( payload, txCount );
+        PartialHashSketch sketch(
+            payload.data() + txCount * PartialHashSketch::SHORT_ID_LEN, cellCount );
+        return PartialHashSketch::recoverProposal( shortIds, sketch, knownKeys );
+    };
+
+    auto recovered = recover( missingCount + 1 );
+    REQUIRE( recovered );
+    REQUIRE( *recovered->getPartialHashes() == *partialHashes );
+
+    // too few cells for the difference
+    REQUIRE_FALSE( recover( 0 ) );
+
+    // colliding short ids make the proposer send the full partial hashes
+    keys[1] = keys[2] ^ ( 1ULL << 40 );
+    memcpy( partialHashes->data() + PARTIAL_HASH_LEN, &keys[1], PARTIAL_HASH_LEN );
+    auto encoded = PartialHashSketch::encodeProposal( list, PartialHashSketch::getCellCount( 0 ) );
+    REQUIRE( encoded->size() == sizeof( uint64_t ) + partialHashes->size() );
+    REQUIRE(
+        equal( encoded->begin() + sizeof( uint64_t ), encoded->end(), partialHashes->begin() ) );
+}
+
+
 class CryptoFixture {
 public:
     CryptoFixture(){};
@@ -26,19 +26,31 @@
 #include "Log.h"
 #include "chains/Schain.h"
 #include "datastructures/CommittedBlock.h"
+#include "exceptions/ExitRequestedException.h"
 #include "exceptions/InvalidStateException.h"
 #include "utils/Time.h"
 
 #include "LevelDBOptions.h"
+#include "BlockSegmentStore.h"
+#include "SerializedBlockCache.h"
 #include "BlockDB.h"
 
 
-constexpr uint64_t NUMBER_OF_BLOCKS_TO_CACHE = 3;
+// enough for a full catchup response, together with the blocks it was assembled from
+constexpr uint64_t SERIALIZED_BLOCK_CACHE_BYTES = 4 * MAX_CATCHUP_DOWNLOAD_BYTES;
 
 ptr< vector< uint8_t > > BlockDB::getSerializedBlocksFromLevelDB(
     block_id _startBlock, block_id _endBlock, ptr< list< uint64_t > > _blockSizes ) {
     CHECK_STATE( _blockSizes );
 
+    // peers that lag by the same number of blocks ask for the same range, for example
+    // after a network partition heals
+    auto cachedBlocks = blockCache->getRange( _startBlock, _endBlock, _blockSizes );
+
+    if ( cachedBlocks ) {
+        return cachedBlocks;
+    }
+
     auto serializedBlocks = make_shared< vector< uint8_t > >();
 
     serializedBlocks->push_back( '[' );
@@ -76,18 +88,46 @@ ptr< vector< uint8_t > > BlockDB::getSerializedBlocksFromLevelDB(
     // a simple sanity check
     CHECK_STATE( _blockSizes->size() > 0 );
 
+    blockCache->putRange( _startBlock, _endBlock, serializedBlocks, _blockSizes );
+
     return serializedBlocks;
 }
 
 
+ptr< vector< SegmentView > > BlockDB::getSerializedBlockViews(
+    block_id _startBlock, block_id _endBlock, const ptr< list< uint64_t > >& _blockSizes ) {
+    CHECK_ARGUMENT( _blockSizes );
+
+    return segmentStore->getBlockRange( _startBlock, _endBlock,
+        getSchain()->getNode()->getMaxCatchupDownloadBytes(), _blockSizes );
+}
+
+ptr< vector< uint8_t > > BlockDB::getCompressedBlockRange(
+    block_id _startBlock, block_id _endBlock, uint64_t _level ) {
+    return blockCache->getCompressedRange( _startBlock, _endBlock, _level );
+}
+
+void BlockDB::putCompressedBlockRange( block_id _startBlock, block_id _endBlock, uint64_t _level,
+    const ptr< vector< uint8_t > >& _frames ) {
+    blockCache->putCompressedRange( _startBlock, _endBlock, _level, _frames );
+}
+
+const ptr< BlockSegmentStore >& BlockDB::getSegmentStore() const {
+    return segmentStore;
+}
+
+
+string BlockDB::getBlockCacheStats() {
+    return blockCache->getStats();
+}
+
+
 ptr< vector< uint8_t > > BlockDB::getSerializedBlockFromLevelDB( block_id _blockID ) {
     // check if block is in the cache and return
     // cache is already thread safe
-    auto result = blockCache.getIfExists( ( uint64_t ) _blockID );
-    if ( result.has_value() ) {
-        auto block = std::any_cast< ptr< vector< uint8_t > > >( result );
-        CHECK_STATE( block )
-        return block;
+    auto cachedBlock = blockCache->getBlock( _blockID );
+    if ( cachedBlock ) {
+        return cachedBlock;
     }
 
     shared_lock< shared_mutex > lock( m );
@@ -102,6 +142,7 @@ ptr< vector< uint8_t > > BlockDB::getSerializedBlockFromLevelDB( block_id _block
             serializedBlock->insert(
                 serializedBlock->begin(), value.data(), value.data() + value.size() );
             CommittedBlock::serializedSanityCheck( serializedBlock );
+            blockCache->putBlock( _blockID, serializedBlock );
             return serializedBlock;
         } else {
             return nullptr;
@@ -111,11 +152,14 @@ ptr< vector< uint8_t > > BlockDB::getSerializedBlockFromLevelDB( block_id _block
     }
 }
 
-BlockDB::BlockDB(
-    Schain* _sChain, string& _dirname, string& _prefix, node_id _nodeId, uint64_t _maxDBSize )
+BlockDB::BlockDB( Schain* _sChain, string& _dirname, string& _prefix, node_id _nodeId,
+    uint64_t _maxDBSize, uint64_t _maxSegmentStoreSize )
     : CacheLevelDB( _sChain, _dirname, _prefix, _nodeId, _maxDBSize,
           LevelDBOptions::getBlockDBOptions(), false ),
-      blockCache( NUMBER_OF_BLOCKS_TO_CACHE ) {}
+      blockCache( make_shared< SerializedBlockCache >( SERIALIZED_BLOCK_CACHE_BYTES ) ) {
+    segmentStore =
+        make_shared< BlockSegmentStore >( dirName + "/segments", _maxSegmentStoreSize );
+}
 
 
 void BlockDB::saveBlock2LevelDB( const ptr< CommittedBlock >& _block ) {
@@ -124,11 +168,13 @@ void BlockDB::saveBlock2LevelDB( const ptr< CommittedBlock >& _block ) {
 
     lock_guard< shared_mutex > lock( m );
 
+    ptr< vector< uint8_t > > serializedBlock;
+
     try {
-        auto serializedBlock = _block->serialize();
+        serializedBlock = _block->serialize();
 
         // put block into the cache
-        blockCache.put( ( uint64_t ) _block->getBlockID(), serializedBlock );
+        blockCache->putBlock( _block->getBlockID(), serializedBlock );
 
         CHECK_STATE( serializedBlock )
 
@@ -139,6 +185,16 @@ void BlockDB::saveBlock2LevelDB( const ptr< CommittedBlock >& _block ) {
     } catch ( ... ) {
         throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
     }
+
+    // LevelDB is the source of truth, segment store only serves catchup.
+    // If the append fails, catchup falls back to LevelDB for this range
+    try {
+        segmentStore->appendBlock( _block->getBlockID(), serializedBlock );
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    }
 }
 
 
@@ -30,17 +30,23 @@ class CommittedBlock;
 #include "CacheLevelDB.h"
 
 class CryptoManager;
+class BlockSegmentStore;
+class SegmentView;
+class SerializedBlockCache;
 
 class BlockDB : public CacheLevelDB {
     shared_mutex m;
 
     void saveBlock2LevelDB( const ptr< CommittedBlock >& _block );
 
-    cache::lru_cache< uint64_t, ptr< vector< uint8_t > > > blockCache;  // tsafe
+    // serialized blocks and assembled catchup responses, shared by all catchup requests
+    ptr< SerializedBlockCache > blockCache;  // tsafe
+
+    ptr< BlockSegmentStore > segmentStore;  // tsafe
 
 public:
-    BlockDB(
-        Schain* _sChain, string& _dirname, string& _prefix, node_id _nodeId, uint64_t _maxDBSize );
+    BlockDB( Schain* _sChain, string& _dirname, string& _prefix, node_id _nodeId,
+        uint64_t _maxDBSize, uint64_t _maxSegmentStoreSize );
 
     ptr< vector< uint8_t > > getSerializedBlockFromLevelDB( block_id _blockID );
 
@@ -60,6 +66,23 @@ public:
 
     ptr< vector< uint8_t > > getSerializedBlocksFromLevelDB(
         block_id _startBlock, block_id _endBlock, ptr< list< uint64_t > > _blockSizes );
+
+    // zero-copy version of getSerializedBlocksFromLevelDB served from the segment store.
+    // Returns nullptr if the range is not in the segment store
+    ptr< vector< SegmentView > > getSerializedBlockViews(
+        block_id _startBlock, block_id _endBlock, const ptr< list< uint64_t > >& _blockSizes );
+
+    // compressed frames of a catchup response, nullptr if they are not cached
+    ptr< vector< uint8_t > > getCompressedBlockRange(
+        block_id _startBlock, block_id _endBlock, uint64_t _level );
+
+    void putCompressedBlockRange( block_id _startBlock, block_id _endBlock, uint64_t _level,
+        const ptr< vector< uint8_t > >& _frames );
+
+    [[nodiscard]] const ptr< BlockSegmentStore >& getSegmentStore() const;
+
+    // hit percentage and cached megabytes of the serialized block cache
+    string getBlockCacheStats();
 };
 
 
@@ -0,0 +1,467 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockSegmentStore.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/IOException.h"
+#include "exceptions/InvalidStateException.h"
+#include "crypto/BLAKE3Hash.h"
+
+#include "BlockSegmentStore.h"
+
+
+static void writeFully( int _fd, const uint8_t* _data, uint64_t _size, uint64_t _offset ) {
+    uint64_t written = 0;
+    while ( written < _size ) {
+        auto result = pwrite( _fd, _data + written, _size - written, _offset + written );
+        if ( result < 0 && errno == EINTR )
+            continue;
+        if ( result <= 0 ) {
+            BOOST_THROW_EXCEPTION( IOException( "Could not write block segment", errno, "" ) );
+        }
+        written += result;
+    }
+}
+
+static uint64_t getFileSize( int _fd ) {
+    struct stat st;
+    CHECK_STATE( fstat( _fd, &st ) == 0 );
+    return st.st_size;
+}
+
+
+SegmentView::SegmentView(
+    const ptr< BlockSegment >& _segment, const uint8_t* _data, uint64_t _size )
+    : segment( _segment ), data( _data ), size( _size ) {
+    CHECK_ARGUMENT( _segment );
+    CHECK_ARGUMENT( _data );
+    CHECK_ARGUMENT( _size > 0 );
+}
+
+const uint8_t* SegmentView::getData() const {
+    return data;
+}
+
+uint64_t SegmentView::getSize() const {
+    return size;
+}
+
+
+string BlockSegment::createDataFileName( uint64_t _firstBlockID ) {
+    // zero-padded so that segment files sort by block id
+    char name[32];
+    snprintf( name, sizeof( name ), "%020lu", _firstBlockID );
+    return string( name );
+}
+
+uint64_t BlockSegment::computeCheckSum( const uint8_t* _data, uint64_t _size ) {
+    blake3_hasher hasher;
+    blake3_hasher_init( &hasher );
+    blake3_hasher_update( &hasher, _data, _size );
+    uint64_t result;
+    blake3_hasher_finalize( &hasher, ( uint8_t* ) &result, sizeof( result ) );
+    return result;
+}
+
+BlockSegment::BlockSegment( const string& _dirName, uint64_t _firstBlockID,
+    uint64_t _reservedSize, bool _create, bool _verify )
+    : firstBlockID( _firstBlockID ) {
+    auto baseName = _dirName + "/" + createDataFileName( _firstBlockID );
+    dataPath = baseName + ".seg";
+    indexPath = baseName + ".idx";
+
+    auto flags = O_RDWR | O_CREAT | O_CLOEXEC | ( _create ? O_TRUNC : 0 );
+
+    dataFd = open( dataPath.c_str(), flags, 0644 );
+    if ( dataFd < 0 ) {
+        BOOST_THROW_EXCEPTION(
+            IOException( "Could not open block segment " + dataPath, errno, __CLASS_NAME__ ) );
+    }
+
+    indexFd = open( indexPath.c_str(), flags, 0644 );
+    if ( indexFd < 0 ) {
+        close( dataFd );
+        BOOST_THROW_EXCEPTION(
+            IOException( "Could not open block segment index " + indexPath, errno, __CLASS_NAME__ ) );
+    }
+
+    if ( !_create ) {
+        loadIndex( _verify );
+    }
+
+    map( max( _reservedSize, getDataSize() ) );
+}
+
+void BlockSegment::loadIndex( bool _verify ) {
+    auto indexSize = getFileSize( indexFd );
+    auto dataSize = getFileSize( dataFd );
+
+    // end offset and checksum of each block
+    vector< uint64_t > entries( indexSize / ( 2 * sizeof( uint64_t ) ) * 2 );
+
+    if ( !entries.empty() ) {
+        auto bytes = entries.size() * sizeof( uint64_t );
+        CHECK_STATE( pread( indexFd, entries.data(), bytes, 0 ) == ( ssize_t ) bytes );
+    }
+
+    // the node may have crashed in the middle of an append, or before unsynced pages
+    // reached the disk. Keep the longest valid prefix and cut everything after it
+    uint64_t validCount = 0;
+    uint64_t previousEnd = 0;
+    vector< uint8_t > block;
+
+    for ( uint64_t i = 0; i < entries.size(); i += 2 ) {
+        auto end = entries[i];
+        if ( end <= previousEnd || end > dataSize )
+            break;
+        if ( _verify ) {
+            block.resize( end - previousEnd );
+            if ( pread( dataFd, block.data(), block.size(), previousEnd ) !=
+                     ( ssize_t ) block.size() ||
+                 computeCheckSum( block.data(), block.size() ) != entries[i + 1] )
+                break;
+        }
+        endOffsets.push_back( end );
+        previousEnd = end;
+        validCount++;
+    }
+
+    if ( validCount * 2 != entries.size() || previousEnd != dataSize ||
+         indexSize != entries.size() * sizeof( uint64_t ) ) {
+        LOG( warn, "Truncating block segment " << dataPath << " to " << validCount << " blocks" );
+        CHECK_STATE( ftruncate( indexFd, validCount * 2 * sizeof( uint64_t ) ) == 0 );
+        CHECK_STATE( ftruncate( dataFd, previousEnd ) == 0 );
+    }
+}
+
+void BlockSegment::map( uint64_t _size ) {
+    if ( _size == 0 )
+        return;
+
+    // mapping may extend past the end of file. Only the bytes that are already
+    // written are ever accessed, so this is safe and lets the file grow in place
+    auto result = mmap( nullptr, _size, PROT_READ, MAP_SHARED, dataFd, 0 );
+    if ( result == MAP_FAILED ) {
+        BOOST_THROW_EXCEPTION(
+            IOException( "Could not map block segment " + dataPath, errno, __CLASS_NAME__ ) );
+    }
+
+    mapping = ( uint8_t* ) result;
+    mappingSize = _size;
+}
+
+BlockSegment::~BlockSegment() {
+    if ( mapping )
+        munmap( mapping, mappingSize );
+    if ( dataFd >= 0 )
+        close( dataFd );
+    if ( indexFd >= 0 )
+        close( indexFd );
+}
+
+void BlockSegment::append( block_id _blockID, const uint8_t* _data, uint64_t _size ) {
+    CHECK_ARGUMENT( _data );
+    CHECK_ARGUMENT( _size > 0 );
+    CHECK_STATE( ( uint64_t ) _blockID == firstBlockID + endOffsets.size() );
+
+    auto offset = getDataSize();
+
+    CHECK_STATE( offset + _size <= mappingSize );
+
+    writeFully( dataFd, _data, _size, offset );
+
+    // the index entry is written after the data. Without a sync the order is not
+    // guaranteed on disk, so the checksum lets the open of an unsealed segment detect
+    // an entry that points to missing data
+    uint64_t entry[2] = { offset + _size, computeCheckSum( _data, _size ) };
+    writeFully(
+        indexFd, ( const uint8_t* ) entry, sizeof( entry ), endOffsets.size() * sizeof( entry ) );
+
+    endOffsets.push_back( entry[0] );
+}
+
+void BlockSegment::seal() {
+    if ( fsync( dataFd ) != 0 || fsync( indexFd ) != 0 ) {
+        BOOST_THROW_EXCEPTION(
+            IOException( "Could not sync block segment " + dataPath, errno, __CLASS_NAME__ ) );
+    }
+}
+
+bool BlockSegment::contains( block_id _blockID ) const {
+    return ( uint64_t ) _blockID >= firstBlockID &&
+           ( uint64_t ) _blockID < firstBlockID + endOffsets.size();
+}
+
+uint64_t BlockSegment::getBlockOffset( block_id _blockID ) const {
+    CHECK_ARGUMENT( contains( _blockID ) );
+    auto index = ( uint64_t ) _blockID - firstBlockID;
+    return index == 0 ? 0 : endOffsets.at( index - 1 );
+}
+
+uint64_t BlockSegment::getBlockSize( block_id _blockID ) const {
+    return endOffsets.at( ( uint64_t ) _blockID - firstBlockID ) - getBlockOffset( _blockID );
+}
+
+const uint8_t* BlockSegment::getMapping() const {
+    CHECK_STATE( mapping );
+    return mapping;
+}
+
+uint64_t BlockSegment::getFirstBlockID() const {
+    return firstBlockID;
+}
+
+uint64_t BlockSegment::getLastBlockID() const {
+    CHECK_STATE( !endOffsets.empty() );
+    return firstBlockID + endOffsets.size() - 1;
+}
+
+uint64_t BlockSegment::getBlockCount() const {
+    return endOffsets.size();
+}
+
+uint64_t BlockSegment::getDataSize() const {
+    return endOffsets.empty() ? 0 : endOffsets.back();
+}
+
+uint64_t BlockSegment::getMappingSize() const {
+    return mappingSize;
+}
+
+void BlockSegment::removeFiles() {
+    // existing mappings stay valid after unlink until the segment object is destroyed
+    unlink( dataPath.c_str() );
+    unlink( indexPath.c_str() );
+}
+
+
+BlockSegmentStore::BlockSegmentStore( const string& _dirName, uint64_t _maxStoreSize )
+    : dirName( _dirName ), maxStoreSize( _maxStoreSize ) {
+    CHECK_ARGUMENT( _maxStoreSize > 0 );
+
+    boost::filesystem::create_directories( dirName );
+
+    vector< uint64_t > firstBlockIDs;
+
+    for ( auto&& entry : boost::filesystem::directory_iterator( dirName ) ) {
+        if ( entry.path().extension() == SEGMENT_SUFFIX ) {
+            firstBlockIDs.push_back(
+                strtoull( entry.path().stem().string().c_str(), nullptr, 10 ) );
+        }
+    }
+
+    sort( firstBlockIDs.begin(), firstBlockIDs.end() );
+
+    for ( auto&& firstBlockID : firstBlockIDs ) {
+        // only the last segment receives appends, so only it needs spare room in the mapping
+        auto isLast = ( firstBlockID == firstBlockIDs.back() );
+        // earlier segments were synced when they were sealed
+        auto segment = make_shared< BlockSegment >(
+            dirName, firstBlockID, isLast ? SEGMENT_RESERVED_BYTES : 0, false, isLast );
+
+        if ( segment->getBlockCount() == 0 && !isLast ) {
+            segment->removeFiles();
+            continue;
+        }
+
+        totalSize += segment->getDataSize();
+        segments[firstBlockID] = segment;
+    }
+
+    LOG( info, "Opened block segment store " << dirName << " segments:" << segments.size()
+                                             << " bytes:" << totalSize );
+}
+
+ptr< BlockSegment > BlockSegmentStore::findSegmentUnsafe( block_id _blockID ) {
+    auto it = segments.upper_bound( ( uint64_t ) _blockID );
+    if ( it == segments.begin() )
+        return nullptr;
+    --it;
+    return it->second->contains( _blockID ) ? it->second : nullptr;
+}
+
+void BlockSegmentStore::rollSegmentIfNeeded( block_id _blockID, uint64_t _blockSize ) {
+    if ( !segments.empty() ) {
+        auto active = segments.rbegin()->second;
+
+        auto isFull = active->getBlockCount() >= BLOCKS_PER_SEGMENT ||
+                      active->getDataSize() >= SEGMENT_ROLL_BYTES ||
+                      active->getDataSize() + _blockSize > active->getMappingSize();
+
+        auto isNext = ( uint64_t ) _blockID == active->getFirstBlockID() + active->getBlockCount();
+
+        if ( isNext && !isFull )
+            return;
+
+        if ( active->getBlockCount() == 0 ) {
+            active->removeFiles();
+            segments.erase( active->getFirstBlockID() );
+        } else {
+            // sealed before the next segment exists, so only the last segment can be unsynced
+            active->seal();
+        }
+    }
+
+    // a gap in block ids (for example after a snapshot start) simply starts a new segment
+    auto segment = make_shared< BlockSegment >(
+        dirName, ( uint64_t ) _blockID, max( SEGMENT_RESERVED_BYTES, _blockSize ), true );
+    segments[( uint64_t ) _blockID] = segment;
+}
+
+void BlockSegmentStore::dropOldSegmentsIfNeeded() {
+    while ( totalSize > maxStoreSize && segments.size() > 1 ) {
+        auto oldest = segments.begin()->second;
+        totalSize -= oldest->getDataSize();
+        oldest->removeFiles();
+        segments.erase( segments.begin() );
+        LOG( info, "Dropped block segment starting at " << oldest->getFirstBlockID() );
+    }
+}
+
+void BlockSegmentStore::appendBlock(
+    block_id _blockID, const ptr< vector< uint8_t > >& _serializedBlock ) {
+    CHECK_ARGUMENT( _serializedBlock );
+    CHECK_ARGUMENT( !_serializedBlock->empty() );
+
+    WRITE_LOCK( m )
+
+    if ( findSegmentUnsafe( _blockID ) )
+        return;
+
+    // blocks are appended in order. An older block that is missing
+    // from the store is not added, since segments can not be appended in the middle
+    if ( !segments.empty() && segments.rbegin()->second->getBlockCount() > 0 &&
+         ( uint64_t ) _blockID < segments.rbegin()->second->getLastBlockID() ) {
+        LOG( debug, "Skipping out of order block in segment store:" << _blockID );
+        return;
+    }
+
+    rollSegmentIfNeeded( _blockID, _serializedBlock->size() );
+
+    segments.rbegin()->second->append(
+        _blockID, _serializedBlock->data(), _serializedBlock->size() );
+
+    totalSize += _serializedBlock->size();
+
+    dropOldSegmentsIfNeeded();
+}
+
+bool BlockSegmentStore::hasBlock( block_id _blockID ) {
+    READ_LOCK( m )
+    return findSegmentUnsafe( _blockID ) != nullptr;
+}
+
+ptr< SegmentView > BlockSegmentStore::getBlock( block_id _blockID ) {
+    READ_LOCK( m )
+
+    auto segment = findSegmentUnsafe( _blockID );
+
+    if ( !segment )
+        return nullptr;
+
+    return make_shared< SegmentView >( segment,
+        segment->getMapping() + segment->getBlockOffset( _blockID ),
+        segment->getBlockSize( _blockID ) );
+}
+
+ptr< vector< SegmentView > > BlockSegmentStore::getBlockRange( block_id _startBlock,
+    block_id _endBlock, uint64_t _maxBytes, const ptr< list< uint64_t > >& _blockSizes ) {
+    CHECK_ARGUMENT( _blockSizes );
+    CHECK_ARGUMENT( _startBlock <= _endBlock );
+
+    READ_LOCK( m )
+
+    auto result = make_shared< vector< SegmentView > >();
+    list< uint64_t > sizes;
+
+    ptr< BlockSegment > segment = nullptr;
+    uint64_t runStart = 0;
+    uint64_t runEnd = 0;
+    uint64_t totalBytes = 0;
+
+    for ( uint64_t i = ( uint64_t ) _startBlock; i <= ( uint64_t ) _endBlock; i++ ) {
+        if ( !segment || !segment->contains( i ) ) {
+            if ( segment ) {
+                result->emplace_back(
+                    segment, segment->getMapping() + runStart, runEnd - runStart );
+            }
+
+            segment = findSegmentUnsafe( i );
+
+            if ( !segment )
+                return nullptr;
+
+            runStart = segment->getBlockOffset( i );
+            runEnd = runStart;
+        }
+
+        auto blockSize = segment->getBlockSize( i );
+
+        totalBytes += blockSize;
+
+        // same rule as in the LevelDB path: up to _maxBytes, but at least one block
+        if ( totalBytes > _maxBytes && !sizes.empty() )
+            break;
+
+        runEnd += blockSize;
+        sizes.push_back( blockSize );
+    }
+
+    if ( runEnd > runStart ) {
+        result->emplace_back( segment, segment->getMapping() + runStart, runEnd - runStart );
+    }
+
+    CHECK_STATE( !sizes.empty() );
+
+    _blockSizes->insert( _blockSizes->end(), sizes.begin(), sizes.end() );
+
+    return result;
+}
+
+uint64_t BlockSegmentStore::getTotalSize() {
+    READ_LOCK( m )
+    return totalSize;
+}
+
+uint64_t BlockSegmentStore::getSegmentCount() {
+    READ_LOCK( m )
+    return segments.size();
+}
+
+block_id BlockSegmentStore::getFirstBlockID() {
+    READ_LOCK( m )
+    if ( segments.empty() || segments.begin()->second->getBlockCount() == 0 )
+        return 0;
+    return segments.begin()->second->getFirstBlockID();
+}
+
+block_id BlockSegmentStore::getLastBlockID() {
+    READ_LOCK( m )
+    if ( segments.empty() || segments.rbegin()->second->getBlockCount() == 0 )
+        return 0;
+    return segments.rbegin()->second->getLastBlockID();
+}
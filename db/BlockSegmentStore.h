@@ -0,0 +1,181 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockSegmentStore.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+/*
+ * Append-only store of serialized committed blocks.
+ *
+ * Blocks are appended in block id order into segment files. Each segment
+ * starts at some block id and holds a dense run of consecutive blocks.
+ * Next to each segment data file there is an index file which holds two uint64_t
+ * per block - the end offset of the block in the data file and a checksum of the block.
+ *
+ * Segments are memory-mapped, so reads do not copy data. A range of blocks
+ * inside a segment is a contiguous byte range that can be passed to writev() directly.
+ *
+ * Retention drops whole segments, oldest first, once the store exceeds its size limit.
+ * The limit is a share of the consensus storage limit, see StorageLimits.
+ *
+ * Appends are not synced. A segment is fsync'ed when it is sealed, that is when the next
+ * segment is started, and on open the blocks of the last segment are checked against their
+ * checksums, so that a crash never leaves a truncated block in the store.
+ *
+ * LevelDB BlockDB stays the source of truth. The segment store is a serving tier for
+ * catchup. If a block is missing from it, callers fall back to LevelDB.
+ */
+
+#ifndef SKALED_BLOCKSEGMENTSTORE_H
+#define SKALED_BLOCKSEGMENTSTORE_H
+
+
+class BlockSegment;
+
+// zero-copy view of a byte range inside a mapped segment
+// the view keeps the segment alive, so the mapping stays valid
+// even if the segment is dropped by retention while the view is in use
+class SegmentView {
+    ptr< BlockSegment > segment;
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+
+public:
+    SegmentView( const ptr< BlockSegment >& _segment, const uint8_t* _data, uint64_t _size );
+
+    [[nodiscard]] const uint8_t* getData() const;
+
+    [[nodiscard]] uint64_t getSize() const;
+};
+
+
+class BlockSegment {
+    string dataPath;
+    string indexPath;
+
+    uint64_t firstBlockID = 0;
+
+    int dataFd = -1;
+    int indexFd = -1;
+
+    // the whole reserved area is mapped once, file grows inside the mapping
+    uint8_t* mapping = nullptr;
+    uint64_t mappingSize = 0;
+
+    // dense index: endOffsets[i] is the end of block firstBlockID + i
+    vector< uint64_t > endOffsets;
+
+    // checks the blocks against their checksums if _verify is set
+    void loadIndex( bool _verify );
+
+    void map( uint64_t _size );
+
+public:
+    // _verify checks the blocks of an existing segment that may not have been synced
+    BlockSegment( const string& _dirName, uint64_t _firstBlockID, uint64_t _reservedSize,
+        bool _create, bool _verify = false );
+
+    ~BlockSegment();
+
+    // all calls below are synchronized by the BlockSegmentStore lock
+
+    void append( block_id _blockID, const uint8_t* _data, uint64_t _size );
+
+    // syncs the data and the index to disk
+    void seal();
+
+    bool contains( block_id _blockID ) const;
+
+    uint64_t getBlockOffset( block_id _blockID ) const;
+
+    uint64_t getBlockSize( block_id _blockID ) const;
+
+    const uint8_t* getMapping() const;
+
+    [[nodiscard]] uint64_t getFirstBlockID() const;
+
+    [[nodiscard]] uint64_t getLastBlockID() const;
+
+    [[nodiscard]] uint64_t getBlockCount() const;
+
+    [[nodiscard]] uint64_t getDataSize() const;
+
+    [[nodiscard]] uint64_t getMappingSize() const;
+
+    void removeFiles();
+
+    static string createDataFileName( uint64_t _firstBlockID );
+
+    static uint64_t computeCheckSum( const uint8_t* _data, uint64_t _size );
+};
+
+
+class BlockSegmentStore {
+    shared_mutex m;
+
+    string dirName;
+
+    uint64_t maxStoreSize = 0;
+
+    // segments by first block id
+    map< uint64_t, ptr< BlockSegment > > segments;
+
+    uint64_t totalSize = 0;
+
+    void rollSegmentIfNeeded( block_id _blockID, uint64_t _blockSize );
+
+    void dropOldSegmentsIfNeeded();
+
+    ptr< BlockSegment > findSegmentUnsafe( block_id _blockID );
+
+    static constexpr const char* SEGMENT_SUFFIX = ".seg";
+
+public:
+    static constexpr uint64_t BLOCKS_PER_SEGMENT = 4096;
+
+    static constexpr uint64_t SEGMENT_ROLL_BYTES = 64 * 1024 * 1024;
+
+    static constexpr uint64_t SEGMENT_RESERVED_BYTES = 2 * SEGMENT_ROLL_BYTES;
+
+    BlockSegmentStore( const string& _dirName, uint64_t _maxStoreSize );
+
+    void appendBlock( block_id _blockID, const ptr< vector< uint8_t > >& _serializedBlock );
+
+    bool hasBlock( block_id _blockID );
+
+    ptr< SegmentView > getBlock( block_id _blockID );
+
+    // returns views for the blocks _startBlock.._endBlock, one view per segment.
+    // Stops once _maxBytes is exceeded, but always returns at least one block.
+    // Returns nullptr if _startBlock is not in the store or if the range has a gap
+    ptr< vector< SegmentView > > getBlockRange( block_id _startBlock, block_id _endBlock,
+        uint64_t _maxBytes, const ptr< list< uint64_t > >& _blockSizes );
+
+    [[nodiscard]] uint64_t getTotalSize();
+
+    [[nodiscard]] uint64_t getSegmentCount();
+
+    [[nodiscard]] block_id getFirstBlockID();
+
+    [[nodiscard]] block_id getLastBlockID();
+};
+
+
+#endif  // SKALED_BLOCKSEGMENTSTORE_H
@@ -22,6 +22,9 @@
     @date 2019
 */
 
+#include <future>
+#include <optional>
+
 #include "leveldb/db.h"
 #include "leveldb/cache.h"
 
@@ -43,6 +46,8 @@
 #include "datastructures/TransactionList.h"
 #include "exceptions/LevelDBException.h"
 #include "node/Node.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
 
 
 #include "monitoring/LivelinessMonitor.h"
@@ -204,6 +209,38 @@ void CacheLevelDB::writeString( const string& _key, const string& _value, bool _
 }
 
 
+void CacheLevelDB::writeStrings( const vector< pair< string, string > >& _entries ) {
+    if ( _entries.empty() )
+        return;
+
+    rotateDBsIfNeeded();
+
+    uint64_t time = 0;
+    writeCounter.fetch_add( 1 );
+    auto measureTime = ( writeCounter % 100 == 0 );
+    if ( measureTime )
+        time = Time::getCurrentTimeMs();
+
+    {
+        checkForDeadLock( __FUNCTION__ );
+        lock_guard< shared_timed_mutex > lock( m );
+
+        leveldb::WriteBatch batch;
+
+        for ( auto&& [key, value] : _entries ) {
+            batch.Put( key, value );
+        }
+
+        auto status = db.back()->Write( writeOptions, &batch );
+
+        throwExceptionOnError( status );
+    }
+
+    if ( measureTime )
+        CacheLevelDB::addWriteStats( Time::getCurrentTimeMs() - time );
+}
+
+
 void CacheLevelDB::writeByteArray(
     const char* _key, size_t _keyLen, const char* _value, size_t _valueLen ) {
     CHECK_ARGUMENT( _key )
@@ -274,50 +311,109 @@ void CacheLevelDB::throwExceptionOnError( Status& _status ) {
 }
 
 
-ptr< map< string, string > > CacheLevelDB::readPrefixRange( string& _prefix ) {
-    ptr< map< string, string > > result = nullptr;
+// an iterator over a snapshot of one shard. The shard stays open while the cursor exists,
+// even if it is rotated out meanwhile. The iterator has to be deleted before its snapshot
+// is released
+class ShardCursor {
+    ptr< leveldb::DB > db;
+    const leveldb::Snapshot* snapshot = nullptr;
 
-    checkForDeadLockRead( __FUNCTION__ );
-    shared_lock< shared_timed_mutex > lock( m );
+public:
+    unique_ptr< Iterator > it;
 
-    for ( int i = LEVELDB_SHARDS - 1; i >= 0; i-- ) {
-        CHECK_STATE( db.at( i ) )
-        auto partialResult = readPrefixRangeFromDBUnsafe( _prefix, db[i] );
-        if ( partialResult ) {
-            if ( result ) {
-                result->insert( partialResult->begin(), partialResult->end() );
-            } else {
-                result = partialResult;
-            }
-        }
+    ShardCursor( const ptr< leveldb::DB >& _db, ReadOptions _options ) : db( _db ) {
+        snapshot = db->GetSnapshot();
+        _options.snapshot = snapshot;
+        it.reset( db->NewIterator( _options ) );
+    }
+
+    ~ShardCursor() {
+        it = nullptr;
+        db->ReleaseSnapshot( snapshot );
     }
+};
+
+
+typedef array< optional< ShardCursor >, LEVELDB_SHARDS > ShardCursors;
 
 
-    return result;
+// takes the snapshots of all shards, the caller holds the lock
+static void openShardCursors( const vector< ptr< leveldb::DB > >& _db,
+    const ReadOptions& _readOptions, ShardCursors& _cursors ) {
+    CHECK_STATE( _db.size() == LEVELDB_SHARDS )
+
+    for ( uint64_t i = 0; i < LEVELDB_SHARDS; i++ ) {
+        CHECK_STATE( _db[i] )
+        _cursors[i].emplace( _db[i], _readOptions );
+    }
 }
 
-ptr< map< string, string > > CacheLevelDB::readPrefixRangeFromDBUnsafe(
-    string& _prefix, const ptr< leveldb::DB >& _db, bool _lastOnly ) {
-    CHECK_ARGUMENT( _db )
 
-    ptr< map< string, string > > result = make_shared< map< string, string > >();
+// seeking and iterating reads the snapshots, which does not need the lock
+static uint64_t visitShardCursors( ShardCursors& _cursors, const string& _prefix,
+    const CacheLevelDB::PrefixVisitor& _visitor, atomic< uint64_t >& _readCounter ) {
+    for ( auto&& cursor : _cursors ) {
+        cursor->it->Seek( _prefix );
+    }
+
+    uint64_t visited = 0;
 
-    auto idb = ptr< Iterator >( _db->NewIterator( readOptions ) );
+    while ( true ) {
+        // merge the shards. Newer shards come later, and win if a key is in several of them
+        int next = -1;
 
-    if ( _lastOnly ) {
-        idb->SeekToLast();
-        if ( idb->Valid() ) {
-            ( *result )[idb->key().ToString()] = idb->value().ToString();
+        for ( int i = LEVELDB_SHARDS - 1; i >= 0; i-- ) {
+            auto& it = _cursors[i]->it;
+            if ( !it->Valid() || !it->key().starts_with( _prefix ) )
+                continue;
+            if ( next < 0 || it->key().compare( _cursors[next]->it->key() ) < 0 )
+                next = i;
         }
-        return result;
+
+        if ( next < 0 )
+            break;
+
+        auto& nextIt = _cursors[next]->it;
+        auto key = nextIt->key();
+
+        visited++;
+        _readCounter++;
+
+        auto proceed = _visitor( key, nextIt->value() );
+
+        if ( !proceed )
+            break;
+
+        for ( uint64_t i = 0; i < LEVELDB_SHARDS; i++ ) {
+            auto& it = _cursors[i]->it;
+            if ( ( int ) i != next && it->Valid() && it->key().compare( key ) == 0 )
+                it->Next();
+        }
+
+        nextIt->Next();
     }
 
-    for ( idb->Seek( _prefix ); idb->Valid() && idb->key().starts_with( _prefix ); idb->Next() ) {
-        ( *result )[idb->key().ToString()] = idb->value().ToString();
+    return visited;
+}
+
+
+uint64_t CacheLevelDB::visitPrefix( const string& _prefix, const PrefixVisitor& _visitor ) {
+    ShardCursors cursors;
+
+    {
+        checkForDeadLockRead( __FUNCTION__ );
+        shared_lock< shared_timed_mutex > lock( m );
+        openShardCursors( db, readOptions, cursors );
     }
 
+    return visitShardCursors( cursors, _prefix, _visitor, readCounter );
+}
+
 
-    return result;
+uint64_t CacheLevelDB::visitPrefixUnsafe( const string& _prefix, const PrefixVisitor& _visitor ) {
+    ShardCursors cursors;
+    openShardCursors( db, readOptions, cursors );
+    return visitShardCursors( cursors, _prefix, _visitor, readCounter );
 }
 
 
@@ -362,15 +458,24 @@ shared_ptr< leveldb::DB > CacheLevelDB::openDB( uint64_t _index ) {
 
 
 CacheLevelDB::CacheLevelDB( Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId,
-    uint64_t _maxDBSize, leveldb::Options _options, bool _isDuplicateAddOK ) {
+    uint64_t _maxDBSize, leveldb::Options _options, bool _isDuplicateAddOK )
+    : CacheLevelDB( _sChain, _dirName, _prefix, _nodeId, _maxDBSize, _options,
+          _sChain ? _sChain->getTotalSigners() : 0, _sChain ? _sChain->getRequiredSigners() : 0,
+          _isDuplicateAddOK ) {}
+
+
+CacheLevelDB::CacheLevelDB( Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId,
+    uint64_t _maxDBSize, leveldb::Options _options, uint64_t _totalSigners,
+    uint64_t _requiredSigners, bool _isDuplicateAddOK ) {
     CHECK_ARGUMENT( _sChain );
     CHECK_ARGUMENT( _maxDBSize > 0 );
+    CHECK_ARGUMENT( _requiredSigners <= _totalSigners );
 
     this->sChain = _sChain;
     this->nodeId = _nodeId;
     this->prefix = _prefix;
-    this->totalSigners = _sChain->getTotalSigners();
-    this->requiredSigners = _sChain->getRequiredSigners();
+    this->totalSigners = _totalSigners;
+    this->requiredSigners = _requiredSigners;
     this->dirName = _dirName + "/" + _prefix;
     this->maxDBSize = _maxDBSize;
     this->options = _options;
@@ -388,8 +493,17 @@ CacheLevelDB::CacheLevelDB( Schain* _sChain, string& _dirName, string& _prefix,
     }
 
 
+    // shards are opened in parallel, each one replays its own log
+    TaskExecutor openExecutor( "DBShardOpen", BlockingIOPool::getShared() );
+
+    vector< future< ptr< DB > > > shards;
+
     for ( auto i = highestDBIndex - LEVELDB_SHARDS + 1; i <= highestDBIndex; i++ ) {
-        auto dbase = openDB( i );
+        shards.push_back( openExecutor.submit( [this, i]() { return openDB( i ); } ) );
+    }
+
+    for ( auto&& shard : shards ) {
+        auto dbase = shard.get();
         CHECK_STATE( dbase );
         db.push_back( dbase );
     }
@@ -570,16 +684,29 @@ ptr< map< schain_index, string > > CacheLevelDB::writeByteArrayToSet(
 ptr< map< schain_index, string > > CacheLevelDB::readSetUnsafe( block_id _blockId ) {
     auto enoughSet = make_shared< map< schain_index, string > >();
 
-    for ( uint64_t i = 1; i <= totalSigners; i++ ) {
-        auto key = createKey( _blockId, schain_index( i ) );
-        auto entry = readStringUnsafe( key );
+    auto prefix = createKey( _blockId ) + ":";
 
-        if ( entry != "" )
-            ( *enoughSet )[schain_index( i )] = entry;
-        if ( enoughSet->size() == requiredSigners ) {
-            break;
+    // keys sort as strings, so ":10" comes before ":2" and the whole block has to be visited
+    visitPrefixUnsafe( prefix, [&]( const leveldb::Slice& _key, const leveldb::Slice& _value ) {
+        uint64_t index = 0;
+
+        for ( auto i = prefix.size(); i < _key.size(); i++ ) {
+            if ( !isdigit( _key[i] ) )
+                return true;
+            index = index * 10 + ( _key[i] - '0' );
+            if ( index > totalSigners )
+                return true;
         }
-    }
+
+        if ( index > 0 && _value.size() > 0 )
+            ( *enoughSet )[schain_index( index )] = _value.ToString();
+
+        return true;
+    } );
+
+    // keep the lowest indices, as the entries would be read one by one
+    while ( enoughSet->size() > requiredSigners )
+        enoughSet->erase( prev( enoughSet->end() ) );
 
     return enoughSet;
 }
@@ -647,18 +774,7 @@ ptr< map< schain_index, string > > CacheLevelDB::writeByteArrayToSetUnsafe(
         return nullptr;
     }
 
-    auto enoughSet = make_shared< map< schain_index, string > >();
-
-    for ( uint64_t i = 1; i <= totalSigners; i++ ) {
-        auto key = createKey( _blockId, schain_index( i ) );
-        auto entry = readStringUnsafe( key );
-
-        if ( entry != "" )
-            ( *enoughSet )[schain_index( i )] = entry;
-        if ( enoughSet->size() == requiredSigners ) {
-            break;
-        }
-    }
+    auto enoughSet = readSetUnsafe( _blockId );
 
     CHECK_STATE( enoughSet->size() == requiredSigners );
 
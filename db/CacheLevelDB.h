@@ -74,6 +74,9 @@ protected:
 
     void writeString( const string& key1, const string& value1, bool overWrite = false );
 
+    // writes all entries in one batch, overwriting existing keys
+    void writeStrings( const vector< pair< string, string > >& _entries );
+
     ptr< map< schain_index, string > > writeStringToSet(
         const string& _value, block_id _blockId, schain_index _index );
 
@@ -120,8 +123,21 @@ protected:
     CacheLevelDB( Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId,
         uint64_t _maxDBSize, leveldb::Options _options, bool _isDuplicateAddOK = false );
 
-    ptr< map< string, string > > readPrefixRangeFromDBUnsafe(
-        string& _prefix, const ptr< leveldb::DB >& _db, bool lastOnly = false );
+    // takes the signer counts instead of asking the chain, which needs a running node
+    CacheLevelDB( Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId,
+        uint64_t _maxDBSize, leveldb::Options _options, uint64_t _totalSigners,
+        uint64_t _requiredSigners, bool _isDuplicateAddOK = false );
+
+public:
+    // receives views of the key and the value that are valid only during the call, returns
+    // false to stop the iteration
+    typedef function< bool( const leveldb::Slice& _key, const leveldb::Slice& _value ) >
+        PrefixVisitor;
+
+protected:
+    // the same as visitPrefix, for callers that hold the lock. The visitor must not use
+    // the locking methods of this database
+    uint64_t visitPrefixUnsafe( const string& _prefix, const PrefixVisitor& _visitor );
 
 public:
     void destroy();
@@ -141,12 +157,17 @@ public:
 
     uint64_t visitKeys( KeyVisitor* _visitor, uint64_t _maxKeysToVisit );
 
+    // visits the entries whose keys start with _prefix in key order over all shards, without
+    // copying them. A key that is in several shards is visited once with the newest value.
+    // The shards are read from snapshots taken at the start, and the lock is only held while
+    // the snapshots are taken, so the visitor may write to this database. Returns the number
+    // of visited entries
+    uint64_t visitPrefix( const string& _prefix, const PrefixVisitor& _visitor );
+
     virtual ~CacheLevelDB();
 
     uint64_t getActiveDBSize();
 
-    ptr< map< string, string > > readPrefixRange( string& _prefix );
-
     static void addWriteStats( uint64_t _time );
     static void addReadStats( uint64_t _time );
 
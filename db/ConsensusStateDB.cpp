@@ -40,6 +40,13 @@ _Pragma( "GCC diagnostic push" ) _Pragma( "GCC diagnostic ignored \"-Wunused-par
           LevelDBOptions::getConsensusStateDBOptions(), false ) {}
 
 
+// the part of a key after the prefix it was found by
+static string keySuffix( const leveldb::Slice& _key, const string& _prefix ) {
+    CHECK_STATE( _key.starts_with( _prefix ) )
+    return string( _key.data() + _prefix.size(), _key.size() - _prefix.size() );
+}
+
+
 const string& ConsensusStateDB::getFormatVersion() {
     static const string version = "1.0";
     return version;
@@ -209,19 +216,11 @@ pair< ptr< map< bin_consensus_round, set< schain_index > > >,
     ptr< map< bin_consensus_round, set< schain_index > > > >
 ConsensusStateDB::readBVBVotes( block_id _blockId, schain_index _proposerIndex ) {
     auto prefix = createKey( _blockId, _proposerIndex ).append( ":bvb:" );
-    auto keysAndValues = readPrefixRange( prefix );
-
     auto trueMap = make_shared< map< bin_consensus_round, set< schain_index > > >();
     auto falseMap = make_shared< map< bin_consensus_round, set< schain_index > > >();
 
-
-    if ( keysAndValues == nullptr ) {
-        return { trueMap, falseMap };
-    }
-
-    for ( auto&& item : *keysAndValues ) {
-        CHECK_STATE( item.first.rfind( prefix ) == 0 );
-        auto info = stringstream( item.first.substr( prefix.size() ) );
+    visitPrefix( prefix, [&]( const leveldb::Slice& _key, const leveldb::Slice& ) {
+        auto info = stringstream( keySuffix( _key, prefix ) );
         uint64_t round;
         uint64_t voterIndex;
         uint32_t value;
@@ -234,7 +233,8 @@ ConsensusStateDB::readBVBVotes( block_id _blockId, schain_index _proposerIndex )
         ptr< map< bin_consensus_round, set< schain_index > > > outputMap;
         outputMap = ( value > 0 ? trueMap : falseMap );
         ( *outputMap )[bin_consensus_round( round )].insert( schain_index( voterIndex ) );
-    }
+        return true;
+    } );
 
     return { trueMap, falseMap };
 }
@@ -254,17 +254,9 @@ ptr< map< bin_consensus_round, set< bin_consensus_value > > > ConsensusStateDB::
     auto result = make_shared< map< bin_consensus_round, set< bin_consensus_value > > >();
 
     auto prefix = createKey( _blockId, _proposerIndex ).append( ":bin:" );
-    auto keysAndValues = readPrefixRange( prefix );
-
-    if ( keysAndValues == nullptr ) {
-        return result;
-    }
-
-    for ( auto&& item : *keysAndValues ) {
-        CHECK_STATE( item.first.rfind( prefix ) == 0 );
 
-
-        auto info = stringstream( item.first.substr( prefix.size() ) );
+    visitPrefix( prefix, [&]( const leveldb::Slice& _key, const leveldb::Slice& ) {
+        auto info = stringstream( keySuffix( _key, prefix ) );
         uint64_t round;
         uint32_t value;
         info >> round;
@@ -272,7 +264,8 @@ ptr< map< bin_consensus_round, set< bin_consensus_value > > > ConsensusStateDB::
         info >> value;
         bin_consensus_value b( value > 0 ? 1 : 0 );
         ( *result )[bin_consensus_round( round )].insert( b );
-    }
+        return true;
+    } );
     return result;
 }
 
@@ -281,17 +274,9 @@ ptr< map< bin_consensus_round, bin_consensus_value > > ConsensusStateDB::readPRs
     auto result = make_shared< map< bin_consensus_round, bin_consensus_value > >();
 
     auto prefix = createKey( _blockId, _proposerIndex ).append( ":pr:" );
-    auto keysAndValues = readPrefixRange( prefix );
-
-    if ( keysAndValues == nullptr ) {
-        return result;
-    }
-
-    for ( auto&& item : *keysAndValues ) {
-        CHECK_STATE( item.first.rfind( prefix ) == 0 );
-
 
-        auto info = stringstream( item.first.substr( prefix.size() ) );
+    visitPrefix( prefix, [&]( const leveldb::Slice& _key, const leveldb::Slice& ) {
+        auto info = stringstream( keySuffix( _key, prefix ) );
         uint64_t round;
         uint32_t value;
         info >> round;
@@ -299,7 +284,8 @@ ptr< map< bin_consensus_round, bin_consensus_value > > ConsensusStateDB::readPRs
         info >> value;
         bin_consensus_value b( value > 0 ? 1 : 0 );
         ( *result )[bin_consensus_round( round )] = b;
-    }
+        return true;
+    } );
     return result;
 }
 
@@ -332,15 +318,8 @@ ConsensusStateDB::readAUXVotes(
 
     auto prefix = key.append( ":aux:" );
 
-    auto keysAndValues = readPrefixRange( prefix );
-
-    if ( keysAndValues == nullptr ) {
-        return { trueMap, falseMap };
-    }
-
-    for ( auto&& item : *keysAndValues ) {
-        CHECK_STATE( item.first.rfind( prefix ) == 0 )
-        auto info = stringstream( item.first.substr( prefix.size() ) );
+    visitPrefix( prefix, [&]( const leveldb::Slice& _key, const leveldb::Slice& _value ) {
+        auto info = stringstream( keySuffix( _key, prefix ) );
         uint64_t round;
         uint64_t voterIndex;
         uint32_t value;
@@ -354,9 +333,10 @@ ConsensusStateDB::readAUXVotes(
         outputMap = ( value > 0 ? trueMap : falseMap );
 
         ( *outputMap )[bin_consensus_round( round )][schain_index( voterIndex )] =
-            _cryptoManager->createSigShare( item.second, getSchain()->getSchainID(), _blockId,
-                voterIndex, ( ( uint64_t ) round ) <= 3 );
-    }
+            _cryptoManager->createSigShare( _value.ToString(), getSchain()->getSchainID(),
+                _blockId, voterIndex, ( ( uint64_t ) round ) <= 3 );
+        return true;
+    } );
 
     return { trueMap, falseMap };
 }
@@ -40,6 +40,9 @@
 #include "chains/Schain.h"
 
 #include "BlockDB.h"
+#include "BlockSegmentStore.h"
+#include "LevelDBOptions.h"
+#include "SerializedBlockCache.h"
 
 
 void test_committed_block_save() {
@@ -56,7 +59,8 @@ void test_committed_block_save() {
     }
 
 
-    auto db = make_shared< BlockDB >( sChain.get(), dirName, fileName, node_id( 1 ), 5000000 );
+    auto db = make_shared< BlockDB >(
+        sChain.get(), dirName, fileName, node_id( 1 ), 5000000, 5000000 );
 
     for ( int i = 1; i < 500; i++ ) {
         auto t = CommittedBlock::createRandomSample( cryptoManager, i, gen, ubyte );
@@ -75,3 +79,308 @@ TEST_CASE( "Save/read block", "[block-save-read-db]" ) {
     SECTION( "Test successful save/read" )
     test_committed_block_save();
 }
+
+
+void test_block_store_range_read_benchmark() {
+    auto sChain = make_shared< Schain >();
+    static string dirName = "/tmp";
+    static string fileName = "test_block_store_range_read";
+    boost::random::mt19937 gen;
+    auto cryptoManager = make_shared< CryptoManager >( *sChain );
+
+    boost::random::uniform_int_distribution<> ubyte( 0, 255 );
+
+    if ( std::system( ( "rm -rf " + dirName + "/" + fileName ).c_str() ) != 0 ) {
+        BOOST_THROW_EXCEPTION( runtime_error( "Remove failed" ) );
+    }
+
+    // large enough so that neither LevelDB nor the segment store drop blocks
+    auto db = make_shared< BlockDB >(
+        sChain.get(), dirName, fileName, node_id( 1 ), 1000000000, 1000000000 );
+
+    const uint64_t blockCount = 1000;
+    const uint64_t iterations = 10;
+
+    for ( uint64_t i = 1; i <= blockCount; i++ ) {
+        db->saveBlock( CommittedBlock::createRandomSample( cryptoManager, i, gen, ubyte ) );
+    }
+
+    REQUIRE( db->getSegmentStore()->getLastBlockID() == blockCount );
+
+    uint64_t levelDBBytes = 0;
+    auto start = chrono::steady_clock::now();
+
+    for ( uint64_t k = 0; k < iterations; k++ ) {
+        auto serializedBlocks = make_shared< vector< uint8_t > >();
+        for ( uint64_t i = 1; i <= blockCount; i++ ) {
+            auto block = db->getSerializedBlockFromLevelDB( i );
+            REQUIRE( block );
+            serializedBlocks->insert( serializedBlocks->end(), block->begin(), block->end() );
+        }
+        levelDBBytes = serializedBlocks->size();
+    }
+
+    auto levelDBUs =
+        chrono::duration_cast< chrono::microseconds >( chrono::steady_clock::now() - start )
+            .count();
+
+    uint64_t segmentBytes = 0;
+    start = chrono::steady_clock::now();
+
+    for ( uint64_t k = 0; k < iterations; k++ ) {
+        auto blockSizes = make_shared< list< uint64_t > >();
+        auto views = db->getSegmentStore()->getBlockRange(
+            1, blockCount, MAX_CATCHUP_DOWNLOAD_BYTES, blockSizes );
+        REQUIRE( views );
+        REQUIRE( blockSizes->size() == blockCount );
+        segmentBytes = 0;
+        for ( auto&& view : *views ) {
+            segmentBytes += view.getSize();
+        }
+    }
+
+    auto segmentUs =
+        chrono::duration_cast< chrono::microseconds >( chrono::steady_clock::now() - start )
+            .count();
+
+    REQUIRE( segmentBytes == levelDBBytes );
+
+    // the two paths must return identical bytes
+    for ( uint64_t i = 1; i <= blockCount; i += 97 ) {
+        auto view = db->getSegmentStore()->getBlock( i );
+        auto block = db->getSerializedBlockFromLevelDB( i );
+        REQUIRE( view );
+        REQUIRE( view->getSize() == block->size() );
+        REQUIRE( memcmp( view->getData(), block->data(), block->size() ) == 0 );
+    }
+
+    cerr << "BLOCK_RANGE_READ:BLOCKS:" << blockCount << ":BYTES:" << levelDBBytes
+         << ":LEVELDB_US:" << levelDBUs / iterations << ":SEGMENT_US:" << segmentUs / iterations
+         << endl;
+}
+
+TEST_CASE( "Block store sequential range read benchmark", "[block-store-benchmark]" ) {
+    SECTION( "Compare LevelDB and segment store range reads" )
+    test_block_store_range_read_benchmark();
+}
+
+
+void test_serialized_block_cache() {
+    SerializedBlockCache cache( 1000 );
+
+    auto blockSizes = make_shared< list< uint64_t > >( list< uint64_t >{ 100, 98 } );
+    auto range = make_shared< vector< uint8_t > >( 200, 'x' );
+
+    cache.putRange( 1, 2, range, blockSizes );
+    cache.putBlock( 1, make_shared< vector< uint8_t > >( 100, 'y' ) );
+
+    auto sizes = make_shared< list< uint64_t > >();
+    REQUIRE( cache.getRange( 1, 2, sizes ) == range );
+    REQUIRE( *sizes == *blockSizes );
+
+    // blocks and ranges with the same ids are different entries
+    REQUIRE( cache.getBlock( 1 )->at( 0 ) == 'y' );
+    REQUIRE( cache.getRange( 1, 3, make_shared< list< uint64_t > >() ) == nullptr );
+
+    // compressed responses are cached per level
+    auto frames = make_shared< vector< uint8_t > >( 50, 'z' );
+    cache.putCompressedRange( 1, 2, 6, frames );
+    REQUIRE( cache.getCompressedRange( 1, 2, 6 ) == frames );
+    REQUIRE( cache.getCompressedRange( 1, 2, 1 ) == nullptr );
+    REQUIRE( cache.getRange( 1, 2, make_shared< list< uint64_t > >() ) == range );
+
+    // the oldest entries are evicted once the byte limit is exceeded
+    for ( uint64_t i = 10; i < 20; i++ ) {
+        cache.putBlock( i, make_shared< vector< uint8_t > >( 100 ) );
+    }
+
+    REQUIRE( cache.getTotalBytes() <= 1000 );
+    REQUIRE( cache.getRange( 1, 2, make_shared< list< uint64_t > >() ) == nullptr );
+    REQUIRE( cache.getBlock( 19 ) );
+}
+
+TEST_CASE( "Serialized block cache", "[serialized-block-cache]" ) {
+    SECTION( "Test byte bounded eviction" )
+    test_serialized_block_cache();
+}
+
+
+class PrefixTestDB : public CacheLevelDB {
+public:
+    PrefixTestDB( Schain* _sChain, string& _dirName, string& _prefix, uint64_t _maxDBSize )
+        : CacheLevelDB( _sChain, _dirName, _prefix, node_id( 1 ), _maxDBSize,
+              LevelDBOptions::getSmallDBOptions() ) {}
+
+    const string& getFormatVersion() override {
+        static const string version = "1.0";
+        return version;
+    }
+
+    using CacheLevelDB::readString;
+    using CacheLevelDB::writeString;
+};
+
+
+void test_prefix_visit() {
+    auto sChain = make_shared< Schain >();
+    static string dirName = "/tmp";
+    static string fileName = "test_prefix_visit";
+
+    if ( std::system( ( "rm -rf " + dirName + "/" + fileName ).c_str() ) != 0 ) {
+        BOOST_THROW_EXCEPTION( runtime_error( "Remove failed" ) );
+    }
+
+    // small enough to rotate the shards every few writes
+    auto db = make_shared< PrefixTestDB >( sChain.get(), dirName, fileName, 20000 );
+
+    string filler( 1000, 'x' );
+
+    for ( uint64_t i = 0; i < 40; i++ ) {
+        db->writeString( "p:" + to_string( i ), "old" + filler );
+        db->writeString( "q:" + to_string( i ), "other" );
+    }
+
+    // newer values of some keys end up in newer shards
+    for ( uint64_t i = 20; i < 40; i += 2 ) {
+        db->writeString( "p:" + to_string( i ), "new" + filler, true );
+    }
+
+    REQUIRE( db->findMaxMinDBIndex().first > LEVELDB_SHARDS );
+
+    string previous;
+    uint64_t expected = 0;
+
+    for ( uint64_t i = 0; i < 40; i++ ) {
+        string key = "p:" + to_string( i );
+        if ( !db->readString( key ).empty() )
+            expected++;
+    }
+
+    vector< pair< string, string > > entries;
+    auto visited =
+        db->visitPrefix( "p:", [&]( const leveldb::Slice& _key, const leveldb::Slice& _value ) {
+            entries.emplace_back( _key.ToString(), _value.ToString() );
+            return true;
+        } );
+    REQUIRE( visited == expected );
+    REQUIRE( entries.size() == expected );
+
+    for ( auto&& [key, value] : entries ) {
+        REQUIRE( key.rfind( "p:", 0 ) == 0 );
+        REQUIRE( key > previous );
+        REQUIRE( value == db->readString( key ) );
+        previous = key;
+    }
+
+    uint64_t count = 0;
+    visited = db->visitPrefix(
+        "p:", [&]( const leveldb::Slice&, const leveldb::Slice& ) { return ++count < 5; } );
+    REQUIRE( visited == 5 );
+}
+
+
+void test_prefix_visit_writes() {
+    auto sChain = make_shared< Schain >();
+    static string dirName = "/tmp";
+    static string fileName = "test_prefix_visit_writes";
+
+    if ( std::system( ( "rm -rf " + dirName + "/" + fileName ).c_str() ) != 0 ) {
+        BOOST_THROW_EXCEPTION( runtime_error( "Remove failed" ) );
+    }
+
+    auto db = make_shared< PrefixTestDB >( sChain.get(), dirName, fileName, 1000000000 );
+
+    for ( uint64_t i = 0; i < 20; i++ ) {
+        db->writeString( "p:" + to_string( i ), "value" );
+    }
+
+    // the lock is not held during the visit, so the visitor may write. The written entries
+    // are not in the snapshot that is visited
+    auto visited = db->visitPrefix( "p:", [&]( const leveldb::Slice& _key, const leveldb::Slice& ) {
+        auto copy = "p:" + _key.ToString() + ":copy";
+        db->writeString( copy, "copy" );
+        REQUIRE( db->readString( copy ) == "copy" );
+        return true;
+    } );
+    REQUIRE( visited == 20 );
+
+    visited = db->visitPrefix(
+        "p:", [&]( const leveldb::Slice&, const leveldb::Slice& ) { return true; } );
+    REQUIRE( visited == 40 );
+}
+
+TEST_CASE( "Visit prefix over shards", "[prefix-visit-db]" ) {
+    SECTION( "Test merged order, newest values and early stop" )
+    test_prefix_visit();
+
+    SECTION( "Test writes from the visitor" )
+    test_prefix_visit_writes();
+}
+
+
+class SetTestDB : public CacheLevelDB {
+public:
+    SetTestDB( Schain* _sChain, string& _dirName, string& _prefix, uint64_t _totalSigners,
+        uint64_t _requiredSigners )
+        : CacheLevelDB( _sChain, _dirName, _prefix, node_id( 1 ), 5000000,
+              LevelDBOptions::getSmallDBOptions(), _totalSigners, _requiredSigners ) {}
+
+    const string& getFormatVersion() override {
+        static const string version = "1.0";
+        return version;
+    }
+
+    using CacheLevelDB::createKey;
+    using CacheLevelDB::readSet;
+    using CacheLevelDB::writeString;
+    using CacheLevelDB::writeStringToSet;
+};
+
+
+void test_read_set() {
+    auto sChain = make_shared< Schain >();
+    static string dirName = "/tmp";
+    static string fileName = "test_read_set";
+
+    if ( std::system( ( "rm -rf " + dirName + "/" + fileName ).c_str() ) != 0 ) {
+        BOOST_THROW_EXCEPTION( runtime_error( "Remove failed" ) );
+    }
+
+    // 12 signers need 9, so the set spans indices that sort as ":10" < ":2"
+    auto db = make_shared< SetTestDB >( sChain.get(), dirName, fileName, 12, 9 );
+
+    // block 10 shares the "1" prefix digits and a per sender key shares the block prefix
+    for ( uint64_t i = 1; i <= 12; i++ )
+        db->writeStringToSet( "other" + to_string( i ), 10, i );
+    db->writeString( db->createKey( 1, schain_index( 2 ), schain_index( 3 ) ), "sender" );
+
+    ptr< map< schain_index, string > > enoughSet;
+
+    for ( uint64_t i = 12; i >= 4; i-- ) {
+        REQUIRE( enoughSet == nullptr );
+        enoughSet = db->writeStringToSet( "value" + to_string( i ), 1, i );
+    }
+
+    REQUIRE( enoughSet );
+    REQUIRE( enoughSet->size() == 9 );
+    REQUIRE( enoughSet->begin()->first == 4 );
+
+    for ( uint64_t i = 3; i >= 2; i-- )
+        REQUIRE( db->writeStringToSet( "value" + to_string( i ), 1, i ) == nullptr );
+
+    auto set = db->readSet( 1 );
+
+    REQUIRE( set->size() == 9 );
+
+    uint64_t expected = 2;
+    for ( auto&& [index, value] : *set ) {
+        REQUIRE( ( uint64_t ) index == expected );
+        REQUIRE( value == "value" + to_string( expected ) );
+        expected++;
+    }
+}
+
+TEST_CASE( "Read set with more than 9 signers", "[read-set-db]" ) {
+    SECTION( "Test numeric signer order and foreign keys" )
+    test_read_set();
+}
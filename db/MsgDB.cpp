@@ -33,21 +33,24 @@
 #include "network/Buffer.h"
 #include "LevelDBOptions.h"
 #include "CacheLevelDB.h"
+#include "utils/Time.h"
 
 
 MsgDB::MsgDB(
     Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId, uint64_t _maxDBSize )
     : CacheLevelDB( _sChain, _dirName, _prefix, _nodeId, _maxDBSize,
-          LevelDBOptions::getMsgDBOptions(), false ) {}
+          LevelDBOptions::getMsgDBOptions(), false ) {
+    // keys of a restarted node do not collide with the keys saved before the restart, as long as
+    // it saved less than a message per microsecond
+    msgCounter = Time::getCurrentTimeMs() * 1000;
+}
 
 
 bool MsgDB::saveMsg( const ptr< NetworkMessage >& _msg ) {
-    static atomic< uint64_t > msgCounter = 0;
-
     CHECK_ARGUMENT( _msg )
 
     try {
-        auto serialized = _msg->serializeToString();
+        auto serialized = *_msg->getSerialized();
 
         CHECK_STATE( !serialized.empty() )
 
@@ -71,21 +74,39 @@ bool MsgDB::saveMsg( const ptr< NetworkMessage >& _msg ) {
     }
 }
 
-ptr< vector< ptr< NetworkMessage > > > MsgDB::getMessages( block_id _blockID ) {
-    auto result = make_shared< vector< ptr< NetworkMessage > > >();
+void MsgDB::saveMsgs( const vector< ptr< NetworkMessage > >& _msgs ) {
+    try {
+        vector< pair< string, string > > entries;
+        entries.reserve( _msgs.size() );
 
+        for ( auto&& msg : _msgs ) {
+            CHECK_ARGUMENT( msg )
+            entries.emplace_back(
+                createKey( msg->getBlockID(), msgCounter++ ), *msg->getSerialized() );
+        }
 
-    try {
-        string prefix = getFormatVersion() + ":" + to_string( _blockID );
+        writeStrings( entries );
 
-        auto messages = readPrefixRange( prefix );
+    } catch ( ... ) {
+        throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
+    }
+}
+
+ptr< vector< ptr< NetworkMessage > > > MsgDB::getMessages( block_id _blockID ) {
+    auto result = make_shared< vector< ptr< NetworkMessage > > >();
 
-        if ( !messages )
-            return result;
 
-        for ( auto&& message : *messages ) {
-            result->push_back( NetworkMessage::parseMessage( message.second, getSchain() ) );
-        }
+    try {
+        string prefix = getFormatVersion() + ":" + to_string( _blockID ) + ":";
+
+        visitPrefix( prefix, [&]( const leveldb::Slice&, const leveldb::Slice& _value ) {
+            auto serialized = _value.ToString();
+            auto msg = NetworkMessage::parseMessage( serialized, getSchain() );
+            // resends use the saved bytes
+            msg->setSerialized( std::move( serialized ) );
+            result->push_back( msg );
+            return true;
+        } );
 
         return result;
 
@@ -34,12 +34,17 @@ class NetworkMessage;
 class MsgDB : public CacheLevelDB {
     recursive_mutex m;
 
+    atomic< uint64_t > msgCounter = 0;
+
 public:
     MsgDB(
         Schain* _sChain, string& _dirName, string& _prefix, node_id _nodeId, uint64_t _maxDBSize );
 
     bool saveMsg( const ptr< NetworkMessage >& _msg );
 
+    // saves the messages in one write
+    void saveMsgs( const vector< ptr< NetworkMessage > >& _msgs );
+
     ptr< vector< ptr< NetworkMessage > > > getMessages( block_id _blockID );
 
     const string& getFormatVersion() override;
@@ -35,6 +35,9 @@ PriceDB::PriceDB(
           LevelDBOptions::getPriceDBOptions(), false ) {}
 
 
+// the version is part of every key, so it is kept at 1.0: decimal prices written by older
+// releases stay readable next to the tagged binary ones. Older releases can not decode binary
+// prices, so downgrading a node after it wrote prices in this format is not supported.
 const string& PriceDB::getFormatVersion() {
     static const string version = "1.0";
     return version;
@@ -59,7 +62,7 @@ u256 PriceDB::readPrice( block_id _blockID ) {
                 "Price for block " + to_string( _blockID ) + " is unknown", __CLASS_NAME__ ) );
         }
 
-        return u256( price.c_str() );
+        return decodePrice( price );
 
     } catch ( ExitRequestedException& ) {
         throw;
@@ -75,12 +78,64 @@ void PriceDB::savePrice( const u256& _price, block_id _blockID ) {
         auto key = createKey( _blockID );
         CHECK_STATE( key != "" )
 
-        auto value = _price.str();
+        writeString( key, encodePrice( _price ) );
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( ... ) {
+        throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
+    }
+}
+
+void PriceDB::savePrices( const vector< pair< block_id, u256 > >& _prices ) {
+    LOG( trace, "Save prices for " << to_string( _prices.size() ) << " blocks" );
 
-        writeString( key, value );
+    try {
+        vector< pair< string, string > > entries;
+
+        for ( auto&& [blockID, price] : _prices ) {
+            auto key = createKey( blockID );
+            CHECK_STATE( key != "" )
+            entries.emplace_back( key, encodePrice( price ) );
+        }
+
+        writeStrings( entries );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
         throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
     }
 }
+
+bool PriceDB::priceExists( block_id _blockID ) {
+    return keyExists( createKey( _blockID ) );
+}
+
+string PriceDB::encodePrice( const u256& _price ) {
+    string result( 33, 0 );
+    result[0] = BINARY_PRICE_TAG;
+
+    // big endian
+    auto value = _price;
+    for ( uint64_t i = 32; i > 0; i-- ) {
+        result[i] = ( char ) ( uint8_t ) ( value & 0xFF );
+        value >>= 8;
+    }
+
+    return result;
+}
+
+u256 PriceDB::decodePrice( const string& _value ) {
+    CHECK_ARGUMENT( !_value.empty() );
+
+    if ( _value[0] != BINARY_PRICE_TAG )
+        return u256( _value.c_str() );
+
+    CHECK_ARGUMENT( _value.size() == 33 );
+
+    u256 result = 0;
+    for ( uint64_t i = 1; i < _value.size(); i++ ) {
+        result = ( result << 8 ) | ( uint8_t ) _value[i];
+    }
+
+    return result;
+}
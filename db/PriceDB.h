@@ -29,6 +29,13 @@
 #include "CacheLevelDB.h"
 
 class PriceDB : public CacheLevelDB {
+    // binary values start with this byte, which decimal values written before never do
+    static constexpr char BINARY_PRICE_TAG = 1;
+
+    static string encodePrice( const u256& _price );
+
+    static u256 decodePrice( const string& _value );
+
 public:
     const string& getFormatVersion() override;
 
@@ -38,6 +45,11 @@ public:
     u256 readPrice( block_id _blockID );
 
     void savePrice( const u256& _price, block_id _blockID );
+
+    void savePrices( const vector< pair< block_id, u256 > >& _prices );
+
+    // false if the price of the block is not in the db
+    bool priceExists( block_id _blockID );
 };
 
 
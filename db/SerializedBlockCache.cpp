@@ -0,0 +1,150 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file SerializedBlockCache.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+
+#include "SerializedBlockCache.h"
+
+
+SerializedBlockCache::SerializedBlockCache( uint64_t _maxBytes ) : maxBytes( _maxBytes ) {
+    CHECK_ARGUMENT( _maxBytes > 0 );
+}
+
+
+ptr< SerializedBlockCache::Entry > SerializedBlockCache::get( const Key& _key ) {
+    LOCK( m );
+
+    auto it = index.find( _key );
+
+    if ( it == index.end() ) {
+        misses++;
+        return nullptr;
+    }
+
+    hits++;
+
+    entries.splice( entries.begin(), entries, it->second );
+
+    return make_shared< Entry >( *it->second );
+}
+
+
+void SerializedBlockCache::put( Entry&& _entry ) {
+    CHECK_ARGUMENT( _entry.data );
+
+    auto size = _entry.data->size();
+
+    // an entry that does not fit would evict everything else
+    if ( size > maxBytes / 2 )
+        return;
+
+    LOCK( m );
+
+    if ( index.count( _entry.key ) > 0 )
+        return;
+
+    entries.push_front( std::move( _entry ) );
+    index[entries.front().key] = entries.begin();
+    totalBytes += size;
+
+    while ( totalBytes > maxBytes ) {
+        auto& last = entries.back();
+        totalBytes -= last.data->size();
+        index.erase( last.key );
+        entries.pop_back();
+    }
+}
+
+
+ptr< vector< uint8_t > > SerializedBlockCache::getBlock( block_id _blockID ) {
+    auto entry = get( Key( BLOCK, ( uint64_t ) _blockID, ( uint64_t ) _blockID, 0 ) );
+    return entry ? entry->data : nullptr;
+}
+
+
+void SerializedBlockCache::putBlock(
+    block_id _blockID, const ptr< vector< uint8_t > >& _serializedBlock ) {
+    CHECK_ARGUMENT( _serializedBlock );
+    put( { Key( BLOCK, ( uint64_t ) _blockID, ( uint64_t ) _blockID, 0 ), _serializedBlock,
+        nullptr } );
+}
+
+
+ptr< vector< uint8_t > > SerializedBlockCache::getRange(
+    block_id _startBlock, block_id _endBlock, const ptr< list< uint64_t > >& _blockSizes ) {
+    CHECK_ARGUMENT( _blockSizes );
+
+    auto entry = get( Key( RANGE, ( uint64_t ) _startBlock, ( uint64_t ) _endBlock, 0 ) );
+
+    if ( !entry )
+        return nullptr;
+
+    _blockSizes->insert( _blockSizes->end(), entry->blockSizes->begin(), entry->blockSizes->end() );
+
+    return entry->data;
+}
+
+
+void SerializedBlockCache::putRange( block_id _startBlock, block_id _endBlock,
+    const ptr< vector< uint8_t > >& _serializedRange, const ptr< list< uint64_t > >& _blockSizes ) {
+    CHECK_ARGUMENT( _serializedRange );
+    CHECK_ARGUMENT( _blockSizes );
+
+    // cached entries are shared between requests, so they keep their own copy of the sizes
+    put( { Key( RANGE, ( uint64_t ) _startBlock, ( uint64_t ) _endBlock, 0 ), _serializedRange,
+        make_shared< list< uint64_t > >( *_blockSizes ) } );
+}
+
+
+ptr< vector< uint8_t > > SerializedBlockCache::getCompressedRange(
+    block_id _startBlock, block_id _endBlock, uint64_t _level ) {
+    auto entry = get( Key( COMPRESSED_RANGE, ( uint64_t ) _startBlock, ( uint64_t ) _endBlock,
+        ( uint8_t ) _level ) );
+    return entry ? entry->data : nullptr;
+}
+
+
+void SerializedBlockCache::putCompressedRange( block_id _startBlock, block_id _endBlock,
+    uint64_t _level, const ptr< vector< uint8_t > >& _frames ) {
+    CHECK_ARGUMENT( _frames );
+    CHECK_ARGUMENT( _level > 0 && _level <= UINT8_MAX );
+    put( { Key( COMPRESSED_RANGE, ( uint64_t ) _startBlock, ( uint64_t ) _endBlock,
+               ( uint8_t ) _level ),
+        _frames, nullptr } );
+}
+
+
+uint64_t SerializedBlockCache::getTotalBytes() {
+    LOCK( m );
+    return totalBytes;
+}
+
+
+string SerializedBlockCache::getStats() {
+    uint64_t h = hits;
+    uint64_t total = h + misses;
+    return to_string( total == 0 ? 0 : h * 100 / total ) + "/" +
+           to_string( getTotalBytes() / ( 1024 * 1024 ) );
+}
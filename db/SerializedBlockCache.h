@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file SerializedBlockCache.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+/*
+ * Memory bounded cache of serialized committed blocks and of assembled catchup responses
+ * (the JSON array of a block range, and its compressed frames for each compression level),
+ * shared by all catchup requests served by the node.
+ * Committed blocks never change, so entries never become stale. Entries are evicted in
+ * LRU order once the total size of cached bytes exceeds the limit.
+ */
+class SerializedBlockCache {
+    enum EntryType { BLOCK, RANGE, COMPRESSED_RANGE };
+
+    // type, first block, last block, compression level
+    typedef tuple< uint8_t, uint64_t, uint64_t, uint8_t > Key;
+
+    class Entry {
+    public:
+        Key key;
+
+        ptr< vector< uint8_t > > data;
+
+        // sizes of the blocks in a range, nullptr for single blocks
+        ptr< list< uint64_t > > blockSizes;
+    };
+
+    const uint64_t maxBytes;
+
+    recursive_mutex m;
+
+    // the fields below are protected by m
+
+    list< Entry > entries;  // most recently used first
+
+    map< Key, list< Entry >::iterator > index;
+
+    uint64_t totalBytes = 0;
+
+    atomic< uint64_t > hits = 0;
+
+    atomic< uint64_t > misses = 0;
+
+    ptr< Entry > get( const Key& _key );
+
+    void put( Entry&& _entry );
+
+public:
+    explicit SerializedBlockCache( uint64_t _maxBytes );
+
+    ptr< vector< uint8_t > > getBlock( block_id _blockID );
+
+    void putBlock( block_id _blockID, const ptr< vector< uint8_t > >& _serializedBlock );
+
+    // returns the cached response for the range and appends its block sizes to _blockSizes
+    ptr< vector< uint8_t > > getRange(
+        block_id _startBlock, block_id _endBlock, const ptr< list< uint64_t > >& _blockSizes );
+
+    void putRange( block_id _startBlock, block_id _endBlock,
+        const ptr< vector< uint8_t > >& _serializedRange,
+        const ptr< list< uint64_t > >& _blockSizes );
+
+    // compressed frames of the catchup response for the range
+    ptr< vector< uint8_t > > getCompressedRange(
+        block_id _startBlock, block_id _endBlock, uint64_t _level );
+
+    void putCompressedRange( block_id _startBlock, block_id _endBlock, uint64_t _level,
+        const ptr< vector< uint8_t > >& _frames );
+
+    uint64_t getTotalBytes();
+
+    // hit percentage and cached megabytes
+    string getStats();
+};
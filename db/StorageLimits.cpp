@@ -28,7 +28,10 @@ StorageLimits::StorageLimits( uint64_t _totalStorageLimitBytes )
     : storageUnitBytes( _totalStorageLimitBytes ) {
     auto unit = _totalStorageLimitBytes / ( LEVELDB_SHARDS * ( 1000 + 10 * 10 + 100 ) );
 
-    BLOCK_DB_SIZE = 1000 * unit;
+    // the segment store keeps a copy of the recent blocks for catchup, so its share is
+    // taken from the block db. It is a single store, not one per LevelDB shard
+    BLOCK_DB_SIZE = 800 * unit;
+    BLOCK_SEGMENT_STORE_SIZE = 200 * unit * LEVELDB_SHARDS;
     RANDOM_DB_SIZE = 10 * unit;
     PRICE_DB_SIZE = 10 * unit;
     PROPOSAL_HASH_DB_SIZE = 10 * unit;
@@ -48,6 +51,9 @@ uint64_t StorageLimits::getStorageUnitBytes() const {
 uint64_t StorageLimits::getBlockDbSize() const {
     return BLOCK_DB_SIZE;
 }
+uint64_t StorageLimits::getBlockSegmentStoreSize() const {
+    return BLOCK_SEGMENT_STORE_SIZE;
+}
 uint64_t StorageLimits::getRandomDbSize() const {
     return RANDOM_DB_SIZE;
 }
@@ -28,6 +28,7 @@
 class StorageLimits {
     uint64_t storageUnitBytes = 0;
     uint64_t BLOCK_DB_SIZE = 0;
+    uint64_t BLOCK_SEGMENT_STORE_SIZE = 0;
     uint64_t RANDOM_DB_SIZE = 0;
     uint64_t PRICE_DB_SIZE = 0;
     uint64_t PROPOSAL_HASH_DB_SIZE = 0;
@@ -46,6 +47,7 @@ class StorageLimits {
 public:
     uint64_t getStorageUnitBytes() const;
     uint64_t getBlockDbSize() const;
+    uint64_t getBlockSegmentStoreSize() const;
     uint64_t getRandomDbSize() const;
     uint64_t getPriceDbSize() const;
     uint64_t getProposalHashDbSize() const;
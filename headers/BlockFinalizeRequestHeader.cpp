@@ -65,8 +65,16 @@ void BlockFinalizeRequestHeader::addFields( nlohmann::basic_json<>& jsonRequest
 
     jsonRequest["fragmentIndex"] = ( uint64_t ) fragmentIndex;
     jsonRequest["nodeID"] = ( uint64_t ) nodeID;
+
+    // servers that do not support compression ignore the field
+    if ( compressionLevel > 0 )
+        jsonRequest["cmp"] = compressionLevel;
 }
 
 const node_id& BlockFinalizeRequestHeader::getNodeId() const {
     return nodeID;
 }
+
+void BlockFinalizeRequestHeader::setCompressionLevel( uint64_t _compressionLevel ) {
+    compressionLevel = _compressionLevel;
+}
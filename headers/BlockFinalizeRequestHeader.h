@@ -28,6 +28,8 @@
 class BlockFinalizeRequestHeader : public AbstractBlockRequestHeader {
     fragment_index fragmentIndex;
     node_id nodeID;
+    // compression level requested for the response, 0 if the response must not be compressed
+    uint64_t compressionLevel = 0;
 
 
 public:
@@ -38,4 +40,6 @@ public:
     void addFields( nlohmann::basic_json<>& jsonRequest ) override;
 
     const node_id& getNodeId() const;
+
+    void setCompressionLevel( uint64_t _compressionLevel );
 };
@@ -48,6 +48,10 @@ void BlockFinalizeResponseHeader::addFields( nlohmann::json& _j ) {
     if ( !daProofSig.empty() ) {
         _j["daSig"] = daProofSig;
     }
+
+    if ( compressionLevel > 0 ) {
+        _j["cmp"] = compressionLevel;
+    }
 }
 
 void BlockFinalizeResponseHeader::setFragmentParams(
@@ -66,3 +70,7 @@ void BlockFinalizeResponseHeader::setFragmentParams(
     daProofSig = _daProofSig;
     setComplete();
 }
+
+void BlockFinalizeResponseHeader::setCompressionLevel( uint64_t _compressionLevel ) {
+    compressionLevel = _compressionLevel;
+}
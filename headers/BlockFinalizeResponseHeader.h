@@ -30,12 +30,16 @@ class BlockFinalizeResponseHeader : public Header {
     uint64_t blockSize = 0;
     string blockHash = "";
     string daProofSig = "";
+    // level of the compressed frames that follow the header, 0 if the fragment is not compressed
+    uint64_t compressionLevel = 0;
 
 
 public:
     void setFragmentParams( uint64_t _fragmentSize, uint64_t _blockSize, const string& _hash,
         const string& _daProofSig );
 
+    void setCompressionLevel( uint64_t _compressionLevel );
+
 
     BlockFinalizeResponseHeader();
 
@@ -31,6 +31,7 @@
 #include "thirdparty/json.hpp"
 
 #include "datastructures/BlockProposal.h"
+#include "node/Node.h"
 #include "node/NodeInfo.h"
 #include "chains/Schain.h"
 
@@ -57,6 +58,9 @@ BlockProposalRequestHeader::BlockProposalRequestHeader(
     auto stateRootStr = Header::getString( _proposalRequest, "sr" );
     CHECK_STATE( !stateRootStr.empty() )
     stateRoot = u256( stateRootStr );
+    // older proposers do not send it
+    if ( _proposalRequest.count( "sketch" ) > 0 )
+        sketchOffered = Header::getUint64( _proposalRequest, "sketch" ) > 0;
 }
 
 BlockProposalRequestHeader::BlockProposalRequestHeader( Schain& _sChain, BlockProposal& _proposal )
@@ -74,6 +78,8 @@ BlockProposalRequestHeader::BlockProposalRequestHeader( Schain& _sChain, BlockPr
 
     stateRoot = _proposal.getStateRoot();
 
+    sketchOffered = _sChain.getNode()->isProposalReconciliationEnabled();
+
     CHECK_STATE( timeStamp > MODERN_TIME )
 
     complete = true;
@@ -96,6 +102,7 @@ void BlockProposalRequestHeader::addFields( nlohmann::basic_json<>& _jsonRequest
     _jsonRequest["hash"] = hash;
     _jsonRequest["sig"] = signature;
     _jsonRequest["sr"] = stateRoot.str();
+    _jsonRequest["sketch"] = ( uint64_t ) sketchOffered;
 }
 node_id BlockProposalRequestHeader::getProposerNodeId() {
     return proposerNodeID;
@@ -126,3 +133,7 @@ string BlockProposalRequestHeader::getSignature() {
 u256 BlockProposalRequestHeader::getStateRoot() {
     return stateRoot;
 }
+
+bool BlockProposalRequestHeader::isSketchOffered() const {
+    return sketchOffered;
+}
@@ -36,6 +36,9 @@ class BlockProposalRequestHeader : public AbstractBlockRequestHeader {
     uint32_t timeStampMs = 0;
     u256 stateRoot;
 
+    // the proposer can send a sketch of the partial hashes
+    bool sketchOffered = false;
+
 public:
     BlockProposalRequestHeader( Schain& _sChain, BlockProposal& proposal );
 
@@ -56,4 +59,6 @@ public:
     string getSignature();
 
     u256 getStateRoot();
+
+    [[nodiscard]] bool isSketchOffered() const;
 };
@@ -26,3 +26,16 @@
 #include "BlockProposalResponseHeader.h"
 
 BlockProposalResponseHeader::BlockProposalResponseHeader() : Header( Header::BLOCK_PROPOSAL_RSP ) {}
+
+void BlockProposalResponseHeader::addFields( nlohmann::json& _j ) {
+    Header::addFields( _j );
+    _j["sketch"] = ( uint64_t ) sketchAccepted;
+}
+
+bool BlockProposalResponseHeader::isSketchAccepted() const {
+    return sketchAccepted;
+}
+
+void BlockProposalResponseHeader::setSketchAccepted( bool _sketchAccepted ) {
+    sketchAccepted = _sketchAccepted;
+}
@@ -28,8 +28,17 @@
 #include "Header.h"
 
 class BlockProposalResponseHeader : public Header {
+    // the server reads a sketch of the partial hashes if the proposer offered it
+    bool sketchAccepted = false;
+
 public:
     BlockProposalResponseHeader();
+
+    void addFields( nlohmann::json& _j ) override;
+
+    [[nodiscard]] bool isSketchAccepted() const;
+
+    void setSketchAccepted( bool _sketchAccepted );
 };
 
 
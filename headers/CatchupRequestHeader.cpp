@@ -57,8 +57,16 @@ void CatchupRequestHeader::addFields( nlohmann::json& _j ) {
     _j["schainID"] = ( uint64_t ) schainID;
     _j["blockID"] = ( uint64_t ) blockID;
     _j["nodeID"] = ( uint64_t ) nodeID;
+
+    // servers that do not support compression ignore the field
+    if ( compressionLevel > 0 )
+        _j["cmp"] = compressionLevel;
 }
 
 const node_id& CatchupRequestHeader::getNodeId() const {
     return nodeID;
 }
+
+void CatchupRequestHeader::setCompressionLevel( uint64_t _compressionLevel ) {
+    compressionLevel = _compressionLevel;
+}
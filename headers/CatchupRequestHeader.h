@@ -33,6 +33,8 @@ class CatchupRequestHeader : public Header {
     schain_id schainID;
     block_id blockID;
     node_id nodeID;
+    // compression level requested for the response, 0 if the response must not be compressed
+    uint64_t compressionLevel = 0;
 
 public:
     CatchupRequestHeader();
@@ -42,4 +44,6 @@ public:
     void addFields( nlohmann::basic_json<>& j ) override;
 
     [[nodiscard]] const node_id& getNodeId() const;
+
+    void setCompressionLevel( uint64_t _compressionLevel );
 };
\ No newline at end of file
@@ -58,4 +58,15 @@ void CatchupResponseHeader::addFields(nlohmann::json &_j) {
 
     if (blockSizes != nullptr)
         _j["sizes"] = *blockSizes;
+
+    if (compressionLevel > 0)
+        _j["cmp"] = compressionLevel;
+}
+
+uint64_t CatchupResponseHeader::getBlockCount() const {
+    return blockSizes ? blockSizes->size() : 0;
+}
+
+void CatchupResponseHeader::setCompressionLevel(uint64_t _compressionLevel) {
+    compressionLevel = _compressionLevel;
 }
@@ -41,6 +41,11 @@ public:
 
     void addFields( nlohmann::basic_json<>& j_ ) override;
 
+    uint64_t getBlockCount() const;
+
+    // the payload follows as compressed frames of this level, 0 if it is not compressed
+    void setCompressionLevel( uint64_t _compressionLevel );
+
 private:
 
     ptr< list< uint64_t > > blockSizes = nullptr;
@@ -49,4 +54,6 @@ private:
     uint64_t lastCommittedBlockId = 0;
     uint64_t lastCommittedBlockTimestampS = 0;
 
+    uint64_t compressionLevel = 0;
+
 };
@@ -55,6 +55,7 @@ MissingTransactionsRequestHeader::MissingTransactionsRequestHeader(
 void MissingTransactionsRequestHeader::addFields( nlohmann::json& _j ) {
     Header::addFields( _j );
     _j["count"] = missingTransactionsCount;
+    _j["fullHashes"] = ( uint64_t ) fullHashesRequested;
 }
 
 uint64_t MissingTransactionsRequestHeader::getMissingTransactionsCount() const {
@@ -65,3 +66,11 @@ void MissingTransactionsRequestHeader::setMissingTransactionsCount(
     uint64_t _missingTransactionsCount ) {
     MissingTransactionsRequestHeader::missingTransactionsCount = _missingTransactionsCount;
 }
+
+bool MissingTransactionsRequestHeader::isFullHashesRequested() const {
+    return fullHashesRequested;
+}
+
+void MissingTransactionsRequestHeader::setFullHashesRequested( bool _fullHashesRequested ) {
+    fullHashesRequested = _fullHashesRequested;
+}
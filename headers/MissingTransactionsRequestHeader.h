@@ -32,6 +32,9 @@ class Schain;
 class MissingTransactionsRequestHeader : public Header {
     uint64_t missingTransactionsCount;
 
+    // the sketch did not decode, the proposer has to send the full partial hashes
+    bool fullHashesRequested = false;
+
 public:
     MissingTransactionsRequestHeader();
 
@@ -43,4 +46,8 @@ public:
     [[nodiscard]] uint64_t getMissingTransactionsCount() const;
 
     void setMissingTransactionsCount( uint64_t _missingTransactionsCount );
+
+    [[nodiscard]] bool isFullHashesRequested() const;
+
+    void setFullHashesRequested( bool _fullHashesRequested );
 };
@@ -249,6 +249,17 @@ string NetworkMessage::serializeToString() {
     return s;
 }
 
+void NetworkMessage::setSerialized( string&& _serialized ) {
+    CHECK_ARGUMENT( !_serialized.empty() )
+    serialized = make_shared< const string >( std::move( _serialized ) );
+}
+
+ptr< const string > NetworkMessage::getSerialized() {
+    if ( serialized )
+        return serialized;
+    return make_shared< const string >( serializeToString() );
+}
+
 void NetworkMessage::addFields( nlohmann::basic_json<>& ) {
     /*
     j["si"] = (uint64_t ) schainID;
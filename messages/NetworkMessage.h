@@ -68,6 +68,9 @@ protected:
     string publicKey;
     string pkSig;
 
+    // the signed message as it is sent, set before the message is shared between threads
+    ptr< const string > serialized;
+
     NetworkMessage( MsgType _messageType, block_id _blockID, schain_index _blockProposerIndex,
         bin_consensus_round _r, bin_consensus_value _value, uint64_t _timeMs,
         ProtocolInstance& _srcProtocolInstance );
@@ -113,6 +116,12 @@ public:
 
     string serializeToString() override;
 
+    // keeps the serialized message, so that sends and resends do not serialize it again
+    void setSerialized( string&& _serialized );
+
+    // the kept serialized message, or a new serialization if there is none
+    ptr< const string > getSerialized();
+
     [[nodiscard]] const string& getECDSASig() const;
     [[nodiscard]] const string& getPublicKey() const;
     [[nodiscard]] const string& getPkSig() const;
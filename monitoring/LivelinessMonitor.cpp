@@ -44,7 +44,7 @@ LivelinessMonitor::LivelinessMonitor( const ptr< MonitoringAgent >& _agent, cons
 LivelinessMonitor::~LivelinessMonitor() {
     auto pointer = agent.lock();
     if ( pointer ) {
-        pointer->unregisterMonitor( this->getId() );
+        pointer->unregisterMonitor( *this );
     }
 }
 
@@ -63,6 +63,14 @@ uint64_t LivelinessMonitor::getExpiryTime() const {
     return expiryTime;
 }
 
+uint64_t LivelinessMonitor::getSlot() const {
+    return slot;
+}
+
+void LivelinessMonitor::setSlot( uint64_t _slot ) {
+    slot = _slot;
+}
+
 uint64_t LivelinessMonitor::getStartTime() const {
     return startTime;
 }
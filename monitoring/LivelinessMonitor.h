@@ -44,6 +44,8 @@ class LivelinessMonitor {
     uint64_t id = 0;
     uint64_t startTime = 0;
     uint64_t expiryTime = 0;
+    // slot in the monitoring agent plus one, 0 if the monitor is not registered
+    uint64_t slot = 0;
     static atomic< uint64_t > counter;
     weak_ptr< MonitoringAgent > agent;
 
@@ -54,6 +56,10 @@ public:
 
     [[nodiscard]] uint64_t getExpiryTime() const;
 
+    [[nodiscard]] uint64_t getSlot() const;
+
+    void setSlot( uint64_t _slot );
+
     string toString();
 
     virtual ~LivelinessMonitor();
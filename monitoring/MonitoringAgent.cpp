@@ -30,9 +30,9 @@
 
 #include "LivelinessMonitor.h"
 #include "MonitoringAgent.h"
-#include "MonitoringThreadPool.h"
 #include "chains/Schain.h"
 #include "node/Node.h"
+#include "threads/TimerWheel.h"
 #include "utils/Time.h"
 
 #include "utils/Time.h"
@@ -41,93 +41,119 @@ MonitoringAgent::MonitoringAgent( Schain& _sChain ) : Agent( _sChain, false, tru
     try {
         logThreadLocal_ = _sChain.getNode()->getLog();
         this->sChain = &_sChain;
-
-        this->monitoringThreadPool = make_shared< MonitoringThreadPool >( 1, this );
-        monitoringThreadPool->startService();
-
     } catch ( ... ) {
         throw_with_nested( FatalError( __FUNCTION__, __CLASS_NAME__ ) );
     }
+
+    if ( !ConsensusEngine::isOnTravis() ) {
+        lock_guard< mutex > lock( sweepLock );
+        scheduleSweep();
+    }
 }
 
 
-void MonitoringAgent::monitor() {
-    if ( ConsensusEngine::isOnTravis() )
+MonitoringAgent::~MonitoringAgent() {
+    uint64_t timerId;
+    {
+        lock_guard< mutex > lock( sweepLock );
+        stopped = true;
+        timerId = sweepTimerId;
+    }
+    if ( timerId != 0 )
+        TimerWheel::getShared().cancel( timerId );
+}
+
+
+void MonitoringAgent::scheduleSweep() {
+    if ( stopped )
         return;
 
-    while ( !getNode()->isInited() ) {
-        usleep( 100000 );
-    }
+    sweepTimerId = TimerWheel::getShared().schedule(
+        Time::getCurrentTimeMs() + SWEEP_INTERVAL_MS, [this]() { sweep(); } );
+}
 
 
-    map< uint64_t, weak_ptr< LivelinessMonitor > > monitorsCopy;
+void MonitoringAgent::sweep() {
+    auto now = Time::getCurrentTimeMs();
 
-    {
-        LOCK( monitorsMutex )
-        monitorsCopy = activeMonitors;
-    }
+    if ( !sChain->getNode()->isExitRequested() ) {
+        for ( auto&& slot : slots ) {
+            if ( slot.deadlineMs.load() > now )
+                continue;
 
-    for ( auto&& item : monitorsCopy ) {
-        if ( sChain->getNode()->isExitRequested() )
-            return;
+            // the monitor is being unregistered
+            if ( slot.busy.test_and_set( memory_order_acquire ) )
+                continue;
 
-        ptr< LivelinessMonitor > monitor = item.second.lock();
+            string description;
+            uint64_t startTime = 0;
 
-        if ( monitor ) {
-            CHECK_STATE( monitor != nullptr );
+            auto monitor = slot.monitor.load();
 
-            auto currentTime = Time::getCurrentTimeMs();
+            if ( monitor && slot.deadlineMs.load() <= now ) {
+                description = monitor->toString();
+                startTime = monitor->getStartTime();
+                slot.deadlineMs = now + getNode()->getMonitoringIntervalMs();
+            }
+
+            slot.busy.clear( memory_order_release );
 
-            if ( currentTime > monitor->getExpiryTime() ) {
-                LOG( warn, monitor->toString()
-                               << " has been stuck for "
-                               << to_string( currentTime - monitor->getStartTime() ) + " ms" );
+            if ( !description.empty() && getNode()->isInited() ) {
+                LOG( warn, description << " has been stuck for "
+                                       << to_string( now - startTime ) + " ms" );
             }
         }
     }
+
+    lock_guard< mutex > lock( sweepLock );
+    scheduleSweep();
 }
 
 
-void MonitoringAgent::monitoringLoop( MonitoringAgent* _agent ) {
-    CHECK_ARGUMENT( _agent );
+void MonitoringAgent::registerMonitor( const ptr< LivelinessMonitor >& _m ) {
+    CHECK_ARGUMENT( _m )
 
-    setThreadName( "MonitoringLoop", _agent->getSchain()->getNode()->getConsensusEngine() );
+    if ( ConsensusEngine::isOnTravis() )
+        return;
 
+    auto start = nextSlot++;
 
-    LOG( info, "Monitoring agent started monitoring" );
+    for ( uint64_t i = 0; i < MAX_MONITORS; i++ ) {
+        auto index = ( start + i ) % MAX_MONITORS;
+        auto& slot = slots.at( index );
 
-    try {
-        while ( !_agent->getSchain()->getNode()->isExitRequested() ) {
-            usleep( _agent->getSchain()->getNode()->getMonitoringIntervalMs() * 1000 );
+        LivelinessMonitor* expected = nullptr;
 
-            try {
-                _agent->monitor();
+        if ( slot.monitor.load() != nullptr ||
+             !slot.monitor.compare_exchange_strong( expected, _m.get() ) )
+            continue;
 
-            } catch ( ExitRequestedException& ) {
-                return;
-            } catch ( exception& e ) {
-                SkaleException::logNested( e );
-            }
-        };
-    } catch ( FatalError& e ) {
-        SkaleException::logNested( e );
-        _agent->getSchain()->getNode()->initiateApplicationExitOnFatalConsensusError( e.what() );
+        _m->setSlot( index + 1 );
+        slot.deadlineMs = _m->getExpiryTime();
+        return;
     }
-}
 
-void MonitoringAgent::registerMonitor( const ptr< LivelinessMonitor >& _m ) {
-    CHECK_ARGUMENT( _m )
-    LOCK( monitorsMutex )
-    activeMonitors[_m->getId()] = _m;
+    droppedMonitors++;
 }
 
-void MonitoringAgent::unregisterMonitor( uint64_t _id ) {
-    LOCK( monitorsMutex )
-    activeMonitors.erase( _id );
-}
 
+void MonitoringAgent::unregisterMonitor( LivelinessMonitor& _m ) {
+    auto slotNumber = _m.getSlot();
+
+    if ( slotNumber == 0 )
+        return;
+
+    auto& slot = slots.at( slotNumber - 1 );
+
+    // the sweep holds the slot only while it formats the warning
+    while ( slot.busy.test_and_set( memory_order_acquire ) ) {
+        this_thread::yield();
+    }
+
+    slot.deadlineMs = UINT64_MAX;
+    slot.monitor = nullptr;
+
+    slot.busy.clear( memory_order_release );
 
-void MonitoringAgent::join() {
-    CHECK_STATE( monitoringThreadPool );
-    monitoringThreadPool->joinAll();
+    _m.setSlot( 0 );
 }
@@ -24,26 +24,58 @@
 #pragma once
 
 class Schain;
-class MonitoringThreadPool;
 class LivelinessMonitor;
 
+/*
+ * Warns about functions that run longer than their liveness monitor allows. Monitors are
+ * registered in a fixed table of slots without locks, since every monitored call registers
+ * one. A sweep on the shared timer wheel checks the deadlines of the registered monitors, and
+ * moves the deadline of a stuck monitor one monitoring interval ahead after each warning.
+ */
 class MonitoringAgent : public Agent {
-    map< uint64_t, weak_ptr< LivelinessMonitor > > activeMonitors;  // tsafe
-    recursive_mutex monitorsMutex;
+    static constexpr uint64_t MAX_MONITORS = 1024;
 
-    ptr< MonitoringThreadPool > monitoringThreadPool = nullptr;
+    static constexpr uint64_t SWEEP_INTERVAL_MS = 100;
 
-public:
-    explicit MonitoringAgent( Schain& _sChain );
+    class Slot {
+    public:
+        // nullptr if the slot is free
+        atomic< LivelinessMonitor* > monitor = nullptr;
+
+        // the time of the next warning, UINT64_MAX if the slot is free or being filled
+        atomic< uint64_t > deadlineMs = UINT64_MAX;
+
+        // held by the sweep while it reads the monitor, and by unregisterMonitor()
+        // before the monitor is destroyed
+        atomic_flag busy = ATOMIC_FLAG_INIT;
+    };
+
+    array< Slot, MAX_MONITORS > slots;
+
+    // where the next registration starts looking for a free slot
+    atomic< uint64_t > nextSlot = 0;
 
-    static void monitoringLoop( MonitoringAgent* agent );
+    // monitors that were not registered because all slots were taken
+    atomic< uint64_t > droppedMonitors = 0;
 
-    void monitor();
+    mutex sweepLock;
 
-    void join();
+    // the fields below are protected by sweepLock
+
+    uint64_t sweepTimerId = 0;
+
+    bool stopped = false;
+
+    void scheduleSweep();
+
+    void sweep();
+
+public:
+    explicit MonitoringAgent( Schain& _sChain );
 
+    ~MonitoringAgent() override;
 
     void registerMonitor( const ptr< LivelinessMonitor >& _m );
 
-    void unregisterMonitor( uint64_t _id );
+    void unregisterMonitor( LivelinessMonitor& _m );
 };
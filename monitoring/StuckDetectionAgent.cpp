@@ -49,7 +49,8 @@
 
 #include "utils/Time.h"
 
-StuckDetectionAgent::StuckDetectionAgent( Schain& _sChain ) : Agent( _sChain, false, true ) {
+// registered, so that the node wakes it up on exit
+StuckDetectionAgent::StuckDetectionAgent( Schain& _sChain ) : Agent( _sChain, false ) {
     try {
         logThreadLocal_ = _sChain.getNode()->getLog();
         this->sChain = &_sChain;
@@ -84,9 +85,26 @@ void StuckDetectionAgent::StuckDetectionLoop( StuckDetectionAgent* _agent ) {
     do {
         try {
             _agent->getSchain()->getNode()->exitCheck();
-            usleep(_agent->getSchain()->getNode()->getStuckMonitoringIntervalMs() * 1000);
+
+            // the chain can not be stuck before no block has been committed for the restart
+            // interval, so sleep until then. If a block is committed before, the deadline moves
+            auto stuckDeadline = max( _agent->getSchain()->getLastCommitTimeMs(),
+                                     _agent->getSchain()->getStartTimeMs() ) +
+                                 _agent->getSchain()->getNode()->getStuckRestartIntervalMs() + 1;
+
+            if ( stuckDeadline > Time::getCurrentTimeMs() ) {
+                _agent->waitUntilTime( stuckDeadline );
+                continue;
+            }
+
             // this will return non-zero if skaled needs to be restarted
             whenToRestart = _agent->doStuckCheckAndReturnTimeWhenToRestart(restartIteration);
+
+            if ( whenToRestart == 0 ) {
+                // the other conditions of the stuck check are polled
+                _agent->waitUntilTime( Time::getCurrentTimeMs() +
+                                       _agent->getSchain()->getNode()->getStuckMonitoringIntervalMs() );
+            }
         } catch ( ExitRequestedException& ) {
             return;
         } catch ( exception& e ) {
@@ -37,7 +37,8 @@
 
 #include "utils/Time.h"
 
-TimeoutAgent::TimeoutAgent( Schain& _sChain ) : Agent( _sChain, false, true ) {
+// registered, so that the node wakes it up on exit
+TimeoutAgent::TimeoutAgent( Schain& _sChain ) : Agent( _sChain, false ) {
     try {
         logThreadLocal_ = _sChain.getNode()->getLog();
         this->sChain = &_sChain;
@@ -73,7 +74,8 @@ void TimeoutAgent::timeoutLoop( TimeoutAgent* _agent ) {
 
     try {
         while ( !_agent->getSchain()->getNode()->isExitRequested() ) {
-            usleep( _agent->getSchain()->getNode()->getMonitoringIntervalMs() * 1000 );
+            // the time of the next check, or 0 if it can not be computed
+            uint64_t nextCheckTime = 0;
 
             try {
                 auto currentBlockId = _agent->getSchain()->getLastCommittedBlockID() + 1;
@@ -105,12 +107,37 @@ void TimeoutAgent::timeoutLoop( TimeoutAgent* _agent ) {
                         _agent->getSchain()->rebroadcastAllMessagesForCurrentBlock();
                         lastRebroadCastTime = currentTime;
                     }
+
+                    // wake up exactly when a timeout expires. If a block is committed before,
+                    // the deadlines move and the agent goes back to sleep
+                    nextCheckTime = lastRebroadCastTime + REBROADCAST_TIMEOUT_MS + 1;
+
+                    if ( !proposalReceiptTimedOut ) {
+                        nextCheckTime = min( nextCheckTime,
+                            blockProcessingStart + BLOCK_PROPOSAL_RECEIVE_TIMEOUT_MS + 1 );
+                    }
+                } else {
+                    // small chains do not use the timeouts, sleep until exit
+                    nextCheckTime = UINT64_MAX;
+                }
+
+                // timeouts that depend on the block id are not armed yet, so check periodically
+                if ( nextCheckTime <= currentTime ) {
+                    nextCheckTime =
+                        currentTime + _agent->getSchain()->getNode()->getMonitoringIntervalMs();
                 }
             } catch ( ExitRequestedException& ) {
                 return;
             } catch ( exception& e ) {
                 SkaleException::logNested( e );
             }
+
+            if ( nextCheckTime == 0 ) {
+                nextCheckTime = Time::getCurrentTimeMs() +
+                                _agent->getSchain()->getNode()->getMonitoringIntervalMs();
+            }
+
+            _agent->waitUntilTime( nextCheckTime );
         };
     } catch ( FatalError& e ) {
         SkaleException::logNested( e );
@@ -28,6 +28,7 @@
 #include "exceptions/SkaleException.h"
 
 #include "Buffer.h"
+#include "BufferPool.h"
 
 void Buffer::write( void* data, size_t dataLen ) {
     CHECK_ARGUMENT( data );
@@ -50,7 +51,7 @@ uint64_t Buffer::getCounter() const {
 Buffer::Buffer( size_t _size ) {
     CHECK_ARGUMENT( _size <= MAX_BUFFER_SIZE );
     this->size = _size;
-    buf = make_shared< vector< uint8_t > >( size, 0 );
+    buf = BufferPool::allocate( size );
 }
 
 size_t Buffer::getSize() const {
@@ -0,0 +1,111 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BufferPool.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/InvalidStateException.h"
+
+#include "BufferPool.h"
+
+
+array< mutex, BufferPool::NUMBER_OF_SIZE_CLASSES > BufferPool::freeListLocks;
+
+array< vector< vector< uint8_t >* >, BufferPool::NUMBER_OF_SIZE_CLASSES > BufferPool::freeLists;
+
+atomic< uint64_t > BufferPool::allocations = 0;
+
+atomic< uint64_t > BufferPool::reuses = 0;
+
+
+uint64_t BufferPool::getSizeClass( uint64_t _size ) {
+    uint64_t sizeClass = 0;
+    while ( sizeClass < NUMBER_OF_SIZE_CLASSES && getClassCapacity( sizeClass ) < _size ) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+uint64_t BufferPool::getClassCapacity( uint64_t _sizeClass ) {
+    return MIN_CLASS_SIZE << ( 2 * _sizeClass );
+}
+
+void BufferPool::release( uint64_t _sizeClass, vector< uint8_t >* _vector ) {
+    CHECK_STATE( _sizeClass < NUMBER_OF_SIZE_CLASSES );
+
+    if ( _vector == nullptr )
+        return;
+
+    {
+        lock_guard< mutex > lock( freeListLocks[_sizeClass] );
+        auto& freeList = freeLists[_sizeClass];
+        if ( freeList.size() < MAX_FREE_PER_CLASS &&
+             ( freeList.size() + 1 ) * getClassCapacity( _sizeClass ) <=
+                 MAX_FREE_BYTES_PER_CLASS ) {
+            freeList.push_back( _vector );
+            return;
+        }
+    }
+
+    delete _vector;
+}
+
+ptr< vector< uint8_t > > BufferPool::allocate( uint64_t _size ) {
+    auto sizeClass = getSizeClass( _size );
+
+    if ( sizeClass == NUMBER_OF_SIZE_CLASSES ) {
+        allocations++;
+        return make_shared< vector< uint8_t > >( _size, 0 );
+    }
+
+    vector< uint8_t >* result = nullptr;
+
+    {
+        lock_guard< mutex > lock( freeListLocks[sizeClass] );
+        auto& freeList = freeLists[sizeClass];
+        if ( !freeList.empty() ) {
+            result = freeList.back();
+            freeList.pop_back();
+        }
+    }
+
+    if ( result ) {
+        reuses++;
+        result->assign( _size, 0 );
+    } else {
+        allocations++;
+        result = new vector< uint8_t >();
+        result->reserve( getClassCapacity( sizeClass ) );
+        result->resize( _size, 0 );
+    }
+
+    return ptr< vector< uint8_t > >(
+        result, [sizeClass]( vector< uint8_t >* _vector ) { release( sizeClass, _vector ); } );
+}
+
+uint64_t BufferPool::getAllocations() {
+    return allocations;
+}
+
+uint64_t BufferPool::getReuses() {
+    return reuses;
+}
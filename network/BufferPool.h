@@ -0,0 +1,66 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BufferPool.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+/*
+ * Process-wide pool of byte vectors used for network I/O.
+ *
+ * Vectors are grouped in power-of-four size classes. A vector returned by allocate()
+ * goes back to the free list of its class when the last shared_ptr to it is released,
+ * keeping its capacity, so the next allocation of a similar size does not hit malloc.
+ * Vectors larger than the largest class are not pooled.
+ */
+class BufferPool {
+    static constexpr uint64_t MIN_CLASS_SIZE = 256;
+
+    static constexpr uint64_t NUMBER_OF_SIZE_CLASSES = 9;  // 256 bytes to 16 MB
+
+    static constexpr uint64_t MAX_FREE_PER_CLASS = 64;
+
+    static constexpr uint64_t MAX_FREE_BYTES_PER_CLASS = 64 * 1024 * 1024;
+
+    static array< mutex, NUMBER_OF_SIZE_CLASSES > freeListLocks;
+
+    static array< vector< vector< uint8_t >* >, NUMBER_OF_SIZE_CLASSES > freeLists;
+
+    static atomic< uint64_t > allocations;
+
+    static atomic< uint64_t > reuses;
+
+    static uint64_t getSizeClass( uint64_t _size );
+
+    static uint64_t getClassCapacity( uint64_t _sizeClass );
+
+    static void release( uint64_t _sizeClass, vector< uint8_t >* _vector );
+
+public:
+    // returns a zero-filled vector of exactly _size bytes
+    static ptr< vector< uint8_t > > allocate( uint64_t _size );
+
+    // number of vectors that had to be allocated from the heap
+    static uint64_t getAllocations();
+
+    // number of allocations served from the free lists
+    static uint64_t getReuses();
+};
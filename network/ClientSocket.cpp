@@ -33,14 +33,18 @@
 #include "ClientSocket.h"
 #include "exceptions/ConnectionRefusedException.h"
 #include "node/NodeInfo.h"
+#include "IO.h"
+#include "NetworkEmulator.h"
 
 using namespace std;
 
 
 void ClientSocket::closeSocket() {
     LOCK( m )
-    if ( descriptor != 0 )
+    if ( descriptor != 0 ) {
+        NetworkEmulator::tagDescriptor( descriptor, 0 );
         close( ( int ) descriptor );
+    }
     descriptor = 0;
 }
 
@@ -102,7 +106,16 @@ ClientSocket::ClientSocket( Schain& _sChain, schain_index _destinationIndex, por
     this->remoteAddr = Sockets::createSocketAddress( remoteIP, ( uint16_t ) remotePort );
     CHECK_STATE( remoteAddr )
 
+    auto emulator = NetworkEmulator::getShared();
+
     try {
+        // a cut off peer looks like a peer that refuses connections
+        if ( emulator && emulator->isPartitioned( ( uint64_t ) _sChain.getSchainIndex(),
+                             ( uint64_t ) _destinationIndex ) ) {
+            BOOST_THROW_EXCEPTION( ConnectionRefusedException(
+                "Emulated partition, couldnt connect to:" + getIP() + ":" + to_string( getPort() ),
+                ECONNREFUSED, __CLASS_NAME__ ) );
+        }
         descriptor = createTCPSocket();
     } catch ( ConnectionRefusedException& e ) {
         _sChain.addDeadNode( ( uint64_t ) _destinationIndex, Time::getCurrentTimeMs() );
@@ -113,6 +126,11 @@ ClientSocket::ClientSocket( Schain& _sChain, schain_index _destinationIndex, por
 
     CHECK_STATE( descriptor != 0 )
 
+    IO::tagDescriptor( descriptor, portType );
+
+    if ( emulator )
+        NetworkEmulator::tagDescriptor( descriptor, ( uint64_t ) _destinationIndex );
+
     totalSockets++;
 }
 
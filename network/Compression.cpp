@@ -0,0 +1,228 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file Compression.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+#include "exceptions/NetworkProtocolException.h"
+
+#include "miniz.h"
+
+#include "Compression.h"
+
+
+Compression::FrameCompressor::FrameCompressor(
+    vector< pair< const uint8_t*, uint64_t > >&& _chunks, int _level )
+    : chunks( std::move( _chunks ) ) {
+    CHECK_ARGUMENT( _level > 0 && _level <= MAX_LEVEL );
+
+    for ( auto&& chunk : chunks ) {
+        CHECK_ARGUMENT( chunk.second <= UINT_MAX );
+    }
+
+    stream = make_shared< mz_stream >();
+
+    CHECK_STATE( mz_deflateInit( stream.get(), _level ) == MZ_OK );
+
+    if ( !chunks.empty() ) {
+        stream->next_in = chunks.front().first;
+        stream->avail_in = ( unsigned int ) chunks.front().second;
+    }
+}
+
+
+Compression::FrameCompressor::~FrameCompressor() {
+    mz_deflateEnd( stream.get() );
+}
+
+
+ptr< vector< uint8_t > > Compression::FrameCompressor::nextFrame() {
+    CHECK_STATE( !endSent );
+
+    auto frame = make_shared< vector< uint8_t > >( FRAME_HEADER_SIZE + MAX_FRAME_SIZE );
+
+    if ( finished ) {
+        endSent = true;
+        frame->resize( FRAME_HEADER_SIZE );
+        memset( frame->data(), 0, FRAME_HEADER_SIZE );
+        return frame;
+    }
+
+    stream->next_out = frame->data() + FRAME_HEADER_SIZE;
+    stream->avail_out = ( unsigned int ) MAX_FRAME_SIZE;
+
+    // fill the frame, moving to the next chunk when the current one is consumed
+    while ( stream->avail_out > 0 ) {
+        while ( stream->avail_in == 0 && currentChunk + 1 < chunks.size() ) {
+            currentChunk++;
+            stream->next_in = chunks.at( currentChunk ).first;
+            stream->avail_in = ( unsigned int ) chunks.at( currentChunk ).second;
+        }
+
+        auto isLast = ( currentChunk + 1 >= chunks.size() );
+
+        auto status = mz_deflate( stream.get(), isLast ? MZ_FINISH : MZ_NO_FLUSH );
+
+        if ( status == MZ_STREAM_END ) {
+            finished = true;
+            break;
+        }
+
+        CHECK_STATE2( status == MZ_OK || status == MZ_BUF_ERROR,
+            "Deflate failed:" + to_string( status ) );
+    }
+
+    auto size = MAX_FRAME_SIZE - stream->avail_out;
+
+    // the end frame is sent separately
+    if ( size == 0 ) {
+        CHECK_STATE( finished );
+        return nextFrame();
+    }
+
+    auto size32 = ( uint32_t ) size;
+    memcpy( frame->data(), &size32, FRAME_HEADER_SIZE );
+    frame->resize( FRAME_HEADER_SIZE + size );
+
+    return frame;
+}
+
+
+bool Compression::FrameCompressor::isFinished() const {
+    return endSent;
+}
+
+
+Compression::FrameDecompressor::FrameDecompressor( uint8_t* _output, uint64_t _outputSize )
+    : output( _output ), outputSize( _outputSize ) {
+    CHECK_ARGUMENT( _output );
+    CHECK_ARGUMENT( _outputSize <= UINT_MAX );
+
+    stream = make_shared< mz_stream >();
+
+    CHECK_STATE( mz_inflateInit( stream.get() ) == MZ_OK );
+
+    stream->next_out = output;
+    stream->avail_out = ( unsigned int ) outputSize;
+}
+
+
+Compression::FrameDecompressor::~FrameDecompressor() {
+    mz_inflateEnd( stream.get() );
+}
+
+
+void Compression::FrameDecompressor::addFrame( const uint8_t* _data, uint64_t _size ) {
+    CHECK_ARGUMENT( _data );
+    CHECK_ARGUMENT( _size <= MAX_FRAME_SIZE );
+
+    if ( streamEnded ) {
+        BOOST_THROW_EXCEPTION(
+            NetworkProtocolException( "Frame after the end of the stream", __CLASS_NAME__ ) );
+    }
+
+    stream->next_in = _data;
+    stream->avail_in = ( unsigned int ) _size;
+
+    while ( stream->avail_in > 0 ) {
+        auto status = mz_inflate( stream.get(), MZ_NO_FLUSH );
+
+        if ( status == MZ_STREAM_END ) {
+            streamEnded = true;
+            break;
+        }
+
+        // no progress is possible if the output buffer, which has exactly the announced
+        // uncompressed size, is full
+        if ( status != MZ_OK ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Could not decompress frame:" + to_string( status ), __CLASS_NAME__ ) );
+        }
+    }
+
+    if ( stream->avail_in > 0 ) {
+        BOOST_THROW_EXCEPTION(
+            NetworkProtocolException( "Bytes after the end of the stream", __CLASS_NAME__ ) );
+    }
+}
+
+
+void Compression::FrameDecompressor::finish() {
+    auto decompressedSize = ( uint64_t ) stream->total_out;
+
+    if ( !streamEnded || decompressedSize != outputSize ) {
+        BOOST_THROW_EXCEPTION( NetworkProtocolException(
+            "Incomplete compressed payload:" + to_string( decompressedSize ) + ":" +
+                to_string( outputSize ),
+            __CLASS_NAME__ ) );
+    }
+}
+
+
+uint64_t Compression::readFrameSize( const uint8_t* _frameHeader ) {
+    CHECK_ARGUMENT( _frameHeader );
+
+    uint32_t size;
+    memcpy( &size, _frameHeader, FRAME_HEADER_SIZE );
+
+    if ( size > MAX_FRAME_SIZE ) {
+        BOOST_THROW_EXCEPTION( NetworkProtocolException(
+            "Invalid frame size:" + to_string( size ), __CLASS_NAME__ ) );
+    }
+
+    return size;
+}
+
+
+void Compression::decompressFrames(
+    const uint8_t* _input, uint64_t _inputSize, uint8_t* _output, uint64_t _outputSize ) {
+    CHECK_ARGUMENT( _input );
+
+    FrameDecompressor decompressor( _output, _outputSize );
+
+    uint64_t offset = 0;
+
+    while ( true ) {
+        if ( offset + FRAME_HEADER_SIZE > _inputSize ) {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "Truncated compressed payload", __CLASS_NAME__ ) );
+        }
+
+        auto size = readFrameSize( _input + offset );
+        offset += FRAME_HEADER_SIZE;
+
+        if ( size == 0 )
+            break;
+
+        if ( offset + size > _inputSize ) {
+            BOOST_THROW_EXCEPTION(
+                NetworkProtocolException( "Truncated compressed frame", __CLASS_NAME__ ) );
+        }
+
+        decompressor.addFrame( _input + offset, size );
+        offset += size;
+    }
+
+    decompressor.finish();
+}
@@ -0,0 +1,102 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file Compression.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+// miniz.h is not included here, it defines zlib compatible macros such as compress
+struct mz_stream_s;
+
+/*
+ * Deflate compression of catchup and block finalize payloads, using the bundled miniz.
+ * A payload is compressed as one zlib stream that is sent as a sequence of frames, so that
+ * the response header and the first frames go out while the rest is still being compressed.
+ * Each frame is a 4 byte length followed by the compressed bytes, an empty frame ends the
+ * stream.
+ */
+class Compression {
+public:
+    // payloads smaller than this are always sent uncompressed
+    static constexpr uint64_t MIN_COMPRESSED_PAYLOAD_SIZE = 4096;
+
+    static constexpr int MAX_LEVEL = 9;
+
+    // compressed bytes in a frame
+    static constexpr uint64_t MAX_FRAME_SIZE = 64 * 1024;
+
+    static constexpr uint64_t FRAME_HEADER_SIZE = sizeof( uint32_t );
+
+    // compresses input chunks without concatenating them first. The chunks must stay valid
+    // until the last frame is taken
+    class FrameCompressor {
+        ptr< mz_stream_s > stream;
+
+        vector< pair< const uint8_t*, uint64_t > > chunks;
+
+        uint64_t currentChunk = 0;
+
+        bool finished = false;
+
+        bool endSent = false;
+
+    public:
+        FrameCompressor( vector< pair< const uint8_t*, uint64_t > >&& _chunks, int _level );
+
+        ~FrameCompressor();
+
+        // the next frame including its length, the empty end frame after the last one
+        ptr< vector< uint8_t > > nextFrame();
+
+        // true once the end frame has been taken
+        bool isFinished() const;
+    };
+
+    // decompresses frames into a buffer of the known uncompressed size
+    class FrameDecompressor {
+        ptr< mz_stream_s > stream;
+
+        uint8_t* const output;
+
+        const uint64_t outputSize;
+
+        bool streamEnded = false;
+
+    public:
+        FrameDecompressor( uint8_t* _output, uint64_t _outputSize );
+
+        ~FrameDecompressor();
+
+        // compressed bytes of one frame, without the length
+        void addFrame( const uint8_t* _data, uint64_t _size );
+
+        // throws if the stream is incomplete or its size does not match
+        void finish();
+    };
+
+    // length of a frame from its first FRAME_HEADER_SIZE bytes, throws if it is too large
+    static uint64_t readFrameSize( const uint8_t* _frameHeader );
+
+    // decompresses a complete sequence of frames, for example a cached response
+    static void decompressFrames(
+        const uint8_t* _input, uint64_t _inputSize, uint8_t* _output, uint64_t _outputSize );
+};
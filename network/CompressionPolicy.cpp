@@ -0,0 +1,87 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file CompressionPolicy.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+
+#include "CompressionPolicy.h"
+
+
+CompressionPolicy::CompressionPolicy( uint64_t _nodeCount ) : peers( _nodeCount ) {}
+
+
+int CompressionPolicy::getLevel( schain_index _peerIndex ) {
+    auto throughput = getThroughput( _peerIndex );
+
+    // the first downloads are uncompressed, as they were before compression was added
+    if ( throughput == 0 || throughput >= NO_COMPRESSION_THROUGHPUT )
+        return 0;
+
+    if ( throughput >= FAST_COMPRESSION_THROUGHPUT )
+        return FAST_LEVEL;
+
+    return STRONG_LEVEL;
+}
+
+
+void CompressionPolicy::recordDownload(
+    schain_index _peerIndex, uint64_t _wireBytes, uint64_t _payloadBytes, uint64_t _timeMs ) {
+    CHECK_ARGUMENT( _peerIndex > 0 && ( uint64_t ) _peerIndex <= peers.size() );
+
+    compressedBytes += _wireBytes;
+    uncompressedBytes += _payloadBytes;
+
+    lock_guard< mutex > lock( peersLock );
+
+    auto& peer = peers.at( ( uint64_t ) _peerIndex - 1 );
+
+    peer.pendingBytes += _wireBytes;
+    peer.pendingTimeMs += _timeMs;
+
+    if ( peer.pendingBytes < MIN_MEASURED_BYTES )
+        return;
+
+    auto measured = peer.pendingBytes * 1000 / max< uint64_t >( peer.pendingTimeMs, 1 );
+
+    peer.pendingBytes = 0;
+    peer.pendingTimeMs = 0;
+
+    // moving average, so that one slow download does not switch the level
+    peer.throughput = peer.throughput == 0 ? measured : ( peer.throughput * 3 + measured ) / 4;
+}
+
+
+uint64_t CompressionPolicy::getThroughput( schain_index _peerIndex ) {
+    CHECK_ARGUMENT( _peerIndex > 0 && ( uint64_t ) _peerIndex <= peers.size() );
+    lock_guard< mutex > lock( peersLock );
+    return peers.at( ( uint64_t ) _peerIndex - 1 ).throughput;
+}
+
+
+uint64_t CompressionPolicy::getSavedPercentage() {
+    uint64_t payload = uncompressedBytes;
+    uint64_t wire = compressedBytes;
+    return payload == 0 || wire >= payload ? 0 : ( payload - wire ) * 100 / payload;
+}
@@ -0,0 +1,84 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file CompressionPolicy.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+/*
+ * Chooses the compression level that a node requests for catchup and block finalize downloads
+ * from a peer, based on the throughput measured on previous downloads from that peer.
+ * Compression pays off only if the link is slower than the compressor: fast links get
+ * uncompressed payloads, slow links get the stronger levels. Peers are not asked to compress
+ * until their link has been measured.
+ */
+class CompressionPolicy {
+public:
+    // downloads smaller than this are dominated by latency, so small downloads such as
+    // finalize fragments are added up until this many bytes are measured
+    static constexpr uint64_t MIN_MEASURED_BYTES = 64 * 1024;
+
+    static constexpr uint64_t NO_COMPRESSION_THROUGHPUT = 64 * 1024 * 1024;  // bytes/s
+
+    static constexpr uint64_t FAST_COMPRESSION_THROUGHPUT = 8 * 1024 * 1024;  // bytes/s
+
+    static constexpr int FAST_LEVEL = 1;
+
+    static constexpr int STRONG_LEVEL = 6;
+
+private:
+    class Peer {
+    public:
+        // bytes/s, 0 if not measured yet
+        uint64_t throughput = 0;
+
+        // downloads that are not measured yet
+        uint64_t pendingBytes = 0;
+
+        uint64_t pendingTimeMs = 0;
+    };
+
+    mutex peersLock;
+
+    // by schain index - 1, protected by peersLock
+    vector< Peer > peers;
+
+    atomic< uint64_t > compressedBytes = 0;
+
+    atomic< uint64_t > uncompressedBytes = 0;
+
+public:
+    explicit CompressionPolicy( uint64_t _nodeCount );
+
+    // 0 means no compression
+    int getLevel( schain_index _peerIndex );
+
+    // _wireBytes were received in _timeMs, and were _payloadBytes after decompression
+    void recordDownload(
+        schain_index _peerIndex, uint64_t _wireBytes, uint64_t _payloadBytes, uint64_t _timeMs );
+
+    // bytes/s measured for the peer, 0 if not measured yet
+    uint64_t getThroughput( schain_index _peerIndex );
+
+    // percentage of payload bytes saved by compression
+    uint64_t getSavedPercentage();
+};
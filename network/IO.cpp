@@ -21,6 +21,12 @@
     @date 2018
 */
 
+#include <climits>
+#include <ctime>
+#include <linux/errqueue.h>
+#include <poll.h>
+#include <sys/uio.h>
+
 #include "Log.h"
 #include "SkaleCommon.h"
 #include "exceptions/FatalError.h"
@@ -29,11 +35,16 @@
 
 
 #include "Buffer.h"
+#include "BufferPool.h"
 #include "ClientSocket.h"
+#include "Compression.h"
 #include "IO.h"
+#include "NetworkEmulator.h"
 #include "ServerConnection.h"
+#include "ZeroCopyCompletions.h"
 #include "abstracttcpserver/ConnectionStatus.h"
 #include "chains/Schain.h"
+#include "db/BlockSegmentStore.h"
 #include "exceptions/ExitRequestedException.h"
 #include "exceptions/IOException.h"
 #include "exceptions/NetworkProtocolException.h"
@@ -42,9 +53,110 @@
 #include "headers/BlockProposalRequestHeader.h"
 #include "headers/Header.h"
 #include "node/Node.h"
+#include "utils/Time.h"
 
 using namespace std;
 
+array< atomic< uint8_t >, IO::MAX_TAGGED_DESCRIPTORS > IO::descriptorProtocols;
+
+array< atomic< bool >, IO::MAX_TAGGED_DESCRIPTORS > IO::zeroCopyDescriptors;
+
+array< atomic< uint64_t >, IO::PROTOCOL_SLOTS > IO::bytesRead;
+
+array< atomic< uint64_t >, IO::PROTOCOL_SLOTS > IO::bytesWritten;
+
+mutex IO::statsLock;
+
+array< pair< uint64_t, uint64_t >, IO::PROTOCOL_SLOTS > IO::lastReportedBytes;
+
+uint64_t IO::lastReportTimeMs = 0;
+
+
+void IO::tagDescriptor( file_descriptor _descriptor, port_type _portType ) {
+    CHECK_ARGUMENT( ( uint64_t ) _portType < PROTOCOL_SLOTS - 1 );
+    if ( ( uint64_t )( int ) _descriptor < MAX_TAGGED_DESCRIPTORS ) {
+        // slot 0 means untagged, so store the port type shifted by one
+        descriptorProtocols[( uint64_t )( int ) _descriptor] = ( uint8_t ) _portType + 1;
+        zeroCopyDescriptors[( uint64_t )( int ) _descriptor] = enableZeroCopy( _descriptor );
+    }
+}
+
+bool IO::isZeroCopyEnabled( file_descriptor _descriptor ) {
+    if ( ( uint64_t )( int ) _descriptor >= MAX_TAGGED_DESCRIPTORS )
+        return false;
+    return zeroCopyDescriptors[( uint64_t )( int ) _descriptor];
+}
+
+uint64_t IO::getProtocolSlot( file_descriptor _descriptor ) {
+    if ( ( uint64_t )( int ) _descriptor >= MAX_TAGGED_DESCRIPTORS )
+        return PROTOCOL_SLOTS - 1;
+
+    auto tag = descriptorProtocols[( uint64_t )( int ) _descriptor].load();
+
+    if ( tag == 0 )
+        return PROTOCOL_SLOTS - 1;
+
+    return tag - 1;
+}
+
+string IO::getStats() {
+    static const map< uint64_t, string > names = { { PROPOSAL, "PRP" }, { CATCHUP, "CTC" },
+        { RETRIEVE, "RTV" }, { PROTOCOL_SLOTS - 1, "OTH" } };
+
+    lock_guard< mutex > lock( statsLock );
+
+    auto now = Time::getCurrentTimeMs();
+    auto elapsedMs = max< uint64_t >( now - lastReportTimeMs, 1 );
+    lastReportTimeMs = now;
+
+    string result;
+
+    for ( uint64_t i = 0; i < PROTOCOL_SLOTS; i++ ) {
+        uint64_t read = bytesRead[i];
+        uint64_t written = bytesWritten[i];
+
+        auto readRate = ( read - lastReportedBytes[i].first ) * 1000 / elapsedMs;
+        auto writeRate = ( written - lastReportedBytes[i].second ) * 1000 / elapsedMs;
+
+        lastReportedBytes[i] = { read, written };
+
+        if ( read == 0 && written == 0 )
+            continue;
+
+        auto name = names.count( i ) ? names.at( i ) : to_string( i );
+
+        result += name + "/" + to_string( readRate ) + "/" + to_string( writeRate ) + ",";
+    }
+
+    result += "BPA/" + to_string( BufferPool::getAllocations() ) + "/BPR/" +
+              to_string( BufferPool::getReuses() );
+
+    return result;
+}
+
+
+uint64_t IO::getNodeBytesRead() const {
+    return nodeBytesRead;
+}
+
+
+uint64_t IO::getNodeBytesWritten() const {
+    return nodeBytesWritten;
+}
+
+void IO::addBytesTransferred( file_descriptor _descriptor, uint64_t _read, uint64_t _written ) {
+    auto slot = getProtocolSlot( _descriptor );
+    bytesRead[slot] += _read;
+    bytesWritten[slot] += _written;
+    nodeBytesRead += _read;
+    nodeBytesWritten += _written;
+}
+
+const ptr< ZeroCopyCompletions >& IO::getZeroCopyCompletions() const {
+    return zeroCopyCompletions;
+}
+
+
 void IO::readBytes( const ptr< ServerConnection >& _env, const ptr< vector< uint8_t > >& _buffer,
     msg_len len, uint32_t _timeoutSec ) {
     CHECK_ARGUMENT( _env );
@@ -64,8 +176,63 @@ void IO::readBuf(
 void IO::readBytes( file_descriptor _descriptor, const ptr< vector< uint8_t > >& _buffer,
     msg_len _len, uint32_t _timeoutSec ) {
     CHECK_ARGUMENT( _buffer )
-    CHECK_ARGUMENT( _len > 0 )
     CHECK_ARGUMENT( _buffer->size() >= _len )
+    readBytes( _descriptor, _buffer->data(), _len, _timeoutSec );
+}
+
+
+uint64_t IO::readPossiblyCompressedBytes( file_descriptor _descriptor,
+    const ptr< vector< uint8_t > >& _buffer, msg_len _len, nlohmann::json& _responseHeader,
+    uint32_t _timeoutSec ) {
+    CHECK_ARGUMENT( _buffer )
+    CHECK_ARGUMENT( _buffer->size() >= _len )
+
+    if ( _responseHeader.count( "cmp" ) == 0 ) {
+        readBytes( _descriptor, _buffer->data(), _len, _timeoutSec );
+        return ( uint64_t ) _len;
+    }
+
+    // frames are decompressed as they arrive, while the server compresses the next ones
+    Compression::FrameDecompressor decompressor( _buffer->data(), ( uint64_t ) _len );
+
+    auto frame = BufferPool::allocate( Compression::MAX_FRAME_SIZE );
+
+    // deflate adds a few bytes per block to incompressible data, more means a broken peer
+    auto maxWireBytes = 2 * ( uint64_t ) _len + Compression::MAX_FRAME_SIZE;
+
+    uint64_t wireBytes = 0;
+
+    while ( true ) {
+        readBytes(
+            _descriptor, frame->data(), msg_len( Compression::FRAME_HEADER_SIZE ), _timeoutSec );
+
+        auto frameSize = Compression::readFrameSize( frame->data() );
+
+        wireBytes += Compression::FRAME_HEADER_SIZE + frameSize;
+
+        if ( frameSize == 0 )
+            break;
+
+        if ( wireBytes > maxWireBytes ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Compressed payload too large:" + to_string( wireBytes ), __CLASS_NAME__ ) );
+        }
+
+        readBytes( _descriptor, frame->data(), msg_len( frameSize ), _timeoutSec );
+
+        decompressor.addFrame( frame->data(), frameSize );
+    }
+
+    decompressor.finish();
+
+    return wireBytes;
+}
+
+
+void IO::readBytes(
+    file_descriptor _descriptor, uint8_t* _data, msg_len _len, uint32_t _timeoutSec ) {
+    CHECK_ARGUMENT( _data )
+    CHECK_ARGUMENT( _len > 0 )
 
     int64_t bytesRead = 0;
 
@@ -83,8 +250,7 @@ void IO::readBytes( file_descriptor _descriptor, const ptr< vector< uint8_t > >&
             BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
 
 
-        result = recv(
-            int( _descriptor ), _buffer->data() + bytesRead, uint64_t( _len ) - bytesRead, 0 );
+        result = recv( int( _descriptor ), _data + bytesRead, uint64_t( _len ) - bytesRead, 0 );
 
         if ( sChain->getNode()->isExitRequested() )
             BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
@@ -115,6 +281,14 @@ void IO::readBytes( file_descriptor _descriptor, const ptr< vector< uint8_t > >&
     }
 
     CHECK_STATE( bytesRead == ( int64_t )( uint64_t ) _len );
+
+    IO::bytesRead[getProtocolSlot( _descriptor )] += bytesRead;
+    nodeBytesRead += bytesRead;
+
+    if ( auto emulator = NetworkEmulator::getShared() ) {
+        emulator->delayTransfer(
+            _descriptor, ( uint64_t ) sChain->getSchainIndex(), bytesRead, false );
+    }
 }
 
 
@@ -124,45 +298,168 @@ void IO::writeBytes(
     CHECK_ARGUMENT( !_buffer->empty() );
     CHECK_ARGUMENT( len <= _buffer->size() )
     CHECK_ARGUMENT( len > 0 );
-    CHECK_ARGUMENT( descriptor != 0 );
+
+    iovec iov = { _buffer->data(), ( uint64_t ) len };
+
+    writeIOVecs( descriptor, &iov, 1, _buffer );
+}
+
+
+bool IO::enableZeroCopy( file_descriptor _descriptor ) {
+#if defined( SO_ZEROCOPY ) && defined( MSG_ZEROCOPY )
+    int one = 1;
+    // fails on kernels older than 4.14, in this case a regular copying send is used
+    return setsockopt( ( int ) _descriptor, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof( one ) ) == 0;
+#else
+    return false;
+#endif
+}
 
 
+void IO::writeIOVecs( file_descriptor _descriptor, iovec* _iovecs, uint64_t _count,
+    const ptr< void >& _buffers ) {
+    CHECK_ARGUMENT( _iovecs );
+    CHECK_ARGUMENT( _count > 0 );
+    CHECK_ARGUMENT( _descriptor != 0 );
+
     if ( sChain->getNode()->getSimulateNetworkWriteDelayMs() > 0 ) {
         usleep( sChain->getNode()->getSimulateNetworkWriteDelayMs() * 1000 );
     }
 
-    uint64_t bytesWritten = 0;
-
     struct timeval tv;
     tv.tv_sec = 30;
     tv.tv_usec = 0;
-    setsockopt( int( descriptor ), SOL_SOCKET, SO_SNDTIMEO, ( const char* ) &tv, sizeof tv );
+    setsockopt( int( _descriptor ), SOL_SOCKET, SO_SNDTIMEO, ( const char* ) &tv, sizeof tv );
 
-    while ( msg_len( bytesWritten ) < len ) {
-        int64_t result = send( ( int ) descriptor, _buffer->data() + bytesWritten,
-            ( uint64_t ) len - bytesWritten, MSG_NOSIGNAL );
+    uint64_t totalBytes = 0;
+    for ( uint64_t i = 0; i < _count; i++ ) {
+        totalBytes += _iovecs[i].iov_len;
+    }
 
-        if ( sChain->getNode()->isExitRequested() )
-            BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
+    if ( auto emulator = NetworkEmulator::getShared() ) {
+        emulator->delayTransfer(
+            _descriptor, ( uint64_t ) sChain->getSchainIndex(), totalBytes, true );
+    }
 
-        if ( result < 1 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
-            BOOST_THROW_EXCEPTION(
-                NetworkProtocolException( "Peer write timeout", __CLASS_NAME__ ) );
-        }
+    int zeroCopyFlag = 0;
+    uint64_t zeroCopySocket = 0;
 
-        if ( result < 1 && ( errno == EPIPE || errno == ECONNRESET ) ) {
-            BOOST_THROW_EXCEPTION( NetworkProtocolException(
-                "Destination unexpectedly closed connection", __CLASS_NAME__ ) );
-        }
+#ifdef MSG_ZEROCOPY
+    if ( _buffers && totalBytes >= ZEROCOPY_THRESHOLD && isZeroCopyEnabled( _descriptor ) ) {
+        zeroCopySocket = zeroCopyCompletions->beginWrite( ( int ) _descriptor );
+        if ( zeroCopySocket != 0 )
+            zeroCopyFlag = MSG_ZEROCOPY;
+    }
+#endif
+
+    uint64_t zeroCopySends = 0;
 
-        if ( result < 1 ) {
-            BOOST_THROW_EXCEPTION( IOException( "Could not write bytes", errno, __CLASS_NAME__ ) );
+    try {
+        uint64_t current = 0;
+
+        while ( current < _count ) {
+            auto batch = min< uint64_t >( _count - current, IOV_MAX );
+
+            msghdr msg{};
+            msg.msg_iov = _iovecs + current;
+            msg.msg_iovlen = batch;
+
+            int64_t result = sendmsg( ( int ) _descriptor, &msg, MSG_NOSIGNAL | zeroCopyFlag );
+
+            if ( sChain->getNode()->isExitRequested() )
+                BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
+
+            if ( result < 1 && zeroCopyFlag != 0 && errno == ENOBUFS ) {
+                // out of optmem for pinned pages, fall back to copying sends
+                zeroCopyFlag = 0;
+                continue;
+            }
+
+            if ( result < 1 && ( errno == EAGAIN || errno == EWOULDBLOCK ) ) {
+                BOOST_THROW_EXCEPTION(
+                    NetworkProtocolException( "Peer write timeout", __CLASS_NAME__ ) );
+            }
+
+            if ( result < 1 && ( errno == EPIPE || errno == ECONNRESET ) ) {
+                BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                    "Destination unexpectedly closed connection", __CLASS_NAME__ ) );
+            }
+
+            if ( result < 1 ) {
+                BOOST_THROW_EXCEPTION(
+                    IOException( "Could not write bytes", errno, __CLASS_NAME__ ) );
+            }
+
+            if ( zeroCopyFlag != 0 )
+                zeroCopySends++;
+
+            // skip fully written vectors and advance into the partially written one
+            uint64_t written = result;
+            while ( current < _count && written >= _iovecs[current].iov_len ) {
+                written -= _iovecs[current].iov_len;
+                current++;
+            }
+
+            if ( current < _count ) {
+                _iovecs[current].iov_base = ( uint8_t* ) _iovecs[current].iov_base + written;
+                _iovecs[current].iov_len -= written;
+            }
         }
+    } catch ( ... ) {
+        // the sends that went out may still reference the buffers
+        if ( zeroCopySocket != 0 )
+            zeroCopyCompletions->endWrite( zeroCopySocket, zeroCopySends, _buffers );
+        throw;
+    }
+
+    // the buffers are released when the kernel reports the completions, the write does not
+    // wait for the peer to acknowledge the data
+    if ( zeroCopySocket != 0 )
+        zeroCopyCompletions->endWrite( zeroCopySocket, zeroCopySends, _buffers );
+
+    bytesWritten[getProtocolSlot( _descriptor )] += totalBytes;
+    nodeBytesWritten += totalBytes;
+}
+
+
+vector< iovec > IO::makeSegmentViewIOVecs( const ptr< vector< SegmentView > >& _views,
+    const ptr< Header >& _header, ptr< void >& _buffers ) {
+    CHECK_ARGUMENT( _views );
+    CHECK_ARGUMENT( !_views->empty() );
+
+    static const char openBracket = '[';
+    static const char closeBracket = ']';
+
+    ptr< Buffer > headerBuf = nullptr;
 
-        bytesWritten += result;
+    vector< iovec > iovecs;
+    iovecs.reserve( _views->size() + 3 );
+
+    if ( _header ) {
+        CHECK_ARGUMENT( _header->isComplete() );
+        headerBuf = _header->toBuffer();
+        iovecs.push_back( { headerBuf->getBuf()->data(), headerBuf->getCounter() } );
+    }
+
+    iovecs.push_back( { ( void* ) &openBracket, 1 } );
+    for ( auto&& view : *_views ) {
+        iovecs.push_back( { ( void* ) view.getData(), view.getSize() } );
     }
+    iovecs.push_back( { ( void* ) &closeBracket, 1 } );
+
+    // the views keep their segments mapped
+    _buffers = make_shared< pair< ptr< Buffer >, ptr< vector< SegmentView > > > >(
+        headerBuf, _views );
 
-    CHECK_STATE( bytesWritten == len )
+    return iovecs;
+}
+
+
+void IO::writeSegmentViews( file_descriptor _socket, const ptr< vector< SegmentView > >& _views,
+    const ptr< Header >& _header ) {
+    ptr< void > buffers;
+    auto iovecs = makeSegmentViewIOVecs( _views, _header, buffers );
+    writeIOVecs( _socket, iovecs.data(), iovecs.size(), buffers );
 }
 
 
@@ -183,19 +480,25 @@ void IO::writeMagic( const ptr< ClientSocket >& _socket, bool _isPing ) {
         magic = MAGIC_NUMBER;
     }
 
-    auto buf = make_shared< vector< uint8_t > >( sizeof( magic ) );
+    iovec iov = { &magic, sizeof( magic ) };
 
-    memcpy( buf->data(), &magic, sizeof( magic ) );
+    writeIOVecs( _socket->getDescriptor(), &iov, 1 );
+}
 
-    try {
-        writeBytesVector( _socket->getDescriptor(), buf );
-    } catch ( ExitRequestedException& ) {
-        throw;
-    }
 
-    catch ( ... ) {
-        throw;
-    }
+void IO::writeMagicAndHeader( const ptr< ClientSocket >& _socket, const ptr< Header >& _header ) {
+    CHECK_ARGUMENT( _socket );
+    CHECK_ARGUMENT( _header );
+    CHECK_ARGUMENT( _header->isComplete() );
+
+    uint64_t magic = MAGIC_NUMBER;
+
+    auto headerBuf = _header->toBuffer();
+
+    iovec iovecs[2] = { { &magic, sizeof( magic ) },
+        { headerBuf->getBuf()->data(), headerBuf->getCounter() } };
+
+    writeIOVecs( _socket->getDescriptor(), iovecs, 2 );
 }
 
 
@@ -206,6 +509,30 @@ void IO::writeHeader( const ptr< ClientSocket >& _socket, const ptr< Header >& _
     writeBuf( _socket->getDescriptor(), _header->toBuffer() );
 }
 
+
+vector< iovec > IO::makeHeaderAndBytesIOVecs( const ptr< Header >& _header,
+    const ptr< vector< uint8_t > >& _bytes, ptr< void >& _buffers ) {
+    CHECK_ARGUMENT( _header );
+    CHECK_ARGUMENT( _header->isComplete() );
+    CHECK_ARGUMENT( _bytes );
+    CHECK_ARGUMENT( !_bytes->empty() );
+
+    auto headerBuf = _header->toBuffer();
+
+    _buffers =
+        make_shared< pair< ptr< Buffer >, ptr< vector< uint8_t > > > >( headerBuf, _bytes );
+
+    return { { headerBuf->getBuf()->data(), headerBuf->getCounter() },
+        { _bytes->data(), _bytes->size() } };
+}
+
+void IO::writeHeaderAndBytes( file_descriptor _descriptor, const ptr< Header >& _header,
+    const ptr< vector< uint8_t > >& _bytes ) {
+    ptr< void > buffers;
+    auto iovecs = makeHeaderAndBytesIOVecs( _header, _bytes, buffers );
+    writeIOVecs( _descriptor, iovecs.data(), iovecs.size(), buffers );
+}
+
 void IO::writeBytesVector( file_descriptor _socket, const ptr< vector< uint8_t > >& _bytes ) {
     writeBytes( _socket, _bytes, msg_len( _bytes->size() ) );
 }
@@ -215,7 +542,7 @@ void IO::writePartialHashes(
     CHECK_ARGUMENT( _hashes );
     CHECK_ARGUMENT( _hashes->size() > 0 );
 
-    auto buffer = make_shared< vector< uint8_t > >( _hashes->size() * PARTIAL_HASH_LEN );
+    auto buffer = BufferPool::allocate( _hashes->size() * PARTIAL_HASH_LEN );
 
     uint64_t counter = 0;
     for ( auto&& item : *_hashes ) {
@@ -227,7 +554,8 @@ void IO::writePartialHashes(
     return writeBytesVector( _socket, buffer );
 }
 
-IO::IO( Schain* _sChain ) : sChain( _sChain ) {
+IO::IO( Schain* _sChain )
+    : sChain( _sChain ), zeroCopyCompletions( make_shared< ZeroCopyCompletions >() ) {
     CHECK_ARGUMENT( _sChain );
 };
 
@@ -235,10 +563,8 @@ IO::IO( Schain* _sChain ) : sChain( _sChain ) {
 void IO::readMagic( file_descriptor descriptor ) {
     uint64_t magic;
 
-    auto readBuffer = make_shared< vector< uint8_t > >( sizeof( magic ) );
-
     try {
-        readBytes( descriptor, readBuffer, sizeof( magic ), 3 );
+        readBytes( descriptor, ( uint8_t* ) &magic, sizeof( magic ), 3 );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -246,8 +572,6 @@ void IO::readMagic( file_descriptor descriptor ) {
             NetworkProtocolException( "Could not read magic number", __CLASS_NAME__ ) );
     }
 
-    magic = *( uint64_t* ) readBuffer->data();
-
     if ( magic != MAGIC_NUMBER ) {
         if ( magic == TEST_MAGIC_NUMBER ) {
             BOOST_THROW_EXCEPTION( PingException( "Got ping", __CLASS_NAME__ ) );
@@ -261,10 +585,10 @@ nlohmann::json IO::readJsonHeader( file_descriptor descriptor, const char* _erro
     uint32_t _timeout, string _ip, uint64_t _maxHeaderLen ) {
     CHECK_ARGUMENT( _errorString );
 
-    auto buf2 = make_shared< vector< uint8_t > >( sizeof( uint64_t ) );
+    uint64_t headerLen = 0;
 
     try {
-        readBytes( descriptor, buf2, msg_len( sizeof( uint64_t ) ), 6 );
+        readBytes( descriptor, ( uint8_t* ) &headerLen, msg_len( sizeof( headerLen ) ), 6 );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
@@ -273,8 +597,6 @@ nlohmann::json IO::readJsonHeader( file_descriptor descriptor, const char* _erro
     }
 
 
-    uint64_t headerLen = *( uint64_t* ) buf2->data();
-
     if ( headerLen < 2 || headerLen > _maxHeaderLen ) {
         LOG( err, "Total Len:" << to_string( headerLen ) );
         BOOST_THROW_EXCEPTION(
@@ -296,22 +618,28 @@ nlohmann::json IO::readJsonHeader( file_descriptor descriptor, const char* _erro
             __CLASS_NAME__ ) );
     }
 
-    auto s = make_shared< string >(
-        ( const char* ) buf->getBuf()->data(), ( size_t ) buf->getBuf()->size() );
+    auto s = string( ( const char* ) buf->getBuf()->data(), ( size_t ) buf->getBuf()->size() );
 
-    LOG( trace, "Read JSON header" << *s );
+    return parseJsonHeader( s, _errorString, _ip );
+};
+
+nlohmann::json IO::parseJsonHeader(
+    const string& _header, const char* _errorString, const string& _ip ) {
+    CHECK_ARGUMENT( _errorString );
+
+    LOG( trace, "Read JSON header" << _header );
 
     nlohmann::json js;
 
     try {
-        js = nlohmann::json::parse( *s );
+        js = nlohmann::json::parse( _header );
     } catch ( ExitRequestedException& ) {
         throw;
     } catch ( ... ) {
         BOOST_THROW_EXCEPTION( ParsingException(
-            string( _errorString ) + ":Could not parse request from" + _ip + ":" + *s,
+            string( _errorString ) + ":Could not parse request from" + _ip + ":" + _header,
             __CLASS_NAME__ ) );
     }
 
     return js;
-};
+}
@@ -30,19 +30,88 @@ class Header;
 class Buffer;
 class ClientSocket;
 class Schain;
+class SegmentView;
+class ZeroCopyCompletions;
+struct iovec;
 
 class IO {
     Schain* sChain = nullptr;
 
+    // descriptors are tagged with the protocol (port type) they serve, so that traffic
+    // can be accounted per protocol without changing every read/write call site
+    static constexpr uint64_t MAX_TAGGED_DESCRIPTORS = 65536;
+
+    static constexpr uint64_t PROTOCOL_SLOTS = STATUS + 2;  // last slot is for untagged descriptors
+
+    static array< atomic< uint8_t >, MAX_TAGGED_DESCRIPTORS > descriptorProtocols;
+
+    // set when the descriptor is tagged, if the socket accepts MSG_ZEROCOPY
+    static array< atomic< bool >, MAX_TAGGED_DESCRIPTORS > zeroCopyDescriptors;
+
+    static array< atomic< uint64_t >, PROTOCOL_SLOTS > bytesRead;
+
+    static array< atomic< uint64_t >, PROTOCOL_SLOTS > bytesWritten;
+
+    static mutex statsLock;
+
+    static array< pair< uint64_t, uint64_t >, PROTOCOL_SLOTS > lastReportedBytes;
+
+    static uint64_t lastReportTimeMs;
+
+    // totals for this node, all protocols
+    atomic< uint64_t > nodeBytesRead = 0;
+
+    atomic< uint64_t > nodeBytesWritten = 0;
+
+    static uint64_t getProtocolSlot( file_descriptor _descriptor );
+
+    static bool enableZeroCopy( file_descriptor _descriptor );
+
+    const ptr< ZeroCopyCompletions > zeroCopyCompletions;
+
+    // zerocopy is used only if _buffers is set, it keeps the memory of _iovecs until the
+    // kernel does not reference it anymore
+    void writeIOVecs( file_descriptor _descriptor, iovec* _iovecs, uint64_t _count,
+        const ptr< void >& _buffers = nullptr );
+
 public:
+    // payloads at least this large are sent with MSG_ZEROCOPY if the kernel supports it
+    static constexpr uint64_t ZEROCOPY_THRESHOLD = 1024 * 1024;
+
     IO( Schain* _sChain );
 
+    // also enables MSG_ZEROCOPY on the socket, so call it once for every new connection
+    static void tagDescriptor( file_descriptor _descriptor, port_type _portType );
+
+    // bytes/s read and written per protocol since the previous call
+    static string getStats();
+
+    uint64_t getNodeBytesRead() const;
+
+    uint64_t getNodeBytesWritten() const;
+
+    // accounts the bytes of transfers that server reactors run without IO
+    void addBytesTransferred( file_descriptor _descriptor, uint64_t _read, uint64_t _written );
+
+    static bool isZeroCopyEnabled( file_descriptor _descriptor );
+
+    [[nodiscard]] const ptr< ZeroCopyCompletions >& getZeroCopyCompletions() const;
+
     void readBytes( const ptr< ServerConnection >& _env, const ptr< vector< uint8_t > >& _buffer,
         msg_len _len, uint32_t _timeoutSec );
 
     void readBytes( file_descriptor _descriptor, const ptr< vector< uint8_t > >& _buffer,
         msg_len _len, uint32_t _timeoutSec );
 
+    void readBytes(
+        file_descriptor _descriptor, uint8_t* _data, msg_len _len, uint32_t _timeoutSec );
+
+    // reads a catchup or finalize payload of _len bytes, decompressing its frames if the
+    // response header has the compression level. Returns the number of bytes read from the socket
+    uint64_t readPossiblyCompressedBytes( file_descriptor _descriptor,
+        const ptr< vector< uint8_t > >& _buffer, msg_len _len,
+        nlohmann::json& _responseHeader, uint32_t _timeoutSec );
+
     void readBuf( file_descriptor _descriptor, const ptr< Buffer >& _buf, msg_len _len,
         uint32_t _timeoutSec );
 
@@ -53,10 +122,29 @@ public:
 
     void writeHeader( const ptr< ClientSocket >& _socket, const ptr< Header >& _header );
 
+    // the iovecs of a header and body, _buffers is set to keep their memory until they are sent
+    static vector< iovec > makeHeaderAndBytesIOVecs( const ptr< Header >& _header,
+        const ptr< vector< uint8_t > >& _bytes, ptr< void >& _buffers );
+
+    // the same for an optional header and '[' + views + ']'
+    static vector< iovec > makeSegmentViewIOVecs( const ptr< vector< SegmentView > >& _views,
+        const ptr< Header >& _header, ptr< void >& _buffers );
+
+    // header and body are sent with a single writev loop
+    void writeHeaderAndBytes( file_descriptor _descriptor, const ptr< Header >& _header,
+        const ptr< vector< uint8_t > >& _bytes );
+
     void writeMagic( const ptr< ClientSocket >& _socket, bool _isPing = false );
 
+    void writeMagicAndHeader( const ptr< ClientSocket >& _socket, const ptr< Header >& _header );
+
     void writeBytesVector( file_descriptor _socket, const ptr< vector< uint8_t > >& _bytes );
 
+    // sends '[' + views + ']' with a single writev loop, without copying the views.
+    // If _header is not null, it is sent first in the same loop
+    void writeSegmentViews( file_descriptor _socket, const ptr< vector< SegmentView > >& _views,
+        const ptr< Header >& _header = nullptr );
+
     void writePartialHashes(
         file_descriptor _socket, const ptr< map< uint64_t, ptr< partial_sha_hash > > >& _hashes );
 
@@ -64,4 +152,7 @@ public:
 
     nlohmann::json readJsonHeader( file_descriptor descriptor, const char* _errorString,
         uint32_t _timeout, string _ip, uint64_t _maxHeaderLen = MAX_HEADER_SIZE );
+
+    static nlohmann::json parseJsonHeader(
+        const string& _header, const char* _errorString, const string& _ip );
 };
@@ -29,6 +29,7 @@
 #include "chains/Schain.h"
 #include "crypto/BLAKE3Hash.h"
 #include "crypto/ConsensusBLSSigShare.h"
+#include "crypto/CryptoManager.h"
 #include "datastructures/BlockProposal.h"
 #include "db/BlockProposalDB.h"
 #include "exceptions/FatalError.h"
@@ -52,6 +53,7 @@
 
 #include "Buffer.h"
 #include "Network.h"
+#include "OutgoingMsgArena.h"
 #include "messages/NetworkMessageEnvelope.h"
 #include "network/Sockets.h"
 #include "network/ZMQSockets.h"
@@ -149,11 +151,8 @@ void Network::broadcastMessageImpl( const ptr< NetworkMessage >& _msg, bool _isF
         if ( _isFirstBroadcast ) {
             // sign message before sending
             _msg->sign( getSchain()->getCryptoManager() );
-            try {
-                getSchain()->getNode()->getOutgoingMsgDB()->saveMsg( _msg );
-            } catch ( exception& e ) {
-                LOG( err, "Could not save outgoing message:" << string( e.what() ) );
-            }
+            // kept for rebroadcasts, and saved to the outgoing message db in the background
+            outgoingMessages->add( _msg );
         }
 
 
@@ -249,34 +248,10 @@ void Network::networkReadLoop() {
 
     while ( !sChain->getNode()->isExitRequested() ) {
         try {
-            ptr< NetworkMessageEnvelope > m = receiveMessage();
-
-            if ( !m )
-                continue;  // check exit again
-
-            auto msg = dynamic_pointer_cast< NetworkMessage >( m->getMessage() );
-
-
-            // catchup test
-            if ( msg->getBlockID() <= catchupBlocks ) {
-                continue;
-            }
-
-
-            if ( !knownMsgHashes.putIfDoesNotExist( msg->getHash().toHex(), true ) ) {
-                // already seen this message, dropping
-                continue;
-            }
-
-            if ( msg->getMsgType() == MSG_ORACLE_REQ_BROADCAST ||
-                 msg->getMsgType() == MSG_ORACLE_RSP ) {
-                sChain->getOracleResultAssemblyAgent()->postMessage( m );
-                continue;
-            }
-
-            CHECK_STATE( sChain );
+            auto messages = receiveMessages();
 
-            postDeferOrDrop( m );
+            for ( auto&& m : *messages )
+                processReceivedMessage( m );
         } catch ( ExitRequestedException& ) {
             break;
         } catch ( FatalError& e ) {
@@ -292,6 +267,32 @@ void Network::networkReadLoop() {
 }
 
 
+void Network::processReceivedMessage( const ptr< NetworkMessageEnvelope >& _m ) {
+    CHECK_ARGUMENT( _m );
+
+    auto msg = dynamic_pointer_cast< NetworkMessage >( _m->getMessage() );
+
+    // catchup test
+    if ( msg->getBlockID() <= catchupBlocks ) {
+        return;
+    }
+
+    if ( !knownMsgHashes.putIfDoesNotExist( msg->getHash().toHex(), true ) ) {
+        // already seen this message, dropping
+        return;
+    }
+
+    if ( msg->getMsgType() == MSG_ORACLE_REQ_BROADCAST || msg->getMsgType() == MSG_ORACLE_RSP ) {
+        sChain->getOracleResultAssemblyAgent()->postMessage( _m );
+        return;
+    }
+
+    CHECK_STATE( sChain );
+
+    postDeferOrDrop( _m );
+}
+
+
 /*
  * Consensus initially defers messages that come from the "future" - those that
  * have the block_id or the consensus round larger than currently processed.
@@ -424,48 +425,101 @@ bool Network::validateIpAddress( const string& _ip ) {
     return result != 0;
 }
 
+uint64_t Network::getMessageBytesSent() const {
+    return messageBytesSent;
+}
+
+const ptr< OutgoingMsgArena >& Network::getOutgoingMessages() const {
+    return outgoingMessages;
+}
+
+uint64_t Network::getMessageBytesReceived() const {
+    return messageBytesReceived;
+}
+
 string Network::ipToString( uint32_t _ip ) {
     char* ip = ( char* ) &_ip;
     return string( to_string( ( uint8_t ) ip[0] ) + "." + to_string( ( uint8_t ) ip[1] ) + "." +
                    to_string( ( uint8_t ) ip[2] ) + "." + to_string( ( uint8_t ) ip[3] ) );
 }
 
-ptr< NetworkMessageEnvelope > Network::receiveMessage() {
+uint64_t Network::tryReadMessageFromNetwork( const ptr< Buffer >& ) {
+    return 0;
+}
+
+
+ptr< vector< ptr< NetworkMessageEnvelope > > > Network::receiveMessages() {
     auto buf = make_shared< Buffer >( MAX_CONSENSUS_MESSAGE_LEN );
 
+    vector< ptr< NetworkMessage > > messages;
+
     uint64_t readBytes = readMessageFromNetwork( buf );
 
-    string msg( ( const char* ) buf->getBuf()->data(), readBytes );
+    for ( uint64_t i = 1; readBytes > 0; i++ ) {
+        messageBytesReceived += readBytes;
 
-    auto mptr = NetworkMessage::parseMessage( msg, getSchain() );
+        string msg( ( const char* ) buf->getBuf()->data(), readBytes );
+
+        try {
+            auto mptr = NetworkMessage::parseMessage( msg, getSchain() );
+
+            CHECK_STATE( mptr );
+
+            if ( getSchain()->getNode()->getVisualizationType() > 0 ) {
+                saveToVisualization( mptr, getSchain()->getNode()->getVisualizationType() );
+            }
+
+            messages.push_back( mptr );
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( exception& e ) {
+            SkaleException::logNested( e );
+        }
 
-    CHECK_STATE( mptr );
+        if ( i >= MAX_MESSAGE_VERIFY_BATCH )
+            break;
 
-    if ( getSchain()->getNode()->getVisualizationType() > 0 ) {
-        saveToVisualization( mptr, getSchain()->getNode()->getVisualizationType() );
+        try {
+            readBytes = tryReadMessageFromNetwork( buf );
+        } catch ( ExitRequestedException& ) {
+            throw;
+        } catch ( exception& e ) {
+            // verify what was read so far
+            SkaleException::logNested( e );
+            break;
+        }
     }
 
+    auto verified = getSchain()->getCryptoManager()->verifyNetworkMsgs( messages );
 
-    mptr->verify( getSchain()->getCryptoManager() );
+    auto result = make_shared< vector< ptr< NetworkMessageEnvelope > > >();
 
+    for ( uint64_t i = 0; i < messages.size(); i++ ) {
+        auto& mptr = messages.at( i );
 
-    ptr< NodeInfo > realSender = sChain->getNode()->getNodeInfoByIndex( mptr->getSrcSchainIndex() );
+        if ( !verified.at( i ) ) {
+            LOG( err, "ECDSA sig did not verify" );
+            continue;
+        }
 
-    if ( realSender == nullptr ) {
-        BOOST_THROW_EXCEPTION( InvalidStateException(
-            "NetworkMessage from unknown sender schain index", __CLASS_NAME__ ) );
-    }
+        ptr< NodeInfo > realSender =
+            sChain->getNode()->getNodeInfoByIndex( mptr->getSrcSchainIndex() );
 
-    ptr< ProtocolKey > key = mptr->createProtocolKey();
+        if ( realSender == nullptr ) {
+            LOG( err, "NetworkMessage from unknown sender schain index" );
+            continue;
+        }
 
-    CHECK_STATE( key );
+        if ( mptr->createProtocolKey() == nullptr ) {
+            LOG( err, "Network Message with corrupt protocol key" );
+            continue;
+        }
 
-    if ( key == nullptr ) {
-        BOOST_THROW_EXCEPTION( InvalidMessageFormatException(
-            "Network Message with corrupt protocol key", __CLASS_NAME__ ) );
-    };
+        result->push_back(
+            make_shared< NetworkMessageEnvelope >( mptr, realSender->getSchainIndex() ) );
+    }
 
-    return make_shared< NetworkMessageEnvelope >( mptr, realSender->getSchainIndex() );
+    return result;
 };
 
 
@@ -500,7 +554,8 @@ Network::Network( Schain& _sChain )
     : Agent( _sChain, false ),
       knownMsgHashes( KNOWN_MSG_HASHES_SIZE ),
       delayedSends( ( uint64_t ) _sChain.getNodeCount() ),
-      delayedSendsLocks( ( uint64_t ) _sChain.getNodeCount() ) {
+      delayedSendsLocks( ( uint64_t ) _sChain.getNodeCount() ),
+      outgoingMessages( make_shared< OutgoingMsgArena >( &_sChain ) ) {
     // no network objects needed for sync nodes
     CHECK_STATE( !getNode()->isSyncOnlyNode() );
 
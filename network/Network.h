@@ -34,6 +34,7 @@ class OracleResponseMessage;
 class Buffer;
 class Node;
 class Schain;
+class OutgoingMsgArena;
 
 enum TransportType { ZMQ };
 
@@ -48,8 +49,15 @@ protected:
 
     uint32_t packetLoss = 0;
 
+    // consensus message traffic of this node
+    atomic< uint64_t > messageBytesSent = 0;
+
+    atomic< uint64_t > messageBytesReceived = 0;
+
     uint64_t catchupBlocks = 0;
 
+    ptr< OutgoingMsgArena > outgoingMessages;
+
     ptr< thread > networkReadThread;
 
     ptr< thread > deferredMessageThread;
@@ -87,10 +95,17 @@ public:
 
     void broadcastMessageImpl( const ptr< NetworkMessage >& _msg, bool _isFirstBroadcast );
 
-    ptr< NetworkMessageEnvelope > receiveMessage();
+    // waits for a message, then also reads the messages that are already waiting, up to
+    // MAX_MESSAGE_VERIFY_BATCH, and verifies them together. Drops invalid messages
+    ptr< vector< ptr< NetworkMessageEnvelope > > > receiveMessages();
+
+    void processReceivedMessage( const ptr< NetworkMessageEnvelope >& _m );
 
     virtual uint64_t readMessageFromNetwork( ptr< Buffer > buf ) = 0;
 
+    // reads a message if one is waiting, returns 0 otherwise
+    virtual uint64_t tryReadMessageFromNetwork( const ptr< Buffer >& _buf );
+
     static bool validateIpAddress( const string& _ip );
 
     static void setTransport( TransportType transport );
@@ -111,5 +126,11 @@ public:
 
     uint64_t computeTotalDelayedSends();
 
+    uint64_t getMessageBytesSent() const;
+
+    const ptr< OutgoingMsgArena >& getOutgoingMessages() const;
+
+    uint64_t getMessageBytesReceived() const;
+
     void saveToVisualization( ptr< NetworkMessage > _msg, uint64_t _visualizationType );
 };
@@ -0,0 +1,301 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file NetworkEmulator.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <fstream>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+#include "exceptions/InvalidArgumentException.h"
+#include "exceptions/NetworkProtocolException.h"
+#include "utils/Time.h"
+
+#include "NetworkEmulator.h"
+
+
+ptr< NetworkEmulator > NetworkEmulator::shared = nullptr;
+
+array< atomic< uint64_t >, NetworkEmulator::MAX_TAGGED_DESCRIPTORS >
+    NetworkEmulator::descriptorPeers;
+
+array< atomic< uint8_t >, NetworkEmulator::MAX_TAGGED_DESCRIPTORS >
+    NetworkEmulator::descriptorDirections;
+
+
+NetworkEmulator::LatencyDistribution NetworkEmulator::parseDistribution( const string& _name ) {
+    if ( _name == "fixed" )
+        return FIXED;
+    if ( _name == "uniform" )
+        return UNIFORM;
+    if ( _name == "normal" )
+        return NORMAL;
+    if ( _name == "lognormal" )
+        return LOGNORMAL;
+    BOOST_THROW_EXCEPTION(
+        InvalidArgumentException( "Unknown latency distribution:" + _name, __CLASS_NAME__ ) );
+}
+
+
+NetworkEmulator::Link NetworkEmulator::parseLink( const nlohmann::json& _j, const Link& _base ) {
+    Link result = _base;
+
+    if ( _j.count( "distribution" ) > 0 )
+        result.distribution = parseDistribution( _j.at( "distribution" ).get< string >() );
+    if ( _j.count( "latencyMs" ) > 0 )
+        result.latencyMs = _j.at( "latencyMs" ).get< double >();
+    if ( _j.count( "jitterMs" ) > 0 )
+        result.jitterMs = _j.at( "jitterMs" ).get< double >();
+    if ( _j.count( "bandwidthMbps" ) > 0 )
+        result.bytesPerMs = _j.at( "bandwidthMbps" ).get< double >() * 1000000 / 8 / 1000;
+    if ( _j.count( "loss" ) > 0 )
+        result.loss = _j.at( "loss" ).get< double >();
+
+    CHECK_ARGUMENT( result.latencyMs >= 0 );
+    CHECK_ARGUMENT( result.jitterMs >= 0 );
+    CHECK_ARGUMENT( result.bytesPerMs >= 0 );
+    CHECK_ARGUMENT( result.loss >= 0 && result.loss < 1 );
+
+    return result;
+}
+
+
+vector< uint64_t > NetworkEmulator::parseIndices( const nlohmann::json& _j ) {
+    vector< uint64_t > result;
+
+    if ( _j.is_array() ) {
+        for ( auto&& index : _j )
+            result.push_back( index.get< uint64_t >() );
+    } else {
+        result.push_back( _j.get< uint64_t >() );
+    }
+
+    for ( auto index : result )
+        CHECK_ARGUMENT( index > 0 );
+
+    return result;
+}
+
+
+NetworkEmulator::NetworkEmulator( const nlohmann::json& _config )
+    : startTimeMs( Time::getCurrentTimeMs() ),
+      rng( _config.count( "seed" ) > 0 ? _config.at( "seed" ).get< uint64_t >() : 1 ) {
+    if ( _config.count( "default" ) > 0 )
+        defaultLink = parseLink( _config.at( "default" ), defaultLink );
+
+    if ( _config.count( "links" ) > 0 ) {
+        for ( auto&& item : _config.at( "links" ) ) {
+            auto link = parseLink( item, defaultLink );
+            auto bidirectional =
+                item.count( "bidirectional" ) == 0 || item.at( "bidirectional" ).get< bool >();
+            // later entries override earlier ones
+            for ( auto from : parseIndices( item.at( "from" ) ) ) {
+                for ( auto to : parseIndices( item.at( "to" ) ) ) {
+                    if ( from == to )
+                        continue;
+                    links[{ from, to }] = link;
+                    if ( bidirectional )
+                        links[{ to, from }] = link;
+                }
+            }
+        }
+    }
+
+    if ( _config.count( "partitions" ) > 0 ) {
+        for ( auto&& item : _config.at( "partitions" ) ) {
+            Partition partition;
+            partition.startMs = item.at( "startMs" ).get< uint64_t >();
+            partition.endMs = item.at( "endMs" ).get< uint64_t >();
+            CHECK_ARGUMENT( partition.startMs < partition.endMs );
+            uint64_t group = 0;
+            for ( auto&& members : item.at( "groups" ) ) {
+                for ( auto index : parseIndices( members ) )
+                    partition.groups[index] = group;
+                group++;
+            }
+            partitions.push_back( partition );
+        }
+    }
+}
+
+
+void NetworkEmulator::init( const string& _configFile ) {
+    ifstream file( _configFile );
+
+    if ( !file.is_open() ) {
+        BOOST_THROW_EXCEPTION(
+            FatalError( "Could not open network emulation config:" + _configFile ) );
+    }
+
+    nlohmann::json config;
+
+    try {
+        file >> config;
+        shared = make_shared< NetworkEmulator >( config );
+    } catch ( ... ) {
+        throw_with_nested(
+            FatalError( "Invalid network emulation config:" + _configFile, __CLASS_NAME__ ) );
+    }
+
+    LOG( info, "Network emulation enabled:" << _configFile );
+}
+
+
+NetworkEmulator* NetworkEmulator::getShared() {
+    return shared.get();
+}
+
+
+NetworkEmulator::Link& NetworkEmulator::getLink( uint64_t _from, uint64_t _to ) {
+    auto it = links.find( { _from, _to } );
+
+    if ( it == links.end() )
+        it = links.emplace( make_pair( _from, _to ), defaultLink ).first;
+
+    return it->second;
+}
+
+
+double NetworkEmulator::sampleLatencyMs( const Link& _link ) {
+    double result = _link.latencyMs;
+
+    switch ( _link.distribution ) {
+    case FIXED:
+        break;
+    case UNIFORM:
+        result = uniform_real_distribution< double >(
+            _link.latencyMs - _link.jitterMs, _link.latencyMs + _link.jitterMs )( rng );
+        break;
+    case NORMAL:
+        if ( _link.jitterMs > 0 )
+            result = normal_distribution< double >( _link.latencyMs, _link.jitterMs )( rng );
+        break;
+    case LOGNORMAL:
+        // latency is the median, and the tail grows with the jitter
+        if ( _link.latencyMs > 0 && _link.jitterMs > 0 )
+            result = lognormal_distribution< double >(
+                log( _link.latencyMs ), _link.jitterMs / _link.latencyMs )( rng );
+        break;
+    }
+
+    return max( result, 0.0 );
+}
+
+
+bool NetworkEmulator::isPartitioned( uint64_t _from, uint64_t _to ) {
+    auto elapsedMs = Time::getCurrentTimeMs() - startTimeMs;
+
+    for ( auto&& partition : partitions ) {
+        if ( elapsedMs < partition.startMs || elapsedMs >= partition.endMs )
+            continue;
+
+        auto from = partition.groups.find( _from );
+        auto to = partition.groups.find( _to );
+
+        if ( from != partition.groups.end() && to != partition.groups.end() &&
+             from->second != to->second )
+            return true;
+    }
+
+    return false;
+}
+
+
+double NetworkEmulator::reserveTransfer(
+    uint64_t _from, uint64_t _to, uint64_t _bytes, bool _payLatency, bool& _lost ) {
+    transfers++;
+
+    lock_guard< mutex > guard( lock );
+
+    auto& link = getLink( _from, _to );
+
+    auto start = max( ( double ) Time::getCurrentTimeMs(), link.busyUntilMs );
+    link.busyUntilMs = start + ( link.bytesPerMs > 0 ? _bytes / link.bytesPerMs : 0 );
+
+    auto arrivalMs = link.busyUntilMs + ( _payLatency ? sampleLatencyMs( link ) : 0 );
+    arrivalMs = max( arrivalMs, link.lastArrivalMs );
+    link.lastArrivalMs = arrivalMs;
+
+    // a lost transfer still takes its share of the bandwidth
+    _lost = link.loss > 0 && uniform_real_distribution< double >( 0, 1 )( rng ) < link.loss;
+
+    if ( _lost )
+        lostTransfers++;
+
+    return arrivalMs;
+}
+
+
+void NetworkEmulator::delayTransfer(
+    file_descriptor _descriptor, uint64_t _localIndex, uint64_t _bytes, bool _isWrite ) {
+    auto descriptor = ( uint64_t )( int ) _descriptor;
+
+    if ( descriptor >= MAX_TAGGED_DESCRIPTORS )
+        return;
+
+    uint64_t peer = descriptorPeers[descriptor];
+
+    if ( peer == 0 )
+        return;
+
+    auto from = _isWrite ? _localIndex : peer;
+    auto to = _isWrite ? peer : _localIndex;
+
+    if ( isPartitioned( from, to ) ) {
+        blockedTransfers++;
+        BOOST_THROW_EXCEPTION( NetworkProtocolException( "Emulated partition between " +
+                                                             to_string( from ) + " and " +
+                                                             to_string( to ),
+            __CLASS_NAME__ ) );
+    }
+
+    auto direction = _isWrite ? WRITE : READ;
+    auto payLatency = descriptorDirections[descriptor].exchange( direction ) != direction;
+
+    bool lost = false;
+    auto arrivalMs = reserveTransfer( from, to, _bytes, payLatency, lost );
+
+    if ( lost )
+        arrivalMs += TCP_MIN_RTO_MS;
+
+    auto now = ( double ) Time::getCurrentTimeMs();
+
+    if ( arrivalMs > now )
+        usleep( ( useconds_t )( ( arrivalMs - now ) * 1000 ) );
+}
+
+
+void NetworkEmulator::tagDescriptor( file_descriptor _descriptor, uint64_t _peerIndex ) {
+    auto descriptor = ( uint64_t )( int ) _descriptor;
+
+    if ( descriptor >= MAX_TAGGED_DESCRIPTORS )
+        return;
+
+    descriptorPeers[descriptor] = _peerIndex;
+    descriptorDirections[descriptor] = NONE;
+}
+
+
+string NetworkEmulator::getStats() {
+    return to_string( transfers ) + "/" + to_string( lostTransfers ) + "/" +
+           to_string( blockedTransfers );
+}
@@ -0,0 +1,154 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file NetworkEmulator.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <random>
+
+#include "thirdparty/json.hpp"
+
+/*
+ * Emulates WAN links between the nodes of an in-process test run.
+ *
+ * Every directed link between two schain indices has a latency distribution, a bandwidth cap
+ * and a loss probability. Transfers on a link are serialized, so that the consensus messages and
+ * the proposal and catchup connections of a pair of nodes compete for the same bandwidth.
+ * Partitions cut the links between groups of nodes for a time window.
+ *
+ * Consensus messages are sent by a timer at their arrival time, and lost messages are dropped.
+ * For TCP connections the client thread sleeps until the data would arrive, in both directions
+ * of the exchange, and a lost transfer costs a retransmission timeout.
+ *
+ * The config is a json file:
+ *
+ * { "seed": 1,
+ *   "default": { "latencyMs": 50, "jitterMs": 10, "distribution": "normal",
+ *                "bandwidthMbps": 100, "loss": 0.001 },
+ *   "links": [ { "from": [1, 2], "to": [3, 4], "latencyMs": 120, "bidirectional": true } ],
+ *   "partitions": [ { "startMs": 20000, "endMs": 30000, "groups": [[1, 2], [3, 4]] } ] }
+ *
+ * Distributions are fixed, uniform, normal and lognormal. Partition times count from the
+ * start of the emulator, nodes that are not in any group of a partition are not cut off.
+ */
+class NetworkEmulator {
+public:
+    enum LatencyDistribution { FIXED, UNIFORM, NORMAL, LOGNORMAL };
+
+private:
+    class Link {
+    public:
+        LatencyDistribution distribution = FIXED;
+
+        double latencyMs = 0;
+
+        double jitterMs = 0;
+
+        double bytesPerMs = 0;  // 0 if not limited
+
+        double loss = 0;
+
+        // the time the link finishes sending the data queued so far
+        double busyUntilMs = 0;
+
+        // arrival time of the last transfer, so that transfers do not overtake each other
+        double lastArrivalMs = 0;
+    };
+
+    class Partition {
+    public:
+        uint64_t startMs = 0;
+
+        uint64_t endMs = 0;
+
+        map< uint64_t, uint64_t > groups;  // schain index -> group
+    };
+
+    static constexpr uint64_t MAX_TAGGED_DESCRIPTORS = 65536;
+
+    // Linux does not retransmit sooner than this
+    static constexpr uint64_t TCP_MIN_RTO_MS = 200;
+
+    enum Direction : uint8_t { NONE, WRITE, READ };
+
+    static ptr< NetworkEmulator > shared;
+
+    // the peer of each client connection, 0 for untagged descriptors
+    static array< atomic< uint64_t >, MAX_TAGGED_DESCRIPTORS > descriptorPeers;
+
+    // the direction of the previous transfer. Latency is paid when the direction changes
+    static array< atomic< uint8_t >, MAX_TAGGED_DESCRIPTORS > descriptorDirections;
+
+    const uint64_t startTimeMs;
+
+    Link defaultLink;
+
+    vector< Partition > partitions;
+
+    atomic< uint64_t > transfers = 0;
+
+    atomic< uint64_t > lostTransfers = 0;
+
+    atomic< uint64_t > blockedTransfers = 0;
+
+    mutex lock;
+
+    // the fields below are protected by lock
+
+    map< pair< uint64_t, uint64_t >, Link > links;
+
+    mt19937_64 rng;
+
+    static LatencyDistribution parseDistribution( const string& _name );
+
+    static Link parseLink( const nlohmann::json& _j, const Link& _base );
+
+    static vector< uint64_t > parseIndices( const nlohmann::json& _j );
+
+    Link& getLink( uint64_t _from, uint64_t _to );
+
+    double sampleLatencyMs( const Link& _link );
+
+public:
+    explicit NetworkEmulator( const nlohmann::json& _config );
+
+    // enables emulation for the nodes created afterwards
+    static void init( const string& _configFile );
+
+    // nullptr if emulation is not enabled
+    static NetworkEmulator* getShared();
+
+    bool isPartitioned( uint64_t _from, uint64_t _to );
+
+    // arrival time in ms of _bytes sent now from _from to _to. Sets _lost if the transfer is lost
+    double reserveTransfer(
+        uint64_t _from, uint64_t _to, uint64_t _bytes, bool _payLatency, bool& _lost );
+
+    // sleeps for the time a transfer on a tagged client connection takes, and throws if
+    // the link is partitioned
+    void delayTransfer(
+        file_descriptor _descriptor, uint64_t _localIndex, uint64_t _bytes, bool _isWrite );
+
+    static void tagDescriptor( file_descriptor _descriptor, uint64_t _peerIndex );
+
+    string getStats();
+};
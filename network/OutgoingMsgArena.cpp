@@ -0,0 +1,192 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file OutgoingMsgArena.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "chains/Schain.h"
+#include "db/MsgDB.h"
+#include "messages/NetworkMessage.h"
+#include "node/Node.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
+
+#include "OutgoingMsgArena.h"
+
+
+OutgoingMsgArena::OutgoingMsgArena( Schain* _sChain )
+    : sChain( _sChain ),
+      saveExecutor( make_shared< TaskExecutor >( "OutMsgSave", BlockingIOPool::getShared() ) ) {
+    CHECK_ARGUMENT( _sChain );
+}
+
+
+uint64_t OutgoingMsgArena::getBytes( const vector< ptr< NetworkMessage > >& _messages ) {
+    uint64_t result = 0;
+    for ( auto&& msg : _messages )
+        result += msg->getSerialized()->size();
+    return result;
+}
+
+
+void OutgoingMsgArena::add( const ptr< NetworkMessage >& _msg ) {
+    CHECK_ARGUMENT( _msg );
+
+    // the message is not shared with other threads yet
+    _msg->setSerialized( _msg->serializeToString() );
+
+    auto blockID = ( uint64_t ) _msg->getBlockID();
+    bool startSaving = false;
+
+    {
+        lock_guard< mutex > guard( lock );
+
+        if ( blockID > lastCommittedBlockID ) {
+            auto& messages = blocks[blockID];
+            if ( !messages )
+                messages = make_shared< vector< ptr< NetworkMessage > > >();
+            messages->push_back( _msg );
+            arenaBytes += _msg->getSerialized()->size();
+        }
+
+        unsaved.push_back( _msg );
+        startSaving = !saving;
+        saving = true;
+    }
+
+    if ( startSaving )
+        saveExecutor->submit( [this]() { saveLoop(); } );
+}
+
+
+void OutgoingMsgArena::saveLoop() {
+    while ( true ) {
+        vector< ptr< NetworkMessage > > batch;
+
+        {
+            lock_guard< mutex > guard( lock );
+            if ( unsaved.empty() ) {
+                saving = false;
+                return;
+            }
+            batch.swap( unsaved );
+        }
+
+        save( batch );
+    }
+}
+
+
+void OutgoingMsgArena::save( const vector< ptr< NetworkMessage > >& _batch ) {
+    if ( _batch.empty() )
+        return;
+
+    try {
+        sChain->getNode()->getOutgoingMsgDB()->saveMsgs( _batch );
+        savedMessages += _batch.size();
+        savedBatches++;
+    } catch ( exception& e ) {
+        LOG( err, "Could not save outgoing messages:" << string( e.what() ) );
+    }
+}
+
+
+void OutgoingMsgArena::flush() {
+    vector< ptr< NetworkMessage > > batch;
+
+    {
+        lock_guard< mutex > guard( lock );
+        batch.swap( unsaved );
+    }
+
+    save( batch );
+}
+
+
+ptr< vector< ptr< NetworkMessage > > > OutgoingMsgArena::getMessages( block_id _blockID ) {
+    auto blockID = ( uint64_t ) _blockID;
+
+    {
+        lock_guard< mutex > guard( lock );
+        if ( dbMergedBlocks.count( blockID ) > 0 ) {
+            auto it = blocks.find( blockID );
+            if ( it == blocks.end() )
+                return make_shared< vector< ptr< NetworkMessage > > >();
+            return make_shared< vector< ptr< NetworkMessage > > >( *it->second );
+        }
+    }
+
+    // the first read of the block, the db has the messages sent before the restart
+    auto saved = sChain->getNode()->getOutgoingMsgDB()->getMessages( _blockID );
+    CHECK_STATE( saved );
+
+    lock_guard< mutex > guard( lock );
+
+    if ( blockID <= lastCommittedBlockID )
+        return saved;
+
+    auto& messages = blocks[blockID];
+    if ( !messages )
+        messages = make_shared< vector< ptr< NetworkMessage > > >();
+
+    if ( dbMergedBlocks.insert( blockID ).second ) {
+        // the messages added since the start may be saved already
+        unordered_set< string_view > added;
+        for ( auto&& msg : *messages )
+            added.insert( *msg->getSerialized() );
+
+        auto merged = make_shared< vector< ptr< NetworkMessage > > >();
+        for ( auto&& msg : *saved ) {
+            if ( added.count( *msg->getSerialized() ) == 0 ) {
+                merged->push_back( msg );
+                arenaBytes += msg->getSerialized()->size();
+            }
+        }
+
+        merged->insert( merged->end(), messages->begin(), messages->end() );
+        messages = merged;
+    }
+
+    return make_shared< vector< ptr< NetworkMessage > > >( *messages );
+}
+
+
+void OutgoingMsgArena::blockCommitted( block_id _blockID ) {
+    lock_guard< mutex > guard( lock );
+
+    lastCommittedBlockID = max( lastCommittedBlockID, ( uint64_t ) _blockID );
+
+    while ( !blocks.empty() && blocks.begin()->first <= lastCommittedBlockID ) {
+        arenaBytes -= getBytes( *blocks.begin()->second );
+        blocks.erase( blocks.begin() );
+    }
+
+    dbMergedBlocks.erase(
+        dbMergedBlocks.begin(), dbMergedBlocks.upper_bound( lastCommittedBlockID ) );
+}
+
+
+string OutgoingMsgArena::getStats() {
+    lock_guard< mutex > guard( lock );
+    return to_string( blocks.size() ) + "/" + to_string( arenaBytes ) + "/" +
+           to_string( savedMessages ) + "/" + to_string( savedBatches );
+}
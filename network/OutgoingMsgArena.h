@@ -0,0 +1,91 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file OutgoingMsgArena.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+class Schain;
+class NetworkMessage;
+class TaskExecutor;
+
+/*
+ * The signed messages this node broadcast for the blocks that are not committed yet.
+ *
+ * A message is serialized once when it is added, and sends and rebroadcasts use the same bytes.
+ * Broadcasting does not wait for a synced db write: the messages are saved to the outgoing
+ * message db on a BlockingIOPool task, and the messages that arrive while a batch is written go
+ * to the next batch. The db is read once per block, on the first getMessages, so the messages
+ * saved before a restart are rebroadcast together with the ones sent since. The messages of a
+ * block are dropped when the block commits.
+ */
+class OutgoingMsgArena {
+    Schain* const sChain;
+
+    atomic< uint64_t > savedMessages = 0;
+
+    atomic< uint64_t > savedBatches = 0;
+
+    mutex lock;
+
+    // the fields below are protected by lock
+
+    map< uint64_t, ptr< vector< ptr< NetworkMessage > > > > blocks;
+
+    // blocks whose messages from the db are merged into blocks
+    set< uint64_t > dbMergedBlocks;
+
+    uint64_t arenaBytes = 0;
+
+    uint64_t lastCommittedBlockID = 0;
+
+    vector< ptr< NetworkMessage > > unsaved;
+
+    bool saving = false;
+
+    // declared last, so that it waits for the running save task before the fields above are
+    // destroyed
+    const ptr< TaskExecutor > saveExecutor;
+
+    void saveLoop();
+
+    void save( const vector< ptr< NetworkMessage > >& _batch );
+
+    static uint64_t getBytes( const vector< ptr< NetworkMessage > >& _messages );
+
+public:
+    explicit OutgoingMsgArena( Schain* _sChain );
+
+    // keeps a signed message and schedules saving it
+    void add( const ptr< NetworkMessage >& _msg );
+
+    // the messages of a block in the order they were added
+    ptr< vector< ptr< NetworkMessage > > > getMessages( block_id _blockID );
+
+    // also called at start with the last committed block of the chain
+    void blockCommitted( block_id _blockID );
+
+    // saves the messages that are not saved yet on the calling thread
+    void flush();
+
+    // blocks/bytes in memory/saved messages/saved batches
+    string getStats();
+};
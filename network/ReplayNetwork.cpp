@@ -1,5 +1,5 @@
 /*
-    Copyright (C) 2021- SKALE Labs
+    Copyright (C) 2022 SKALE Labs
 
     This file is part of skale-consensus.
 
@@ -16,25 +16,33 @@
     You should have received a copy of the GNU Affero General Public License
     along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
 
-    @file OracleThreadPool.cpp
+    @file ReplayNetwork.cpp
     @author Stan Kladko
-    @date 2021
+    @date 2022
 */
 
 #include "SkaleCommon.h"
 #include "Log.h"
+#include "exceptions/InvalidStateException.h"
 
-#include "OracleServerAgent.h"
-#include "OracleThreadPool.h"
+#include "ReplayNetwork.h"
 
-OracleThreadPool::OracleThreadPool( Agent* _agent )
-    : WorkerThreadPool( NUM_ORACLE_THREADS, _agent, false ) {}
 
+ReplayNetwork::ReplayNetwork( Schain& _schain ) : Network( _schain ) {}
 
-void OracleThreadPool::createThread( uint64_t /*number*/ ) {
-    auto p = ( OracleServerAgent* ) agent;
 
-    LOCK( threadPoolLock );
-    this->threadpool.push_back(
-        make_shared< thread >( OracleServerAgent::workerThreadItemSendLoop, p ) );
+uint64_t ReplayNetwork::readMessageFromNetwork( const ptr< Buffer > ) {
+    BOOST_THROW_EXCEPTION(
+        InvalidStateException( "Replay network can not receive messages", __CLASS_NAME__ ) );
+}
+
+
+bool ReplayNetwork::sendMessage( const ptr< NodeInfo >&, const ptr< NetworkMessage >& ) {
+    droppedMessages++;
+    return true;
+}
+
+
+uint64_t ReplayNetwork::getDroppedMessages() const {
+    return droppedMessages;
 }
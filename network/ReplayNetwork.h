@@ -1,5 +1,5 @@
 /*
-    Copyright (C) 2019 SKALE Labs
+    Copyright (C) 2022 SKALE Labs
 
     This file is part of skale-consensus.
 
@@ -16,24 +16,30 @@
     You should have received a copy of the GNU Affero General Public License
     along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
 
-    @file BlockFinalizeDownloaderThreadPool.h
+    @file ReplayNetwork.h
     @author Stan Kladko
-    @date 2019
+    @date 2022
 */
 
 #pragma once
 
-#include <cstdint>
+#include "Network.h"
 
-#include "threads/WorkerThreadPool.h"
+/*
+ * Consensus network of a node that replays a recorded message trace. Messages the node sends
+ * are signed and saved as usual, and then dropped. Nothing is read from it, the replayer feeds
+ * the recorded messages to the block consensus agent directly.
+ */
+class ReplayNetwork : public Network {
+    atomic< uint64_t > droppedMessages = 0;
 
-class BlockFinalizeDownloaderThreadPool : public WorkerThreadPool {
 public:
-    BlockFinalizeDownloaderThreadPool( num_threads numThreads, Agent* _params );
+    explicit ReplayNetwork( Schain& _schain );
 
-    void createThread( uint64_t threadIndex ) override;
+    uint64_t readMessageFromNetwork( const ptr< Buffer > _buf ) override;
 
-    void startService() override;
+    bool sendMessage(
+        const ptr< NodeInfo >& _remoteNodeInfo, const ptr< NetworkMessage >& _msg ) override;
 
-    ~BlockFinalizeDownloaderThreadPool() override;
+    uint64_t getDroppedMessages() const;
 };
@@ -47,6 +47,42 @@ string ServerConnection::getIP() {
     return ip;
 }
 
+const string& ServerConnection::getRequestHeader() const {
+    return requestHeader;
+}
+
+void ServerConnection::setRequestHeader( const string& _requestHeader ) {
+    requestHeader = _requestHeader;
+}
+
+uint64_t ServerConnection::getDeadlineMs() const {
+    return deadlineMs;
+}
+
+void ServerConnection::setDeadlineMs( uint64_t _deadlineMs ) {
+    deadlineMs = _deadlineMs;
+}
+
+uint64_t ServerConnection::getQueuedTimeMs() const {
+    return queuedTimeMs;
+}
+
+void ServerConnection::setQueuedTimeMs( uint64_t _queuedTimeMs ) {
+    queuedTimeMs = _queuedTimeMs;
+}
+
+void ServerConnection::setContinuation( function< void() >&& _continuation ) {
+    LOCK( m )
+    continuation = std::move( _continuation );
+}
+
+function< void() > ServerConnection::takeContinuation() {
+    LOCK( m )
+    function< void() > result;
+    result.swap( continuation );
+    return result;
+}
+
 ServerConnection::~ServerConnection() {
     totalObjects--;
     closeConnection();
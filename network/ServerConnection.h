@@ -32,6 +32,16 @@ class ServerConnection {
 
     string ip;
 
+    // request header, read by the reactor before the connection is handed to a worker
+    string requestHeader;
+
+    uint64_t deadlineMs = 0;
+
+    uint64_t queuedTimeMs = 0;
+
+    // the next step of a request, set when the reactor finished a transfer for it
+    function< void() > continuation;
+
     void closeConnection();
 
 public:
@@ -43,5 +53,22 @@ public:
 
     string getIP();
 
+    [[nodiscard]] const string& getRequestHeader() const;
+
+    void setRequestHeader( const string& _requestHeader );
+
+    [[nodiscard]] uint64_t getDeadlineMs() const;
+
+    void setDeadlineMs( uint64_t _deadlineMs );
+
+    [[nodiscard]] uint64_t getQueuedTimeMs() const;
+
+    void setQueuedTimeMs( uint64_t _queuedTimeMs );
+
+    void setContinuation( function< void() >&& _continuation );
+
+    // returns and clears the continuation, an empty function if there is none
+    function< void() > takeContinuation();
+
     static uint64_t getTotalObjects();
 };
@@ -30,7 +30,7 @@
 
 
 ServerSocket::ServerSocket( const string& _bindIP, uint16_t _basePort, port_type _portType )
-    : bindIP( _bindIP ) {
+    : bindIP( _bindIP ), portType( _portType ) {
     CHECK_ARGUMENT( !_bindIP.empty() )
 
     bindPort = _basePort + _portType;
@@ -43,3 +43,7 @@ ServerSocket::ServerSocket( const string& _bindIP, uint16_t _basePort, port_type
 
 
 ServerSocket::~ServerSocket() {}
+
+port_type ServerSocket::getPortType() const {
+    return portType;
+}
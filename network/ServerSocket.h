@@ -32,10 +32,14 @@ protected:
 
     uint32_t bindPort = 0;
 
+    port_type portType;
+
 public:
     ServerSocket( const string& _bindIP, uint16_t _basePort, port_type _portType );
 
     virtual ~ServerSocket();
 
     virtual void closeAndCleanupAll() = 0;
+
+    [[nodiscard]] port_type getPortType() const;
 };
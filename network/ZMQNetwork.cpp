@@ -38,9 +38,11 @@
 #include "messages/NetworkMessage.h"
 #include "messages/NetworkMessageEnvelope.h"
 #include "node/NodeInfo.h"
+#include "threads/TimerWheel.h"
 #include "pendingqueue/PendingTransactionsAgent.h"
 
 #include "Buffer.h"
+#include "NetworkEmulator.h"
 #include "Sockets.h"
 #include "ZMQNetwork.h"
 #include "chains/Schain.h"
@@ -55,13 +57,21 @@ bool ZMQNetwork::sendMessage(
     CHECK_ARGUMENT( _remoteNodeInfo );
     CHECK_ARGUMENT( _msg );
 
-    auto buf = _msg->serializeToString();
+    auto buf = _msg->getSerialized();
 
     getSchain()->getNode()->exitCheck();
+
+    if ( auto emulator = NetworkEmulator::getShared() )
+        return sendEmulated( *emulator, _remoteNodeInfo, string( *buf ) );
+
     void* s = sChain->getNode()->getSockets()->consensusZMQSockets->getDestinationSocket(
         _remoteNodeInfo );
 
-    return interruptableSend( s, buf.data(), buf.size() );
+    if ( !interruptableSend( s, ( void* ) buf->data(), buf->size() ) )
+        return false;
+
+    messageBytesSent += buf->size();
+    return true;
 }
 
 
@@ -151,4 +161,106 @@ uint64_t ZMQNetwork::readMessageFromNetwork( const ptr< Buffer > buf ) {
 }
 
 
-ZMQNetwork::ZMQNetwork( Schain& _schain ) : Network( _schain ) {}
\ No newline at end of file
+uint64_t ZMQNetwork::tryReadMessageFromNetwork( const ptr< Buffer >& _buf ) {
+    getSchain()->getNode()->exitCheck();
+
+    if ( getSchain()->getNodeCount() == 1 )
+        return 0;
+
+    auto s = sChain->getNode()->getSockets()->consensusZMQSockets->getReceiveSocket();
+
+    CHECK_STATE( _buf->getBuf()->size() >= MAX_CONSENSUS_MESSAGE_LEN );
+
+    auto rc = zmq_recv( s, _buf->getBuf()->data(), MAX_CONSENSUS_MESSAGE_LEN, ZMQ_DONTWAIT );
+
+    if ( rc < 0 ) {
+        if ( errno != EAGAIN ) {
+            BOOST_THROW_EXCEPTION( NetworkProtocolException(
+                "Zmq recv failed " + string( zmq_strerror( errno ) ), __CLASS_NAME__ ) );
+        }
+        return 0;
+    }
+
+    if ( ( uint64_t ) rc >= MAX_CONSENSUS_MESSAGE_LEN ) {
+        BOOST_THROW_EXCEPTION( NetworkProtocolException(
+            "Consensus Message length too large:" + to_string( rc ), __CLASS_NAME__ ) );
+    }
+
+    return rc;
+}
+
+
+bool ZMQNetwork::sendEmulated(
+    NetworkEmulator& _emulator, const ptr< NodeInfo >& _remoteNodeInfo, string&& _buf ) {
+    uint64_t from = ( uint64_t ) getSchain()->getSchainIndex();
+    uint64_t to = ( uint64_t ) _remoteNodeInfo->getSchainIndex();
+
+    // a cut off peer is handled like a peer that is offline, the message goes to delayed sends
+    if ( _emulator.isPartitioned( from, to ) )
+        return false;
+
+    bool lost = false;
+    auto arrivalMs = _emulator.reserveTransfer( from, to, _buf.size(), true, lost );
+
+    messageBytesSent += _buf.size();
+
+    if ( lost )
+        return true;
+
+    lock_guard< mutex > lock( emulatedSendsLock );
+
+    if ( emulatedSendsCancelled )
+        return true;
+
+    auto sendNumber = emulatedSendCounter++;
+
+    // the timer callback takes the lock to remove itself, so it cannot run before it is added
+    auto timerId = TimerWheel::getShared().schedule( ( uint64_t ) ceil( arrivalMs ),
+        [this, sendNumber, _remoteNodeInfo, buf = std::move( _buf )]() {
+            try {
+                void* s =
+                    sChain->getNode()->getSockets()->consensusZMQSockets->getDestinationSocket(
+                        _remoteNodeInfo );
+                // runs on the timer thread, so the message is dropped if the queue is full
+                zmq_send( s, buf.data(), buf.size(), ZMQ_DONTWAIT );
+            } catch ( ExitRequestedException& ) {
+            }
+            lock_guard< mutex > lock( emulatedSendsLock );
+            emulatedSends.erase( sendNumber );
+        } );
+
+    emulatedSends[sendNumber] = timerId;
+
+    return true;
+}
+
+
+void ZMQNetwork::cancelEmulatedSends() {
+    map< uint64_t, uint64_t > sends;
+
+    {
+        lock_guard< mutex > lock( emulatedSendsLock );
+        emulatedSendsCancelled = true;
+        sends.swap( emulatedSends );
+    }
+
+    // cancel waits for a running callback, so it is called without holding the lock
+    for ( auto&& item : sends ) {
+        TimerWheel::getShared().cancel( item.second );
+    }
+}
+
+
+void ZMQNetwork::notifyAllConditionVariables() {
+    // messages in flight must not be sent after the sockets are closed
+    cancelEmulatedSends();
+    Network::notifyAllConditionVariables();
+}
+
+
+ZMQNetwork::ZMQNetwork( Schain& _schain ) : Network( _schain ) {}
+
+
+ZMQNetwork::~ZMQNetwork() {
+    cancelEmulatedSends();
+}
\ No newline at end of file
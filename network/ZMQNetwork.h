@@ -37,8 +37,23 @@ class ServerConnection;
 class Schain;
 
 class TransactionList;
+class NetworkEmulator;
 
 class ZMQNetwork : public Network {
+    mutex emulatedSendsLock;
+
+    // send timers of messages that are still in flight on emulated links, by send number
+    map< uint64_t, uint64_t > emulatedSends;  // protected by emulatedSendsLock
+
+    uint64_t emulatedSendCounter = 0;  // protected by emulatedSendsLock
+
+    bool emulatedSendsCancelled = false;  // protected by emulatedSendsLock
+
+    bool sendEmulated( NetworkEmulator& _emulator, const ptr< NodeInfo >& _remoteNodeInfo,
+        string&& _buf );
+
+    void cancelEmulatedSends();
+
 public:
     uint64_t interruptableRecv( void* _socket, void* _buf, size_t _len );
 
@@ -46,8 +61,14 @@ public:
 
     uint64_t readMessageFromNetwork( const ptr< Buffer > buf ) override;
 
+    uint64_t tryReadMessageFromNetwork( const ptr< Buffer >& _buf ) override;
+
     explicit ZMQNetwork( Schain& _schain );
 
+    ~ZMQNetwork() override;
+
+    void notifyAllConditionVariables() override;
+
     bool sendMessage(
         const ptr< NodeInfo >& _remoteNodeInfo, const ptr< NetworkMessage >& _msg ) override;
 };
@@ -0,0 +1,205 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ZeroCopyCompletions.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <ctime>
+#include <linux/errqueue.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
+#include "utils/Time.h"
+
+#include "ZeroCopyCompletions.h"
+
+
+ZeroCopyCompletions::ZeroCopyCompletions()
+    : reapExecutor( make_shared< TaskExecutor >( "ZeroCopyReap", BlockingIOPool::getShared() ) ) {}
+
+
+ZeroCopyCompletions::~ZeroCopyCompletions() {
+    stopped = true;
+
+    // waits for the reap task
+    reapExecutor = nullptr;
+
+    for ( auto&& item : sockets )
+        close( item.second.descriptor );
+}
+
+
+uint64_t ZeroCopyCompletions::beginWrite( int _descriptor ) {
+    struct stat info {};
+    if ( fstat( _descriptor, &info ) != 0 || info.st_ino == 0 )
+        return 0;
+
+    uint64_t key = info.st_ino;
+
+    lock_guard< mutex > guard( lock );
+
+    if ( stopped )
+        return 0;
+
+    auto it = sockets.find( key );
+
+    if ( it == sockets.end() ) {
+        auto descriptor = dup( _descriptor );
+        if ( descriptor < 0 )
+            return 0;
+        it = sockets.emplace( key, PendingSocket() ).first;
+        it->second.descriptor = descriptor;
+    }
+
+    it->second.writers++;
+
+    return key;
+}
+
+
+void ZeroCopyCompletions::endWrite(
+    uint64_t _socketKey, uint64_t _sends, const ptr< void >& _buffers ) {
+    CHECK_ARGUMENT( _socketKey != 0 );
+
+    bool startReaping = false;
+
+    {
+        lock_guard< mutex > guard( lock );
+
+        auto it = sockets.find( _socketKey );
+        CHECK_STATE( it != sockets.end() );
+
+        auto& socket = it->second;
+        CHECK_STATE( socket.writers > 0 );
+        socket.writers--;
+
+        if ( _sends > 0 ) {
+            socket.sends += _sends;
+            socket.buffers.emplace_back( socket.sends, Time::getCurrentTimeMs(), _buffers );
+        }
+
+        startReaping = !reaping;
+        reaping = true;
+    }
+
+    if ( startReaping )
+        reapExecutor->submit( [this]() { reapLoop(); } );
+}
+
+
+bool ZeroCopyCompletions::readCompletions( PendingSocket& _socket ) {
+    bool result = false;
+
+    while ( true ) {
+        char control[128];
+        msghdr msg{};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof( control );
+
+        if ( recvmsg( _socket.descriptor, &msg, MSG_ERRQUEUE | MSG_DONTWAIT ) < 0 )
+            return result;
+
+        // completions arrive as ranges of send sequence numbers
+        for ( auto cmsg = CMSG_FIRSTHDR( &msg ); cmsg; cmsg = CMSG_NXTHDR( &msg, cmsg ) ) {
+            if ( !( cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR ) &&
+                 !( cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR ) )
+                continue;
+
+            auto err = ( sock_extended_err* ) CMSG_DATA( cmsg );
+
+            if ( err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY )
+                continue;
+
+            _socket.completed += err->ee_data - err->ee_info + 1;
+            result = true;
+        }
+    }
+}
+
+
+void ZeroCopyCompletions::reapLoop() {
+    while ( true ) {
+        vector< pollfd > descriptors;
+
+        {
+            lock_guard< mutex > guard( lock );
+
+            if ( sockets.empty() || stopped || reapExecutor->isExitRequested() ) {
+                reaping = false;
+                return;
+            }
+
+            for ( auto&& item : sockets )
+                descriptors.push_back( { item.second.descriptor, 0, 0 } );
+        }
+
+        // error queue data is reported as POLLERR
+        poll( descriptors.data(), descriptors.size(), 10 );
+
+        bool completed = false;
+        auto nowMs = Time::getCurrentTimeMs();
+
+        {
+            lock_guard< mutex > guard( lock );
+
+            for ( auto it = sockets.begin(); it != sockets.end(); ) {
+                auto& socket = it->second;
+                auto& buffers = socket.buffers;
+
+                completed |= readCompletions( socket );
+
+                while ( !buffers.empty() && get< 0 >( buffers.front() ) <= socket.completed ) {
+                    buffers.pop_front();
+                    releasedWrites++;
+                }
+
+                while ( !buffers.empty() &&
+                        get< 1 >( buffers.front() ) + COMPLETION_TIMEOUT_MS < nowMs ) {
+                    LOG( warn, "Zerocopy completion timeout, dropping the buffers of a write" );
+                    buffers.pop_front();
+                    expiredWrites++;
+                }
+
+                if ( buffers.empty() && socket.writers == 0 ) {
+                    close( socket.descriptor );
+                    it = sockets.erase( it );
+                } else {
+                    it++;
+                }
+            }
+        }
+
+        // a socket with a pending error reports POLLERR without completions, do not spin on it
+        if ( !completed )
+            usleep( 1000 );
+    }
+}
+
+
+string ZeroCopyCompletions::getStats() {
+    lock_guard< mutex > guard( lock );
+    return to_string( sockets.size() ) + "/" + to_string( releasedWrites ) + "/" +
+           to_string( expiredWrites );
+}
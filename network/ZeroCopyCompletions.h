@@ -0,0 +1,95 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ZeroCopyCompletions.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <sys/types.h>
+
+class TaskExecutor;
+
+/*
+ * Keeps the buffers of MSG_ZEROCOPY sends until the kernel reports that it does not
+ * reference them anymore, which happens when the peer acknowledges the data.
+ *
+ * A write registers its buffers and returns right away. Completions are read from the socket
+ * error queues on a BlockingIOPool task, and the buffers are released there, so a BufferPool
+ * vector goes back to its pool only when the kernel is done with it. Each tracked socket holds
+ * a duplicate descriptor, so that its error queue can still be read after the connection
+ * closes it. Buffers whose completions do not arrive in time are dropped.
+ */
+class ZeroCopyCompletions {
+    struct PendingSocket {
+        int descriptor = -1;
+
+        // zerocopy sends registered and completed since the socket is tracked
+        uint64_t sends = 0;
+
+        uint64_t completed = 0;
+
+        // writes that started sending and did not register their buffers yet
+        uint64_t writers = 0;
+
+        // total sends after the write, registration time, buffers of the write
+        deque< tuple< uint64_t, uint64_t, ptr< void > > > buffers;
+    };
+
+    mutex lock;
+
+    // the fields below are protected by lock
+
+    // by socket inode, since descriptor numbers are reused after close
+    map< uint64_t, PendingSocket > sockets;
+
+    bool reaping = false;
+
+    atomic< bool > stopped = false;
+
+    atomic< uint64_t > releasedWrites = 0;
+
+    atomic< uint64_t > expiredWrites = 0;
+
+    ptr< TaskExecutor > reapExecutor;
+
+    void reapLoop();
+
+    // reads the completions that are available, returns true if there were any
+    static bool readCompletions( PendingSocket& _socket );
+
+public:
+    static constexpr uint64_t COMPLETION_TIMEOUT_MS = 30000;
+
+    ZeroCopyCompletions();
+
+    ~ZeroCopyCompletions();
+
+    // call before the zerocopy sends of a write. Returns the key of the socket, or 0 if the
+    // socket can not be tracked and the write must not use zerocopy
+    uint64_t beginWrite( int _descriptor );
+
+    // keeps _buffers until the kernel completes the _sends zerocopy sends of the write.
+    // Must be called once for every beginWrite that returned a key, also if the write failed
+    void endWrite( uint64_t _socketKey, uint64_t _sends, const ptr< void >& _buffers );
+
+    // tracked sockets/released writes/expired writes
+    string getStats();
+};
@@ -40,6 +40,7 @@
 #include "oracle/OracleClient.h"
 #include "catchup/client/CatchupClientAgent.h"
 #include "thirdparty/json.hpp"
+#include "threads/ExecutorPool.h"
 #include "threads/GlobalThreadRegistry.h"
 
 
@@ -97,6 +98,7 @@
 #include "libBLS/bls/BLSPrivateKeyShare.h"
 #include "libBLS/bls/BLSPublicKey.h"
 #include "libBLS/bls/BLSSignature.h"
+#include "network/NetworkEmulator.h"
 #include "network/Sockets.h"
 #include "network/Utils.h"
 #include "network/ZMQSockets.h"
@@ -377,6 +379,12 @@ void ConsensusEngine::parseTestConfigsAndCreateAllNodes(
     try {
         checkExistsAndDirectory( dirname );
 
+        // in-process test runs can emulate WAN links between the nodes
+        auto emulationConfig = getenv( "NETWORK_EMULATION_CONFIG" );
+        if ( emulationConfig && !NetworkEmulator::getShared() ) {
+            NetworkEmulator::init( emulationConfig );
+        }
+
         // cycle through the directory
 
         uint64_t nodeCount = 0;
@@ -580,6 +588,10 @@ node_count ConsensusEngine::nodesCount() {
     return node_count( nodes.size() );
 }
 
+const map< node_id, ptr< Node > >& ConsensusEngine::getNodes() const {
+    return nodes;
+}
+
 
 std::string ConsensusEngine::exec( const char* cmd ) {
     CHECK_ARGUMENT( cmd );
@@ -663,8 +675,7 @@ void ConsensusEngine::init() {
 }
 
 
-ConsensusEngine::ConsensusEngine( block_id _lastId, uint64_t _totalStorageLimitBytes )
-    : prices( 256 ) {
+ConsensusEngine::ConsensusEngine( block_id _lastId, uint64_t _totalStorageLimitBytes ) {
     cout << "Constructing consensus engine:LAST_BLOCK:" << ( uint64_t ) _lastId
          << ":TOTAL_STORAGE_LIMIT:" << _totalStorageLimitBytes << endl;
 
@@ -689,7 +700,7 @@ ConsensusEngine::ConsensusEngine( block_id _lastId, uint64_t _totalStorageLimitB
 ConsensusEngine::ConsensusEngine( ConsensusExtFace& _extFace, uint64_t _lastCommittedBlockID,
     uint64_t _lastCommittedBlockTimeStamp, uint64_t _lastCommittedBlockTimeStampMs,
     map< string, uint64_t > _patchTimestamps, uint64_t _totalStorageLimitBytes )
-    : prices( 256 ), patchTimestamps( _patchTimestamps ) {
+    : patchTimestamps( _patchTimestamps ) {
     std::time_t lastCommitedBlockTimestamp = _lastCommittedBlockTimeStamp;
     cout << "Constructing consensus engine: "
          << ""
@@ -836,6 +847,8 @@ void ConsensusEngine::exitGracefullyAsync() {
         for ( auto&& it : nodes ) {
             it.second->getSchain()->joinMonitorAndTimeoutThreads();
         }
+
+        ExecutorPool::shutdownShared();
     } catch ( exception& e ) {
         SkaleException::logNested( e );
         status = CONSENSUS_EXITED;
@@ -905,17 +918,10 @@ u256 ConsensusEngine::getRandomForBlockId( uint64_t _blockId ) const {
 u256 ConsensusEngine::getPriceForBlockId( uint64_t _blockId ) const {
     CHECK_STATE( nodes.size() == 1 );
 
-    auto priceFromCache = prices.getIfExists( _blockId );
-
-    if ( priceFromCache.has_value() ) {
-        return any_cast< u256 >( priceFromCache );
-    }
-
+    // recent prices are kept in memory by the pricing agent
     for ( auto&& item : nodes ) {
         CHECK_STATE( item.second );
-        auto result = item.second->getSchain()->getPriceForBlockId( _blockId );
-        prices.putIfDoesNotExist( _blockId, result );
-        return result;
+        return item.second->getSchain()->getPriceForBlockId( _blockId );
     }
 
     throw std::invalid_argument( "Price not found" );
@@ -1206,6 +1212,38 @@ uint64_t ConsensusEngine::checkOracleResult( const string& _receipt, string& _re
     }
 }
 
+/*
+ * Wait until Oracle result has been derived, the request times out or _timeoutMs passes.
+ * Returns ORACLE_RESULT_NOT_READY if _timeoutMs passes first.
+ */
+
+uint64_t ConsensusEngine::waitOracleResult(
+    const string& _receipt, uint64_t _timeoutMs, string& _result ) {
+    try {
+        if ( nodes.size() == 0 ) {
+            LOG( err, string( "Empty nodes in " ) << __FUNCTION__ );
+            return ORACLE_INTERNAL_SERVER_ERROR;
+        }
+        auto node = nodes.begin()->second;
+        if ( !node ) {
+            LOG( err, string( "Null node in " ) << __FUNCTION__ );
+            return ORACLE_INTERNAL_SERVER_ERROR;
+        }
+        auto oracleClient = node->getSchain()->getOracleClient();
+        if ( !oracleClient ) {
+            LOG( err, string( "Null oracleClient in " ) << __FUNCTION__ );
+            return ORACLE_INTERNAL_SERVER_ERROR;
+        }
+        return oracleClient->waitOracleResult( _receipt, _timeoutMs, _result );
+    } catch ( exception& e ) {
+        SkaleException::logNested( e, err );
+        return ORACLE_INTERNAL_SERVER_ERROR;
+    } catch ( ... ) {
+        LOG( err, string( "Unknown exception in " ) << __FUNCTION__ );
+        return ORACLE_INTERNAL_SERVER_ERROR;
+    }
+}
+
 
 ptr< vector< uint8_t > > ConsensusEngine::getSerializedBlock( std::uint64_t _blockNumber ) {
     CHECK_STATE( nodes.size() > 0 );
@@ -52,8 +52,6 @@ class StorageLimits;
 class ConsensusEngine : public ConsensusInterface {
     map< node_id, ptr< Node > > nodes;  // tsafe
 
-    mutable cache::lru_cache< uint64_t, u256 > prices;  // tsafe
-
     ConsensusExtFace* extFace = nullptr;
 
     block_id lastCommittedBlockID = 0;
@@ -207,6 +205,9 @@ public:
 
     node_count nodesCount();
 
+    // used in benchmarks
+    const map< node_id, ptr< Node > >& getNodes() const;
+
     block_id getLargestCommittedBlockID();
 
     block_id getLargestCommittedBlockIDInDb();
@@ -304,6 +305,9 @@ public:
 
     uint64_t checkOracleResult( const string& _receipt, string& _result ) override;
 
+    uint64_t waitOracleResult(
+        const string& _receipt, uint64_t _timeoutMs, string& _result ) override;
+
 
     std::shared_ptr< std::vector< std::uint8_t > > getSerializedBlock( std::uint64_t _blockNumber );
 
@@ -33,8 +33,11 @@
 
 #pragma GCC diagnostic pop
 
+#include <algorithm>
+#include <chrono>
 #include <map>
 #include <string>
+#include <thread>
 #include <vector>
 
 enum consensus_engine_status {
@@ -178,6 +181,40 @@ public:
 
     virtual uint64_t checkOracleResult(const string &_receipt, string &_result) = 0;
 
+    /*
+     * Same as checkOracleResult, but if the result is not ready, waits until it is derived,
+     * the request times out or _timeoutMs passes. Returns as soon as the nodes agree,
+     * so clients do not need to poll.
+     *
+     * ORACLE_RESULT_NOT_READY is returned if _timeoutMs passes first.
+     * Note: this functions is guaranteed to not throw exceptions
+     *
+     * The default implementation polls checkOracleResult.
+     */
+
+    virtual uint64_t waitOracleResult(
+            const string &_receipt, uint64_t _timeoutMs, string &_result) {
+        static constexpr uint64_t POLL_INTERVAL_MS = 100;
+
+        auto start = std::chrono::steady_clock::now();
+
+        while (true) {
+            auto status = checkOracleResult(_receipt, _result);
+
+            if (status != ORACLE_RESULT_NOT_READY)
+                return status;
+
+            auto elapsedMs = (uint64_t) std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            if (elapsedMs >= _timeoutMs)
+                return ORACLE_RESULT_NOT_READY;
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                    std::min(POLL_INTERVAL_MS, _timeoutMs - elapsedMs)));
+        }
+    }
+
 
     struct SyncInfo {
         // sync information as required by eth_syncing API request of geth
@@ -23,6 +23,7 @@
 
 
 #include <chrono>
+#include <future>
 #include "leveldb/db.h"
 
 #include "SkaleCommon.h"
@@ -58,6 +59,7 @@
 #include "db/InternalInfoDB.h"
 #include "db/MsgDB.h"
 #include "db/PriceDB.h"
+#include "pricing/PricingAgent.h"
 #include "db/ProposalHashDB.h"
 #include "db/ProposalVectorDB.h"
 #include "db/RandomDB.h"
@@ -65,11 +67,15 @@
 #include "messages/Message.h"
 #include "messages/NetworkMessageEnvelope.h"
 #include "network/Sockets.h"
+#include "network/OutgoingMsgArena.h"
+#include "network/ReplayNetwork.h"
 #include "network/TCPServerSocket.h"
 #include "network/ZMQNetwork.h"
 #include "network/ZMQSockets.h"
 #include "json/JSONFactory.h"
 #include "db/StorageLimits.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
 #include "utils/Time.h"
 #include "NodeInfo.h"
 #include "Node.h"
@@ -176,38 +182,93 @@ void Node::initLevelDBs() {
     string internalInfoDBPrefix = "/internal_info_" + to_string( nodeID ) + ".db";
 
 
-    blockDB =
-        make_shared< BlockDB >( getSchain(), dbDir, blockDBPrefix, getNodeID(), getBlockDBSize() );
-    randomDB = make_shared< RandomDB >(
-        getSchain(), dbDir, randomDBPrefix, getNodeID(), getRandomDBSize() );
-    priceDB =
-        make_shared< PriceDB >( getSchain(), dbDir, priceDBPrefix, getNodeID(), getPriceDBSize() );
-    proposalHashDB = make_shared< ProposalHashDB >(
-        getSchain(), dbDir, proposalHashDBPrefix, getNodeID(), getProposalHashDBSize() );
-    proposalVectorDB = make_shared< ProposalVectorDB >(
-        getSchain(), dbDir, proposalVectorDBPrefix, getNodeID(), getProposalVectorDBSize() );
-
-    outgoingMsgDB = make_shared< MsgDB >(
-        getSchain(), dbDir, outgoingMsgDBPrefix, getNodeID(), getOutgoingMsgDBSize() );
-
-    incomingMsgDB = make_shared< MsgDB >(
-        getSchain(), dbDir, incomingMsgDBPrefix, getNodeID(), getIncomingMsgDBSize() );
+    auto startTimeMs = Time::getCurrentTimeMs();
 
-    consensusStateDB = make_shared< ConsensusStateDB >(
-        getSchain(), dbDir, consensusStateDBPrefix, getNodeID(), getConsensusStateDBSize() );
+    // The databases do not depend on each other, so they are opened in parallel. Opening a
+    // database replays the logs of all its shards, which is most of the restart time on nodes
+    // with long histories. The executor waits for submitted opens when it goes out of scope
+    TaskExecutor openExecutor( "DBOpen", BlockingIOPool::getShared() );
+
+    vector< future< void > > openTasks;
+
+    auto openInParallel = [&]( function< void() > _open ) {
+        openTasks.push_back( openExecutor.submit( [this, _open]() {
+            logThreadLocal_ = getLog();
+            _open();
+        } ) );
+    };
+
+    openInParallel( [&]() {
+        blockDB = make_shared< BlockDB >( getSchain(), dbDir, blockDBPrefix, getNodeID(),
+            getBlockDBSize(), getBlockSegmentStoreSize() );
+    } );
+    openInParallel( [&]() {
+        randomDB = make_shared< RandomDB >(
+            getSchain(), dbDir, randomDBPrefix, getNodeID(), getRandomDBSize() );
+    } );
+    openInParallel( [&]() {
+        priceDB = make_shared< PriceDB >(
+            getSchain(), dbDir, priceDBPrefix, getNodeID(), getPriceDBSize() );
+    } );
+    openInParallel( [&]() {
+        proposalHashDB = make_shared< ProposalHashDB >(
+            getSchain(), dbDir, proposalHashDBPrefix, getNodeID(), getProposalHashDBSize() );
+    } );
+    openInParallel( [&]() {
+        proposalVectorDB = make_shared< ProposalVectorDB >( getSchain(), dbDir,
+            proposalVectorDBPrefix, getNodeID(), getProposalVectorDBSize() );
+    } );
+    openInParallel( [&]() {
+        outgoingMsgDB = make_shared< MsgDB >(
+            getSchain(), dbDir, outgoingMsgDBPrefix, getNodeID(), getOutgoingMsgDBSize() );
+    } );
+    openInParallel( [&]() {
+        incomingMsgDB = make_shared< MsgDB >(
+            getSchain(), dbDir, incomingMsgDBPrefix, getNodeID(), getIncomingMsgDBSize() );
+    } );
+    openInParallel( [&]() {
+        consensusStateDB = make_shared< ConsensusStateDB >( getSchain(), dbDir,
+            consensusStateDBPrefix, getNodeID(), getConsensusStateDBSize() );
+    } );
+    openInParallel( [&]() {
+        blockSigShareDB = make_shared< BlockSigShareDB >(
+            getSchain(), dbDir, blockSigShareDBPrefix, getNodeID(), getBlockSigShareDBSize() );
+    } );
+    openInParallel( [&]() {
+        daSigShareDB = make_shared< DASigShareDB >(
+            getSchain(), dbDir, daSigShareDBPrefix, getNodeID(), getDaSigShareDBSize() );
+    } );
+    openInParallel( [&]() {
+        daProofDB = make_shared< DAProofDB >(
+            getSchain(), dbDir, daProofDBPrefix, getNodeID(), getDaProofDBSize() );
+    } );
+    openInParallel( [&]() {
+        blockProposalDB = make_shared< BlockProposalDB >(
+            getSchain(), dbDir, blockProposalDBPrefix, getNodeID(), getBlockProposalDBSize() );
+    } );
+    openInParallel( [&]() {
+        internalInfoDB = make_shared< InternalInfoDB >(
+            getSchain(), dbDir, internalInfoDBPrefix, getNodeID(), getInternalInfoDBSize() );
+    } );
+
+    // wait for all tasks before rethrowing, since they reference the locals above
+    exception_ptr firstError = nullptr;
+
+    for ( auto&& task : openTasks ) {
+        try {
+            task.get();
+        } catch ( ... ) {
+            if ( !firstError )
+                firstError = current_exception();
+        }
+    }
 
+    if ( firstError )
+        rethrow_exception( firstError );
 
-    blockSigShareDB = make_shared< BlockSigShareDB >(
-        getSchain(), dbDir, blockSigShareDBPrefix, getNodeID(), getBlockSigShareDBSize() );
-    daSigShareDB = make_shared< DASigShareDB >(
-        getSchain(), dbDir, daSigShareDBPrefix, getNodeID(), getDaSigShareDBSize() );
-    daProofDB = make_shared< DAProofDB >(
-        getSchain(), dbDir, daProofDBPrefix, getNodeID(), getDaProofDBSize() );
-    blockProposalDB = make_shared< BlockProposalDB >(
-        getSchain(), dbDir, blockProposalDBPrefix, getNodeID(), getBlockProposalDBSize() );
+    dbOpenTimeMs = Time::getCurrentTimeMs() - startTimeMs;
 
-    internalInfoDB = make_shared< InternalInfoDB >(
-        getSchain(), dbDir, internalInfoDBPrefix, getNodeID(), getInternalInfoDBSize() );
+    LOG( info, "Opened databases in " << dbOpenTimeMs << " ms" );
 }
 
 void Node::initLogging() {
@@ -252,9 +313,21 @@ void Node::initParamsFromConfig() {
     maxTransactionsPerBlock =
         getParamUint64( "maxTransactionsPerBlock", MAX_TRANSACTIONS_PER_BLOCK );
     minBlockIntervalMs = getParamUint64( "minBlockIntervalMs", MIN_BLOCK_INTERVAL_MS );
+    targetBlockTimeMs = getParamUint64( "targetBlockTimeMs", 0 );
+    maxBlockBytes = getParamUint64( "maxBlockBytes", 0 );
+    proposalReconciliation = ( getParamUint64( "proposalReconciliation", 1 ) > 0 );
+    oracleMaxConcurrentRequests =
+        getParamUint64( "oracleMaxConcurrentRequests", ORACLE_MAX_CONCURRENT_REQUESTS );
+    oracleMaxConnectionsPerHost =
+        getParamUint64( "oracleMaxConnectionsPerHost", ORACLE_MAX_CONNECTIONS_PER_HOST );
+    oracleMaxRequestsPerSecondPerHost = getParamUint64(
+        "oracleMaxRequestsPerSecondPerHost", ORACLE_MAX_REQUESTS_PER_SECOND_PER_HOST );
+    oracleResponseCacheTtlMs =
+        getParamUint64( "oracleResponseCacheTtlMs", ORACLE_RESPONSE_CACHE_TTL_MS );
     testNet = ( getParamUint64( "isTestNet", 0 ) > 0 );
 
     blockDBSize = storageLimits->getBlockDbSize();
+    blockSegmentStoreSize = storageLimits->getBlockSegmentStoreSize();
     proposalHashDBSize = storageLimits->getProposalHashDbSize();
     proposalVectorDBSize = storageLimits->getProposalVectorDbSize();
     outgoingMsgDBSize = storageLimits->getOutgoingMsgDbSize();
@@ -272,6 +345,8 @@ void Node::initParamsFromConfig() {
 
     simulateNetworkWriteDelayMs = getParamInt64( "simulateNetworkWriteDelayMs", 0 );
 
+    recordMessageTrace = getParamUint64( "recordMessageTrace", 0 ) > 0;
+
     testConfig = make_shared< TestConfig >( cfg );
 
     // for tests we add an option to read patchtimestamps from config
@@ -363,6 +438,15 @@ void Node::startServers( ptr< vector< uint8_t > > _startingFromSnapshotWithThisA
 }
 
 
+void Node::startReplay() {
+    CHECK_STATE( !startedServers );
+    CHECK_STATE( !isSyncOnlyNode() );
+    CHECK_STATE( !network );
+
+    network = make_shared< ReplayNetwork >( *sChain );
+}
+
+
 void Node::startClients() {
     if ( isExitRequested() )
         return;
@@ -572,6 +656,20 @@ void Node::exitImmediately() {
 
     LOG( info, "Status server stopped" );
 
+    try {
+        if ( getSchain()->getPricingAgent() )
+            getSchain()->getPricingAgent()->flushPrices();
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    }
+
+    try {
+        if ( network )
+            network->getOutgoingMessages()->flush();
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    }
+
     closeAllSocketsAndNotifyAllAgentsAndThreads();
 
     LOG( info, __FUNCTION__ << string( " completed" ) );
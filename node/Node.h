@@ -94,8 +94,6 @@ class Node {
 
     atomic_bool closeAllSocketsCalled = false;
 
-    void exitImmediately();
-
     bool isExitOnBlockBoundaryRequested() const;
 
     ptr< SkaleLog > log = nullptr;
@@ -109,6 +107,8 @@ class Node {
 
     uint64_t simulateNetworkWriteDelayMs = 0;
 
+    bool recordMessageTrace = false;
+
     PricingStrategyEnum DOS_PROTECT;
 
     ptr< Sockets > sockets = nullptr;
@@ -177,6 +177,8 @@ class Node {
 
     ptr< InternalInfoDB > internalInfoDB;
 
+    uint64_t dbOpenTimeMs = 0;
+
     uint64_t catchupIntervalMS = 0;
 
     uint64_t monitoringIntervalMs = 0;
@@ -201,7 +203,26 @@ class Node {
 
     uint64_t minBlockIntervalMs = 0;
 
+    // adaptive block assembly is off if 0
+    uint64_t targetBlockTimeMs = 0;
+
+    uint64_t maxBlockBytes = 0;
+
+    // proposals are pushed as short ids and a sketch of the partial hashes if true
+    bool proposalReconciliation = true;
+
+    uint64_t oracleMaxConcurrentRequests = 0;
+
+    uint64_t oracleMaxConnectionsPerHost = 0;
+
+    // not limited if 0
+    uint64_t oracleMaxRequestsPerSecondPerHost = 0;
+
+    // endpoint responses are not shared between requests if 0
+    uint64_t oracleResponseCacheTtlMs = 0;
+
     uint64_t blockDBSize = 0;
+    uint64_t blockSegmentStoreSize = 0;
     ;
     uint64_t proposalHashDBSize = 0;
     uint64_t proposalVectorDBSize = 0;
@@ -277,6 +298,9 @@ public:
 
     ptr< InternalInfoDB > getInternalInfoDB() const;
 
+    // time it took to open all databases at startup
+    uint64_t getDBOpenTimeMs() const;
+
     ptr< ProposalHashDB > getProposalHashDB() const;
 
     ptr< ProposalVectorDB > getProposalVectorDB() const;
@@ -302,6 +326,7 @@ public:
     uint64_t getIncomingMsgDBSize() const;
     uint64_t getConsensusStateDBSize() const;
     uint64_t getBlockDBSize() const;
+    uint64_t getBlockSegmentStoreSize() const;
     uint64_t getBlockSigShareDBSize() const;
     uint64_t getRandomDBSize() const;
     uint64_t getPriceDBSize() const;
@@ -311,6 +336,7 @@ public:
     uint64_t getBlockProposalDBSize() const;
     uint64_t getInternalInfoDBSize() const;
     uint64_t getSimulateNetworkWriteDelayMs() const;
+    bool isRecordMessageTrace() const;
 
     map< string, uint64_t > getDBUsage() const;
 
@@ -335,6 +361,11 @@ public:
     // coming from the snapshot. Normally we will pass nullptr
     void startServers( ptr< vector< uint8_t > > _startingFromSnapshotWithThisAsLastBlock );
 
+    // used by MessageReplayer instead of starting the node. Messages the node sends are dropped
+    void startReplay();
+
+    void exitImmediately();
+
 
     void setSchain( const ptr< Schain >& _schain );
 
@@ -398,6 +429,20 @@ public:
 
     uint64_t getMinBlockIntervalMs() const;
 
+    uint64_t getTargetBlockTimeMs() const;
+
+    uint64_t getMaxBlockBytes() const;
+
+    bool isProposalReconciliationEnabled() const;
+
+    uint64_t getOracleMaxConcurrentRequests() const;
+
+    uint64_t getOracleMaxConnectionsPerHost() const;
+
+    uint64_t getOracleMaxRequestsPerSecondPerHost() const;
+
+    uint64_t getOracleResponseCacheTtlMs() const;
+
     uint64_t getWaitAfterNetworkErrorMs();
 
     uint64_t getParamUint64( const string& _paramName, uint64_t paramDefault );
@@ -56,6 +56,7 @@
 #include "messages/Message.h"
 
 #include "db/BlockDB.h"
+#include "db/BlockSegmentStore.h"
 #include "db/BlockProposalDB.h"
 #include "db/BlockSigShareDB.h"
 #include "db/DAProofDB.h"
@@ -256,6 +257,10 @@ ptr< InternalInfoDB > Node::getInternalInfoDB() const {
     return internalInfoDB;
 }
 
+uint64_t Node::getDBOpenTimeMs() const {
+    return dbOpenTimeMs;
+}
+
 
 uint64_t Node::getCatchupIntervalMs() {
     return catchupIntervalMS;
@@ -300,10 +305,42 @@ uint64_t Node::getMinBlockIntervalMs() const {
     return minBlockIntervalMs;
 }
 
+uint64_t Node::getTargetBlockTimeMs() const {
+    return targetBlockTimeMs;
+}
+
+uint64_t Node::getMaxBlockBytes() const {
+    return maxBlockBytes;
+}
+
+bool Node::isProposalReconciliationEnabled() const {
+    return proposalReconciliation;
+}
+
+uint64_t Node::getOracleMaxConcurrentRequests() const {
+    return oracleMaxConcurrentRequests;
+}
+
+uint64_t Node::getOracleMaxConnectionsPerHost() const {
+    return oracleMaxConnectionsPerHost;
+}
+
+uint64_t Node::getOracleMaxRequestsPerSecondPerHost() const {
+    return oracleMaxRequestsPerSecondPerHost;
+}
+
+uint64_t Node::getOracleResponseCacheTtlMs() const {
+    return oracleResponseCacheTtlMs;
+}
+
 uint64_t Node::getBlockDBSize() const {
     return blockDBSize;
 }
 
+uint64_t Node::getBlockSegmentStoreSize() const {
+    return blockSegmentStoreSize;
+}
+
 uint64_t Node::getConsensusStateDBSize() const {
     return consensusStateDBSize;
 }
@@ -318,6 +355,10 @@ uint64_t Node::getSimulateNetworkWriteDelayMs() const {
     return simulateNetworkWriteDelayMs;
 }
 
+bool Node::isRecordMessageTrace() const {
+    return recordMessageTrace;
+}
+
 const ptr< TestConfig >& Node::getTestConfig() const {
     CHECK_STATE( testConfig )
     return testConfig;
@@ -385,6 +426,7 @@ map< string, uint64_t > Node::getDBUsage() const {
     // use getFullDBSize() to get storage used by the entire db
     // not only the active one
     ret["blocks.db_disk_usage"] = getBlockDB()->getFullDBSize();
+    ret["block_segments.disk_usage"] = getBlockDB()->getSegmentStore()->getTotalSize();
     ret["block_proposal.db_disk_usage"] = getBlockProposalDB()->getFullDBSize();
     ret["block_sigshare.db_disk_usage"] = getBlockSigShareDB()->getFullDBSize();
     ret["consensus_state.db_disk_usage"] = getConsensusStateDB()->getFullDBSize();
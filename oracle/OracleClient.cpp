@@ -100,9 +100,7 @@ void OracleClient::sendTestRequestAndWaitForResult( ptr< OracleRequestSpec > _sp
         thread t( [this, _receipt]() {
             while ( true ) {
                 string result;
-                string r = _receipt;
-                sleep( 1 );
-                auto st = checkOracleResult( r, result );
+                auto st = waitOracleResult( _receipt, ORACLE_TIMEOUT_MS, result );
                 if ( st == ORACLE_SUCCESS ) {
                     cerr << result << endl;
                     return;
@@ -227,6 +225,30 @@ uint64_t OracleClient::checkOracleResult( const string& _receipt, string& _resul
 }
 
 
+uint64_t OracleClient::waitOracleResult(
+    const string& _receipt, uint64_t _timeoutMs, string& _result ) {
+    try {
+        auto oracleReceivedResults = receiptsMap.getIfExists( _receipt );
+
+        if ( !oracleReceivedResults.has_value() ) {
+            LOG( warn, "Received waitOracleResult with unknown receipt" << _receipt );
+            return ORACLE_UNKNOWN_RECEIPT;
+        }
+
+        auto receipts = std::any_cast< ptr< OracleReceivedResults > >( oracleReceivedResults );
+
+        return receipts->waitForResult( _result, _timeoutMs );
+
+    } catch ( exception& e ) {
+        SkaleException::logNested( e, err );
+        return ORACLE_INTERNAL_SERVER_ERROR;
+    } catch ( ... ) {
+        LOG( err, "Internal server error in waitOracleResult " );
+        return ORACLE_INTERNAL_SERVER_ERROR;
+    }
+}
+
+
 void OracleClient::processResponseMessage( const ptr< MessageEnvelope >& _me ) {
     try {
         CHECK_STATE( _me );
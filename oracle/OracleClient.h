@@ -49,6 +49,8 @@ public:
 
     uint64_t checkOracleResult( const string& _receipt, string& _result );
 
+    uint64_t waitOracleResult( const string& _receipt, uint64_t _timeoutMs, string& _result );
+
     pair< uint64_t, string > submitOracleRequest( const string& _spec, string& _receipt );
 
 
@@ -0,0 +1,335 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file OracleHttpEngine.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "node/ConsensusEngine.h"
+#include "node/ConsensusInterface.h"
+#include "utils/Time.h"
+
+#include "OracleHttpEngine.h"
+
+
+// the longest time the engine thread sleeps without activity
+static constexpr int MAX_POLL_TIME_MS = 1000;
+
+
+OracleHttpEngine::OracleHttpEngine( uint64_t _maxConcurrentRequests,
+    uint64_t _maxConnectionsPerHost, uint64_t _maxRequestsPerSecondPerHost, uint64_t _timeoutMs,
+    const string& _caInfoPath )
+    : maxConcurrentRequests( _maxConcurrentRequests ),
+      maxConnectionsPerHost( _maxConnectionsPerHost ),
+      maxRequestsPerSecondPerHost( _maxRequestsPerSecondPerHost ),
+      timeoutMs( _timeoutMs ),
+      caInfoPath( _caInfoPath ) {
+    CHECK_ARGUMENT( _maxConcurrentRequests > 0 );
+    CHECK_ARGUMENT( _maxConnectionsPerHost > 0 );
+    CHECK_ARGUMENT( _timeoutMs > 0 );
+
+    static once_flag curlInit;
+    call_once( curlInit, []() { CHECK_STATE( curl_global_init( CURL_GLOBAL_DEFAULT ) == 0 ); } );
+
+    multi = curl_multi_init();
+    CHECK_STATE2( multi, "Could not init curl multi object" );
+
+    curl_multi_setopt( multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, ( long ) maxConcurrentRequests );
+    curl_multi_setopt( multi, CURLMOPT_MAX_HOST_CONNECTIONS, ( long ) maxConnectionsPerHost );
+    // idle connections kept alive for reuse
+    curl_multi_setopt( multi, CURLMOPT_MAXCONNECTS, ( long ) maxConcurrentRequests );
+
+    // only the engine thread uses the share, so it needs no lock callbacks
+    share = curl_share_init();
+    CHECK_STATE2( share, "Could not init curl share object" );
+    curl_share_setopt( share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION );
+    curl_share_setopt( share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS );
+
+    auto log = logThreadLocal_;
+
+    eventThread = make_shared< thread >( [this, log]() {
+        logThreadLocal_ = log;
+        eventLoop();
+    } );
+}
+
+
+OracleHttpEngine::~OracleHttpEngine() {
+    stop();
+
+    for ( auto&& [handle, request] : running ) {
+        curl_multi_remove_handle( multi, handle );
+        curl_slist_free_all( request->headers );
+        curl_easy_cleanup( handle );
+    }
+
+    for ( auto handle : idleHandles )
+        curl_easy_cleanup( handle );
+
+    curl_multi_cleanup( multi );
+    curl_share_cleanup( share );
+}
+
+
+void OracleHttpEngine::stop() {
+    {
+        lock_guard< mutex > guard( lock );
+        if ( exitRequested )
+            return;
+        exitRequested = true;
+    }
+
+    curl_multi_wakeup( multi );
+
+    if ( eventThread && eventThread->joinable() )
+        eventThread->join();
+}
+
+
+void OracleHttpEngine::submit(
+    const string& _uri, bool _isPost, const string& _postString, const Callback& _callback ) {
+    CHECK_ARGUMENT( _callback );
+
+    auto request = make_shared< Request >();
+    request->uri = _uri;
+    request->host = getHost( _uri );
+    request->isPost = _isPost;
+    request->postString = _postString;
+    request->callback = _callback;
+    request->submitTimeMs = Time::getCurrentTimeMs();
+
+    {
+        lock_guard< mutex > guard( lock );
+        CHECK_STATE2( !exitRequested, "Oracle HTTP engine is stopped" );
+        submitted.push_back( request );
+    }
+
+    curl_multi_wakeup( multi );
+}
+
+
+string OracleHttpEngine::getHost( const string& _uri ) {
+    auto start = _uri.find( "://" );
+    start = ( start == string::npos ) ? 0 : start + 3;
+
+    auto end = _uri.find_first_of( "/?#", start );
+
+    return _uri.substr( start, end == string::npos ? string::npos : end - start );
+}
+
+
+bool OracleHttpEngine::takeToken( const string& _host, uint64_t _nowMs, uint64_t& _waitMs ) {
+    if ( maxRequestsPerSecondPerHost == 0 )
+        return true;
+
+    auto& host = hosts[_host];
+
+    // a new host starts with a full bucket
+    if ( host.refillTimeMs == 0 ) {
+        host.tokens = maxRequestsPerSecondPerHost;
+    } else {
+        host.tokens = min( ( double ) maxRequestsPerSecondPerHost,
+            host.tokens + ( _nowMs - host.refillTimeMs ) * maxRequestsPerSecondPerHost / 1000.0 );
+    }
+
+    host.refillTimeMs = _nowMs;
+
+    if ( host.tokens >= 1 ) {
+        host.tokens -= 1;
+        return true;
+    }
+
+    _waitMs = ( uint64_t ) ( ( 1 - host.tokens ) * 1000 / maxRequestsPerSecondPerHost ) + 1;
+
+    return false;
+}
+
+
+uint64_t OracleHttpEngine::startRequests( uint64_t _nowMs, uint64_t& _started ) {
+    uint64_t pollMs = MAX_POLL_TIME_MS;
+
+    deque< ptr< Request > > stillWaiting;
+
+    while ( !waiting.empty() ) {
+        auto request = waiting.front();
+        waiting.pop_front();
+
+        if ( request->submitTimeMs + timeoutMs <= _nowMs ) {
+            failedRequests++;
+            request->callback( ORACLE_TIMEOUT, "" );
+            continue;
+        }
+
+        uint64_t waitMs = 0;
+
+        // requests keep their order per host, because a host that is out of tokens
+        // stays out of tokens for the rest of this pass
+        if ( running.size() < maxConcurrentRequests &&
+             takeToken( request->host, _nowMs, waitMs ) ) {
+            startRequest( request );
+            _started++;
+        } else {
+            if ( waitMs > 0 ) {
+                if ( !request->rateLimited ) {
+                    request->rateLimited = true;
+                    rateLimitedRequests++;
+                }
+                pollMs = min( pollMs, waitMs );
+            }
+            pollMs = min( pollMs, request->submitTimeMs + timeoutMs - _nowMs );
+            stillWaiting.push_back( request );
+        }
+    }
+
+    waiting.swap( stillWaiting );
+
+    return pollMs;
+}
+
+
+size_t OracleHttpEngine::writeCallback(
+    void* _contents, size_t _size, size_t _nmemb, void* _userp ) {
+    auto request = ( Request* ) _userp;
+    request->response.append( ( const char* ) _contents, _size * _nmemb );
+    return _size * _nmemb;
+}
+
+
+void OracleHttpEngine::startRequest( const ptr< Request >& _request ) {
+    CURL* handle;
+
+    if ( idleHandles.empty() ) {
+        handle = curl_easy_init();
+        CHECK_STATE2( handle, "Could not init curl object" );
+    } else {
+        handle = idleHandles.back();
+        idleHandles.pop_back();
+    }
+
+    _request->handle = handle;
+
+    curl_easy_setopt( handle, CURLOPT_URL, _request->uri.c_str() );
+    curl_easy_setopt( handle, CURLOPT_SSL_VERIFYPEER, 1L );
+    if ( !caInfoPath.empty() )
+        curl_easy_setopt( handle, CURLOPT_CAINFO, caInfoPath.c_str() );
+    curl_easy_setopt( handle, CURLOPT_WRITEFUNCTION, writeCallback );
+    curl_easy_setopt( handle, CURLOPT_WRITEDATA, ( void* ) _request.get() );
+    curl_easy_setopt( handle, CURLOPT_COOKIEFILE, "" );
+    // the timeout counts from submission, so the time spent waiting to start is deducted
+    auto deadlineMs = _request->submitTimeMs + timeoutMs;
+    auto nowMs = Time::getCurrentTimeMs();
+    curl_easy_setopt(
+        handle, CURLOPT_TIMEOUT_MS, ( long ) ( deadlineMs > nowMs ? deadlineMs - nowMs : 1 ) );
+    curl_easy_setopt( handle, CURLOPT_USERAGENT, "libcurl-agent/1.0" );
+    curl_easy_setopt( handle, CURLOPT_DNS_SERVERS, "8.8.8.8" );
+    curl_easy_setopt( handle, CURLOPT_SHARE, share );
+    curl_easy_setopt( handle, CURLOPT_TCP_KEEPALIVE, 1L );
+    curl_easy_setopt( handle, CURLOPT_NOSIGNAL, 1L );
+
+    if ( _request->isPost ) {
+        _request->headers =
+            curl_slist_append( _request->headers, "Content-Type: application/json" );
+        curl_easy_setopt( handle, CURLOPT_HTTPHEADER, _request->headers );
+        curl_easy_setopt( handle, CURLOPT_POSTFIELDS, _request->postString.c_str() );
+    }
+
+    running[handle] = _request;
+
+    CHECK_STATE( curl_multi_add_handle( multi, handle ) == CURLM_OK );
+}
+
+
+void OracleHttpEngine::finishRequest( CURL* _handle, CURLcode _result ) {
+    auto it = running.find( _handle );
+    CHECK_STATE( it != running.end() );
+
+    auto request = it->second;
+    running.erase( it );
+
+    curl_multi_remove_handle( multi, _handle );
+    curl_slist_free_all( request->headers );
+    request->headers = nullptr;
+
+    // the connection stays in the multi handle cache, the easy handle is reused
+    curl_easy_reset( _handle );
+    idleHandles.push_back( _handle );
+
+    uint64_t status = ORACLE_SUCCESS;
+
+    if ( _result != CURLE_OK ) {
+        LOG( err, "Curl request failed for url: " << request->uri
+                                                  << " with error code:" + to_string( _result ) );
+        status = ORACLE_COULD_NOT_CONNECT_TO_ENDPOINT;
+        failedRequests++;
+    } else {
+        completedRequests++;
+    }
+
+    try {
+        request->callback( status, move( request->response ) );
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    }
+}
+
+
+void OracleHttpEngine::eventLoop() {
+    while ( true ) {
+        {
+            lock_guard< mutex > guard( lock );
+            if ( exitRequested )
+                return;
+            while ( !submitted.empty() ) {
+                waiting.push_back( submitted.front() );
+                submitted.pop_front();
+            }
+        }
+
+        try {
+            int stillRunning = 0;
+            curl_multi_perform( multi, &stillRunning );
+
+            int queued = 0;
+            while ( auto msg = curl_multi_info_read( multi, &queued ) ) {
+                if ( msg->msg == CURLMSG_DONE )
+                    finishRequest( msg->easy_handle, msg->data.result );
+            }
+
+            uint64_t started = 0;
+            auto pollMs = startRequests( Time::getCurrentTimeMs(), started );
+
+            // let the new transfers start right away
+            if ( started > 0 )
+                continue;
+
+            curl_multi_poll( multi, nullptr, 0, ( int ) max( pollMs, ( uint64_t ) 1 ), nullptr );
+        } catch ( exception& e ) {
+            SkaleException::logNested( e );
+            usleep( 1000 * MAX_POLL_TIME_MS );
+        }
+    }
+}
+
+
+string OracleHttpEngine::getStats() {
+    return to_string( completedRequests ) + "/" + to_string( failedRequests ) + "/" +
+           to_string( rateLimitedRequests );
+}
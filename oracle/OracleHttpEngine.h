@@ -0,0 +1,149 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file OracleHttpEngine.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <deque>
+
+#include <curl/curl.h>
+
+/*
+ * Event driven HTTP client of the oracle server.
+ *
+ * One thread runs all transfers on a curl multi handle. Easy handles are reused, and the multi
+ * handle keeps finished connections alive, so that requests to the same host reuse the TCP
+ * connection. TLS sessions and DNS results are shared between the transfers.
+ *
+ * At most maxConcurrentRequests transfers run at a time, and at most maxConnectionsPerHost
+ * connections go to one host. Requests to a host are also limited to
+ * maxRequestsPerSecondPerHost by a token bucket. A request that is not completed within the
+ * timeout from submission, including the time it waited to start, fails with ORACLE_TIMEOUT.
+ *
+ * Callbacks run on the engine thread, so they must not block.
+ */
+class OracleHttpEngine {
+public:
+    typedef function< void( uint64_t _status, string&& _response ) > Callback;
+
+private:
+    class Request {
+    public:
+        string uri;
+
+        string host;
+
+        bool isPost = false;
+
+        string postString;
+
+        Callback callback;
+
+        uint64_t submitTimeMs = 0;
+
+        bool rateLimited = false;
+
+        CURL* handle = nullptr;
+
+        curl_slist* headers = nullptr;
+
+        string response;
+    };
+
+    class Host {
+    public:
+        double tokens = 0;
+
+        uint64_t refillTimeMs = 0;
+    };
+
+    const uint64_t maxConcurrentRequests;
+
+    const uint64_t maxConnectionsPerHost;
+
+    const uint64_t maxRequestsPerSecondPerHost;  // not limited if 0
+
+    const uint64_t timeoutMs;
+
+    const string caInfoPath;  // the system CA bundle if empty
+
+    CURLM* multi = nullptr;
+
+    CURLSH* share = nullptr;
+
+    ptr< thread > eventThread;
+
+    atomic< uint64_t > completedRequests = 0;
+
+    atomic< uint64_t > failedRequests = 0;
+
+    atomic< uint64_t > rateLimitedRequests = 0;
+
+    mutex lock;
+
+    // the fields below are protected by lock
+
+    deque< ptr< Request > > submitted;
+
+    bool exitRequested = false;
+
+    // the fields below are only used by the engine thread
+
+    deque< ptr< Request > > waiting;
+
+    map< CURL*, ptr< Request > > running;
+
+    map< string, Host > hosts;
+
+    vector< CURL* > idleHandles;
+
+    void eventLoop();
+
+    // starts the waiting requests that are allowed to start. Returns the time until the next
+    // rate limited request may start, or the default poll time
+    uint64_t startRequests( uint64_t _nowMs, uint64_t& _started );
+
+    void startRequest( const ptr< Request >& _request );
+
+    void finishRequest( CURL* _handle, CURLcode _result );
+
+    bool takeToken( const string& _host, uint64_t _nowMs, uint64_t& _waitMs );
+
+    static size_t writeCallback( void* _contents, size_t _size, size_t _nmemb, void* _userp );
+
+public:
+    OracleHttpEngine( uint64_t _maxConcurrentRequests, uint64_t _maxConnectionsPerHost,
+        uint64_t _maxRequestsPerSecondPerHost, uint64_t _timeoutMs,
+        const string& _caInfoPath = "" );
+
+    ~OracleHttpEngine();
+
+    void submit( const string& _uri, bool _isPost, const string& _postString,
+        const Callback& _callback );
+
+    // stops the engine thread. Callbacks of unfinished requests are not called
+    void stop();
+
+    static string getHost( const string& _uri );
+
+    string getStats();
+};
@@ -54,6 +54,8 @@ void OracleReceivedResults::insertIfDoesntExist(
             resultsByCount->insert_or_assign( unsignedResult, count + 1 );
         }
 
+        resultCond.notify_all();
+
     } catch ( ... ) {
         throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
     }
@@ -164,6 +166,29 @@ uint64_t OracleReceivedResults::tryGettingResult( string& _result ) {
     }
 }
 
+uint64_t OracleReceivedResults::waitForResult( string& _result, uint64_t _timeoutMs ) {
+    // the result times out after ORACLE_TIMEOUT_MS anyway, clamping keeps the sum from overflowing
+    auto deadlineMs = min( Time::getCurrentTimeMs() + min( _timeoutMs, ORACLE_TIMEOUT_MS + 1 ),
+        getRequestTime() + ORACLE_TIMEOUT_MS + 1 );
+
+    // results are inserted under m, so a result can not arrive between the check and the wait
+    unique_lock< recursive_mutex > lock( m );
+
+    while ( true ) {
+        auto status = tryGettingResult( _result );
+
+        if ( status != ORACLE_RESULT_NOT_READY )
+            return status;
+
+        auto nowMs = Time::getCurrentTimeMs();
+
+        if ( nowMs >= deadlineMs )
+            return ORACLE_RESULT_NOT_READY;
+
+        resultCond.wait_for( lock, chrono::milliseconds( deadlineMs - nowMs ) );
+    }
+}
+
 const ptr< OracleRequestSpec >& OracleReceivedResults::getRequestSpec() const {
     return requestSpec;
 }
@@ -11,6 +11,8 @@ class OracleRequestSpec;
 
 class OracleReceivedResults {
     recursive_mutex m;
+    // notified on every received result
+    condition_variable_any resultCond;
     uint64_t requiredConfirmations;
     uint64_t nodeCount;
     uint64_t requestTime;
@@ -33,6 +35,9 @@ public:
 
     uint64_t tryGettingResult( string& _result );
 
+    // like tryGettingResult, but waits up to _timeoutMs for the result
+    uint64_t waitForResult( string& _result, uint64_t _timeoutMs );
+
     string compileCompleteResultJson( string& _unsignedResult );
 
     string compileCompleteResultRlp( string& _unsignedResult );
@@ -344,6 +344,19 @@ string OracleRequestSpec::getReceipt() {
     return receipt;
 }
 
+string OracleRequestSpec::getFetchKey() {
+    string key = uri + "\n";
+
+    // the eth call id changes with every call and does not change the result
+    if ( isEthApi() ) {
+        appendEthCallPart( key, from, to, data, gas, blockId );
+    } else {
+        key.append( post );
+    }
+
+    return key;
+}
+
 
 bool OracleRequestSpec::verifyPow( string& _spec ) {
     try {
@@ -118,6 +118,9 @@ public:
 
     string getReceipt();
 
+    // identifies the endpoint request. Specs with the same key get the same endpoint response
+    string getFetchKey();
+
     static bool verifyPow( string& _spec );
 
     const string& getEncoding() const;
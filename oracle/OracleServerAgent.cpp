@@ -21,9 +21,6 @@
     @date 2021-
 */
 
-#include <curl/curl.h>
-
-
 #include "Log.h"
 #include "SkaleCommon.h"
 
@@ -55,17 +52,21 @@
 
 #include "OracleClient.h"
 #include "OracleErrors.h"
+#include "OracleHttpEngine.h"
 #include "OracleRequestBroadcastMessage.h"
 #include "OracleRequestSpec.h"
 #include "OracleResponseMessage.h"
 #include "OracleResult.h"
 #include "OracleServerAgent.h"
-#include "OracleThreadPool.h"
 #include "protocols/ProtocolInstance.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
 #include "utils/Time.h"
 
 OracleServerAgent::OracleServerAgent( Schain& _schain )
-    : Agent( _schain, true ), requestCounter( 0 ), threadCounter( 0 ) {
+    : Agent( _schain, true ),
+      responseCacheTtlMs( _schain.getNode()->getOracleResponseCacheTtlMs() ),
+      responseCache( ORACLE_RESPONSE_CACHE_SIZE ) {
     if ( _schain.getNode()->isTestNet() ) {
         // allow things like IP based URLS for tests
         OracleRequestSpec::setTestMode();
@@ -73,23 +74,22 @@ OracleServerAgent::OracleServerAgent( Schain& _schain )
 
     gethURL = getSchain()->getNode()->getGethUrl();
 
-    for ( int i = 0; i < NUM_ORACLE_THREADS; i++ ) {
-        incomingQueues.push_back(
-            make_shared< BlockingReaderWriterQueue< shared_ptr< MessageEnvelope > > >() );
-    }
+    auto node = getSchain()->getNode();
 
-    try {
-        LOG( info, "Constructing OracleThreadPool" );
+    httpEngine = make_shared< OracleHttpEngine >( node->getOracleMaxConcurrentRequests(),
+        node->getOracleMaxConnectionsPerHost(), node->getOracleMaxRequestsPerSecondPerHost(),
+        ORACLE_HTTP_TIMEOUT_MS );
 
-        this->oracleThreadPool = make_shared< OracleThreadPool >( this );
-        oracleThreadPool->startService();
-    } catch ( ExitRequestedException& ) {
-        throw;
-    } catch ( ... ) {
-        throw_with_nested( InvalidStateException( __FUNCTION__, __CLASS_NAME__ ) );
-    }
+    oracleExecutor = make_shared< TaskExecutor >( "OracleServer", BlockingIOPool::getShared() );
 };
 
+OracleServerAgent::~OracleServerAgent() {
+    // no endpoint results are submitted once the engine is stopped
+    if ( httpEngine )
+        httpEngine->stop();
+    oracleExecutor = nullptr;
+}
+
 void OracleServerAgent::routeAndProcessMessage( const ptr< MessageEnvelope >& _me ) {
     try {
         CHECK_ARGUMENT( _me );
@@ -100,10 +100,7 @@ void OracleServerAgent::routeAndProcessMessage( const ptr< MessageEnvelope >& _m
                      _me->getMessage()->getMsgType() == MSG_ORACLE_RSP );
 
         if ( _me->getMessage()->getMsgType() == MSG_ORACLE_REQ_BROADCAST ) {
-            auto value = requestCounter.fetch_add( 1 );
-
-            this->incomingQueues.at( value % ( uint64_t ) NUM_ORACLE_THREADS )->enqueue( _me );
-
+            oracleExecutor->submit( [this, _me]() { processRequest( _me ); } );
             return;
         } else {
             auto client = getSchain()->getOracleClient();
@@ -115,116 +112,179 @@ void OracleServerAgent::routeAndProcessMessage( const ptr< MessageEnvelope >& _m
     }
 }
 
-void OracleServerAgent::workerThreadItemSendLoop( OracleServerAgent* _agent ) {
-    CHECK_STATE( _agent )
+void OracleServerAgent::processRequest( const ptr< MessageEnvelope >& _me ) {
+    try {
+        auto orclMsg = dynamic_pointer_cast< OracleRequestBroadcastMessage >( _me->getMessage() );
+
+        CHECK_STATE( orclMsg );
 
-    CHECK_STATE( _agent->threadCounter == 0 );
+        auto spec = orclMsg->getParsedSpec();
+
+        if ( spec->getChainId() != getSchain()->getSchainID() ) {
+            LOG( err, string( "Received msg with invalid schain id in oracle spec:" )
+                          << to_string( spec->getChainId() ) );
+            return;
+        }
+
+        if ( spec->getTime() + ORACLE_REQUEST_AGE_ON_RECEIPT_MS < Time::getCurrentTimeMs() ) {
+            LOG( err, string( "Received msg with old request with age:" )
+                          << to_string( Time::getCurrentTimeMs() - spec->getTime() ) );
+            return;
+        }
 
-    LOG( info, "Thread counter is : " << to_string( _agent->threadCounter ) );
+        if ( spec->getTime() > Time::getCurrentTimeMs() + ORACLE_REQUEST_FUTURE_JITTER_MS ) {
+            LOG( err, string( "Received msg with oracle request with time in the future:" )
+                          << to_string( spec->getTime() - Time::getCurrentTimeMs() ) );
+            return;
+        }
 
-    auto threadNumber = ++( _agent->threadCounter );
+        submitEndpointRequest( spec, _me->getSrcSchainIndex() );
+    } catch ( ExitRequestedException& e ) {
+        return;
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    } catch ( ... ) {
+        LOG( err, "Error in Oracle request processing, unknown object is thrown" );
+    }
+}
 
-    LOG( info, "Starting Oracle worker thread: " << to_string( threadNumber ) );
 
-    _agent->waitOnGlobalStartBarrier();
+void OracleServerAgent::sendEndpointResult( const ptr< OracleRequestSpec >& _requestSpec,
+    schain_index _destination, uint64_t _status, string& _response ) {
+    try {
+        auto msg = makeResponseMessage( _requestSpec, _status, _response );
+        sendOutResult( msg, _destination );
+    } catch ( ExitRequestedException& e ) {
+        return;
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    } catch ( ... ) {
+        LOG( err, "Error in Oracle result sending, unknown object is thrown" );
+    }
+}
 
-    LOG( info, "Started Oracle worker thread " << to_string( threadNumber ) );
+using namespace nlohmann;
 
-    auto agent = ( Agent* ) _agent;
+void OracleServerAgent::submitEndpointRequest(
+    ptr< OracleRequestSpec > _requestSpec, schain_index _source ) {
+    CHECK_ARGUMENT( _requestSpec )
 
-    while ( !agent->getSchain()->getNode()->isExitRequested() ) {
-        try {
-            ptr< MessageEnvelope > msge;
+    string endpointUri;
+    if ( _requestSpec->isEthMainnet() ) {
+        endpointUri = gethURL;
+    } else {
+        endpointUri = _requestSpec->getUri();
+    }
 
-            auto success = _agent->incomingQueues.at( threadNumber - 1 )
-                               ->wait_dequeue_timed( msge, 1000 * ORACLE_QUEUE_TIMEOUT_MS );
-            if ( !success )
-                continue;
+    auto fetch = make_shared< PendingFetch >();
+    fetch->startTimeMs = Time::getCurrentTimeMs();
+    fetch->waiters.emplace_back( _requestSpec, _source );
 
-            auto orclMsg =
-                dynamic_pointer_cast< OracleRequestBroadcastMessage >( msge->getMessage() );
+    string key;
 
+    if ( responseCacheTtlMs > 0 ) {
+        key = _requestSpec->getFetchKey();
 
-            auto spec = orclMsg->getParsedSpec();
+        string cachedResponse;
 
-            if ( spec->getChainId() != agent->getSchain()->getSchainID() ) {
-                LOG( err, string( "Received msg with invalid schain id in oracle spec:" )
-                              << to_string( spec->getChainId() ) );
-                continue;
-            }
+        {
+            lock_guard< mutex > guard( fetchLock );
 
-            if ( spec->getTime() + ORACLE_REQUEST_AGE_ON_RECEIPT_MS < Time::getCurrentTimeMs() ) {
-                LOG( err, string( "Received msg with old request with age:" )
-                              << to_string( Time::getCurrentTimeMs() - spec->getTime() ) );
-                continue;
-            }
+            auto cached = responseCache.getIfExists( key );
 
-            if ( spec->getTime() > Time::getCurrentTimeMs() + ORACLE_REQUEST_FUTURE_JITTER_MS ) {
-                LOG( err, string( "Received msg with oracle request with time in the future:" )
-                              << to_string( spec->getTime() - Time::getCurrentTimeMs() ) );
-                continue;
+            if ( cached.has_value() ) {
+                auto entry = any_cast< ptr< CachedResponse > >( cached );
+                if ( isFresh( entry->fetchTimeMs, _requestSpec ) ) {
+                    cacheHits++;
+                    cachedResponse = entry->response;
+                }
             }
 
+            if ( cachedResponse.empty() ) {
+                auto it = pendingFetches.find( key );
 
-            CHECK_STATE( orclMsg );
+                if ( it != pendingFetches.end() &&
+                     isFresh( it->second->startTimeMs, _requestSpec ) ) {
+                    inFlightHits++;
+                    it->second->waiters.emplace_back( _requestSpec, _source );
+                    return;
+                }
 
-            auto msg = _agent->doEndpointRequestResponse( orclMsg->getParsedSpec() );
+                // a running fetch that is too old for this request is not waited for
+                cacheMisses++;
+                pendingFetches[key] = fetch;
+            }
+        }
 
-            _agent->sendOutResult( msg, msge->getSrcSchainIndex() );
-        } catch ( ExitRequestedException& e ) {
+        // only successful responses are cached, and they are never empty
+        if ( !cachedResponse.empty() ) {
+            auto msg = makeResponseMessage( _requestSpec, ORACLE_SUCCESS, cachedResponse );
+            sendOutResult( msg, _source );
             return;
-        } catch ( exception& e ) {
-            SkaleException::logNested( e );
-        } catch ( ... ) {
-            LOG( err, "Error in Oracle loop, unknown object is thrown" );
         }
+    } else {
+        cacheMisses++;
     }
+
+    httpEngine->submit( endpointUri, _requestSpec->isPost(), _requestSpec->whatToPost(),
+        [this, key, fetch]( uint64_t _status, string&& _response ) {
+            fetchCompleted( key, fetch, _status, move( _response ) );
+        } );
 }
 
-struct MemoryStruct {
-    char* memory;
-    size_t size;
-};
 
-static size_t WriteMemoryCallback( void* contents, size_t size, size_t nmemb, void* userp ) {
-    size_t realsize = size * nmemb;
-    struct MemoryStruct* mem = ( struct MemoryStruct* ) userp;
+bool OracleServerAgent::isFresh(
+    uint64_t _fetchTimeMs, const ptr< OracleRequestSpec >& _requestSpec ) {
+    // the request time may be ahead of the local time by up to ORACLE_REQUEST_FUTURE_JITTER_MS,
+    // and the response must not be older than the ttl at the request time either
+    auto validUntilMs = _fetchTimeMs + responseCacheTtlMs;
+    return validUntilMs >= Time::getCurrentTimeMs() && validUntilMs >= _requestSpec->getTime();
+}
 
-    char* ptr = ( char* ) realloc( mem->memory, mem->size + realsize + 1 );
-    CHECK_STATE( ptr );
-    mem->memory = ptr;
-    memcpy( &( mem->memory[mem->size] ), contents, realsize );
-    mem->size += realsize;
-    mem->memory[mem->size] = 0;
 
-    return realsize;
-}
+void OracleServerAgent::fetchCompleted(
+    const string& _key, const ptr< PendingFetch >& _fetch, uint64_t _status, string&& _response ) {
+    if ( responseCacheTtlMs > 0 ) {
+        lock_guard< mutex > guard( fetchLock );
 
-using namespace nlohmann;
+        auto it = pendingFetches.find( _key );
 
-ptr< OracleResponseMessage > OracleServerAgent::doEndpointRequestResponse(
-    ptr< OracleRequestSpec > _requestSpec ) {
-    CHECK_ARGUMENT( _requestSpec )
+        // no more waiters join once the fetch is removed
+        if ( it != pendingFetches.end() && it->second == _fetch )
+            pendingFetches.erase( it );
 
+        if ( _status == ORACLE_SUCCESS && !_response.empty() ) {
+            auto entry = make_shared< CachedResponse >();
+            // the start time, because the endpoint may have answered any time after it
+            entry->fetchTimeMs = _fetch->startTimeMs;
+            entry->response = _response;
+            responseCache.put( _key, entry );
+        }
+    }
 
-    string endpointUri;
-    if ( _requestSpec->isEthMainnet() ) {
-        endpointUri = gethURL;
-    } else {
-        endpointUri = _requestSpec->getUri();
+    // signing the result is slow, so the engine thread only submits it
+    for ( auto&& waiter : _fetch->waiters ) {
+        oracleExecutor->submit( [this, waiter, _status, response = _response]() mutable {
+            sendEndpointResult( waiter.first, waiter.second, _status, response );
+        } );
     }
+}
 
-    auto postString = _requestSpec->whatToPost();
 
-    string response;
+string OracleServerAgent::getStats() {
+    return to_string( cacheHits ) + "/" + to_string( inFlightHits ) + "/" +
+           to_string( cacheMisses );
+}
 
-    auto status = curlHttp( endpointUri, _requestSpec->isPost(), postString, response );
+ptr< OracleResponseMessage > OracleServerAgent::makeResponseMessage(
+    ptr< OracleRequestSpec > _requestSpec, uint64_t _status, string& _response ) {
+    CHECK_ARGUMENT( _requestSpec )
 
     ptr< OracleResult > oracleResult = nullptr;
 
     try {
         oracleResult = make_shared< OracleResult >(
-            _requestSpec, status, response, getSchain()->getCryptoManager() );
+            _requestSpec, _status, _response, getSchain()->getCryptoManager() );
     } catch ( OracleException& e ) {
         static string EMPTY = "";
         oracleResult = make_shared< OracleResult >(
@@ -242,62 +302,6 @@ ptr< OracleResponseMessage > OracleServerAgent::doEndpointRequestResponse(
         *getSchain()->getOracleClient() );
 }
 
-
-uint64_t OracleServerAgent::curlHttp(
-    const string& _uri, bool _isPost, string& _postString, string& _result ) {
-    uint64_t status = ORACLE_UNKNOWN_ERROR;
-    CURL* curl;
-    CURLcode res;
-    struct MemoryStruct chunk;
-    chunk.memory = ( char* ) malloc( 1 ); /* will be grown as needed by the realloc above */
-    CHECK_STATE( chunk.memory );
-    chunk.size = 0; /* no data at this point */
-
-    curl = curl_easy_init();
-
-    CHECK_STATE2( curl, "Could not init curl object" );
-
-    curl_easy_setopt( curl, CURLOPT_URL, _uri.c_str() );
-    curl_easy_setopt( curl, CURLOPT_SSL_VERIFYPEER, 1L );
-
-    string pagedata;
-
-    curl_easy_setopt( curl, CURLOPT_WRITEFUNCTION, WriteMemoryCallback );
-    /* we pass our 'chunk' struct to the callback function */
-    curl_easy_setopt( curl, CURLOPT_WRITEDATA, ( void* ) &chunk );
-    curl_easy_setopt( curl, CURLOPT_COOKIEFILE, "" );
-    curl_easy_setopt( curl, CURLOPT_TIMEOUT, 2 );
-    curl_easy_setopt( curl, CURLOPT_USERAGENT, "libcurl-agent/1.0" );
-    curl_easy_setopt( curl, CURLOPT_DNS_SERVERS, "8.8.8.8" );
-
-    if ( _isPost ) {
-        struct curl_slist* headers = NULL;
-        headers = curl_slist_append( headers, "Content-Type: application/json" );
-        curl_easy_setopt( curl, CURLOPT_HTTPHEADER, headers );
-        curl_easy_setopt( curl, CURLOPT_POSTFIELDS, _postString.c_str() );
-    }
-
-    res = curl_easy_perform( curl );
-
-    if ( res != CURLE_OK ) {
-        LOG( err, "Curl easy perform failed for url: " << _uri
-                                                       << " with error code:" + to_string( res ) );
-        status = ORACLE_COULD_NOT_CONNECT_TO_ENDPOINT;
-    } else {
-        status = ORACLE_SUCCESS;
-    }
-
-    curl_easy_cleanup( curl );
-
-    string r = string( chunk.memory, chunk.size );
-
-    free( chunk.memory );
-
-    _result = r;
-
-    return status;
-}
-
 void OracleServerAgent::sendOutResult(
     ptr< OracleResponseMessage > _msg, schain_index _destination ) {
     try {
@@ -34,10 +34,6 @@ class CryptoManager;
 
 
 #include "thirdparty/lrucache.hpp"
-#include "sgxwallet/third_party/concurrentqueue.h"
-#include "sgxwallet/third_party/readerwriterqueue.h"
-
-using namespace moodycamel;
 
 class MessageEnvelope;
 
@@ -45,23 +41,66 @@ class OracleResponseMessage;
 
 class OracleRequestBroadcastMessage;
 
-class OracleThreadPool;
 class OracleRequestSpec;
+class OracleHttpEngine;
+class TaskExecutor;
 
 class OracleServerAgent : public Agent {
-    vector< shared_ptr< BlockingReaderWriterQueue< shared_ptr< MessageEnvelope > > > >
-        incomingQueues;
+    // endpoint request that is running, and the requests waiting for its response
+    class PendingFetch {
+    public:
+        uint64_t startTimeMs = 0;
+
+        vector< pair< ptr< OracleRequestSpec >, schain_index > > waiters;
+    };
 
-    atomic< uint64_t > requestCounter;
+    class CachedResponse {
+    public:
+        uint64_t fetchTimeMs = 0;
 
-    atomic< uint64_t > threadCounter;
+        string response;
+    };
 
-    ptr< OracleThreadPool > oracleThreadPool = nullptr;
+    // checks incoming requests, and signs and sends back endpoint results. Signing may wait
+    // for the SGX server
+    ptr< TaskExecutor > oracleExecutor;
 
     string gethURL;
 
+    ptr< OracleHttpEngine > httpEngine;
+
+    const uint64_t responseCacheTtlMs;
+
+    atomic< uint64_t > cacheHits = 0;
+
+    atomic< uint64_t > inFlightHits = 0;
+
+    atomic< uint64_t > cacheMisses = 0;
+
+    mutex fetchLock;
+
+    // the fields below are protected by fetchLock, and keyed by OracleRequestSpec::getFetchKey
+
+    map< string, ptr< PendingFetch > > pendingFetches;
 
-    ptr< OracleResponseMessage > doEndpointRequestResponse( ptr< OracleRequestSpec > _requestSpec );
+    cache::lru_cache< string, ptr< CachedResponse > > responseCache;
+
+    // true if a response fetched at _fetchTimeMs is recent enough for the request
+    bool isFresh( uint64_t _fetchTimeMs, const ptr< OracleRequestSpec >& _requestSpec );
+
+    void fetchCompleted( const string& _key, const ptr< PendingFetch >& _fetch, uint64_t _status,
+        string&& _response );
+
+
+    void processRequest( const ptr< MessageEnvelope >& _me );
+
+    void submitEndpointRequest( ptr< OracleRequestSpec > _requestSpec, schain_index _source );
+
+    void sendEndpointResult( const ptr< OracleRequestSpec >& _requestSpec,
+        schain_index _destination, uint64_t _status, string& _response );
+
+    ptr< OracleResponseMessage > makeResponseMessage(
+        ptr< OracleRequestSpec > _requestSpec, uint64_t _status, string& _response );
 
 
     void sendOutResult( ptr< OracleResponseMessage > _msg, schain_index _destination );
@@ -70,14 +109,12 @@ class OracleServerAgent : public Agent {
 public:
     OracleServerAgent( Schain& _schain );
 
-    virtual ~OracleServerAgent(){};
+    virtual ~OracleServerAgent();
 
     void routeAndProcessMessage( const ptr< MessageEnvelope >& _me );
 
-    static void workerThreadItemSendLoop( OracleServerAgent* _agent );
-
-    static uint64_t curlHttp(
-        const string& _uri, bool _isPost, string& _postString, string& _result );
+    // cache hits/requests joining a running fetch/endpoint requests
+    string getStats();
 
     static ptr< vector< ptr< string > > > extractResults(
         string& _response, vector< string >& _jsps );
@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file AdaptiveBlockAssembler.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "utils/Time.h"
+
+#include "AdaptiveBlockAssembler.h"
+
+
+AdaptiveBlockAssembler::AdaptiveBlockAssembler(
+    uint64_t _targetBlockTimeMs, uint64_t _maxTransactionsPerBlock, uint64_t _maxBlockBytes )
+    : targetBlockTimeMs( _targetBlockTimeMs ),
+      maxTransactionsPerBlock( _maxTransactionsPerBlock ),
+      maxBlockBytes( _maxBlockBytes ) {
+    CHECK_ARGUMENT( _targetBlockTimeMs > 0 );
+    CHECK_ARGUMENT( _maxTransactionsPerBlock > 0 );
+}
+
+
+void AdaptiveBlockAssembler::smooth( double& _average, double _sample ) {
+    // the first sample initializes the average
+    if ( _average == 0 )
+        _average = _sample;
+    else
+        _average += SMOOTHING * ( _sample - _average );
+}
+
+
+AdaptiveBlockAssembler::Decision AdaptiveBlockAssembler::decide(
+    uint64_t _emptyBlockIntervalMs, uint64_t _queueDepth ) {
+    lock_guard< mutex > guard( lock );
+
+    auto budgetMs = max( ( double ) targetBlockTimeMs - fixedMs, 0.0 );
+    auto transactionCostMs = evmMsPerTransaction + sentBytes * transferMsPerByte;
+
+    auto limit = ( double ) maxTransactionsPerBlock;
+
+    if ( transactionCostMs > 0 )
+        limit = min( limit, budgetMs / transactionCostMs );
+
+    if ( maxBlockBytes > 0 && transactionBytes > 0 )
+        limit = min( limit, maxBlockBytes / transactionBytes );
+
+    // the averages lag behind, so the limit changes at most twice per block. It only grows
+    // while the blocks are full, a larger limit would not make a block that was not larger
+    if ( lastDecision.maxTransactions > 0 ) {
+        auto growth = lastSaturated || _queueDepth > lastDecision.maxTransactions ? 2.0 : 1.0;
+        limit = min( limit, growth * lastDecision.maxTransactions );
+        limit = max( limit, lastDecision.maxTransactions / 2.0 );
+    }
+
+    Decision decision;
+    decision.maxTransactions = max( ( uint64_t ) limit, ( uint64_t ) 1 );
+    decision.maxBytes = maxBlockBytes;
+
+    if ( _queueDepth >= decision.maxTransactions ) {
+        // a full block is already there
+        decision.waitMs = 0;
+    } else {
+        // wait for more transactions as long as a full block still fits into the target
+        auto slackMs = budgetMs - decision.maxTransactions * transactionCostMs;
+        decision.waitMs =
+            ( uint64_t ) min( max( slackMs, 0.0 ), ( double ) _emptyBlockIntervalMs );
+    }
+
+    lastDecision = decision;
+    lastQueueDepth = _queueDepth;
+    decisions++;
+
+    return decision;
+}
+
+
+void AdaptiveBlockAssembler::proposalAssembled(
+    uint64_t _transactions, uint64_t _bytes, uint64_t _waitMs, bool _saturated ) {
+    lock_guard< mutex > guard( lock );
+    lastTransactions = _transactions;
+    lastBytes = _bytes;
+    lastWaitMs = _waitMs;
+    lastSaturated = _saturated;
+}
+
+
+void AdaptiveBlockAssembler::proposalPushed(
+    uint64_t _transactions, uint64_t _bytes, uint64_t _timeMs ) {
+    lock_guard< mutex > guard( lock );
+
+    if ( _transactions > 0 )
+        smooth( sentBytes, ( double ) _bytes / _transactions );
+
+    if ( _bytes < MIN_BANDWIDTH_SAMPLE_BYTES ) {
+        smooth( roundTripMs, _timeMs );
+    } else {
+        smooth( transferMsPerByte, max( _timeMs - roundTripMs, 0.0 ) / _bytes );
+    }
+}
+
+
+void AdaptiveBlockAssembler::blockCommitted(
+    uint64_t _transactions, uint64_t _bytes, uint64_t _evmProcessingTimeMs ) {
+    blockCommitted( _transactions, _bytes, _evmProcessingTimeMs, Time::getCurrentTimeMs() );
+}
+
+
+void AdaptiveBlockAssembler::blockCommitted( uint64_t _transactions, uint64_t _bytes,
+    uint64_t _evmProcessingTimeMs, uint64_t _commitTimeMs ) {
+    lock_guard< mutex > guard( lock );
+
+    if ( _transactions > 0 ) {
+        smooth( evmMsPerTransaction, ( double ) _evmProcessingTimeMs / _transactions );
+        smooth( transactionBytes, ( double ) _bytes / _transactions );
+    }
+
+    if ( lastCommitTimeMs > 0 ) {
+        // whatever the model does not explain is the fixed cost of a block
+        auto variableMs =
+            _transactions * ( evmMsPerTransaction + sentBytes * transferMsPerByte ) + lastWaitMs;
+        smooth( fixedMs,
+            max( ( double ) _commitTimeMs - ( double ) lastCommitTimeMs - variableMs, 0.0 ) );
+    }
+
+    lastCommitTimeMs = _commitTimeMs;
+}
+
+
+nlohmann::json AdaptiveBlockAssembler::getStatus() {
+    lock_guard< mutex > guard( lock );
+
+    auto status = nlohmann::json::object();
+
+    status["enabled"] = true;
+    status["targetBlockTimeMs"] = targetBlockTimeMs;
+    status["maxTransactions"] = lastDecision.maxTransactions;
+    status["maxBytes"] = lastDecision.maxBytes;
+    status["waitMs"] = lastDecision.waitMs;
+    status["decisions"] = decisions;
+    status["queueDepth"] = lastQueueDepth;
+
+    status["model"]["evmMsPerTransaction"] = evmMsPerTransaction;
+    status["model"]["transferMsPerByte"] = transferMsPerByte;
+    status["model"]["roundTripMs"] = roundTripMs;
+    status["model"]["sentBytesPerTransaction"] = sentBytes;
+    status["model"]["fixedMs"] = fixedMs;
+    status["model"]["transactionBytes"] = transactionBytes;
+
+    status["lastProposal"]["transactions"] = lastTransactions;
+    status["lastProposal"]["bytes"] = lastBytes;
+    status["lastProposal"]["waitMs"] = lastWaitMs;
+    status["lastProposal"]["saturated"] = lastSaturated;
+
+    return status;
+}
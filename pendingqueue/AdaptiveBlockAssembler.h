@@ -0,0 +1,123 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file AdaptiveBlockAssembler.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "thirdparty/json.hpp"
+
+/*
+ * Picks the transaction limit and the wait time of each block proposal, so that blocks are as
+ * large as possible while the block time stays under a target.
+ *
+ * The block time is modelled as
+ *
+ *     fixedMs + transactions * ( evmMsPerTransaction + sentBytes * transferMsPerByte )
+ *
+ * The EVM cost comes from the processing time of committed blocks. The transfer cost comes from
+ * the time it takes to push proposals to the peers, sentBytes is what a push sends per
+ * transaction, which is less than the transaction if the peer already has it. The fixed part,
+ * consensus rounds and round trips, is the rest of the time between commits. All of them are
+ * moving averages.
+ *
+ * The limit is the number of transactions that fits the target, capped by the configured
+ * maximum transaction count and block size. It grows only while the pending queue fills the
+ * blocks. If fewer transactions are pending, the proposer waits for more while the predicted
+ * block time stays under the target.
+ */
+class AdaptiveBlockAssembler {
+public:
+    class Decision {
+    public:
+        uint64_t maxTransactions = 0;
+
+        uint64_t maxBytes = 0;  // 0 if not limited
+
+        uint64_t waitMs = 0;
+    };
+
+private:
+    static constexpr double SMOOTHING = 0.2;
+
+    // smaller pushes measure the round trip rather than the bandwidth
+    static constexpr uint64_t MIN_BANDWIDTH_SAMPLE_BYTES = 16 * 1024;
+
+    const uint64_t targetBlockTimeMs;
+
+    const uint64_t maxTransactionsPerBlock;
+
+    const uint64_t maxBlockBytes;  // 0 if not limited
+
+    mutex lock;
+
+    // the fields below are protected by lock
+
+    double evmMsPerTransaction = 0;
+
+    double transferMsPerByte = 0;
+
+    double roundTripMs = 0;
+
+    double sentBytes = 0;
+
+    double fixedMs = 0;
+
+    double transactionBytes = 0;  // used for the block size limit
+
+    uint64_t lastCommitTimeMs = 0;
+
+    Decision lastDecision;
+
+    uint64_t lastTransactions = 0;
+
+    uint64_t lastBytes = 0;
+
+    uint64_t lastWaitMs = 0;
+
+    // the queue had at least as many transactions as the limit
+    bool lastSaturated = false;
+
+    uint64_t lastQueueDepth = 0;
+
+    uint64_t decisions = 0;
+
+    static void smooth( double& _average, double _sample );
+
+public:
+    AdaptiveBlockAssembler(
+        uint64_t _targetBlockTimeMs, uint64_t _maxTransactionsPerBlock, uint64_t _maxBlockBytes );
+
+    // _queueDepth is the number of pending transactions, up to the configured maximum
+    Decision decide( uint64_t _emptyBlockIntervalMs, uint64_t _queueDepth );
+
+    void proposalAssembled( uint64_t _transactions, uint64_t _bytes, uint64_t _waitMs,
+        bool _saturated );
+
+    void proposalPushed( uint64_t _transactions, uint64_t _bytes, uint64_t _timeMs );
+
+    void blockCommitted( uint64_t _transactions, uint64_t _bytes, uint64_t _evmProcessingTimeMs );
+
+    void blockCommitted( uint64_t _transactions, uint64_t _bytes, uint64_t _evmProcessingTimeMs,
+        uint64_t _commitTimeMs );
+
+    nlohmann::json getStatus();
+};
@@ -0,0 +1,374 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file KnownTransactionIndex.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+
+#include "datastructures/Transaction.h"
+#include "utils/Time.h"
+
+#include "KnownTransactionIndex.h"
+
+
+KnownTransactionIndex::Table::Table( uint64_t _capacity )
+    : mask( _capacity - 1 ), keys( _capacity ), entries( _capacity ), referenced( _capacity ) {
+    CHECK_ARGUMENT( ( _capacity & mask ) == 0 );
+}
+
+
+KnownTransactionIndex::KnownTransactionIndex( uint64_t _maxCount, uint64_t _maxTotalSize )
+    : maxCount( _maxCount ),
+      maxTotalSize( _maxTotalSize ),
+      capacity( [_maxCount]() {
+          // keep the load factor at or below 1/4 so that probe sequences stay short
+          uint64_t result = 1024;
+          while ( result < 4 * _maxCount )
+              result *= 2;
+          return result;
+      }() ),
+      table( new Table( capacity ) ) {
+    CHECK_ARGUMENT( _maxCount > 0 );
+    CHECK_ARGUMENT( _maxTotalSize > 0 );
+}
+
+
+KnownTransactionIndex::~KnownTransactionIndex() {
+    auto current = table.load();
+    for ( uint64_t i = 0; i <= current->mask; i++ ) {
+        delete current->entries[i].load();
+    }
+    delete current;
+
+    for ( auto&& item : retiredEntries )
+        delete item.second;
+    for ( auto&& item : retiredTables )
+        delete item.second;
+}
+
+
+uint64_t KnownTransactionIndex::toKey( const partial_sha_hash& _hash ) {
+    uint64_t key;
+    memcpy( &key, _hash.data(), sizeof( key ) );
+    return key;
+}
+
+
+uint64_t KnownTransactionIndex::slotKey( uint64_t _key ) {
+    // entries store the original key, so a remapped key never matches a different transaction
+    return _key > DELETED_KEY ? _key : _key + 2;
+}
+
+
+uint64_t KnownTransactionIndex::probeStart( uint64_t _slotKey, uint64_t _mask ) {
+    // partial hashes are hash prefixes, mix anyway in case the table is fed non-random keys
+    uint64_t h = _slotKey * 0x9E3779B97F4A7C15ULL;
+    return ( h ^ ( h >> 32 ) ) & _mask;
+}
+
+
+uint64_t KnownTransactionIndex::enterReader() {
+    static thread_local uint64_t hint = std::hash< std::thread::id >()( std::this_thread::get_id() );
+
+    uint64_t epoch = globalEpoch.load();
+
+    while ( true ) {
+        for ( uint64_t i = 0; i < READER_SLOTS; i++ ) {
+            auto index = ( hint + i ) % READER_SLOTS;
+            uint64_t expected = 0;
+            if ( readerSlots[index].epoch.compare_exchange_strong( expected, epoch ) ) {
+                hint = index;
+                // a writer may have advanced the epoch before seeing the announcement,
+                // so announce again until the epoch is stable
+                while ( true ) {
+                    auto current = globalEpoch.load();
+                    if ( current == epoch )
+                        return index;
+                    epoch = current;
+                    readerSlots[index].epoch.store( epoch );
+                }
+            }
+        }
+        this_thread::yield();
+    }
+}
+
+
+void KnownTransactionIndex::exitReader( uint64_t _readerSlot ) {
+    readerSlots[_readerSlot].epoch.store( 0, memory_order_release );
+}
+
+
+ptr< Transaction > KnownTransactionIndex::get( const partial_sha_hash& _hash ) {
+    auto key = toKey( _hash );
+    auto k = slotKey( key );
+
+    auto readerSlot = enterReader();
+    auto& slot = readerSlots[readerSlot];
+
+    ptr< Transaction > result = nullptr;
+
+    auto current = table.load( memory_order_acquire );
+
+    auto index = probeStart( k, current->mask );
+
+    for ( uint64_t i = 0; i <= current->mask; i++ ) {
+        auto slotKey = current->keys[index].load( memory_order_acquire );
+        if ( slotKey == EMPTY_KEY )
+            break;
+        if ( slotKey == k ) {
+            auto entry = current->entries[index].load( memory_order_acquire );
+            // the slot may have been reused for another key since the key was read
+            if ( entry && entry->key == key ) {
+                result = entry->transaction;
+                if ( !current->referenced[index].load( memory_order_relaxed ) )
+                    current->referenced[index].store( true, memory_order_relaxed );
+                break;
+            }
+        }
+        index = ( index + 1 ) & current->mask;
+    }
+
+    slot.lookups.store( slot.lookups.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+    if ( result )
+        slot.hits.store( slot.hits.load( memory_order_relaxed ) + 1, memory_order_relaxed );
+
+    exitReader( readerSlot );
+
+    return result;
+}
+
+
+int64_t KnownTransactionIndex::findSlot( Table& _table, uint64_t _key ) {
+    auto k = slotKey( _key );
+    auto index = probeStart( k, _table.mask );
+
+    for ( uint64_t i = 0; i <= _table.mask; i++ ) {
+        auto key = _table.keys[index].load( memory_order_relaxed );
+        if ( key == EMPTY_KEY )
+            return -1;
+        if ( key == k ) {
+            auto entry = _table.entries[index].load( memory_order_relaxed );
+            if ( entry && entry->key == _key )
+                return ( int64_t ) index;
+        }
+        index = ( index + 1 ) & _table.mask;
+    }
+
+    return -1;
+}
+
+
+void KnownTransactionIndex::insertIntoTable( Table& _table, Entry* _entry ) {
+    auto k = slotKey( _entry->key );
+    auto index = probeStart( k, _table.mask );
+
+    for ( uint64_t i = 0; i <= _table.mask; i++ ) {
+        auto key = _table.keys[index].load( memory_order_relaxed );
+        if ( key == EMPTY_KEY || key == DELETED_KEY ) {
+            if ( key == EMPTY_KEY )
+                _table.usedSlots++;
+            // the entry is published before the key, so a reader that sees the key sees the
+            // entry
+            _table.entries[index].store( _entry, memory_order_release );
+            _table.referenced[index].store( true, memory_order_relaxed );
+            _table.keys[index].store( k, memory_order_release );
+            return;
+        }
+        index = ( index + 1 ) & _table.mask;
+    }
+
+    BOOST_THROW_EXCEPTION( FatalError( "Known transaction index is full" ) );
+}
+
+
+void KnownTransactionIndex::evictOne( Table& _table ) {
+    CHECK_STATE( count > 0 );
+
+    while ( true ) {
+        auto index = clockHand;
+        clockHand = ( clockHand + 1 ) & _table.mask;
+
+        auto entry = _table.entries[index].load( memory_order_relaxed );
+
+        if ( !entry )
+            continue;
+
+        if ( _table.referenced[index].load( memory_order_relaxed ) ) {
+            _table.referenced[index].store( false, memory_order_relaxed );
+            continue;
+        }
+
+        _table.keys[index].store( DELETED_KEY, memory_order_release );
+        _table.entries[index].store( nullptr, memory_order_release );
+
+        count--;
+        totalSize -= entry->size;
+        retiredEntries.emplace_back( globalEpoch.load(), entry );
+        return;
+    }
+}
+
+
+void KnownTransactionIndex::rebuild() {
+    // deleted slots lengthen probe sequences, so the table is rebuilt once they pile up.
+    // Readers that still use the old table see the same live entries
+    auto oldTable = table.load();
+    auto newTable = new Table( capacity );
+
+    for ( uint64_t i = 0; i <= oldTable->mask; i++ ) {
+        auto entry = oldTable->entries[i].load( memory_order_relaxed );
+        if ( entry )
+            insertIntoTable( *newTable, entry );
+    }
+
+    table.store( newTable, memory_order_release );
+    retiredTables.emplace_back( globalEpoch.load(), oldTable );
+}
+
+
+void KnownTransactionIndex::reclaim() {
+    // objects retired at epoch e are only visible to readers that announced epoch e or earlier
+    globalEpoch++;
+
+    auto minEpoch = globalEpoch.load();
+
+    for ( auto&& slot : readerSlots ) {
+        auto epoch = slot.epoch.load();
+        if ( epoch != 0 && epoch < minEpoch )
+            minEpoch = epoch;
+    }
+
+    auto freeRetired = [minEpoch]( auto& _retired ) {
+        auto it = remove_if( _retired.begin(), _retired.end(), [minEpoch]( auto& _item ) {
+            if ( _item.first >= minEpoch )
+                return false;
+            delete _item.second;
+            return true;
+        } );
+        _retired.erase( it, _retired.end() );
+    };
+
+    freeRetired( retiredEntries );
+    freeRetired( retiredTables );
+}
+
+
+bool KnownTransactionIndex::put( const ptr< Transaction >& _transaction ) {
+    CHECK_ARGUMENT( _transaction );
+
+    auto partialHash = _transaction->getPartialHash();
+    CHECK_STATE( partialHash );
+
+    auto key = toKey( *partialHash );
+
+    LOCK( writeLock );
+
+    auto current = table.load();
+
+    if ( findSlot( *current, key ) >= 0 )
+        return false;
+
+    auto entry = new Entry();
+    entry->key = key;
+    entry->transaction = _transaction;
+    entry->size = _transaction->getData()->size() + PARTIAL_HASH_LEN;
+
+    insertIntoTable( *current, entry );
+
+    count++;
+    totalSize += entry->size;
+
+    while ( count > maxCount || totalSize > maxTotalSize ) {
+        evictOne( *current );
+    }
+
+    if ( current->usedSlots > capacity / 2 ) {
+        rebuild();
+    }
+
+    if ( retiredEntries.size() >= RECLAIM_BATCH || !retiredTables.empty() ) {
+        reclaim();
+    }
+
+    return true;
+}
+
+
+uint64_t KnownTransactionIndex::getCount() {
+    LOCK( writeLock );
+    return count;
+}
+
+
+uint64_t KnownTransactionIndex::getTotalSize() {
+    LOCK( writeLock );
+    return totalSize;
+}
+
+
+void KnownTransactionIndex::forEachKey( const function< void( uint64_t _key ) >& _visitor ) {
+    // runs as a reader, so puts are not blocked. Entries and tables unlinked during the
+    // iteration stay allocated until exitReader, entries added during it may be missed
+    auto readerSlot = enterReader();
+
+    try {
+        auto current = table.load( memory_order_acquire );
+
+        for ( uint64_t i = 0; i <= current->mask; i++ ) {
+            auto entry = current->entries[i].load( memory_order_acquire );
+            if ( entry )
+                _visitor( entry->key );
+        }
+    } catch ( ... ) {
+        exitReader( readerSlot );
+        throw;
+    }
+
+    exitReader( readerSlot );
+}
+
+
+string KnownTransactionIndex::getLookupStats() {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+
+    for ( auto&& slot : readerSlots ) {
+        lookups += slot.lookups.load( memory_order_relaxed );
+        hits += slot.hits.load( memory_order_relaxed );
+    }
+
+    LOCK( writeLock );
+
+    auto now = Time::getCurrentTimeMs();
+    auto elapsedMs = max< uint64_t >( now - lastReportTimeMs, 1 );
+    auto newLookups = lookups - lastReportedLookups;
+
+    string result = to_string( lastReportTimeMs == 0 ? 0 : newLookups * 1000 / elapsedMs ) + "/" +
+                    to_string( lookups == 0 ? 0 : hits * 100 / lookups );
+
+    lastReportedLookups = lookups;
+    lastReportTimeMs = now;
+
+    return result;
+}
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file KnownTransactionIndex.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+class Transaction;
+
+/*
+ * Index of known transactions by partial hash.
+ *
+ * An open addressing table with linear probing, keyed inline by the 8-byte partial hash.
+ * Lookups do not take locks: a reader announces the current epoch in a reader slot,
+ * and entries and tables unlinked by writers are freed only once no reader can still
+ * see them (epoch based reclamation).
+ *
+ * Writers are serialized by a mutex. Entries are evicted in CLOCK order once the
+ * entry count or the total transaction size exceeds the limits. A lookup hit gives
+ * an entry a second chance.
+ */
+class KnownTransactionIndex {
+    class Entry {
+    public:
+        uint64_t key;
+
+        ptr< Transaction > transaction;
+
+        uint64_t size;
+    };
+
+    class Table {
+    public:
+        explicit Table( uint64_t _capacity );
+
+        uint64_t mask;
+
+        vector< atomic< uint64_t > > keys;
+
+        vector< atomic< Entry* > > entries;
+
+        vector< atomic< bool > > referenced;
+
+        // live entries plus tombstones, only accessed by writers
+        uint64_t usedSlots = 0;
+    };
+
+    class alignas( 64 ) ReaderSlot {
+    public:
+        atomic< uint64_t > epoch = 0;  // 0 if the slot is free
+
+        // only written by the thread that holds the slot
+        atomic< uint64_t > lookups = 0;
+
+        atomic< uint64_t > hits = 0;
+    };
+
+    // keys 0 and 1 mark empty and deleted slots, partial hashes equal to them are remapped
+    static constexpr uint64_t EMPTY_KEY = 0;
+
+    static constexpr uint64_t DELETED_KEY = 1;
+
+    static constexpr uint64_t READER_SLOTS = 128;
+
+    static constexpr uint64_t RECLAIM_BATCH = 256;
+
+    const uint64_t maxCount;
+
+    const uint64_t maxTotalSize;
+
+    const uint64_t capacity;
+
+    atomic< Table* > table;
+
+    array< ReaderSlot, READER_SLOTS > readerSlots;
+
+    atomic< uint64_t > globalEpoch = 2;
+
+    recursive_mutex writeLock;
+
+    // the fields below are protected by writeLock
+
+    uint64_t count = 0;
+
+    uint64_t totalSize = 0;
+
+    uint64_t clockHand = 0;
+
+    vector< pair< uint64_t, Entry* > > retiredEntries;
+
+    vector< pair< uint64_t, Table* > > retiredTables;
+
+    uint64_t lastReportedLookups = 0;
+
+    uint64_t lastReportTimeMs = 0;
+
+    static uint64_t toKey( const partial_sha_hash& _hash );
+
+    static uint64_t slotKey( uint64_t _key );
+
+    static uint64_t probeStart( uint64_t _slotKey, uint64_t _mask );
+
+    uint64_t enterReader();
+
+    void exitReader( uint64_t _readerSlot );
+
+    // returns the slot holding the key, or -1
+    int64_t findSlot( Table& _table, uint64_t _key );
+
+    void insertIntoTable( Table& _table, Entry* _entry );
+
+    void evictOne( Table& _table );
+
+    void rebuild();
+
+    void reclaim();
+
+public:
+    KnownTransactionIndex( uint64_t _maxCount, uint64_t _maxTotalSize );
+
+    ~KnownTransactionIndex();
+
+    // does not take locks
+    ptr< Transaction > get( const partial_sha_hash& _hash );
+
+    // returns false if a transaction with this partial hash is already known
+    bool put( const ptr< Transaction >& _transaction );
+
+    uint64_t getCount();
+
+    uint64_t getTotalSize();
+
+    // visits the partial hashes of all entries without taking the write lock. A slow visitor
+    // only delays the reclamation of evicted entries
+    void forEachKey( const function< void( uint64_t _key ) >& _visitor );
+
+    // lookups/s and hit percentage since the previous call
+    string getLookupStats();
+};
@@ -0,0 +1,202 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file LoadGenerator.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/InvalidArgumentException.h"
+
+#include "LoadGenerator.h"
+
+
+LoadGenerator::LoadGenerator( ArrivalProcess _arrivalProcess, double _rate, uint64_t _burstSize,
+    SizeDistribution _sizeDistribution, uint64_t _size, uint64_t _minSize, uint64_t _maxSize,
+    double _sigma, uint64_t _seed )
+    : arrivalProcess( _arrivalProcess ),
+      rate( _rate ),
+      burstSize( _burstSize ),
+      sizeDistribution( _sizeDistribution ),
+      size( _size ),
+      minSize( _minSize ),
+      maxSize( _maxSize ),
+      sigma( _sigma ),
+      arrivalRng( _seed ),
+      sizeRng( _seed + 1 ),
+      bytesRng( _seed + 2 ) {
+    CHECK_ARGUMENT( _rate > 0 );
+    CHECK_ARGUMENT( _burstSize > 0 );
+    CHECK_ARGUMENT( _minSize >= MIN_TRANSACTION_SIZE );
+    CHECK_ARGUMENT( _minSize <= _maxSize );
+    CHECK_ARGUMENT( _size >= _minSize && _size <= _maxSize );
+    CHECK_ARGUMENT( _sigma >= 0 );
+}
+
+
+LoadGenerator::ArrivalProcess LoadGenerator::parseArrivalProcess( const string& _name ) {
+    if ( _name == "constant" )
+        return CONSTANT;
+    if ( _name == "poisson" )
+        return POISSON;
+    if ( _name == "burst" )
+        return BURST;
+    BOOST_THROW_EXCEPTION(
+        InvalidArgumentException( "Unknown arrival process:" + _name, __CLASS_NAME__ ) );
+}
+
+
+LoadGenerator::SizeDistribution LoadGenerator::parseSizeDistribution( const string& _name ) {
+    if ( _name == "fixed" )
+        return FIXED;
+    if ( _name == "uniform" )
+        return UNIFORM;
+    if ( _name == "lognormal" )
+        return LOGNORMAL;
+    BOOST_THROW_EXCEPTION(
+        InvalidArgumentException( "Unknown size distribution:" + _name, __CLASS_NAME__ ) );
+}
+
+
+double LoadGenerator::toOpenUnitInterval( uint64_t _random ) {
+    // 53 bits would round the largest value up to 1
+    return ( ( double ) ( _random >> 12 ) + 0.5 ) / ( double ) ( 1ULL << 52 );
+}
+
+
+double LoadGenerator::inverseNormalCdf( double _p ) {
+    CHECK_ARGUMENT( _p > 0 && _p < 1 );
+
+    // Acklam's rational approximation, relative error below 1.15e-9
+    static const double a[] = { -3.969683028665376e+01, 2.209460984245205e+02,
+        -2.759285104469687e+02, 1.383577518672690e+02, -3.066479806614716e+01,
+        2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01, 1.615858368580409e+02,
+        -1.556989798598866e+02, 6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01,
+        -2.400758277161838e+00, -2.549732539343734e+00, 4.374664141464968e+00,
+        2.938163982698783e+00 };
+    static const double d[] = { 7.784695709041462e-03, 3.224671290700398e-01,
+        2.445134137142996e+00, 3.754408661907416e+00 };
+
+    const double low = 0.02425;
+
+    if ( _p < low ) {
+        auto q = sqrt( -2 * log( _p ) );
+        return ( ( ( ( ( c[0] * q + c[1] ) * q + c[2] ) * q + c[3] ) * q + c[4] ) * q + c[5] ) /
+               ( ( ( ( d[0] * q + d[1] ) * q + d[2] ) * q + d[3] ) * q + 1 );
+    }
+
+    if ( _p > 1 - low ) {
+        auto q = sqrt( -2 * log( 1 - _p ) );
+        return -( ( ( ( ( c[0] * q + c[1] ) * q + c[2] ) * q + c[3] ) * q + c[4] ) * q + c[5] ) /
+               ( ( ( ( d[0] * q + d[1] ) * q + d[2] ) * q + d[3] ) * q + 1 );
+    }
+
+    auto q = _p - 0.5;
+    auto r = q * q;
+    return ( ( ( ( ( a[0] * r + a[1] ) * r + a[2] ) * r + a[3] ) * r + a[4] ) * r + a[5] ) * q /
+           ( ( ( ( ( b[0] * r + b[1] ) * r + b[2] ) * r + b[3] ) * r + b[4] ) * r + 1 );
+}
+
+
+double LoadGenerator::sampleExponential( uint64_t _random, double _rate ) {
+    CHECK_ARGUMENT( _rate > 0 );
+    return -log( toOpenUnitInterval( _random ) ) / _rate;
+}
+
+
+double LoadGenerator::sampleLognormal( uint64_t _random, double _median, double _sigma ) {
+    CHECK_ARGUMENT( _median > 0 );
+    return _median * exp( _sigma * inverseNormalCdf( toOpenUnitInterval( _random ) ) );
+}
+
+
+uint64_t LoadGenerator::sampleUniform( uint64_t _random, uint64_t _min, uint64_t _max ) {
+    CHECK_ARGUMENT( _min <= _max );
+    auto range = ( unsigned __int128 ) ( _max - _min ) + 1;
+    // the high bits of the product, which have no modulo bias to speak of for these ranges
+    return _min + ( uint64_t ) ( ( ( unsigned __int128 ) _random * range ) >> 64 );
+}
+
+
+uint64_t LoadGenerator::getNextArrivalUs() const {
+    return ( uint64_t ) nextArrivalUs;
+}
+
+
+void LoadGenerator::advanceArrival() {
+    switch ( arrivalProcess ) {
+    case CONSTANT:
+        nextArrivalUs += 1000000.0 / rate;
+        break;
+    case POISSON:
+        nextArrivalUs += sampleExponential( arrivalRng(), rate ) * 1000000.0;
+        break;
+    case BURST:
+        // burstSize transactions arrive together, at the same average rate
+        if ( nextSequence % burstSize == 0 )
+            nextArrivalUs += burstSize * 1000000.0 / rate;
+        break;
+    }
+}
+
+
+uint64_t LoadGenerator::nextSize() {
+    double result = size;
+
+    switch ( sizeDistribution ) {
+    case FIXED:
+        break;
+    case UNIFORM:
+        result = sampleUniform( sizeRng(), minSize, maxSize );
+        break;
+    case LOGNORMAL:
+        result = sampleLognormal( sizeRng(), size, sigma );
+        break;
+    }
+
+    return min( max( ( uint64_t ) result, minSize ), maxSize );
+}
+
+
+vector< uint8_t > LoadGenerator::next() {
+    vector< uint8_t > transaction( nextSize() );
+
+    auto sequence = nextSequence++;
+    memcpy( transaction.data(), &sequence, sizeof( sequence ) );
+
+    for ( uint64_t i = sizeof( sequence ); i < transaction.size(); i += sizeof( uint64_t ) ) {
+        auto word = bytesRng();
+        memcpy( transaction.data() + i, &word, min( sizeof( word ), transaction.size() - i ) );
+    }
+
+    advanceArrival();
+
+    return transaction;
+}
+
+
+uint64_t LoadGenerator::getSequence( const vector< uint8_t >& _transaction ) {
+    CHECK_ARGUMENT( _transaction.size() >= MIN_TRANSACTION_SIZE );
+    uint64_t sequence;
+    memcpy( &sequence, _transaction.data(), sizeof( sequence ) );
+    return sequence;
+}
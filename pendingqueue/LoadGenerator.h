@@ -0,0 +1,108 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file LoadGenerator.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <random>
+
+/*
+ * Transaction load for benchmarks.
+ *
+ * Arrival times and sizes come from generators seeded with the benchmark seed, so runs
+ * with the same parameters submit the same transactions at the same offsets from the start.
+ * The standard library distributions are implementation defined, so samples are computed
+ * from the raw mt19937_64 output by inverting the distribution function. This keeps runs
+ * comparable between compilers and standard libraries.
+ * Each transaction starts with its sequence number, which makes it unique and lets the
+ * benchmark match it when it is committed.
+ */
+class LoadGenerator {
+public:
+    enum ArrivalProcess { CONSTANT, POISSON, BURST };
+
+    enum SizeDistribution { FIXED, UNIFORM, LOGNORMAL };
+
+    static constexpr uint64_t MIN_TRANSACTION_SIZE = sizeof( uint64_t );
+
+private:
+    const ArrivalProcess arrivalProcess;
+
+    const double rate;  // transactions per second
+
+    const uint64_t burstSize;
+
+    const SizeDistribution sizeDistribution;
+
+    const uint64_t size;  // fixed size, or median of the log-normal distribution
+
+    const uint64_t minSize;
+
+    const uint64_t maxSize;
+
+    const double sigma;
+
+    // separate generators, so that changing the size distribution does not move arrivals
+    mt19937_64 arrivalRng;
+
+    mt19937_64 sizeRng;
+
+    mt19937_64 bytesRng;
+
+    uint64_t nextSequence = 0;
+
+    double nextArrivalUs = 0;
+
+    void advanceArrival();
+
+    uint64_t nextSize();
+
+public:
+    // uniform in (0, 1), from the top 52 bits of a raw generator output
+    static double toOpenUnitInterval( uint64_t _random );
+
+    // the standard normal quantile of _p in (0, 1)
+    static double inverseNormalCdf( double _p );
+
+    static double sampleExponential( uint64_t _random, double _rate );
+
+    static double sampleLognormal( uint64_t _random, double _median, double _sigma );
+
+    // uniform in [_min, _max]
+    static uint64_t sampleUniform( uint64_t _random, uint64_t _min, uint64_t _max );
+
+    LoadGenerator( ArrivalProcess _arrivalProcess, double _rate, uint64_t _burstSize,
+        SizeDistribution _sizeDistribution, uint64_t _size, uint64_t _minSize, uint64_t _maxSize,
+        double _sigma, uint64_t _seed );
+
+    static ArrivalProcess parseArrivalProcess( const string& _name );
+
+    static SizeDistribution parseSizeDistribution( const string& _name );
+
+    // offset of the next arrival from the start of the run
+    uint64_t getNextArrivalUs() const;
+
+    // returns the transaction arriving at getNextArrivalUs() and moves to the next arrival
+    vector< uint8_t > next();
+
+    static uint64_t getSequence( const vector< uint8_t >& _transaction );
+};
@@ -33,6 +33,8 @@
 #include <monitoring/LivelinessMonitor.h>
 #include <unordered_set>
 
+#include "AdaptiveBlockAssembler.h"
+#include "KnownTransactionIndex.h"
 #include "PendingTransactionsAgent.h"
 #include "chains/Schain.h"
 #include "crypto/CryptoManager.h"
@@ -54,7 +56,15 @@ using namespace std;
 
 
 PendingTransactionsAgent::PendingTransactionsAgent(Schain &ref_sChain)
-        : Agent(ref_sChain, false) {}
+        : Agent(ref_sChain, false),
+          knownTransactions(make_shared<KnownTransactionIndex>(
+                  KNOWN_TRANSACTIONS_HISTORY, MAX_KNOWN_TRANSACTIONS_TOTAL_SIZE)) {
+    if (getNode()->getTargetBlockTimeMs() > 0) {
+        blockAssembler = make_shared<AdaptiveBlockAssembler>(
+                getNode()->getTargetBlockTimeMs(), getNode()->getMaxTransactionsPerBlock(),
+                getNode()->getMaxBlockBytes());
+    }
+}
 
 ptr<BlockProposal> PendingTransactionsAgent::buildBlockProposal(
         block_id _blockID, TimeStamp &_previousBlockTimeStamp, bool _isCalledAfterCatchup) {
@@ -113,6 +123,20 @@ PendingTransactionsAgent::createTransactionsListForProposal(bool _isCalledAfterC
     }
 
 
+    uint64_t emptyBlockTimeMs;
+
+    if (_isCalledAfterCatchup) {
+        // chose the smaller of two intervals. This is just to be able to force
+        // empty block in tests by setting only emptyBlockInterval to zero
+        emptyBlockTimeMs = std::min(getNode()->getEmptyBlockIntervalAfterCatchupMs(),
+                                    getNode()->getEmptyBlockIntervalMs());
+    } else {
+        emptyBlockTimeMs = getNode()->getEmptyBlockIntervalMs();
+    }
+
+    AdaptiveBlockAssembler::Decision decision;
+    bool decided = !blockAssembler;
+
     ConsensusExtFace::transactions_vector txVector;
 
     auto startTimeMs = Time::getCurrentTimeMs();
@@ -123,7 +147,7 @@ PendingTransactionsAgent::createTransactionsListForProposal(bool _isCalledAfterC
     uint64_t waitTimeMs = 10;
 
 
-    while (txVector.empty()) {
+    while (true) {
         getSchain()->getNode()->exitCheck();
 
         if (sChain->getExtFace()) {
@@ -139,25 +163,37 @@ PendingTransactionsAgent::createTransactionsListForProposal(bool _isCalledAfterC
             txVector = sChain->getTestMessageGeneratorAgent()->pendingTransactions(needMax);
         }
 
+        if (!decided) {
+            // the first poll shows how deep the queue is, up to the configured maximum
+            decision = blockAssembler->decide(emptyBlockTimeMs, txVector.size());
+            needMax = std::min(needMax, (size_t) decision.maxTransactions);
+            if (txVector.size() > needMax) {
+                txVector.resize(needMax);
+            }
+            decided = true;
+        }
+
         auto finishTime = Time::getCurrentTimeMs();
         auto diffTime = finishTime - startTimeMs;
 
-        uint64_t emptyBlockTimeMs;
-
-        if (_isCalledAfterCatchup) {
-            // chose the smaller of two intervals. This is just to be able to force
-            // empty block in tests by setting only emptyBlockInterval to zero
-            emptyBlockTimeMs = std::min(getNode()->getEmptyBlockIntervalAfterCatchupMs(),
-                                        getNode()->getEmptyBlockIntervalMs());
-        } else {
-            emptyBlockTimeMs = getNode()->getEmptyBlockIntervalMs();
+        if (this->sChain->getLastCommittedBlockID() == 0 || diffTime >= emptyBlockTimeMs) {
+            break;
         }
 
-        if (this->sChain->getLastCommittedBlockID() == 0 || diffTime >= emptyBlockTimeMs) {
+        // a poll does not remove transactions from the queue, so the adaptive assembler polls
+        // again until the block is full or the wait time it picked is over
+        if (!txVector.empty() &&
+            (!blockAssembler || txVector.size() >= needMax || diffTime >= decision.waitMs)) {
             break;
         }
 
-        usleep(waitTimeMs * 1000);
+        auto sleepMs = waitTimeMs;
+
+        if (!txVector.empty()) {
+            sleepMs = std::min(sleepMs, decision.waitMs - diffTime);
+        }
+
+        usleep(sleepMs * 1000);
 
         if (waitTimeMs < 10 * 32) {
             waitTimeMs *= 2;
@@ -169,58 +205,61 @@ PendingTransactionsAgent::createTransactionsListForProposal(bool _isCalledAfterC
 
     transactionListWaitTime = finishTimeMs - startTimeMs;
 
+    auto saturated = txVector.size() >= needMax;
+    uint64_t bytes = 0;
+
     for (const auto &e: txVector) {
+        // the first transaction is always taken, so that a large one can not block the queue
+        if (decision.maxBytes > 0 && !result->empty() && bytes + e.size() > decision.maxBytes) {
+            saturated = true;
+            break;
+        }
+        bytes += e.size();
         ptr<Transaction> pt = Transaction::deserialize(
                 make_shared<std::vector<uint8_t> >(e), 0, e.size(), false);
         result->push_back(pt);
         pushKnownTransaction(pt);
     }
 
+    if (blockAssembler) {
+        blockAssembler->proposalAssembled(
+                result->size(), bytes, transactionListWaitTime, saturated);
+    }
+
     return {result, stateRoot};
 }
 
 
+const ptr<AdaptiveBlockAssembler> &PendingTransactionsAgent::getBlockAssembler() const {
+    return blockAssembler;
+}
+
+
 ptr<Transaction> PendingTransactionsAgent::getKnownTransactionByPartialHash(
         const ptr<partial_sha_hash> hash) {
-    READ_LOCK(transactionsMutex);
-    if (knownTransactions.count(hash))
-        return knownTransactions.at(hash);
-    return nullptr;
+    CHECK_ARGUMENT(hash);
+    return knownTransactions->get(*hash);
+}
+
+void PendingTransactionsAgent::forEachKnownPartialHash(
+        const function<void(uint64_t _key)> &_visitor) {
+    knownTransactions->forEachKey(_visitor);
 }
 
 void PendingTransactionsAgent::pushKnownTransaction(const ptr<Transaction> &_transaction) {
     CHECK_ARGUMENT(_transaction);
 
-    WRITE_LOCK(transactionsMutex);
-
-    if (knownTransactions.count(_transaction->getPartialHash())) {
+    if (!knownTransactions->put(_transaction)) {
         LOG(trace, "Duplicate transaction pushed to known transactions");
-        return;
     }
+}
 
-    auto partialHash = _transaction->getPartialHash();
-
-    CHECK_STATE(partialHash);
-
-    knownTransactions[partialHash] = _transaction;
-    knownTransactionsQueue.push(_transaction);
-    CHECK_STATE(knownTransactions.size() == knownTransactionsQueue.size());
-    knownTransactionsTotalSize += (_transaction->getData()->size() + PARTIAL_HASH_LEN);
 
-    while (knownTransactions.size() > KNOWN_TRANSACTIONS_HISTORY ||
-           knownTransactionsTotalSize > MAX_KNOWN_TRANSACTIONS_TOTAL_SIZE) {
-        auto tx = knownTransactionsQueue.front();
-        CHECK_STATE(tx);
-        knownTransactionsTotalSize -= (tx->getData()->size() + PARTIAL_HASH_LEN);
-        CHECK_STATE(knownTransactions.count(tx->getPartialHash()) > 0);
-        knownTransactions.erase(tx->getPartialHash());
-        knownTransactionsQueue.pop();
-    }
+uint64_t PendingTransactionsAgent::getKnownTransactionsSize() {
+    return knownTransactions->getCount();
 }
 
 
-uint64_t PendingTransactionsAgent::getKnownTransactionsSize() {
-    READ_LOCK(transactionsMutex);
-    CHECK_STATE(knownTransactions.size() == knownTransactionsQueue.size());
-    return knownTransactions.size();
+string PendingTransactionsAgent::getKnownTransactionsLookupStats() {
+    return knownTransactions->getLookupStats();
 }
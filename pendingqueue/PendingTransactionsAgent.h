@@ -31,6 +31,8 @@ class Schain;
 class BlockProposal;
 class PartialHashesList;
 class Transaction;
+class KnownTransactionIndex;
+class AdaptiveBlockAssembler;
 
 #include "db/CacheLevelDB.h"
 
@@ -77,12 +79,11 @@ private:
         }
     };
 
-    unordered_map< ptr< partial_sha_hash >, ptr< Transaction >, Hasher, Equal > knownTransactions;
-    queue< ptr< Transaction > > knownTransactionsQueue;
+    // probed once per partial hash of every received proposal, lookups do not lock
+    ptr< KnownTransactionIndex > knownTransactions;
 
-    uint64_t knownTransactionsTotalSize = 0;
-
-    shared_mutex transactionsMutex;
+    // null if adaptive block assembly is not configured
+    ptr< AdaptiveBlockAssembler > blockAssembler;
 
     transaction_count transactionCounter = 0;
 
@@ -100,8 +101,14 @@ public:
 
     uint64_t getKnownTransactionsSize();
 
+    // lookups/s and hit percentage since the previous call
+    string getKnownTransactionsLookupStats();
+
     ptr< Transaction > getKnownTransactionByPartialHash( ptr< partial_sha_hash > hash );
 
+    // see KnownTransactionIndex::forEachKey
+    void forEachKnownPartialHash( const function< void( uint64_t _key ) >& _visitor );
+
     ptr< BlockProposal > buildBlockProposal(
         block_id _blockID, TimeStamp& _previousBlockTimeStamp, bool _isCalledAfterCatchup );
 
@@ -109,5 +116,7 @@ public:
 
     uint64_t transactionListReceivedTime() const { return transactionListReceivedTimeMs; }
 
+    const ptr< AdaptiveBlockAssembler >& getBlockAssembler() const;
+
     ~PendingTransactionsAgent() override = default;
 };
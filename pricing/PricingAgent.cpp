@@ -29,6 +29,8 @@
 
 #include "ZeroPricingStrategy.h"
 #include "chains/Schain.h"
+#include "datastructures/CommittedBlock.h"
+#include "datastructures/TransactionList.h"
 #include "db/PriceDB.h"
 #include "exceptions/ExitRequestedException.h"
 #include "exceptions/FatalError.h"
@@ -40,7 +42,8 @@
 
 #include "PricingAgent.h"
 
-PricingAgent::PricingAgent( Schain& _sChain ) : Agent( _sChain, false ) {
+PricingAgent::PricingAgent( Schain& _sChain )
+    : Agent( _sChain, false ), recentPrices( RECENT_BLOCK_VALUES ) {
     string def( "DYNAMIC" );
 
     auto strategy = _sChain.getNode()->getParamString( "pricingStrategy", def );
@@ -96,12 +99,94 @@ u256 PricingAgent::calculatePrice(
 void PricingAgent::savePrice( u256 _price, block_id _blockID ) {
     auto db = sChain->getNode()->getPriceDB();
     CHECK_STATE( db );
-    db->savePrice( _price, _blockID );
+
+    // prices up to block 1 are written at once instead of being batched
+    if ( _blockID <= 1 ) {
+        db->savePrice( _price, _blockID );
+        return;
+    }
+
+    recentPrices.put( _blockID, _price );
+
+    lock_guard< mutex > lock( unsavedPricesLock );
+
+    unsavedPrices.emplace_back( _blockID, _price );
+
+    if ( unsavedPrices.size() >= PRICE_DB_WRITE_BATCH ) {
+        db->savePrices( unsavedPrices );
+        unsavedPrices.clear();
+    }
+}
+
+
+void PricingAgent::flushPrices() {
+    auto db = sChain->getNode()->getPriceDB();
+    CHECK_STATE( db );
+
+    lock_guard< mutex > lock( unsavedPricesLock );
+    db->savePrices( unsavedPrices );
+    unsavedPrices.clear();
 }
 
 
 u256 PricingAgent::readPrice( block_id _blockID ) {
+    u256 price;
+
+    if ( recentPrices.get( _blockID, price ) )
+        return price;
+
     auto db = sChain->getNode()->getPriceDB();
     CHECK_STATE( db );
+
+    auto lastCommittedBlockID = ( uint64_t ) sChain->getLastCommittedBlockID();
+
+    // only the prices of the last blocks may be missing after a restart
+    if ( _blockID > 1 && ( uint64_t ) _blockID <= lastCommittedBlockID &&
+         ( uint64_t ) _blockID + RECENT_BLOCK_VALUES > lastCommittedBlockID &&
+         !db->priceExists( _blockID ) ) {
+        return recoverPrice( _blockID );
+    }
+
     return db->readPrice( _blockID );
 }
+
+
+u256 PricingAgent::recoverPrice( block_id _blockID ) {
+    auto db = sChain->getNode()->getPriceDB();
+    CHECK_STATE( db );
+
+    // at most PRICE_DB_WRITE_BATCH prices are lost, the last one that was written to the db
+    // or the start price is the base
+    auto baseID = _blockID - 1;
+
+    while ( baseID > 1 && baseID + PRICE_DB_WRITE_BATCH >= _blockID &&
+            !db->priceExists( baseID ) ) {
+        baseID = baseID - 1;
+    }
+
+    LOG( info, "Recovering prices of blocks " << to_string( baseID + 1 ) << " to "
+                                              << to_string( _blockID ) );
+
+    auto price = db->readPrice( baseID );
+
+    vector< pair< block_id, u256 > > recovered;
+
+    for ( auto blockID = baseID + 1; blockID <= _blockID; blockID = blockID + 1 ) {
+        auto block = sChain->getBlock( blockID );
+        CHECK_STATE2( block, "Can not recover price, no block " + to_string( blockID ) );
+        auto tv = block->getTransactionList()->createTransactionVector();
+        price = pricingStrategy->calculatePrice(
+            price, *tv, block->getTimeStampS(), block->getTimeStampMs(), blockID );
+        recovered.emplace_back( blockID, price );
+        recentPrices.put( blockID, price );
+    }
+
+    db->savePrices( recovered );
+
+    return price;
+}
+
+
+string PricingAgent::getStats() {
+    return recentPrices.getStats();
+}
@@ -25,12 +25,25 @@
 #define SKALED_PRICINGAGENT_H
 
 #include "Agent.h"
+#include "datastructures/BlockValueRing.h"
 
 class PricingStrategy;
 
 class PricingAgent : public Agent {
     ptr< PricingStrategy > pricingStrategy;
 
+    BlockValueRing recentPrices;
+
+    mutex unsavedPricesLock;
+
+    // prices that are in recentPrices but not yet in the price db, protected by
+    // unsavedPricesLock
+    vector< pair< block_id, u256 > > unsavedPrices;
+
+    // recomputes a price that was not written to the price db before a restart
+    // from the committed blocks
+    u256 recoverPrice( block_id _blockID );
+
 public:
     explicit PricingAgent( Schain& _sChain );
 
@@ -40,6 +53,12 @@ public:
     u256 readPrice( block_id _blockId );
 
     void savePrice( u256 price, block_id _blockID );
+
+    // writes the pending prices to the price db
+    void flushPrices();
+
+    // hits/misses of recent prices
+    string getStats();
 };
 
 
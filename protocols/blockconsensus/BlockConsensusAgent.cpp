@@ -27,7 +27,6 @@
 #include "thirdparty/json.hpp"
 
 #include "blockfinalize/client/BlockFinalizeDownloader.h"
-#include "blockfinalize/client/BlockFinalizeDownloaderThreadPool.h"
 #include "blockproposal/pusher/BlockProposalClientAgent.h"
 #include "chains/Schain.h"
 #include "crypto/BLAKE3Hash.h"
@@ -86,14 +85,9 @@ BlockConsensusAgent::BlockConsensusAgent( Schain& _schain )
                 MAX_CONSENSUS_HISTORY ) );
     }
 
-    auto blockDB = _schain.getNode()->getBlockDB();
-
-    auto currentBlock = blockDB->readLastCommittedBlockID() + 1;
-
-    for ( int i = 0; i < _schain.getNodeCount(); i++ ) {
-        children[i]->put( ( uint64_t ) currentBlock,
-            make_shared< BinConsensusInstance >( this, currentBlock, i + 1, true ) );
-    }
+    // instances of the block that was in progress before a restart are restored from the db
+    // when they are first used, instead of all of them at startup
+    recoveredBlockID = _schain.getNode()->getBlockDB()->readLastCommittedBlockID() + 1;
 };
 
 
@@ -388,9 +382,9 @@ ptr< BinConsensusInstance > BlockConsensusAgent::getChild( const ptr< ProtocolKe
     try {
         LOCK( m )
         if ( !children.at( ( uint64_t ) bpi - 1 )->exists( ( uint64_t ) bid ) ) {
-            children.at( ( uint64_t ) bpi - 1 )
-                ->putIfDoesNotExist(
-                    ( uint64_t ) bid, make_shared< BinConsensusInstance >( this, bid, bpi ) );
+            auto child = make_shared< BinConsensusInstance >(
+                this, bid, bpi, bid == recoveredBlockID );
+            children.at( ( uint64_t ) bpi - 1 )->putIfDoesNotExist( ( uint64_t ) bid, child );
         }
 
         return children.at( ( uint64_t ) bpi - 1 )->get( ( uint64_t ) bid );
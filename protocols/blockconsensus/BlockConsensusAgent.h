@@ -46,6 +46,9 @@ class BlockConsensusAgent : public ProtocolInstance {
 
     vector< ptr< cache::lru_cache< uint64_t, ptr< BinConsensusInstance > > > > children;  // tsafe
 
+    // the block that was in consensus when the node stopped
+    block_id recoveredBlockID = 0;
+
     ptr< cache::lru_cache< uint64_t, ptr< map< schain_index, ptr< ChildBVDecidedMessage > > > > >
         trueDecisions;
     ptr< cache::lru_cache< uint64_t, ptr< map< schain_index, ptr< ChildBVDecidedMessage > > > > >
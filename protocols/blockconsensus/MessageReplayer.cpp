@@ -0,0 +1,263 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file MessageReplayer.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include <fstream>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "chains/Schain.h"
+#include "datastructures/BooleanProposalVector.h"
+#include "datastructures/TimeStamp.h"
+#include "exceptions/ExitRequestedException.h"
+#include "exceptions/InvalidArgumentException.h"
+#include "messages/ConsensusProposalMessage.h"
+#include "messages/InternalMessageEnvelope.h"
+#include "messages/NetworkMessage.h"
+#include "messages/NetworkMessageEnvelope.h"
+#include "network/ReplayNetwork.h"
+#include "node/Node.h"
+
+#include "BlockConsensusAgent.h"
+#include "MessageTrace.h"
+#include "MessageReplayer.h"
+
+
+MessageReplayer::MessageReplayer( Schain& _sChain ) : sChain( &_sChain ) {
+    sChain->getNode()->startReplay();
+    sChain->setReplayer( this );
+}
+
+
+MessageReplayer::~MessageReplayer() {
+    sChain->setReplayer( nullptr );
+}
+
+
+uint64_t MessageReplayer::getCurrentTimeUs() {
+    return chrono::duration_cast< chrono::microseconds >(
+        chrono::steady_clock::now().time_since_epoch() )
+        .count();
+}
+
+
+node_id MessageReplayer::readNodeID( const string& _traceFile ) {
+    ifstream file( _traceFile );
+
+    string line;
+
+    if ( !file.is_open() || !getline( file, line ) || line.size() < 3 ||
+         line[0] != MessageTrace::HEADER ) {
+        BOOST_THROW_EXCEPTION(
+            InvalidArgumentException( "Not a message trace:" + _traceFile, __CLASS_NAME__ ) );
+    }
+
+    return nlohmann::json::parse( line.substr( 2 ) ).at( "ni" ).get< uint64_t >();
+}
+
+
+void MessageReplayer::replay( const string& _traceFile ) {
+    ifstream file( _traceFile );
+
+    if ( !file.is_open() ) {
+        BOOST_THROW_EXCEPTION( InvalidArgumentException(
+            "Could not open message trace:" + _traceFile, __CLASS_NAME__ ) );
+    }
+
+    LOG( info, "Replaying message trace " << _traceFile );
+
+    auto startTimeUs = getCurrentTimeUs();
+
+    string line;
+
+    while ( getline( file, line ) ) {
+        if ( line.size() < 3 || line[1] != ' ' ) {
+            BOOST_THROW_EXCEPTION( InvalidArgumentException(
+                "Invalid trace record " + to_string( records + 1 ), __CLASS_NAME__ ) );
+        }
+
+        auto type = line[0];
+        auto json = line.substr( 2 );
+
+        // the recording node may have crashed in the middle of the last line
+        if ( file.eof() && json.back() != '}' ) {
+            LOG( warn, "Skipping truncated last trace record" );
+            break;
+        }
+
+        records++;
+
+        switch ( type ) {
+        case MessageTrace::HEADER:
+            processHeader( nlohmann::json::parse( json ) );
+            break;
+        case MessageTrace::PROPOSAL:
+            processProposal( nlohmann::json::parse( json ) );
+            break;
+        case MessageTrace::MESSAGE:
+            processMessage( json );
+            break;
+        case MessageTrace::COMMIT:
+            processCommit( nlohmann::json::parse( json ) );
+            break;
+        default:
+            BOOST_THROW_EXCEPTION( InvalidArgumentException(
+                "Unknown trace record type " + string( 1, type ), __CLASS_NAME__ ) );
+        }
+    }
+
+    replayTimeUs += getCurrentTimeUs() - startTimeUs;
+
+    LOG( info, "Replayed " << records << " trace records" );
+}
+
+
+void MessageReplayer::processHeader( const nlohmann::json& _header ) {
+    if ( _header.at( "ni" ).get< uint64_t >() != ( uint64_t ) sChain->getNode()->getNodeID() ||
+         _header.at( "si" ).get< uint64_t >() != ( uint64_t ) sChain->getSchainIndex() ||
+         _header.at( "nc" ).get< uint64_t >() != ( uint64_t ) sChain->getNodeCount() ) {
+        BOOST_THROW_EXCEPTION( InvalidArgumentException(
+            "The trace was recorded by a node with a different config", __CLASS_NAME__ ) );
+    }
+
+    TimeStamp stamp( _header.at( "s" ).get< uint64_t >(), _header.at( "ms" ).get< uint64_t >() );
+
+    sChain->initLastCommittedBlockInfo( _header.at( "bi" ).get< uint64_t >(), stamp );
+}
+
+
+void MessageReplayer::processProposal( const nlohmann::json& _record ) {
+    block_id blockID = _record.at( "bi" ).get< uint64_t >();
+
+    if ( blockID != sChain->getLastCommittedBlockID() + 1 )
+        return;
+
+    auto proposalVector = make_shared< BooleanProposalVector >(
+        sChain->getNodeCount(), _record.at( "cv" ).get< string >() );
+
+    auto message = make_shared< ConsensusProposalMessage >( *sChain, blockID, proposalVector );
+
+    proposals++;
+
+    sChain->getBlockConsensusInstance()->routeAndProcessMessage(
+        make_shared< InternalMessageEnvelope >( ORIGIN_EXTERNAL, message, *sChain ) );
+}
+
+
+void MessageReplayer::processMessage( const string& _json ) {
+    messages++;
+
+    try {
+        auto startTimeUs = getCurrentTimeUs();
+
+        auto message = NetworkMessage::parseMessage( _json, sChain );
+
+        auto parsedTimeUs = getCurrentTimeUs();
+        parseTimeUs += parsedTimeUs - startTimeUs;
+
+        message->verify( sChain->getCryptoManager() );
+
+        auto verifiedTimeUs = getCurrentTimeUs();
+        verifyTimeUs += verifiedTimeUs - parsedTimeUs;
+
+        // the recorded node had committed this block already, the replay did not
+        if ( message->getBlockID() > sChain->getLastCommittedBlockID() + 1 ) {
+            skippedMessages++;
+            return;
+        }
+
+        sChain->getBlockConsensusInstance()->routeAndProcessMessage(
+            make_shared< NetworkMessageEnvelope >( message, message->getSrcSchainIndex() ) );
+
+        processTimeUs += getCurrentTimeUs() - verifiedTimeUs;
+
+    } catch ( ExitRequestedException& ) {
+        throw;
+    } catch ( exception& e ) {
+        failedMessages++;
+        LOG( err, "Could not replay trace record " << records );
+        SkaleException::logNested( e );
+    }
+}
+
+
+void MessageReplayer::processCommit( const nlohmann::json& _record ) {
+    uint64_t blockID = _record.at( "bi" ).get< uint64_t >();
+    uint64_t proposer = _record.at( "cp" ).get< uint64_t >();
+
+    if ( blockID <= sChain->getLastCommittedBlockID() )
+        return;
+
+    commits++;
+
+    auto decision = decisions.find( blockID );
+
+    if ( decision == decisions.end() ) {
+        undecidedBlocks.push_back( blockID );
+    } else if ( decision->second != proposer ) {
+        mismatchedBlocks.push_back( blockID );
+    } else {
+        matchingDecisions++;
+    }
+
+    decisions.erase( decisions.begin(), decisions.upper_bound( blockID ) );
+
+    TimeStamp stamp( _record.at( "s" ).get< uint64_t >(), _record.at( "ms" ).get< uint64_t >() );
+
+    sChain->initLastCommittedBlockInfo( blockID, stamp );
+}
+
+
+void MessageReplayer::blockDecided(
+    block_id _blockID, schain_index _proposerIndex, const ptr< ThresholdSignature >& ) {
+    // a block can be finalized more than once until the replay reaches its commit
+    decisions.emplace( ( uint64_t ) _blockID, ( uint64_t ) _proposerIndex );
+}
+
+
+nlohmann::json MessageReplayer::getReport() {
+    nlohmann::json report = nlohmann::json::object();
+
+    report["records"] = records;
+    report["messages"] = messages;
+    report["proposals"] = proposals;
+    report["skippedMessages"] = skippedMessages;
+    report["failedMessages"] = failedMessages;
+    report["commits"] = commits;
+    report["matchingDecisions"] = matchingDecisions;
+    report["mismatchedBlocks"] = mismatchedBlocks;
+    report["undecidedBlocks"] = undecidedBlocks;
+
+    report["timeUs"]["parse"] = parseTimeUs;
+    report["timeUs"]["verify"] = verifyTimeUs;
+    report["timeUs"]["process"] = processTimeUs;
+    report["timeUs"]["total"] = replayTimeUs;
+
+    if ( replayTimeUs > 0 )
+        report["messagesPerS"] = messages * 1000000.0 / replayTimeUs;
+
+    auto network = dynamic_pointer_cast< ReplayNetwork >( sChain->getNode()->getNetwork() );
+    CHECK_STATE( network );
+    report["sentMessages"] = network->getDroppedMessages();
+
+    return report;
+}
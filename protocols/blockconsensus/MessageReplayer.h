@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file MessageReplayer.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include "thirdparty/json.hpp"
+
+class Schain;
+class ThresholdSignature;
+
+/*
+ * Replays a MessageTrace into the block consensus agent of a node as fast as possible, on the
+ * calling thread. The node must not be started. It gets a ReplayNetwork that drops the
+ * messages it sends, so no servers, sockets or SGX are needed, and test configs with mock
+ * signatures work.
+ *
+ * Decided and signed blocks are not finalized. The replayer records the decision and moves
+ * the chain to the next block when the trace shows the commit, with the recorded time stamp,
+ * so that the messages reach the agent in the same state as in the recorded run. The report
+ * compares the decisions with the recorded commits and times parsing, verification and
+ * processing of the messages.
+ *
+ * Traces recorded with the fast consensus patch active can not be replayed yet, since the
+ * optimized consensus reads the previous winners from committed blocks.
+ */
+class MessageReplayer {
+    Schain* const sChain;
+
+    uint64_t records = 0;
+
+    uint64_t messages = 0;
+
+    uint64_t proposals = 0;
+
+    // messages for blocks the replay has not reached
+    uint64_t skippedMessages = 0;
+
+    uint64_t failedMessages = 0;
+
+    uint64_t parseTimeUs = 0;
+
+    uint64_t verifyTimeUs = 0;
+
+    uint64_t processTimeUs = 0;
+
+    uint64_t commits = 0;
+
+    uint64_t replayTimeUs = 0;
+
+    uint64_t matchingDecisions = 0;
+
+    // blocks that were decided differently or not decided in the replay
+    vector< uint64_t > mismatchedBlocks;
+
+    vector< uint64_t > undecidedBlocks;
+
+    map< uint64_t, uint64_t > decisions;  // block id -> proposer index
+
+    static uint64_t getCurrentTimeUs();
+
+    void processHeader( const nlohmann::json& _header );
+
+    void processProposal( const nlohmann::json& _record );
+
+    void processMessage( const string& _json );
+
+    void processCommit( const nlohmann::json& _record );
+
+public:
+    explicit MessageReplayer( Schain& _sChain );
+
+    ~MessageReplayer();
+
+    // node id of the node that recorded the trace
+    static node_id readNodeID( const string& _traceFile );
+
+    void replay( const string& _traceFile );
+
+    // called by the schain instead of finalizing a block
+    void blockDecided( block_id _blockID, schain_index _proposerIndex,
+        const ptr< ThresholdSignature >& _thresholdSig );
+
+    nlohmann::json getReport();
+};
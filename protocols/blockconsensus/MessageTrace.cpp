@@ -0,0 +1,134 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file MessageTrace.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "thirdparty/json.hpp"
+#include "exceptions/FatalError.h"
+#include "datastructures/BooleanProposalVector.h"
+#include "datastructures/TimeStamp.h"
+#include "messages/ConsensusProposalMessage.h"
+#include "messages/MessageEnvelope.h"
+#include "messages/NetworkMessage.h"
+
+#include "MessageTrace.h"
+
+
+MessageTrace::MessageTrace( const string& _fileName ) : fileName( _fileName ) {
+    CHECK_ARGUMENT( !_fileName.empty() );
+}
+
+
+MessageTrace::~MessageTrace() {
+    lock_guard< mutex > guard( lock );
+    if ( file.is_open() )
+        file.close();
+}
+
+
+void MessageTrace::start( node_id _nodeID, schain_index _schainIndex, node_count _nodeCount,
+    block_id _lastCommittedBlockID, const TimeStamp& _lastCommittedBlockTimeStamp ) {
+    {
+        lock_guard< mutex > guard( lock );
+
+        CHECK_STATE( !file.is_open() );
+
+        file.open( fileName, ios::out | ios::trunc );
+
+        if ( !file.is_open() ) {
+            BOOST_THROW_EXCEPTION( FatalError( "Could not open message trace:" + fileName ) );
+        }
+    }
+
+    nlohmann::json header = nlohmann::json::object();
+    header["ni"] = ( uint64_t ) _nodeID;
+    header["si"] = ( uint64_t ) _schainIndex;
+    header["nc"] = ( uint64_t ) _nodeCount;
+    header["bi"] = ( uint64_t ) _lastCommittedBlockID;
+    header["s"] = _lastCommittedBlockTimeStamp.getS();
+    header["ms"] = _lastCommittedBlockTimeStamp.getMs();
+
+    writeLine( HEADER, header.dump() );
+
+    started = true;
+
+    LOG( info, "Recording consensus messages to " << fileName );
+}
+
+
+void MessageTrace::recordMessage( const ptr< MessageEnvelope >& _me ) {
+    CHECK_ARGUMENT( _me );
+
+    if ( !started )
+        return;
+
+    auto message = _me->getMessage();
+
+    if ( message->getMsgType() == MSG_CONSENSUS_PROPOSAL ) {
+        auto proposal = dynamic_pointer_cast< ConsensusProposalMessage >( message );
+        CHECK_STATE( proposal );
+        nlohmann::json record = nlohmann::json::object();
+        record["bi"] = ( uint64_t ) proposal->getBlockId();
+        record["cv"] = proposal->getProposals()->toString();
+        writeLine( PROPOSAL, record.dump() );
+        return;
+    }
+
+    if ( _me->getOrigin() != ORIGIN_NETWORK )
+        return;
+
+    auto networkMessage = dynamic_pointer_cast< NetworkMessage >( message );
+
+    if ( networkMessage )
+        writeLine( MESSAGE, networkMessage->serializeToString() );
+}
+
+
+void MessageTrace::recordCommit(
+    block_id _blockID, schain_index _proposerIndex, const TimeStamp& _stamp ) {
+    if ( !started )
+        return;
+
+    nlohmann::json record = nlohmann::json::object();
+    record["bi"] = ( uint64_t ) _blockID;
+    record["cp"] = ( uint64_t ) _proposerIndex;
+    record["s"] = _stamp.getS();
+    record["ms"] = _stamp.getMs();
+
+    writeLine( COMMIT, record.dump() );
+
+    // flushed once per block, a crash loses at most the block in progress
+    lock_guard< mutex > guard( lock );
+    file.flush();
+}
+
+
+void MessageTrace::writeLine( char _type, const string& _json ) {
+    lock_guard< mutex > guard( lock );
+    file << _type << ' ' << _json << '\n';
+}
+
+
+const string& MessageTrace::getFileName() const {
+    return fileName;
+}
@@ -0,0 +1,78 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file MessageTrace.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <fstream>
+
+class MessageEnvelope;
+class TimeStamp;
+
+/*
+ * Records the messages processed by the block consensus agent of a node, in the order they
+ * were processed, so that MessageReplayer can feed them to the agent again.
+ *
+ * The trace is a text file with one record per line, a type letter followed by json:
+ *
+ *   H {"ni":1,"si":1,"nc":4,"bi":0,"s":0,"ms":0}  node, schain index, node count and the
+ *                                                   last committed block at bootstrap
+ *   P {"bi":5,"cv":"1101"}                          consensus started with a proposal vector
+ *   M {"type":"BVB",...}                            a network message in its wire format
+ *   C {"bi":5,"cp":2,"s":1650000000,"ms":120}       block committed, proposer and time stamp
+ *
+ * Messages that are processed before bootstrap are not recorded.
+ */
+class MessageTrace {
+public:
+    static constexpr char HEADER = 'H';
+    static constexpr char PROPOSAL = 'P';
+    static constexpr char MESSAGE = 'M';
+    static constexpr char COMMIT = 'C';
+
+private:
+    const string fileName;
+
+    atomic< bool > started = false;
+
+    mutex lock;
+
+    ofstream file;  // protected by lock
+
+    void writeLine( char _type, const string& _json );
+
+public:
+    explicit MessageTrace( const string& _fileName );
+
+    ~MessageTrace();
+
+    // opens the file and writes the header. Nothing is recorded before this call
+    void start( node_id _nodeID, schain_index _schainIndex, node_count _nodeCount,
+        block_id _lastCommittedBlockID, const TimeStamp& _lastCommittedBlockTimeStamp );
+
+    // records a consensus proposal or a network message going to the block consensus agent
+    void recordMessage( const ptr< MessageEnvelope >& _me );
+
+    void recordCommit( block_id _blockID, schain_index _proposerIndex, const TimeStamp& _stamp );
+
+    const string& getFileName() const;
+};
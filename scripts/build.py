@@ -70,6 +70,7 @@ os.chdir("..")
 
 assert  os.path.isfile("build/consensust")
 assert  os.path.isfile("build/consensusd")
+assert  os.path.isfile("build/consensusb")
 
 print("Build successfull.")
 
@@ -3,6 +3,9 @@
 //
 
 #include "StatusServer.h"
+#include "crypto/CryptoManager.h"
+#include "pendingqueue/AdaptiveBlockAssembler.h"
+#include "pendingqueue/PendingTransactionsAgent.h"
 
 
 /*************************************************************************
@@ -40,4 +43,15 @@ string StatusServer::consensus_getBlockSizeAverage() {
 string StatusServer::consensus_getBlockTimeAverageMs() {
     CHECK_STATE( sChain );
     return to_string( sChain->getBlockTimeAverageMs() );
-};
\ No newline at end of file
+};
+string StatusServer::consensus_getBlockAssembly() {
+    CHECK_STATE( sChain );
+    auto blockAssembler = sChain->getPendingTransactionsAgent()->getBlockAssembler();
+    if ( !blockAssembler )
+        return "{\"enabled\":false}";
+    return blockAssembler->getStatus().dump();
+};
+string StatusServer::consensus_getSessionKeys() {
+    CHECK_STATE( sChain );
+    return sChain->getCryptoManager()->getSessionKeyStatus().dump();
+};
@@ -23,6 +23,8 @@ public:
     virtual string consensus_getTPSAverage();
     virtual string consensus_getBlockSizeAverage();
     virtual string consensus_getBlockTimeAverageMs();
+    virtual string consensus_getBlockAssembly();
+    virtual string consensus_getSessionKeys();
 };
 
 
@@ -21,6 +21,12 @@ public:
         this->bindAndAddMethod( jsonrpc::Procedure( "consensus_getBlockTimeAverageMs",
                                     jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_STRING, NULL ),
             &AbstractStatusServer::consensus_getBlockTimeAverageMsI );
+        this->bindAndAddMethod( jsonrpc::Procedure( "consensus_getBlockAssembly",
+                                    jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_STRING, NULL ),
+            &AbstractStatusServer::consensus_getBlockAssemblyI );
+        this->bindAndAddMethod( jsonrpc::Procedure( "consensus_getSessionKeys",
+                                    jsonrpc::PARAMS_BY_NAME, jsonrpc::JSON_STRING, NULL ),
+            &AbstractStatusServer::consensus_getSessionKeysI );
     }
 
     inline virtual void consensus_getTPSAverageI(
@@ -38,9 +44,21 @@ public:
         ( void ) request;
         response = this->consensus_getBlockTimeAverageMs();
     }
+    inline virtual void consensus_getBlockAssemblyI(
+        const Json::Value& request, Json::Value& response ) {
+        ( void ) request;
+        response = this->consensus_getBlockAssembly();
+    }
+    inline virtual void consensus_getSessionKeysI(
+        const Json::Value& request, Json::Value& response ) {
+        ( void ) request;
+        response = this->consensus_getSessionKeys();
+    }
     virtual std::string consensus_getTPSAverage() = 0;
     virtual std::string consensus_getBlockSizeAverage() = 0;
     virtual std::string consensus_getBlockTimeAverageMs() = 0;
+    virtual std::string consensus_getBlockAssembly() = 0;
+    virtual std::string consensus_getSessionKeys() = 0;
 };
 
 #endif  // JSONRPC_CPP_STUB_ABSTRACTSTATUSSERVER_H_
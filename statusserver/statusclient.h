@@ -43,6 +43,26 @@ public:
             throw jsonrpc::JsonRpcException(
                 jsonrpc::Errors::ERROR_CLIENT_INVALID_RESPONSE, result.toStyledString() );
     }
+    std::string consensus_getBlockAssembly() throw( jsonrpc::JsonRpcException ) {
+        Json::Value p;
+        p = Json::nullValue;
+        Json::Value result = this->CallMethod( "consensus_getBlockAssembly", p );
+        if ( result.isString() )
+            return result.asString();
+        else
+            throw jsonrpc::JsonRpcException(
+                jsonrpc::Errors::ERROR_CLIENT_INVALID_RESPONSE, result.toStyledString() );
+    }
+    std::string consensus_getSessionKeys() throw( jsonrpc::JsonRpcException ) {
+        Json::Value p;
+        p = Json::nullValue;
+        Json::Value result = this->CallMethod( "consensus_getSessionKeys", p );
+        if ( result.isString() )
+            return result.asString();
+        else
+            throw jsonrpc::JsonRpcException(
+                jsonrpc::Errors::ERROR_CLIENT_INVALID_RESPONSE, result.toStyledString() );
+    }
 };
 
 #endif  // JSONRPC_CPP_STUB_STATUSCLIENT_H_
@@ -0,0 +1,164 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockingIOPool.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+
+#include "BlockingIOPool.h"
+#include "GlobalThreadRegistry.h"
+
+
+BlockingIOPool::BlockingIOPool( const string& _name, uint64_t _idleTimeoutMs )
+    : ExecutorPool( _name ), idleTimeoutMs( _idleTimeoutMs ) {}
+
+
+BlockingIOPool::~BlockingIOPool() {
+    shutdown();
+}
+
+
+mutex BlockingIOPool::sharedLock;
+
+atomic< BlockingIOPool* > BlockingIOPool::shared = nullptr;
+
+
+BlockingIOPool& BlockingIOPool::getShared() {
+    auto pool = shared.load();
+    if ( pool )
+        return *pool;
+
+    lock_guard< mutex > lock( sharedLock );
+    if ( !shared )
+        shared = new BlockingIOPool( "IO" );
+    return *shared;
+}
+
+
+BlockingIOPool* BlockingIOPool::getSharedIfCreated() {
+    return shared;
+}
+
+
+void BlockingIOPool::shutdownShared() {
+    lock_guard< mutex > lock( sharedLock );
+    auto pool = shared.exchange( nullptr );
+    // not deleted, since executors of exited agents may still refer to it
+    if ( pool )
+        pool->shutdown();
+}
+
+
+void BlockingIOPool::execute( function< void() >&& _func ) {
+    auto task = createTask( std::move( _func ) );
+
+    bool threadAdded = false;
+
+    {
+        lock_guard< mutex > lock( queueLock );
+
+        // checked under the lock, so that no task is queued after the threads exited
+        checkForExit();
+
+        tasks.push( std::move( task ) );
+
+        if ( tasks.size() > idleThreads && threadCount < MAX_THREADS ) {
+            threadCount++;
+            threadRegistry->add( make_shared< thread >( &BlockingIOPool::workerLoop, this ) );
+            threadAdded = true;
+        } else {
+            queueCond.notify_one();
+        }
+    }
+
+    if ( threadAdded )
+        joinExitedThreads();
+}
+
+
+void BlockingIOPool::joinExitedThreads() {
+    vector< thread::id > exited;
+
+    {
+        lock_guard< mutex > lock( queueLock );
+        exited.swap( exitedThreads );
+    }
+
+    // the threads have left the worker loop, so the joins do not wait
+    for ( auto&& id : exited ) {
+        auto t = threadRegistry->remove( id );
+        if ( t )
+            t->join();
+    }
+}
+
+
+void BlockingIOPool::wakeAll() {
+    lock_guard< mutex > lock( queueLock );
+    queueCond.notify_all();
+}
+
+
+void BlockingIOPool::workerLoop() {
+    uint64_t threadNumber;
+
+    {
+        lock_guard< mutex > lock( queueLock );
+        threadNumber = threadsStarted++;
+    }
+
+    auto threadName = name + to_string( threadNumber );
+    pthread_setname_np( pthread_self(), threadName.substr( 0, 15 ).c_str() );
+
+    unique_lock< mutex > lock( queueLock );
+
+    while ( true ) {
+        if ( tasks.empty() ) {
+            // the queued tasks are run before the thread exits
+            if ( exitRequested ) {
+                threadCount--;
+                return;
+            }
+
+            idleThreads++;
+            queueCond.wait_for( lock, chrono::milliseconds( idleTimeoutMs ),
+                [this]() { return !tasks.empty() || exitRequested; } );
+            idleThreads--;
+
+            if ( tasks.empty() ) {
+                threadCount--;
+                if ( !exitRequested )
+                    exitedThreads.push_back( this_thread::get_id() );
+                return;
+            }
+        }
+
+        auto task = std::move( tasks.front() );
+        tasks.pop();
+
+        lock.unlock();
+        run( task );
+        lock.lock();
+    }
+}
@@ -0,0 +1,81 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file BlockingIOPool.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+#include "ExecutorPool.h"
+
+/*
+ * Pool for tasks that block on network, disk or SGX calls.
+ * A thread is added when a task is queued and no thread is idle, up to MAX_THREADS.
+ * Threads that stay idle for the idle timeout exit, and are joined when the next thread
+ * is added.
+ */
+class BlockingIOPool : public ExecutorPool {
+    static constexpr uint64_t MAX_THREADS = 1024;
+
+    static constexpr uint64_t IDLE_TIMEOUT_MS = 60000;
+
+    const uint64_t idleTimeoutMs;
+
+    mutex queueLock;
+
+    condition_variable queueCond;
+
+    // the fields below are protected by queueLock
+
+    queue< Task > tasks;
+
+    uint64_t idleThreads = 0;
+
+    uint64_t threadsStarted = 0;
+
+    // threads that exited after the idle timeout and have not been joined yet
+    vector< thread::id > exitedThreads;
+
+    static mutex sharedLock;
+
+    static atomic< BlockingIOPool* > shared;
+
+    void workerLoop();
+
+    void joinExitedThreads();
+
+    void wakeAll() override;
+
+public:
+    explicit BlockingIOPool( const string& _name, uint64_t _idleTimeoutMs = IDLE_TIMEOUT_MS );
+
+    ~BlockingIOPool() override;
+
+    void execute( function< void() >&& _func ) override;
+
+    // created on first use, lives until shutdownShared()
+    static BlockingIOPool& getShared();
+
+    // nullptr if the shared pool has not been created yet
+    static BlockingIOPool* getSharedIfCreated();
+
+    static void shutdownShared();
+};
@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ExecutorPool.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/ExitRequestedException.h"
+#include "exceptions/FatalError.h"
+
+#include "BlockingIOPool.h"
+#include "GlobalThreadRegistry.h"
+#include "WorkStealingPool.h"
+
+#include "ExecutorPool.h"
+
+
+ExecutorPool::ExecutorPool( const string& _name )
+    : name( _name ), threadRegistry( make_shared< GlobalThreadRegistry >() ) {
+    lastReportTimeUs = getCurrentTimeUs();
+}
+
+
+uint64_t ExecutorPool::getCurrentTimeUs() {
+    return chrono::duration_cast< chrono::microseconds >(
+        chrono::steady_clock::now().time_since_epoch() )
+        .count();
+}
+
+
+ExecutorPool::Task ExecutorPool::createTask( function< void() >&& _func ) {
+    Task task;
+    task.func = std::move( _func );
+    task.queuedTimeUs = getCurrentTimeUs();
+    return task;
+}
+
+
+void ExecutorPool::run( Task& _task ) {
+    auto startTimeUs = getCurrentTimeUs();
+
+    totalQueueLatencyUs += startTimeUs - _task.queuedTimeUs;
+
+    // tasks deliver their exceptions through futures, anything else is a bug in the task
+    try {
+        _task.func();
+    } catch ( exception& e ) {
+        SkaleException::logNested( e );
+    } catch ( ... ) {
+        LOG( err, name << ": unknown exception in task" );
+    }
+
+    totalBusyUs += getCurrentTimeUs() - startTimeUs;
+    tasksRun++;
+}
+
+
+uint64_t ExecutorPool::getThreadCount() const {
+    return threadCount;
+}
+
+
+bool ExecutorPool::isExitRequested() const {
+    return exitRequested;
+}
+
+
+void ExecutorPool::checkForExit() {
+    if ( exitRequested )
+        BOOST_THROW_EXCEPTION( ExitRequestedException( __CLASS_NAME__ ) );
+}
+
+
+void ExecutorPool::shutdown() {
+    exitRequested = true;
+    wakeAll();
+    threadRegistry->joinAll();
+}
+
+
+void ExecutorPool::shutdownShared() {
+    // IO tasks may still submit CPU tasks while they finish
+    BlockingIOPool::shutdownShared();
+    WorkStealingPool::shutdownShared();
+}
+
+
+string ExecutorPool::getStats() {
+    lock_guard< mutex > lock( statsLock );
+
+    auto now = getCurrentTimeUs();
+    uint64_t runs = tasksRun;
+    uint64_t latencyUs = totalQueueLatencyUs;
+    uint64_t busyUs = totalBusyUs;
+    uint64_t threads = threadCount;
+
+    auto elapsedUs = max< uint64_t >( now - lastReportTimeUs, 1 );
+    auto newRuns = runs - lastTasksRun;
+
+    auto utilization = threads == 0 ? 0 : ( busyUs - lastBusyUs ) * 100 / ( elapsedUs * threads );
+    auto averageLatencyMs = newRuns == 0 ? 0 : ( latencyUs - lastQueueLatencyUs ) / newRuns / 1000;
+
+    lastReportTimeUs = now;
+    lastTasksRun = runs;
+    lastQueueLatencyUs = latencyUs;
+    lastBusyUs = busyUs;
+
+    return name + "/" + to_string( threads ) + "/" + to_string( utilization ) + "/" +
+           to_string( averageLatencyMs );
+}
+
+
+string ExecutorPool::getAllStats() {
+    // stats must not start the pools, so a pool that was not created reports no threads
+    auto cpuPool = WorkStealingPool::getSharedIfCreated();
+    auto ioPool = BlockingIOPool::getSharedIfCreated();
+    return ( cpuPool ? cpuPool->getStats() : string( "CPU/0/0/0" ) ) + "," +
+           ( ioPool ? ioPool->getStats() : string( "IO/0/0/0" ) );
+}
@@ -0,0 +1,107 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file ExecutorPool.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+#include <functional>
+
+class GlobalThreadRegistry;
+
+/*
+ * Process wide pool of threads that runs tasks submitted by all engines and chains.
+ * Tasks do not own threads, so agents that submit short tasks do not need dedicated threads.
+ *
+ * The threads of a pool are kept in its thread registry. On exit the pool runs the tasks that
+ * are already queued, refuses new ones and joins its threads.
+ */
+class ExecutorPool {
+protected:
+    class Task {
+    public:
+        function< void() > func;
+
+        uint64_t queuedTimeUs = 0;
+    };
+
+    string name;
+
+    atomic< uint64_t > threadCount = 0;
+
+    atomic< bool > exitRequested = false;
+
+    const ptr< GlobalThreadRegistry > threadRegistry;
+
+    atomic< uint64_t > tasksRun = 0;
+
+    atomic< uint64_t > totalQueueLatencyUs = 0;
+
+    atomic< uint64_t > totalBusyUs = 0;
+
+    mutex statsLock;
+
+    uint64_t lastReportTimeUs = 0;
+
+    uint64_t lastTasksRun = 0;
+
+    uint64_t lastQueueLatencyUs = 0;
+
+    uint64_t lastBusyUs = 0;
+
+    static uint64_t getCurrentTimeUs();
+
+    static Task createTask( function< void() >&& _func );
+
+    // runs a task, catches exceptions and accounts queue latency and busy time
+    void run( Task& _task );
+
+    // throws ExitRequestedException if the pool is exiting
+    void checkForExit();
+
+    // wakes up all threads, so that idle threads see that the pool is exiting
+    virtual void wakeAll() = 0;
+
+    explicit ExecutorPool( const string& _name );
+
+public:
+    virtual ~ExecutorPool() = default;
+
+    virtual void execute( function< void() >&& _func ) = 0;
+
+    uint64_t getThreadCount() const;
+
+    // long running tasks return early once this is set
+    bool isExitRequested() const;
+
+    // runs the queued tasks and joins the threads. execute() throws afterwards
+    void shutdown();
+
+    // shuts down the shared pools when the engine exits, getShared() creates new ones
+    static void shutdownShared();
+
+    // threads, utilization % and average queue latency ms since the previous call
+    string getStats();
+
+    // stats of all shared pools
+    static string getAllStats();
+};
@@ -50,3 +50,17 @@ void GlobalThreadRegistry::add( const ptr< thread >& _t ) {
     LOCK( allThreadsLock )
     allThreads.push_back( _t );
 }
+
+ptr< thread > GlobalThreadRegistry::remove( thread::id _id ) {
+    LOCK( allThreadsLock )
+
+    for ( auto it = allThreads.begin(); it != allThreads.end(); it++ ) {
+        if ( ( *it )->get_id() == _id ) {
+            auto result = *it;
+            allThreads.erase( it );
+            return result;
+        }
+    }
+
+    return nullptr;
+}
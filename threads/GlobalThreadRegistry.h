@@ -36,6 +36,10 @@ public:
     void joinAll();
 
     void add( const ptr< thread >& _t );
+
+    // removes a thread that is about to exit, so that the caller can join it.
+    // Returns nullptr if it is not registered
+    ptr< thread > remove( thread::id _id );
 };
 
 
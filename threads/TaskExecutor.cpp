@@ -0,0 +1,94 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TaskExecutor.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+#include "node/ConsensusEngine.h"
+
+#include "ExecutorPool.h"
+#include "TaskExecutor.h"
+
+
+TaskExecutor::TaskExecutor( const string& _name, ExecutorPool& _pool )
+    : name( _name ), pool( _pool ) {}
+
+
+TaskExecutor::~TaskExecutor() {
+    unique_lock< mutex > lock( inFlightLock );
+    if ( inFlight > 0 ) {
+        LOG( debug, name << ": waiting for " << inFlight << " tasks to finish" );
+    }
+    while ( inFlight > 0 ) {
+        inFlightCond.wait_for( lock, chrono::milliseconds( 1000 ) );
+    }
+}
+
+
+void TaskExecutor::push( function< void() >&& _task ) {
+    {
+        lock_guard< mutex > lock( inFlightLock );
+        inFlight++;
+    }
+
+    auto log = logThreadLocal_;
+
+    try {
+        pool.execute( [this, log, task = std::move( _task )]() {
+            // pool threads are shared by all nodes of the process
+            logThreadLocal_ = log;
+            try {
+                task();
+            } catch ( ... ) {
+                logThreadLocal_ = nullptr;
+                taskFinished();
+                throw;
+            }
+            logThreadLocal_ = nullptr;
+            taskFinished();
+        } );
+    } catch ( ... ) {
+        // the task never runs
+        taskFinished();
+        throw;
+    }
+}
+
+
+void TaskExecutor::taskFinished() {
+    lock_guard< mutex > lock( inFlightLock );
+    inFlight--;
+    inFlightCond.notify_all();
+}
+
+
+uint64_t TaskExecutor::getInFlightCount() {
+    lock_guard< mutex > lock( inFlightLock );
+    return inFlight;
+}
+
+
+bool TaskExecutor::isExitRequested() {
+    return pool.isExitRequested();
+}
@@ -0,0 +1,71 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TaskExecutor.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+#include <functional>
+#include <future>
+
+class ExecutorPool;
+
+/*
+ * Submits the tasks of one agent to a shared ExecutorPool, and returns their results as futures.
+ * Tasks run with the log of the node that submitted them. The destructor waits for the
+ * tasks that are still running, since they may use the agent.
+ */
+class TaskExecutor {
+    string name;
+
+    ExecutorPool& pool;
+
+    mutex inFlightLock;
+
+    condition_variable inFlightCond;
+
+    uint64_t inFlight = 0;  // protected by inFlightLock
+
+    void push( function< void() >&& _task );
+
+    void taskFinished();
+
+public:
+    TaskExecutor( const string& _name, ExecutorPool& _pool );
+
+    ~TaskExecutor();
+
+    template < typename F >
+    auto submit( F&& _f ) -> future< decltype( _f() ) > {
+        using R = decltype( _f() );
+        auto task = make_shared< packaged_task< R() > >( std::forward< F >( _f ) );
+        auto result = task->get_future();
+        push( [task]() { ( *task )(); } );
+        return result;
+    }
+
+    // tasks submitted and not yet finished
+    uint64_t getInFlightCount();
+
+    // set when the pool exits, long running tasks return early
+    bool isExitRequested();
+};
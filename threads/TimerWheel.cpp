@@ -0,0 +1,295 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TimerWheel.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+#include "node/ConsensusEngine.h"
+#include "utils/Time.h"
+
+#include "TimerWheel.h"
+
+
+thread_local bool TimerWheel::isWheelThread = false;
+
+
+TimerWheel::TimerWheel() {
+    currentMs = Time::getCurrentTimeMs();
+    plannedWakeMs = UINT64_MAX;
+    thread( &TimerWheel::wheelLoop, this ).detach();
+}
+
+
+TimerWheel& TimerWheel::getShared() {
+    // never destroyed, since its thread runs until the process exits
+    static auto wheel = new TimerWheel();
+    return *wheel;
+}
+
+
+list< TimerWheel::Timer >& TimerWheel::getList( uint64_t _level, uint64_t _slot ) {
+    if ( _level == OVERFLOW_LEVEL )
+        return overflowTimers;
+    return slots.at( _level ).at( _slot );
+}
+
+
+void TimerWheel::place( list< Timer >& _from, list< Timer >::iterator _it ) {
+    auto deadline = max( _it->deadlineMs, currentMs );
+
+    Location location;
+    location.level = OVERFLOW_LEVEL;
+
+    // the lowest level at which the deadline and the current time are in the same parent slot
+    for ( uint64_t level = 0; level < LEVELS; level++ ) {
+        auto parentShift = SLOT_BITS * ( level + 1 );
+        if ( ( deadline >> parentShift ) == ( currentMs >> parentShift ) ) {
+            location.level = level;
+            location.slot = ( deadline >> ( SLOT_BITS * level ) ) & ( SLOTS - 1 );
+            occupied.at( level ) |= 1ULL << location.slot;
+            break;
+        }
+    }
+
+    auto& to = getList( location.level, location.slot );
+
+    // splicing keeps the iterator valid
+    to.splice( to.end(), _from, _it );
+    location.it = _it;
+
+    locations[_it->id] = location;
+}
+
+
+void TimerWheel::remove( const Location& _location ) {
+    auto& from = getList( _location.level, _location.slot );
+    from.erase( _location.it );
+
+    if ( _location.level != OVERFLOW_LEVEL && from.empty() )
+        occupied.at( _location.level ) &= ~( 1ULL << _location.slot );
+}
+
+
+uint64_t TimerWheel::getNextEventMs() {
+    uint64_t result = UINT64_MAX;
+
+    for ( uint64_t level = 0; level < LEVELS; level++ ) {
+        auto shift = SLOT_BITS * level;
+        auto current = ( currentMs >> shift ) & ( SLOTS - 1 );
+        auto pending = occupied.at( level ) & ( ~0ULL << current );
+
+        if ( pending == 0 )
+            continue;
+
+        auto slot = ( uint64_t ) __builtin_ctzll( pending );
+        auto parentShift = shift + SLOT_BITS;
+        auto tick = ( ( currentMs >> parentShift ) << parentShift ) + ( slot << shift );
+
+        result = min( result, max( tick, currentMs ) );
+    }
+
+    if ( !overflowTimers.empty() ) {
+        auto topShift = SLOT_BITS * LEVELS;
+        result = min( result, ( ( currentMs >> topShift ) + 1 ) << topShift );
+    }
+
+    return result;
+}
+
+
+void TimerWheel::processTick( uint64_t _tick, list< Timer >& _expired ) {
+    CHECK_STATE( _tick >= currentMs );
+
+    currentMs = _tick;
+
+    // move the timers of the slots that start at this tick to lower levels, top level first
+    if ( ( _tick & ( ( 1ULL << ( SLOT_BITS * LEVELS ) ) - 1 ) ) == 0 ) {
+        list< Timer > moved;
+        moved.splice( moved.end(), overflowTimers );
+        while ( !moved.empty() )
+            place( moved, moved.begin() );
+    }
+
+    for ( uint64_t level = LEVELS - 1; level > 0; level-- ) {
+        auto shift = SLOT_BITS * level;
+
+        if ( ( _tick & ( ( 1ULL << shift ) - 1 ) ) != 0 )
+            continue;
+
+        auto slot = ( _tick >> shift ) & ( SLOTS - 1 );
+
+        if ( ( occupied.at( level ) & ( 1ULL << slot ) ) == 0 )
+            continue;
+
+        list< Timer > moved;
+        moved.splice( moved.end(), slots.at( level ).at( slot ) );
+        occupied.at( level ) &= ~( 1ULL << slot );
+
+        while ( !moved.empty() )
+            place( moved, moved.begin() );
+    }
+
+    auto slot = _tick & ( SLOTS - 1 );
+    auto& due = slots.at( 0 ).at( slot );
+
+    for ( auto&& timer : due ) {
+        locations.erase( timer.id );
+        firingTimers.insert( timer.id );
+    }
+
+    _expired.splice( _expired.end(), due );
+    occupied.at( 0 ) &= ~( 1ULL << slot );
+
+    currentMs = _tick + 1;
+}
+
+
+void TimerWheel::wheelLoop() {
+    isWheelThread = true;
+    pthread_setname_np( pthread_self(), "TimerWheel" );
+
+    while ( true ) {
+        list< Timer > expired;
+
+        {
+            unique_lock< mutex > l( lock );
+
+            auto now = Time::getCurrentTimeMs();
+
+            uint64_t next;
+
+            while ( ( next = getNextEventMs() ) <= now ) {
+                processTick( next, expired );
+            }
+
+            // nothing is due until next, so the ticks in between do not need to be processed
+            currentMs = max( currentMs, now );
+
+            if ( expired.empty() ) {
+                plannedWakeMs = next;
+                if ( next == UINT64_MAX ) {
+                    wakeCond.wait( l );
+                } else {
+                    wakeCond.wait_for( l, chrono::milliseconds( next - now ) );
+                }
+                plannedWakeMs = UINT64_MAX;
+                continue;
+            }
+        }
+
+        for ( auto&& timer : expired ) {
+            {
+                lock_guard< mutex > l( lock );
+                // cancelled after it expired
+                if ( firingTimers.count( timer.id ) == 0 )
+                    continue;
+                runningTimerId = timer.id;
+            }
+
+            logThreadLocal_ = timer.log;
+
+            try {
+                timer.callback();
+            } catch ( exception& e ) {
+                SkaleException::logNested( e );
+            } catch ( ... ) {
+                LOG( err, "Timer callback threw an unknown exception" );
+            }
+
+            logThreadLocal_ = nullptr;
+
+            {
+                lock_guard< mutex > l( lock );
+                runningTimerId = 0;
+                firingTimers.erase( timer.id );
+            }
+            callbackCond.notify_all();
+        }
+    }
+}
+
+
+uint64_t TimerWheel::schedule( uint64_t _deadlineMs, function< void() >&& _callback ) {
+    CHECK_ARGUMENT( _callback );
+
+    bool wakeUp;
+    uint64_t id;
+
+    {
+        lock_guard< mutex > l( lock );
+
+        id = nextTimerId++;
+
+        list< Timer > added;
+        added.emplace_back();
+        added.back().id = id;
+        added.back().deadlineMs = _deadlineMs;
+        added.back().callback = std::move( _callback );
+        added.back().log = logThreadLocal_;
+
+        place( added, added.begin() );
+
+        // the wheel thread only needs to wake up if the timer is due before it planned to
+        wakeUp = _deadlineMs < plannedWakeMs;
+    }
+
+    if ( wakeUp )
+        wakeCond.notify_one();
+
+    return id;
+}
+
+
+bool TimerWheel::cancel( uint64_t _timerId ) {
+    unique_lock< mutex > l( lock );
+
+    auto it = locations.find( _timerId );
+
+    if ( it != locations.end() ) {
+        remove( it->second );
+        locations.erase( it );
+        return true;
+    }
+
+    if ( firingTimers.count( _timerId ) == 0 )
+        return false;
+
+    if ( runningTimerId != _timerId ) {
+        // expired, but the callback has not started yet
+        firingTimers.erase( _timerId );
+        return true;
+    }
+
+    // a callback may cancel its own timer
+    if ( !isWheelThread ) {
+        callbackCond.wait( l, [this, _timerId]() { return runningTimerId != _timerId; } );
+    }
+
+    return false;
+}
+
+
+uint64_t TimerWheel::getPendingCount() {
+    lock_guard< mutex > l( lock );
+    return locations.size();
+}
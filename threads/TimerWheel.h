@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file TimerWheel.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+#pragma once
+
+#include <functional>
+
+class SkaleLog;
+
+/*
+ * Process wide hierarchical timer wheel with millisecond ticks. Each level has 64 slots,
+ * and a slot of level l covers 64^l ms, so that scheduling and cancelling a timer take
+ * constant time. Timers further away than the top level are kept in an overflow list.
+ *
+ * A single thread sleeps until the next occupied slot is due, so there are no wakeups
+ * while nothing is scheduled. Callbacks run on this thread with the log of the node that
+ * scheduled them, and must not block: long reactions should wake up an agent thread or
+ * be submitted to an executor.
+ */
+class TimerWheel {
+    static constexpr uint64_t LEVELS = 4;
+
+    static constexpr uint64_t SLOT_BITS = 6;
+
+    static constexpr uint64_t SLOTS = 1 << SLOT_BITS;
+
+    static constexpr uint64_t OVERFLOW_LEVEL = LEVELS;
+
+    class Timer {
+    public:
+        uint64_t id = 0;
+
+        uint64_t deadlineMs = 0;
+
+        function< void() > callback;
+
+        ptr< SkaleLog > log;
+    };
+
+    class Location {
+    public:
+        uint64_t level = 0;
+
+        uint64_t slot = 0;
+
+        list< Timer >::iterator it;
+    };
+
+    mutex lock;
+
+    condition_variable wakeCond;
+
+    // signalled when a callback finishes, so that cancel() can wait for a running callback
+    condition_variable callbackCond;
+
+    // the fields below are protected by lock
+
+    array< array< list< Timer >, SLOTS >, LEVELS > slots;
+
+    array< uint64_t, LEVELS > occupied{};  // bit s is set if slot s of the level is not empty
+
+    list< Timer > overflowTimers;
+
+    unordered_map< uint64_t, Location > locations;
+
+    // the first tick that has not been processed yet
+    uint64_t currentMs = 0;
+
+    // the time the wheel thread is going to wake up at
+    uint64_t plannedWakeMs = 0;
+
+    uint64_t nextTimerId = 1;
+
+    // expired timers whose callbacks have not finished yet
+    unordered_set< uint64_t > firingTimers;
+
+    uint64_t runningTimerId = 0;
+
+    static thread_local bool isWheelThread;
+
+    void place( list< Timer >& _from, list< Timer >::iterator _it );
+
+    list< Timer >& getList( uint64_t _level, uint64_t _slot );
+
+    void remove( const Location& _location );
+
+    // the earliest tick at which a timer expires or has to be moved to a lower level
+    uint64_t getNextEventMs();
+
+    void processTick( uint64_t _tick, list< Timer >& _expired );
+
+    void wheelLoop();
+
+    TimerWheel();
+
+public:
+    // created on first use, lives until the process exits
+    static TimerWheel& getShared();
+
+    // returns the timer id. Deadlines in the past expire immediately
+    uint64_t schedule( uint64_t _deadlineMs, function< void() >&& _callback );
+
+    // returns false if the callback of the timer has already run or is running. If it is
+    // running on another thread, waits until it finishes, so that the callback does not
+    // outlive its captures
+    bool cancel( uint64_t _timerId );
+
+    uint64_t getPendingCount();
+};
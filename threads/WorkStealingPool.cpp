@@ -0,0 +1,204 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file WorkStealingPool.cpp
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#include <sched.h>
+
+#include "SkaleCommon.h"
+#include "Log.h"
+#include "exceptions/FatalError.h"
+
+#include "GlobalThreadRegistry.h"
+#include "WorkStealingPool.h"
+
+
+thread_local WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+
+thread_local uint64_t WorkStealingPool::currentWorker = 0;
+
+
+WorkStealingPool::WorkStealingPool( const string& _name, uint64_t _threadCount )
+    : ExecutorPool( _name ) {
+    vector< int > cpus;
+
+    cpu_set_t allowed;
+    CPU_ZERO( &allowed );
+
+    if ( sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0 ) {
+        for ( int cpu = 0; cpu < CPU_SETSIZE; cpu++ ) {
+            if ( CPU_ISSET( cpu, &allowed ) )
+                cpus.push_back( cpu );
+        }
+    }
+
+    if ( cpus.empty() ) {
+        // do not pin
+        cpus.resize( max< uint64_t >( thread::hardware_concurrency(), 1 ), -1 );
+    }
+
+    auto count = _threadCount > 0 ? _threadCount : cpus.size();
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        workers.push_back( make_shared< Worker >() );
+    }
+
+    threadCount = count;
+
+    for ( uint64_t i = 0; i < count; i++ ) {
+        threadRegistry->add( make_shared< thread >(
+            &WorkStealingPool::workerLoop, this, i, cpus.at( i % cpus.size() ) ) );
+    }
+}
+
+
+WorkStealingPool::~WorkStealingPool() {
+    shutdown();
+}
+
+
+mutex WorkStealingPool::sharedLock;
+
+atomic< WorkStealingPool* > WorkStealingPool::shared = nullptr;
+
+
+WorkStealingPool& WorkStealingPool::getShared() {
+    auto pool = shared.load();
+    if ( pool )
+        return *pool;
+
+    lock_guard< mutex > lock( sharedLock );
+    if ( !shared )
+        shared = new WorkStealingPool( "CPU" );
+    return *shared;
+}
+
+
+WorkStealingPool* WorkStealingPool::getSharedIfCreated() {
+    return shared;
+}
+
+
+void WorkStealingPool::shutdownShared() {
+    lock_guard< mutex > lock( sharedLock );
+    auto pool = shared.exchange( nullptr );
+    // not deleted, since executors of exited agents may still refer to it
+    if ( pool )
+        pool->shutdown();
+}
+
+
+void WorkStealingPool::execute( function< void() >&& _func ) {
+    executing++;
+
+    if ( exitRequested ) {
+        executing--;
+        checkForExit();
+    }
+
+    auto task = createTask( std::move( _func ) );
+
+    // tasks submitted by a task stay on the same worker, since their data is in its cache
+    auto index = currentPool == this ? currentWorker : nextWorker++ % workers.size();
+
+    {
+        lock_guard< mutex > lock( workers.at( index )->lock );
+        workers.at( index )->tasks.push_back( std::move( task ) );
+    }
+
+    queuedTasks++;
+    executing--;
+
+    {
+        lock_guard< mutex > lock( idleLock );
+    }
+    idleCond.notify_one();
+}
+
+
+void WorkStealingPool::wakeAll() {
+    {
+        lock_guard< mutex > lock( idleLock );
+    }
+    idleCond.notify_all();
+}
+
+
+bool WorkStealingPool::popTask( uint64_t _workerIndex, Task& _task ) {
+    {
+        auto& own = *workers.at( _workerIndex );
+        lock_guard< mutex > lock( own.lock );
+        if ( !own.tasks.empty() ) {
+            _task = std::move( own.tasks.back() );
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for ( uint64_t i = 1; i < workers.size(); i++ ) {
+        auto& victim = *workers.at( ( _workerIndex + i ) % workers.size() );
+        lock_guard< mutex > lock( victim.lock );
+        if ( !victim.tasks.empty() ) {
+            _task = std::move( victim.tasks.front() );
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void WorkStealingPool::workerLoop( uint64_t _workerIndex, int _cpu ) {
+    currentPool = this;
+    currentWorker = _workerIndex;
+
+    auto threadName = name + to_string( _workerIndex );
+    pthread_setname_np( pthread_self(), threadName.substr( 0, 15 ).c_str() );
+
+    if ( _cpu >= 0 ) {
+        cpu_set_t cpuSet;
+        CPU_ZERO( &cpuSet );
+        CPU_SET( _cpu, &cpuSet );
+        if ( pthread_setaffinity_np( pthread_self(), sizeof( cpuSet ), &cpuSet ) != 0 ) {
+            LOG( warn, "Could not pin " << threadName << " to CPU " << _cpu );
+        }
+    }
+
+    while ( true ) {
+        Task task;
+
+        if ( popTask( _workerIndex, task ) ) {
+            queuedTasks--;
+            run( task );
+            continue;
+        }
+
+        // the queued tasks are run before the worker exits
+        if ( exitRequested && executing == 0 && queuedTasks == 0 )
+            return;
+
+        unique_lock< mutex > lock( idleLock );
+        idleCond.wait_for( lock, chrono::milliseconds( IDLE_WAIT_MS ),
+            [this]() { return queuedTasks > 0 || exitRequested; } );
+    }
+}
@@ -0,0 +1,89 @@
+/*
+    Copyright (C) 2022 SKALE Labs
+
+    This file is part of skale-consensus.
+
+    skale-consensus is free software: you can redistribute it and/or modify
+    it under the terms of the GNU Affero General Public License as published
+    by the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    skale-consensus is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Affero General Public License for more details.
+
+    You should have received a copy of the GNU Affero General Public License
+    along with skale-consensus.  If not, see <https://www.gnu.org/licenses/>.
+
+    @file WorkStealingPool.h
+    @author Stan Kladko
+    @date 2022
+*/
+
+
+#pragma once
+
+#include "ExecutorPool.h"
+
+/*
+ * Pool for CPU bound tasks, with one worker thread pinned to each CPU the process may run on.
+ * Each worker has its own deque. A worker runs its newest task first, and takes the oldest
+ * task of another worker when its own deque is empty. Tasks must not block on IO.
+ */
+class WorkStealingPool : public ExecutorPool {
+    class Worker {
+    public:
+        mutex lock;
+
+        deque< Task > tasks;
+    };
+
+    static constexpr uint64_t IDLE_WAIT_MS = 100;
+
+    vector< ptr< Worker > > workers;
+
+    atomic< uint64_t > nextWorker = 0;
+
+    // tasks in all deques
+    atomic< uint64_t > queuedTasks = 0;
+
+    // execute() calls that are queueing a task. Workers exit only when the pool is exiting
+    // and no task is queued or being queued
+    atomic< uint64_t > executing = 0;
+
+    mutex idleLock;
+
+    condition_variable idleCond;
+
+    // the worker index of the current thread, if it is a worker of this pool
+    static thread_local WorkStealingPool* currentPool;
+
+    static thread_local uint64_t currentWorker;
+
+    static mutex sharedLock;
+
+    static atomic< WorkStealingPool* > shared;
+
+    bool popTask( uint64_t _workerIndex, Task& _task );
+
+    void workerLoop( uint64_t _workerIndex, int _cpu );
+
+    void wakeAll() override;
+
+public:
+    // one worker per allowed CPU if _threadCount is 0
+    explicit WorkStealingPool( const string& _name, uint64_t _threadCount = 0 );
+
+    ~WorkStealingPool() override;
+
+    void execute( function< void() >&& _func ) override;
+
+    // created on first use, lives until shutdownShared()
+    static WorkStealingPool& getShared();
+
+    // nullptr if the shared pool has not been created yet
+    static WorkStealingPool* getSharedIfCreated();
+
+    static void shutdownShared();
+};
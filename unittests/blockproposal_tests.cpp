@@ -0,0 +1,68 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include "blockproposal/server/ProposerRequestLimiter.h"
+#include "network/ServerConnection.h"
+
+
+// the limiter alone, the server path is covered by [proposer-limiter]
+TEST_CASE(
+    "Proposer limiter defers, turns away and expires requests", "[proposer-limiter-queue]" ) {
+    const uint64_t maxInProcessing = 2;
+    const uint64_t maxDeferred = 3;
+
+    ProposerRequestLimiter limiter( 4, maxInProcessing, maxDeferred );
+
+    // descriptor 0 is not closed by the connection
+    auto makeConnection = []( uint64_t _deadlineMs ) {
+        auto connection = make_shared< ServerConnection >( 0, "127.0.0.1" );
+        connection->setDeadlineMs( _deadlineMs );
+        return connection;
+    };
+
+    for ( uint64_t i = 0; i < maxInProcessing; i++ ) {
+        REQUIRE( limiter.admit( 1, makeConnection( 0 ) ) == ProposerRequestLimiter::ADMITTED );
+    }
+
+    vector< ptr< ServerConnection > > deferred;
+
+    for ( uint64_t i = 0; i < maxDeferred; i++ ) {
+        deferred.push_back( makeConnection( 0 ) );
+        REQUIRE( limiter.admit( 1, deferred.back() ) == ProposerRequestLimiter::DEFERRED );
+    }
+
+    REQUIRE( limiter.admit( 1, makeConnection( 0 ) ) == ProposerRequestLimiter::BUSY );
+
+    // other proposers are not affected
+    REQUIRE( limiter.admit( 2, makeConnection( 0 ) ) == ProposerRequestLimiter::ADMITTED );
+
+    // deferred requests are handed back in order as requests finish, and admitted again
+    // when the server processes them
+    for ( uint64_t i = 0; i < maxDeferred; i++ ) {
+        auto next = limiter.finish( 1 );
+        REQUIRE( next == deferred.at( i ) );
+        REQUIRE( limiter.admit( 1, next ) == ProposerRequestLimiter::ADMITTED );
+    }
+
+    REQUIRE( limiter.getInProcessingCount( 1 ) == maxInProcessing );
+    REQUIRE( limiter.getDeferredCount( 1 ) == 0 );
+
+    // the timer closes deferred requests that pass their deadline
+    auto now = Time::getCurrentTimeMs();
+    REQUIRE( limiter.admit( 1, makeConnection( now + 50 ) ) == ProposerRequestLimiter::DEFERRED );
+    REQUIRE( limiter.admit( 1, makeConnection( now + 100 ) ) == ProposerRequestLimiter::DEFERRED );
+    REQUIRE( limiter.admit( 1, makeConnection( now + 60000 ) ) ==
+             ProposerRequestLimiter::DEFERRED );
+    REQUIRE( limiter.getDeferredCount( 1 ) == 3 );
+
+    usleep( 500 * 1000 );
+
+    REQUIRE( limiter.getDeferredCount( 1 ) == 1 );
+    REQUIRE( limiter.admit( 1, makeConnection( 0 ) ) == ProposerRequestLimiter::DEFERRED );
+
+    REQUIRE( limiter.finish( 1 ) != nullptr );
+    REQUIRE( limiter.finish( 1 ) != nullptr );
+    REQUIRE( limiter.getInProcessingCount( 1 ) == 0 );
+    REQUIRE( limiter.getDeferredCount( 1 ) == 0 );
+}
@@ -0,0 +1,202 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include <random>
+
+#include "exceptions/NetworkProtocolException.h"
+#include "network/Compression.h"
+#include "network/CompressionPolicy.h"
+
+
+// compresses the chunks and returns the frames as they go out on the wire
+ptr< vector< uint8_t > > compressToFrames(
+    const vector< pair< const uint8_t*, uint64_t > >& _chunks, int _level ) {
+    auto chunks = _chunks;
+    Compression::FrameCompressor compressor( std::move( chunks ), _level );
+
+    auto frames = make_shared< vector< uint8_t > >();
+
+    while ( !compressor.isFinished() ) {
+        auto frame = compressor.nextFrame();
+        REQUIRE( frame->size() >= Compression::FRAME_HEADER_SIZE );
+        REQUIRE( frame->size() <= Compression::FRAME_HEADER_SIZE + Compression::MAX_FRAME_SIZE );
+        frames->insert( frames->end(), frame->begin(), frame->end() );
+    }
+
+    return frames;
+}
+
+
+vector< uint8_t > makeCompressibleData( uint64_t _size, uint64_t _seed ) {
+    mt19937_64 gen( _seed );
+    vector< uint8_t > data;
+    // block JSON repeats field names and values, only some of the hex digits differ
+    while ( data.size() < _size ) {
+        auto nonce = to_string( gen() % 100000000 );
+        string tx = "{\"nonce\":\"" + nonce +
+                    "\",\"gas\":\"0x5208\",\"to\":\"0x000000000000000000000000000000000000dead\"},";
+        data.insert( data.end(), tx.begin(), tx.end() );
+    }
+    data.resize( _size );
+    return data;
+}
+
+
+vector< uint8_t > makeRandomData( uint64_t _size, uint64_t _seed ) {
+    mt19937_64 gen( _seed );
+    vector< uint8_t > data( _size );
+    for ( auto&& byte : data ) {
+        byte = ( uint8_t ) gen();
+    }
+    return data;
+}
+
+
+TEST_CASE( "Compressed frames round trip", "[compression]" ) {
+    auto compressible = makeCompressibleData( 1024 * 1024, 1 );
+    auto random = makeRandomData( 300 * 1024, 2 );
+
+    SECTION( "All levels restore the payload" ) {
+        for ( int level = 1; level <= Compression::MAX_LEVEL; level++ ) {
+            auto frames =
+                compressToFrames( { { compressible.data(), compressible.size() } }, level );
+            REQUIRE( frames->size() < compressible.size() / 2 );
+
+            vector< uint8_t > output( compressible.size() );
+            Compression::decompressFrames(
+                frames->data(), frames->size(), output.data(), output.size() );
+            REQUIRE( output == compressible );
+        }
+    }
+
+    SECTION( "Chunks are compressed as one stream" ) {
+        // empty chunks and chunks that span several frames, as block views do
+        vector< pair< const uint8_t*, uint64_t > > chunks = { { compressible.data(), 0 },
+            { compressible.data(), 1 }, { compressible.data() + 1, 200 * 1024 },
+            { compressible.data(), 0 }, { random.data(), random.size() },
+            { compressible.data() + 200 * 1024 + 1, 100 } };
+
+        vector< uint8_t > expected;
+        for ( auto&& chunk : chunks ) {
+            expected.insert( expected.end(), chunk.first, chunk.first + chunk.second );
+        }
+
+        auto frames = compressToFrames( chunks, 6 );
+
+        // incompressible data makes the stream span several frames
+        REQUIRE( frames->size() > 2 * Compression::MAX_FRAME_SIZE );
+
+        // frames are decompressed one by one, as they are read from the socket
+        vector< uint8_t > output( expected.size() );
+        Compression::FrameDecompressor decompressor( output.data(), output.size() );
+
+        uint64_t offset = 0;
+        uint64_t frameCount = 0;
+
+        while ( true ) {
+            auto size = Compression::readFrameSize( frames->data() + offset );
+            offset += Compression::FRAME_HEADER_SIZE;
+            if ( size == 0 )
+                break;
+            decompressor.addFrame( frames->data() + offset, size );
+            offset += size;
+            frameCount++;
+        }
+
+        decompressor.finish();
+
+        REQUIRE( offset == frames->size() );
+        REQUIRE( frameCount > 2 );
+        REQUIRE( output == expected );
+    }
+
+    SECTION( "Broken streams are rejected" ) {
+        auto frames = compressToFrames( { { compressible.data(), compressible.size() } }, 1 );
+
+        vector< uint8_t > output( compressible.size() );
+
+        // the announced size does not match
+        vector< uint8_t > shorter( compressible.size() - 1 );
+        REQUIRE_THROWS_AS( Compression::decompressFrames( frames->data(), frames->size(),
+                               shorter.data(), shorter.size() ),
+            NetworkProtocolException );
+
+        vector< uint8_t > longer( compressible.size() + 1 );
+        REQUIRE_THROWS_AS( Compression::decompressFrames(
+                               frames->data(), frames->size(), longer.data(), longer.size() ),
+            NetworkProtocolException );
+
+        // the end frame is missing
+        REQUIRE_THROWS_AS( Compression::decompressFrames( frames->data(),
+                               frames->size() - Compression::FRAME_HEADER_SIZE, output.data(),
+                               output.size() ),
+            NetworkProtocolException );
+
+        // corrupted data
+        auto corrupted = *frames;
+        for ( uint64_t i = Compression::FRAME_HEADER_SIZE + 2; i < corrupted.size() - 8; i += 7 ) {
+            corrupted.at( i ) ^= 0x5a;
+        }
+        REQUIRE_THROWS( Compression::decompressFrames(
+            corrupted.data(), corrupted.size(), output.data(), output.size() ) );
+
+        // a frame larger than allowed
+        uint32_t tooLarge = Compression::MAX_FRAME_SIZE + 1;
+        REQUIRE_THROWS_AS(
+            Compression::readFrameSize( ( const uint8_t* ) &tooLarge ), NetworkProtocolException );
+    }
+}
+
+
+TEST_CASE( "Compression level follows the measured throughput", "[compression]" ) {
+    const uint64_t MB = 1024 * 1024;
+
+    CompressionPolicy policy( 4 );
+
+    SECTION( "Peers are not asked to compress before they are measured" ) {
+        REQUIRE( policy.getLevel( 1 ) == 0 );
+        REQUIRE( policy.getThroughput( 1 ) == 0 );
+    }
+
+    SECTION( "Small downloads are added up" ) {
+        // 16KB finalize fragments at 1MB/s
+        for ( uint64_t i = 0; i < 3; i++ ) {
+            policy.recordDownload( 2, 16 * 1024, 16 * 1024, 16 );
+            REQUIRE( policy.getThroughput( 2 ) == 0 );
+        }
+
+        policy.recordDownload( 2, 16 * 1024, 16 * 1024, 16 );
+        REQUIRE( policy.getThroughput( 2 ) == 64 * 1024 * 1000 / 64 );
+        REQUIRE( policy.getLevel( 2 ) == CompressionPolicy::STRONG_LEVEL );
+
+        // other peers are not affected
+        REQUIRE( policy.getLevel( 3 ) == 0 );
+    }
+
+    SECTION( "Levels by throughput" ) {
+        // 1GB/s
+        policy.recordDownload( 1, 10 * MB, 10 * MB, 10 );
+        REQUIRE( policy.getLevel( 1 ) == 0 );
+
+        // 16MB/s
+        policy.recordDownload( 2, 16 * MB, 16 * MB, 1000 );
+        REQUIRE( policy.getLevel( 2 ) == CompressionPolicy::FAST_LEVEL );
+
+        // 1MB/s
+        policy.recordDownload( 3, MB, MB, 1000 );
+        REQUIRE( policy.getLevel( 3 ) == CompressionPolicy::STRONG_LEVEL );
+    }
+
+    SECTION( "One slow download does not switch a fast peer" ) {
+        policy.recordDownload( 1, 100 * MB, 100 * MB, 1000 );
+        policy.recordDownload( 1, MB, MB, 1000 );
+        REQUIRE( policy.getLevel( 1 ) == 0 );
+        REQUIRE( policy.getThroughput( 1 ) == ( 100 * MB * 3 + MB ) / 4 );
+    }
+
+    SECTION( "Saved bytes" ) {
+        policy.recordDownload( 1, MB / 4, MB, 1000 );
+        REQUIRE( policy.getSavedPercentage() == 75 );
+    }
+}
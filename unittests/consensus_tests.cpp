@@ -2,6 +2,81 @@
 // Created by kladko on 17.06.20.
 //
 
+#include "abstracttcpserver/ConnectionStatus.h"
+#include "headers/Header.h"
+#include "network/Sockets.h"
+#include "node/NodeInfo.h"
+
+
+// a proposal request of a proposer for block 0. The server reads it like any proposal and
+// answers that it is too late, so it exercises the proposal server without a real proposal
+nlohmann::json makeStaleProposalRequest( Node& _server, uint64_t _proposerIndex ) {
+    auto proposerInfo = _server.getNodeInfoByIndex( schain_index( _proposerIndex ) );
+    CHECK_STATE( proposerInfo );
+
+    nlohmann::json request = nlohmann::json::object();
+    request["type"] = Header::BLOCK_PROPOSAL_REQ;
+    request["status"] = ( uint64_t ) CONNECTION_SUCCESS;
+    request["substatus"] = ( uint64_t ) CONNECTION_OK;
+    request["schainID"] = ( uint64_t ) _server.getSchain()->getSchainID();
+    request["proposerIndex"] = _proposerIndex;
+    request["proposerNodeID"] = ( uint64_t ) proposerInfo->getNodeID();
+    request["blockID"] = 0;
+    request["txCount"] = 0;
+    request["timeStamp"] = Time::getCurrentTimeSec();
+    request["timeStampMs"] = 0;
+    request["hash"] = string( 2 * HASH_LEN, '0' );
+    request["sig"] = "0";
+    request["sr"] = "1";
+    return request;
+}
+
+
+// sends _request to the proposal port of _server over loopback, the way a proposer does,
+// and returns the status of the response, or CONNECTION_STATUS_UNKNOWN if the server closed
+// the connection without one
+pair< uint64_t, uint64_t > sendLoopbackProposalRequest(
+    Node& _server, const nlohmann::json& _request ) {
+    auto serverInfo = _server.getNodeInfoByIndex( _server.getSchain()->getSchainIndex() );
+    CHECK_STATE( serverInfo );
+
+    auto address = Sockets::createSocketAddress(
+        serverInfo->getBaseIP(), ( uint16_t )( serverInfo->getPort() + PROPOSAL ) );
+
+    pair< uint64_t, uint64_t > result = { CONNECTION_STATUS_UNKNOWN, CONNECTION_SUBSTATUS_UNKNOWN };
+
+    auto s = socket( AF_INET, SOCK_STREAM, 0 );
+    CHECK_STATE( s >= 0 );
+
+    timeval timeout = { 10, 0 };
+    setsockopt( s, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) );
+
+    auto header = _request.dump();
+    uint64_t magic = MAGIC_NUMBER;
+    uint64_t headerLen = header.size();
+    string message = string( ( const char* ) &magic, sizeof( magic ) ) +
+                     string( ( const char* ) &headerLen, sizeof( headerLen ) ) + header;
+
+    uint64_t responseLen = 0;
+
+    if ( connect( s, ( sockaddr* ) address.get(), sizeof( sockaddr_in ) ) == 0 &&
+         send( s, message.data(), message.size(), MSG_NOSIGNAL ) == ( ssize_t ) message.size() &&
+         recv( s, &responseLen, sizeof( responseLen ), MSG_WAITALL ) ==
+             ( ssize_t ) sizeof( responseLen ) &&
+         responseLen > 0 && responseLen <= MAX_HEADER_SIZE ) {
+        string response( responseLen, '\0' );
+        if ( recv( s, response.data(), responseLen, MSG_WAITALL ) == ( ssize_t ) responseLen ) {
+            auto js = nlohmann::json::parse( response );
+            result = { js["status"].get< uint64_t >(), js["substatus"].get< uint64_t >() };
+        }
+    }
+
+    close( s );
+
+    return result;
+}
+
+
 
 TEST_CASE_METHOD( StartFromScratch, "Run basic consensus", "[consensus-basic]" ) {
     basicRun();
@@ -95,3 +170,249 @@ TEST_CASE_METHOD(
     unsetenv( "CORRUPT_PROPOSAL_TEST" );
     SUCCEED();
 }
+
+
+// N concurrent proposers: all N nodes of the chain in the config dir (e.g. sixteennodes) run in
+// this process and send every proposal to the other nodes over loopback, so the proposal server
+// of each node serves N-1 proposers at once for every block
+TEST_CASE_METHOD( StartFromScratch, "Proposal processing benchmark", "[proposal-benchmark][.]" ) {
+    auto processedBefore = BlockProposalServerAgent::getProposalsProcessed();
+
+    engine = new ConsensusEngine( 0, 1000000000 );
+    engine->parseTestConfigsAndCreateAllNodes( Consensust::getConfigDirPath() );
+    engine->slowStartBootStrapTest();
+
+    auto startTimeMs = Time::getCurrentTimeMs();
+
+    usleep( 1000 * 1000 * Consensust::getRunningTimeS() ); /* Flawfinder: ignore */
+
+    auto elapsedMs = max< uint64_t >( Time::getCurrentTimeMs() - startTimeMs, 1 );
+    auto proposers = engine->nodesCount();
+    auto lastId = ( uint64_t ) engine->getLargestCommittedBlockID();
+    auto processed = BlockProposalServerAgent::getProposalsProcessed() - processedBefore;
+
+    printf( "Proposers: %lu, blocks: %lu, proposals processed: %lu, proposals/s: %lu\n",
+        ( uint64_t ) proposers, lastId, processed, processed * 1000 / elapsedMs );
+    printf( "Proposals processed/average processing time ms: %s\n",
+        BlockProposalServerAgent::getProposalStats().c_str() );
+    printf( "Proposer index/average queue delay ms: %s\n",
+        BlockProposalServerAgent::getQueueDelayStats().c_str() );
+    printf( "Proposal sketches decoded/failed: %s\n",
+        BlockProposalServerAgent::getSketchStats().c_str() );
+
+    engine->exitGracefully();
+
+    while ( engine->getStatus() != CONSENSUS_EXITED ) {
+        usleep( 100 * 1000 );
+    }
+
+    delete engine;
+
+    REQUIRE( lastId > 0 );
+
+    if ( proposers > 1 )
+        REQUIRE( processed > 0 );
+}
+
+
+// one proposer floods a node with requests over loopback, while the other proposers send one
+// request at a time. Run from a config dir with at least three nodes (e.g. fournodes)
+TEST_CASE_METHOD( StartFromScratch, "Concurrent proposers are not starved by a flooding proposer",
+    "[proposer-limiter]" ) {
+    const uint64_t floodThreads = 8;
+    const uint64_t floodRequestsPerThread = 50;
+    const uint64_t requestsPerProposer = 20;
+
+    engine = new ConsensusEngine( 0, 1000000000 );
+    engine->parseTestConfigsAndCreateAllNodes( Consensust::getConfigDirPath() );
+    engine->slowStartBootStrapTest();
+
+    auto& server = *engine->getNodes().begin()->second;
+    auto serverIndex = ( uint64_t ) server.getSchain()->getSchainIndex();
+    auto nodeCount = ( uint64_t ) server.getSchain()->getNodeCount();
+
+    REQUIRE( nodeCount > 2 );
+
+    vector< uint64_t > proposerIndexes;
+    for ( uint64_t i = 1; i <= nodeCount; i++ ) {
+        if ( i != serverIndex )
+            proposerIndexes.push_back( i );
+    }
+
+    auto floodIndex = proposerIndexes.front();
+
+    atomic< uint64_t > floodBusy = 0;
+    atomic< uint64_t > floodAnswered = 0;
+    atomic< uint64_t > othersAnswered = 0;
+    atomic< uint64_t > othersBusy = 0;
+
+    auto blockBefore = ( uint64_t ) engine->getLargestCommittedBlockID();
+
+    vector< thread > threads;
+
+    for ( uint64_t i = 0; i < floodThreads; i++ ) {
+        threads.emplace_back( [&]() {
+            for ( uint64_t j = 0; j < floodRequestsPerThread; j++ ) {
+                auto status = sendLoopbackProposalRequest(
+                    server, makeStaleProposalRequest( server, floodIndex ) );
+                if ( status.second == CONNECTION_SERVER_BUSY )
+                    floodBusy++;
+                else if ( status.first != CONNECTION_STATUS_UNKNOWN )
+                    floodAnswered++;
+            }
+        } );
+    }
+
+    for ( uint64_t k = 1; k < proposerIndexes.size(); k++ ) {
+        threads.emplace_back( [&, k]() {
+            for ( uint64_t j = 0; j < requestsPerProposer; j++ ) {
+                auto status = sendLoopbackProposalRequest(
+                    server, makeStaleProposalRequest( server, proposerIndexes.at( k ) ) );
+                if ( status.second == CONNECTION_SERVER_BUSY )
+                    othersBusy++;
+                else if ( status.first != CONNECTION_STATUS_UNKNOWN )
+                    othersAnswered++;
+            }
+        } );
+    }
+
+    for ( auto&& t : threads ) {
+        t.join();
+    }
+
+    // the chain keeps going while the node is flooded
+    auto startTime = Time::getCurrentTimeSec();
+    while ( ( uint64_t ) engine->getLargestCommittedBlockID() <= blockBefore &&
+            Time::getCurrentTimeSec() < startTime + 30 ) {
+        usleep( 100 * 1000 );
+    }
+    auto blockAfter = ( uint64_t ) engine->getLargestCommittedBlockID();
+
+    printf( "Flooding proposer: %lu answered, %lu busy of %lu requests\n", floodAnswered.load(),
+        floodBusy.load(), floodThreads * floodRequestsPerThread );
+
+    engine->exitGracefully();
+
+    while ( engine->getStatus() != CONSENSUS_EXITED ) {
+        usleep( 100 * 1000 );
+    }
+
+    delete engine;
+
+    // the proposers that send one request at a time are never turned away
+    REQUIRE( othersBusy == 0 );
+    REQUIRE( othersAnswered == requestsPerProposer * ( proposerIndexes.size() - 1 ) );
+    REQUIRE( floodAnswered + floodBusy > 0 );
+    REQUIRE( blockAfter > blockBefore );
+}
+
+
+// N concurrent proposers over loopback: one thread per other node of the chain in the config
+// dir (e.g. sixteennodes) sends proposal requests to the first node back to back
+TEST_CASE_METHOD( StartFromScratch, "Loopback proposers benchmark", "[proposer-benchmark][.]" ) {
+    const uint64_t requestsPerProposer = 200;
+
+    engine = new ConsensusEngine( 0, 1000000000 );
+    engine->parseTestConfigsAndCreateAllNodes( Consensust::getConfigDirPath() );
+    engine->slowStartBootStrapTest();
+
+    auto& server = *engine->getNodes().begin()->second;
+    auto serverIndex = ( uint64_t ) server.getSchain()->getSchainIndex();
+    auto nodeCount = ( uint64_t ) server.getSchain()->getNodeCount();
+
+    REQUIRE( nodeCount > 1 );
+
+    vector< uint64_t > totalLatencyMs( nodeCount + 1, 0 );
+    vector< uint64_t > maxLatencyMs( nodeCount + 1, 0 );
+    vector< uint64_t > answered( nodeCount + 1, 0 );
+
+    auto startTimeMs = Time::getCurrentTimeMs();
+
+    vector< thread > proposers;
+
+    for ( uint64_t i = 1; i <= nodeCount; i++ ) {
+        if ( i == serverIndex )
+            continue;
+        proposers.emplace_back( [&, i]() {
+            for ( uint64_t j = 0; j < requestsPerProposer; j++ ) {
+                auto requestStartMs = Time::getCurrentTimeMs();
+                auto status = sendLoopbackProposalRequest(
+                    server, makeStaleProposalRequest( server, i ) );
+                auto latencyMs = Time::getCurrentTimeMs() - requestStartMs;
+                if ( status.first != CONNECTION_STATUS_UNKNOWN )
+                    answered[i]++;
+                totalLatencyMs[i] += latencyMs;
+                maxLatencyMs[i] = max( maxLatencyMs[i], latencyMs );
+            }
+        } );
+    }
+
+    for ( auto&& proposer : proposers ) {
+        proposer.join();
+    }
+
+    auto elapsedMs = max< uint64_t >( Time::getCurrentTimeMs() - startTimeMs, 1 );
+    uint64_t totalAnswered = 0;
+
+    for ( uint64_t i = 1; i <= nodeCount; i++ ) {
+        if ( i == serverIndex )
+            continue;
+        totalAnswered += answered[i];
+        printf( "Proposer %lu: %lu answered, average latency %lu ms, max latency %lu ms\n", i,
+            answered[i], totalLatencyMs[i] / requestsPerProposer, maxLatencyMs[i] );
+    }
+
+    printf( "Proposers: %lu, requests/s: %lu\n", nodeCount - 1, totalAnswered * 1000 / elapsedMs );
+    printf( "Proposer index/average queue delay ms: %s\n",
+        BlockProposalServerAgent::getQueueDelayStats().c_str() );
+
+    engine->exitGracefully();
+
+    while ( engine->getStatus() != CONSENSUS_EXITED ) {
+        usleep( 100 * 1000 );
+    }
+
+    delete engine;
+
+    REQUIRE( totalAnswered == requestsPerProposer * ( nodeCount - 1 ) );
+}
+
+
+// restarts the nodes on the history of a first run and reports how long it takes them to open
+// the databases and to propose again. Use a long running time to get a large history
+TEST_CASE_METHOD( StartFromScratch, "Startup benchmark", "[startup-benchmark][.]" ) {
+    auto lastId = basicRun();
+
+    engine = new ConsensusEngine( ( int64_t )( uint64_t ) lastId, 1000000000 );
+    engine->parseTestConfigsAndCreateAllNodes( Consensust::getConfigDirPath() );
+    engine->slowStartBootStrapTest();
+
+    auto startTime = Time::getCurrentTimeSec();
+    bool allProposed = false;
+
+    while ( !allProposed && Time::getCurrentTimeSec() < startTime + 60 ) {
+        usleep( 100 * 1000 );
+        allProposed = true;
+        for ( auto&& item : engine->getNodes() ) {
+            if ( item.second->getSchain()->getFirstProposalDelayMs() == 0 )
+                allProposed = false;
+        }
+    }
+
+    for ( auto&& item : engine->getNodes() ) {
+        printf( "Node %lu: history %lu blocks, databases opened in %lu ms, first proposal "
+                "after %lu ms\n",
+            ( uint64_t ) item.first, ( uint64_t ) lastId, item.second->getDBOpenTimeMs(),
+            item.second->getSchain()->getFirstProposalDelayMs() );
+    }
+
+    engine->exitGracefully();
+
+    while ( engine->getStatus() != CONSENSUS_EXITED ) {
+        usleep( 100 * 1000 );
+    }
+
+    delete engine;
+
+    REQUIRE( allProposed );
+}
@@ -0,0 +1,72 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include "crypto/BLAKE3Hash.h"
+#include "crypto/CryptoManager.h"
+#include "crypto/OpenSSLEdDSAKey.h"
+
+
+TEST_CASE( "A bad signature in a message burst rejects only its message", "[verify-burst]" ) {
+    // the test constructor does not connect to SGX
+    CryptoManager cryptoManager( 4, 3, false );
+
+    const uint64_t keyCount = 3;
+    const uint64_t messageCount = 30;
+
+    vector< ptr< OpenSSLEdDSAKey > > keys;
+    for ( uint64_t i = 0; i < keyCount; i++ ) {
+        keys.push_back( OpenSSLEdDSAKey::generateKey() );
+    }
+
+    vector< string > publicKeys;
+    vector< string > sigs;
+    vector< BLAKE3Hash > hashes;
+
+    for ( uint64_t i = 0; i < messageCount; i++ ) {
+        auto data = make_shared< vector< uint8_t > >( 8 );
+        memcpy( data->data(), &i, sizeof( i ) );
+        hashes.push_back( BLAKE3Hash::calculateHash( data ) );
+        auto& key = keys.at( i % keyCount );
+        publicKeys.push_back( key->serializePubKey() );
+        sigs.push_back( key->sign( ( const char* ) hashes.back().data() ) );
+    }
+
+    SECTION( "A valid burst is accepted" ) {
+        auto verified = cryptoManager.verifySessionSigsByKey( publicKeys, sigs, hashes );
+        REQUIRE( verified.size() == messageCount );
+        for ( auto&& v : verified ) {
+            REQUIRE( v );
+        }
+    }
+
+    SECTION( "Bad messages are rejected and the others are accepted" ) {
+        // signed by the right key, but for another message
+        sigs.at( 7 ) = sigs.at( 10 );
+        // not a signature
+        sigs.at( 12 ) = "garbage";
+        // the session key certificate did not verify
+        publicKeys.at( 20 ) = "";
+        // signed by the key of another node
+        sigs.at( 25 ) = keys.at( 2 )->sign( ( const char* ) hashes.at( 25 ).data() );
+
+        set< uint64_t > bad = { 7, 12, 20, 25 };
+
+        auto verified = cryptoManager.verifySessionSigsByKey( publicKeys, sigs, hashes );
+        REQUIRE( verified.size() == messageCount );
+        for ( uint64_t i = 0; i < messageCount; i++ ) {
+            REQUIRE( verified.at( i ) == ( bad.count( i ) == 0 ) );
+        }
+    }
+
+    SECTION( "A key that does not parse rejects only its messages" ) {
+        for ( uint64_t i = 0; i < messageCount; i += keyCount ) {
+            publicKeys.at( i ) = "not a key";
+        }
+
+        auto verified = cryptoManager.verifySessionSigsByKey( publicKeys, sigs, hashes );
+        for ( uint64_t i = 0; i < messageCount; i++ ) {
+            REQUIRE( verified.at( i ) == ( i % keyCount != 0 ) );
+        }
+    }
+}
@@ -0,0 +1,133 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include "exceptions/ExitRequestedException.h"
+#include "threads/BlockingIOPool.h"
+#include "threads/TaskExecutor.h"
+#include "threads/WorkStealingPool.h"
+
+
+TEST_CASE( "Idle workers steal subtasks of a blocked task", "[executor-pool]" ) {
+    WorkStealingPool pool( "TestCPU", 4 );
+
+    const uint64_t subtaskCount = 64;
+
+    mutex lock;
+    condition_variable cond;
+    uint64_t finished = 0;
+    set< thread::id > subtaskThreads;
+    thread::id parentThread;
+
+    pool.execute( [&]() {
+        {
+            lock_guard< mutex > guard( lock );
+            parentThread = this_thread::get_id();
+        }
+
+        // the subtasks go to the deque of this worker, which is blocked until they finish
+        for ( uint64_t i = 0; i < subtaskCount; i++ ) {
+            pool.execute( [&]() {
+                lock_guard< mutex > guard( lock );
+                subtaskThreads.insert( this_thread::get_id() );
+                finished++;
+                cond.notify_all();
+            } );
+        }
+
+        unique_lock< mutex > guard( lock );
+        cond.wait_for(
+            guard, chrono::seconds( 30 ), [&]() { return finished == subtaskCount; } );
+    } );
+
+    unique_lock< mutex > guard( lock );
+    REQUIRE( cond.wait_for(
+        guard, chrono::seconds( 30 ), [&]() { return finished == subtaskCount; } ) );
+    REQUIRE( subtaskThreads.count( parentThread ) == 0 );
+    REQUIRE( !subtaskThreads.empty() );
+    guard.unlock();
+
+    pool.shutdown();
+    REQUIRE_THROWS_AS( pool.execute( []() {} ), ExitRequestedException );
+}
+
+
+TEST_CASE( "Blocking IO pool grows and shrinks its threads", "[executor-pool]" ) {
+    const uint64_t idleTimeoutMs = 200;
+    const uint64_t blockingTasks = 8;
+
+    BlockingIOPool pool( "TestIO", idleTimeoutMs );
+
+    mutex lock;
+    condition_variable cond;
+    uint64_t started = 0;
+    bool released = false;
+
+    for ( uint64_t i = 0; i < blockingTasks; i++ ) {
+        pool.execute( [&]() {
+            unique_lock< mutex > guard( lock );
+            started++;
+            cond.notify_all();
+            cond.wait( guard, [&]() { return released; } );
+        } );
+    }
+
+    // each blocked task holds a thread, so all of them start
+    {
+        unique_lock< mutex > guard( lock );
+        REQUIRE( cond.wait_for(
+            guard, chrono::seconds( 30 ), [&]() { return started == blockingTasks; } ) );
+        REQUIRE( pool.getThreadCount() >= blockingTasks );
+        released = true;
+        cond.notify_all();
+    }
+
+    // the threads exit after the idle timeout
+    auto deadlineMs = Time::getCurrentTimeMs() + 30000;
+    while ( pool.getThreadCount() > 0 && Time::getCurrentTimeMs() < deadlineMs ) {
+        usleep( idleTimeoutMs * 1000 );
+    }
+    REQUIRE( pool.getThreadCount() == 0 );
+
+    // a new task starts a new thread, and the exited threads are joined
+    promise< void > ran;
+    pool.execute( [&]() { ran.set_value(); } );
+    REQUIRE( ran.get_future().wait_for( chrono::seconds( 30 ) ) == future_status::ready );
+
+    pool.shutdown();
+    REQUIRE( pool.getThreadCount() == 0 );
+    REQUIRE_THROWS_AS( pool.execute( []() {} ), ExitRequestedException );
+}
+
+
+TEST_CASE( "Failing tasks do not affect other tasks", "[executor-pool]" ) {
+    WorkStealingPool pool( "TestCPU", 2 );
+
+    {
+        TaskExecutor executor( "TestExecutor", pool );
+
+        auto failed = executor.submit( []() -> uint64_t {
+            BOOST_THROW_EXCEPTION( InvalidStateException( "Task failed", "executor_tests" ) );
+        } );
+        REQUIRE_THROWS_AS( failed.get(), InvalidStateException );
+
+        // an exception thrown by a raw task is caught by the pool, the worker keeps running
+        for ( uint64_t i = 0; i < 8; i++ ) {
+            pool.execute( []() { throw runtime_error( "Task failed" ); } );
+        }
+
+        vector< future< uint64_t > > results;
+        for ( uint64_t i = 0; i < 16; i++ ) {
+            results.push_back( executor.submit( [i]() { return i * i; } ) );
+        }
+        for ( uint64_t i = 0; i < 16; i++ ) {
+            REQUIRE( results.at( i ).get() == i * i );
+        }
+
+        pool.shutdown();
+
+        // the slot taken by a refused task is released
+        REQUIRE_THROWS_AS( executor.submit( []() { return 0; } ), ExitRequestedException );
+        REQUIRE( executor.getInFlightCount() == 0 );
+    }
+}
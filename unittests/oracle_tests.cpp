@@ -0,0 +1,435 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/socket.h>
+
+#include <openssl/pem.h>
+#include <openssl/ssl.h>
+#include <openssl/x509v3.h>
+
+#include "oracle/OracleHttpEngine.h"
+#include "oracle/OracleReceivedResults.h"
+#include "oracle/OracleRequestSpec.h"
+#include "oracle/OracleResult.h"
+
+
+// HTTP or HTTPS server on localhost that answers every request with the same body. The
+// connections are kept alive unless the server is told to close them after each response
+class OracleTestHttpServer {
+public:
+    int listenSocket = -1;
+
+    uint16_t port = 0;
+
+    SSL_CTX* sslContext = nullptr;  // plain HTTP if null
+
+    string certificatePath;  // the self signed certificate of the HTTPS server
+
+    const bool closeAfterResponse;
+
+    atomic< uint64_t > acceptedConnections = 0;
+
+    atomic< uint64_t > handshakes = 0;
+
+    atomic< uint64_t > resumedHandshakes = 0;
+
+    atomic< uint64_t > activeConnections = 0;
+
+    thread acceptThread;
+
+    explicit OracleTestHttpServer( bool _tls = false, bool _closeAfterResponse = false )
+        : closeAfterResponse( _closeAfterResponse ) {
+        // writes to connections that the client closed must not kill the test
+        signal( SIGPIPE, SIG_IGN );
+
+        if ( _tls )
+            initTls();
+
+        listenSocket = socket( AF_INET, SOCK_STREAM, 0 );
+        REQUIRE( listenSocket >= 0 );
+
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+        REQUIRE( bind( listenSocket, ( sockaddr* ) &address, sizeof( address ) ) == 0 );
+
+        socklen_t length = sizeof( address );
+        REQUIRE( getsockname( listenSocket, ( sockaddr* ) &address, &length ) == 0 );
+        port = ntohs( address.sin_port );
+        REQUIRE( listen( listenSocket, 64 ) == 0 );
+
+        acceptThread = thread( [this]() {
+            int connection;
+            while ( ( connection = accept( listenSocket, nullptr, nullptr ) ) >= 0 ) {
+                acceptedConnections++;
+                activeConnections++;
+                thread( [this, connection]() {
+                    serve( connection );
+                    activeConnections--;
+                } ).detach();
+            }
+        } );
+    }
+
+    ~OracleTestHttpServer() {
+        // wakes up accept, the socket is closed once the accept thread can not use it
+        shutdown( listenSocket, SHUT_RDWR );
+        acceptThread.join();
+        close( listenSocket );
+
+        // the connection threads use the context until the clients close the connections
+        auto startTimeMs = Time::getCurrentTimeMs();
+        while ( activeConnections > 0 && Time::getCurrentTimeMs() < startTimeMs + 5000 )
+            usleep( 1000 );
+
+        if ( sslContext && activeConnections == 0 )
+            SSL_CTX_free( sslContext );
+
+        if ( !certificatePath.empty() )
+            remove( certificatePath.c_str() );
+    }
+
+    string getUri( const string& _path ) {
+        return string( sslContext ? "https" : "http" ) + "://127.0.0.1:" + to_string( port ) +
+               _path;
+    }
+
+    // a self signed certificate for 127.0.0.1, which the client trusts as its CA bundle
+    void initTls() {
+        auto keyContext = EVP_PKEY_CTX_new_id( EVP_PKEY_EC, nullptr );
+        REQUIRE( keyContext );
+        REQUIRE( EVP_PKEY_keygen_init( keyContext ) == 1 );
+        REQUIRE( EVP_PKEY_CTX_set_ec_paramgen_curve_nid( keyContext, NID_X9_62_prime256v1 ) == 1 );
+        EVP_PKEY* key = nullptr;
+        REQUIRE( EVP_PKEY_keygen( keyContext, &key ) == 1 );
+        EVP_PKEY_CTX_free( keyContext );
+
+        auto certificate = X509_new();
+        REQUIRE( certificate );
+        X509_set_version( certificate, 2 );
+        ASN1_INTEGER_set( X509_get_serialNumber( certificate ), 1 );
+        X509_gmtime_adj( X509_getm_notBefore( certificate ), -3600 );
+        X509_gmtime_adj( X509_getm_notAfter( certificate ), 3600 );
+        X509_set_pubkey( certificate, key );
+
+        auto name = X509_get_subject_name( certificate );
+        X509_NAME_add_entry_by_txt(
+            name, "CN", MBSTRING_ASC, ( const unsigned char* ) "127.0.0.1", -1, -1, 0 );
+        X509_set_issuer_name( certificate, name );
+
+        X509V3_CTX extensionContext;
+        X509V3_set_ctx_nodb( &extensionContext );
+        X509V3_set_ctx( &extensionContext, certificate, certificate, nullptr, nullptr, 0 );
+        for ( auto&& [nid, value] : vector< pair< int, string > >{
+                  { NID_basic_constraints, "critical,CA:TRUE" },
+                  { NID_subject_alt_name, "IP:127.0.0.1" } } ) {
+            auto extension =
+                X509V3_EXT_conf_nid( nullptr, &extensionContext, nid, value.c_str() );
+            REQUIRE( extension );
+            X509_add_ext( certificate, extension, -1 );
+            X509_EXTENSION_free( extension );
+        }
+
+        REQUIRE( X509_sign( certificate, key, EVP_sha256() ) > 0 );
+
+        char path[] = "/tmp/oracle_test_cert_XXXXXX";
+        auto fd = mkstemp( path );
+        REQUIRE( fd >= 0 );
+        auto file = fdopen( fd, "w" );
+        REQUIRE( PEM_write_X509( file, certificate ) == 1 );
+        fclose( file );
+        certificatePath = path;
+
+        sslContext = SSL_CTX_new( TLS_server_method() );
+        REQUIRE( sslContext );
+        REQUIRE( SSL_CTX_use_certificate( sslContext, certificate ) == 1 );
+        REQUIRE( SSL_CTX_use_PrivateKey( sslContext, key ) == 1 );
+
+        X509_free( certificate );
+        EVP_PKEY_free( key );
+    }
+
+    void serve( int _connection ) {
+        static const string KEEP_ALIVE_RESPONSE =
+            "HTTP/1.1 200 OK\r\nContent-Length: 11\r\n\r\n{\"price\":1}";
+        static const string CLOSE_RESPONSE =
+            "HTTP/1.1 200 OK\r\nContent-Length: 11\r\nConnection: close\r\n\r\n{\"price\":1}";
+
+        auto& response = closeAfterResponse ? CLOSE_RESPONSE : KEEP_ALIVE_RESPONSE;
+
+        SSL* ssl = nullptr;
+
+        if ( sslContext ) {
+            ssl = SSL_new( sslContext );
+            SSL_set_fd( ssl, _connection );
+            if ( SSL_accept( ssl ) != 1 ) {
+                SSL_free( ssl );
+                close( _connection );
+                return;
+            }
+            handshakes++;
+            if ( SSL_session_reused( ssl ) )
+                resumedHandshakes++;
+        }
+
+        auto receive = [&]( char* _buffer, int _size ) -> int {
+            return ssl ? SSL_read( ssl, _buffer, _size ) : read( _connection, _buffer, _size );
+        };
+
+        auto send = [&]( const string& _data ) -> bool {
+            auto n = ssl ? SSL_write( ssl, _data.data(), _data.size() ) :
+                           write( _connection, _data.data(), _data.size() );
+            return n == ( ssize_t ) _data.size();
+        };
+
+        string received;
+        char buffer[4096];
+        int n;
+        bool closed = false;
+
+        while ( !closed && ( n = receive( buffer, sizeof( buffer ) ) ) > 0 ) {
+            received.append( buffer, n );
+            size_t end;
+            while ( ( end = received.find( "\r\n\r\n" ) ) != string::npos ) {
+                received.erase( 0, end + 4 );
+                if ( !send( response ) || closeAfterResponse ) {
+                    closed = true;
+                    break;
+                }
+            }
+        }
+
+        if ( ssl ) {
+            SSL_shutdown( ssl );
+            SSL_free( ssl );
+        }
+
+        close( _connection );
+    }
+};
+
+
+// submits the requests and waits until all callbacks are called. Returns the successes
+static uint64_t runOracleRequests( OracleHttpEngine& _engine, const string& _uri,
+    uint64_t _count, bool _sequential, uint64_t* _timedOut = nullptr ) {
+    atomic< uint64_t > succeeded = 0;
+    atomic< uint64_t > finished = 0;
+    atomic< uint64_t > timedOut = 0;
+
+    auto callback = [&]( uint64_t _status, string&& _response ) {
+        if ( _status == ORACLE_SUCCESS && _response == "{\"price\":1}" )
+            succeeded++;
+        else if ( _status == ORACLE_TIMEOUT )
+            timedOut++;
+        finished++;
+    };
+
+    auto waitFor = [&]( uint64_t _finished ) {
+        auto startTimeMs = Time::getCurrentTimeMs();
+        while ( finished < _finished && Time::getCurrentTimeMs() < startTimeMs + 10000 )
+            usleep( 1000 );
+    };
+
+    for ( uint64_t i = 0; i < _count; i++ ) {
+        _engine.submit( _uri, false, "", callback );
+        if ( _sequential )
+            waitFor( i + 1 );
+    }
+
+    waitFor( _count );
+
+    REQUIRE( finished == _count );
+
+    if ( _timedOut )
+        *_timedOut = timedOut;
+
+    return succeeded;
+}
+
+
+TEST_CASE( "Oracle http engine reuses connections", "[oracle-http-engine]" ) {
+    OracleTestHttpServer server;
+
+    auto uri = server.getUri( "/price" );
+
+    REQUIRE( OracleHttpEngine::getHost( uri ) == "127.0.0.1:" + to_string( server.port ) );
+
+    OracleHttpEngine engine( 64, 2, 0, 2000 );
+
+    REQUIRE( runOracleRequests( engine, uri, 200, false ) == 200 );
+    REQUIRE( server.acceptedConnections <= 2 );
+}
+
+
+TEST_CASE( "Oracle http engine reuses TLS connections", "[oracle-http-engine]" ) {
+    OracleTestHttpServer server( true );
+
+    OracleHttpEngine engine( 64, 2, 0, 5000, server.certificatePath );
+
+    // every request after the first ones runs on a connection that finished its handshake
+    REQUIRE( runOracleRequests( engine, server.getUri( "/price" ), 200, false ) == 200 );
+    REQUIRE( server.acceptedConnections <= 2 );
+    REQUIRE( server.handshakes <= 2 );
+}
+
+
+TEST_CASE( "Oracle http engine resumes TLS sessions", "[oracle-http-engine]" ) {
+    // the server closes every connection, so every request makes a new one
+    OracleTestHttpServer server( true, true );
+
+    OracleHttpEngine engine( 64, 1, 0, 5000, server.certificatePath );
+
+    const uint64_t count = 10;
+
+    REQUIRE( runOracleRequests( engine, server.getUri( "/price" ), count, true ) == count );
+    REQUIRE( server.handshakes == count );
+    // the shared TLS session lets all connections after the first one skip the full handshake
+    REQUIRE( server.resumedHandshakes == count - 1 );
+}
+
+
+TEST_CASE( "Oracle http engine limits request rate", "[oracle-http-engine]" ) {
+    OracleTestHttpServer server;
+
+    OracleHttpEngine engine( 64, 2, 10, 1000 );
+
+    uint64_t timedOut = 0;
+
+    auto succeeded = runOracleRequests( engine, server.getUri( "/price" ), 40, false, &timedOut );
+
+    // a full bucket of 10 plus 10 per second for the 1 s timeout. A slow machine starts
+    // fewer requests in time, so only the limit is checked
+    REQUIRE( succeeded + timedOut == 40 );
+    REQUIRE( succeeded <= 21 );
+}
+
+
+TEST_CASE( "Oracle specs for the same endpoint request share a fetch key", "[oracle-fetch-key]" ) {
+    string uri = "https://worldtimeapi.org/api/timezone/Europe/Kiev";
+    auto time = Time::getCurrentTimeMs();
+
+    auto spec1 = OracleRequestSpec::makeWebSpec( 1, uri, { "/unixtime" }, { 1 }, "", "json", time );
+    auto spec2 =
+        OracleRequestSpec::makeWebSpec( 1, uri, { "/day_of_year" }, {}, "", "json", time + 500 );
+    auto spec3 =
+        OracleRequestSpec::makeWebSpec( 1, uri, { "/unixtime" }, {}, "haha", "json", time );
+
+    REQUIRE( spec1->getFetchKey() == spec2->getFetchKey() );
+    REQUIRE( spec1->getFetchKey() != spec3->getFetchKey() );
+
+    string ethUri = "http://127.0.0.1:8545/";
+    string from = "0x9876543210987654321098765432109876543210";
+    string to = "0x5FbDB2315678afecb367f032d93F642f64180aa3";
+
+    auto call1 = OracleRequestSpec::makeEthCallSpec(
+        1, ethUri, from, to, "0x893d20e8", "0x100000", "latest", "json", time );
+    auto call2 = OracleRequestSpec::makeEthCallSpec(
+        1, ethUri, from, to, "0x893d20e8", "0x100000", "latest", "json", time + 1 );
+
+    // the post string changes with the call id
+    auto post = call1->whatToPost();
+    REQUIRE( call1->whatToPost() != post );
+    REQUIRE( call1->getFetchKey() == call2->getFetchKey() );
+}
+
+
+TEST_CASE( "Oracle waitForResult wakes up on confirmations", "[oracle-wait-result]" ) {
+    string uri = "https://worldtimeapi.org/api/timezone/Europe/Kiev";
+    auto spec = OracleRequestSpec::makeWebSpec(
+        1, uri, { "/unixtime" }, {}, "", "json", Time::getCurrentTimeMs() );
+
+    // 4 signers need 2 matching results
+    auto received = make_shared< OracleReceivedResults >( spec, 4, 4, false );
+
+    auto specString = spec->getSpec();
+    auto unsignedResult = specString.substr( 0, specString.find_last_of( "," ) + 1 );
+    unsignedResult.append( "\"rslts\":[\"1\"]," );
+
+    auto makeResult = [&]( uint64_t _origin ) {
+        auto resultString = unsignedResult + "\"sig\":\"" + to_string( _origin ) + "\"}";
+        return OracleResult::parseResult( resultString, spec );
+    };
+
+    string result;
+
+    auto startMs = Time::getCurrentTimeMs();
+    REQUIRE( received->waitForResult( result, 50 ) == ORACLE_RESULT_NOT_READY );
+    REQUIRE( Time::getCurrentTimeMs() >= startMs + 50 );
+
+    received->insertIfDoesntExist( 1, makeResult( 1 ) );
+    REQUIRE( received->waitForResult( result, 50 ) == ORACLE_RESULT_NOT_READY );
+
+    thread inserter( [&]() {
+        usleep( 100000 );
+        received->insertIfDoesntExist( 2, makeResult( 2 ) );
+    } );
+
+    // an unbounded timeout must not overflow the deadline
+    startMs = Time::getCurrentTimeMs();
+    auto status = received->waitForResult( result, numeric_limits< uint64_t >::max() );
+    auto waitedMs = Time::getCurrentTimeMs() - startMs;
+
+    inserter.join();
+
+    REQUIRE( status == ORACLE_SUCCESS );
+    REQUIRE( waitedMs < 5000 );
+    REQUIRE( result.find( "\"sigs\":[\"1\",\"2\",null,null]" ) != string::npos );
+}
+
+
+// an engine that only implements checkOracleResult, which reports a result after some calls
+class OracleTestPollingEngine : public ConsensusInterface {
+public:
+    atomic< uint64_t > checks = 0;
+
+    uint64_t readyAfterChecks = 0;
+
+    void parseFullConfigAndCreateNode( const string&, const string& ) override {}
+    void startAll() override {}
+    void bootStrapAll() override {}
+    void exitGracefully() override {}
+    u256 getPriceForBlockId( uint64_t ) const override { return 0; }
+    u256 getRandomForBlockId( uint64_t ) const override { return 0; }
+    map< string, uint64_t > getConsensusDbUsage() const override { return {}; }
+    consensus_engine_status getStatus() const override { return CONSENSUS_ACTIVE; }
+    SyncInfo getSyncInfo() override { return {}; }
+
+    uint64_t submitOracleRequest( const string&, string&, string& ) override {
+        return ORACLE_SUCCESS;
+    }
+
+    uint64_t checkOracleResult( const string& _receipt, string& _result ) override {
+        if ( _receipt != "receipt" )
+            return ORACLE_UNKNOWN_RECEIPT;
+        if ( ++checks < readyAfterChecks )
+            return ORACLE_RESULT_NOT_READY;
+        _result = "result";
+        return ORACLE_SUCCESS;
+    }
+};
+
+
+TEST_CASE( "Default waitOracleResult polls checkOracleResult", "[oracle-wait-result]" ) {
+    OracleTestPollingEngine engine;
+    string result;
+
+    engine.readyAfterChecks = 3;
+    REQUIRE( engine.waitOracleResult( "receipt", 5000, result ) == ORACLE_SUCCESS );
+    REQUIRE( result == "result" );
+    REQUIRE( engine.checks == 3 );
+
+    REQUIRE( engine.waitOracleResult( "unknown", 5000, result ) == ORACLE_UNKNOWN_RECEIPT );
+
+    // the result is checked once more when the timeout passes
+    engine.checks = 0;
+    engine.readyAfterChecks = 1000;
+    auto startMs = Time::getCurrentTimeMs();
+    REQUIRE( engine.waitOracleResult( "receipt", 150, result ) == ORACLE_RESULT_NOT_READY );
+    REQUIRE( Time::getCurrentTimeMs() >= startMs + 150 );
+    REQUIRE( engine.checks >= 2 );
+
+    REQUIRE( engine.waitOracleResult( "receipt", 0, result ) == ORACLE_RESULT_NOT_READY );
+}
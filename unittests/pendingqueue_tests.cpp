@@ -0,0 +1,323 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+
+#include <future>
+
+#include "datastructures/Transaction.h"
+#include "pendingqueue/AdaptiveBlockAssembler.h"
+#include "pendingqueue/KnownTransactionIndex.h"
+#include "pendingqueue/LoadGenerator.h"
+
+
+TEST_CASE( "Known transaction index lookups while it is written", "[known-tx-index]" ) {
+    boost::random::mt19937 gen;
+    boost::random::uniform_int_distribution<> ubyte( 0, 255 );
+
+    const uint64_t txCount = 4 * KNOWN_TRANSACTIONS_HISTORY;
+    const uint64_t readerCount = 16;
+    const uint64_t lookupsPerReader = 1000000;
+
+    vector< ptr< Transaction > > transactions;
+    for ( uint64_t i = 0; i < txCount; i++ ) {
+        transactions.push_back( Transaction::createRandomSample( 64, gen, ubyte ) );
+    }
+
+    // never put into the index
+    vector< ptr< Transaction > > unknownTransactions;
+    for ( uint64_t i = 0; i < 1000; i++ ) {
+        unknownTransactions.push_back( Transaction::createRandomSample( 64, gen, ubyte ) );
+    }
+
+    KnownTransactionIndex index( KNOWN_TRANSACTIONS_HISTORY, MAX_KNOWN_TRANSACTIONS_TOTAL_SIZE );
+
+    for ( uint64_t i = 0; i < KNOWN_TRANSACTIONS_HISTORY; i++ ) {
+        REQUIRE( index.put( transactions[i] ) );
+    }
+
+    REQUIRE( index.getCount() == KNOWN_TRANSACTIONS_HISTORY );
+    REQUIRE_FALSE( index.put( transactions[0] ) );
+
+    // nothing is evicted before the limit is reached
+    for ( uint64_t i = 0; i < txCount; i++ ) {
+        auto result = index.get( *transactions[i]->getPartialHash() );
+        if ( i < KNOWN_TRANSACTIONS_HISTORY ) {
+            REQUIRE( result == transactions[i] );
+        } else {
+            REQUIRE( result == nullptr );
+        }
+    }
+
+    // readers probe partial hashes as proposals arrive while the writer keeps pushing.
+    // A lookup may miss an evicted transaction, but must never return a different one
+    atomic< uint64_t > hits = 0;
+    atomic< uint64_t > mismatches = 0;
+    vector< thread > readers;
+
+    auto startTimeMs = Time::getCurrentTimeMs();
+
+    for ( uint64_t r = 0; r < readerCount; r++ ) {
+        readers.emplace_back( [&, r]() {
+            uint64_t found = 0;
+            for ( uint64_t i = 0; i < lookupsPerReader; i++ ) {
+                auto& tx = transactions[( i * 7919 + r ) % txCount];
+                auto result = index.get( *tx->getPartialHash() );
+                if ( result == tx ) {
+                    found++;
+                } else if ( result ) {
+                    mismatches++;
+                }
+                if ( index.get( *unknownTransactions[i % unknownTransactions.size()]
+                                      ->getPartialHash() ) )
+                    mismatches++;
+            }
+            hits += found;
+        } );
+    }
+
+    for ( uint64_t i = KNOWN_TRANSACTIONS_HISTORY; i < txCount; i++ ) {
+        index.put( transactions[i] );
+    }
+
+    for ( auto&& reader : readers ) {
+        reader.join();
+    }
+
+    auto elapsedMs = max< uint64_t >( Time::getCurrentTimeMs() - startTimeMs, 1 );
+
+    REQUIRE( mismatches == 0 );
+    REQUIRE( hits > 0 );
+    REQUIRE( index.getCount() == KNOWN_TRANSACTIONS_HISTORY );
+
+    // every entry left in the index is found, and maps to its own transaction
+    uint64_t found = 0;
+    for ( auto&& tx : transactions ) {
+        auto result = index.get( *tx->getPartialHash() );
+        if ( result ) {
+            REQUIRE( result == tx );
+            found++;
+        }
+    }
+
+    REQUIRE( found == index.getCount() );
+
+    for ( auto&& tx : unknownTransactions ) {
+        REQUIRE( index.get( *tx->getPartialHash() ) == nullptr );
+    }
+
+    printf( "Known transaction index: %lu lookups by %lu threads in %lu ms, %lu lookups/s\n",
+        2 * readerCount * lookupsPerReader, readerCount, elapsedMs,
+        2 * readerCount * lookupsPerReader * 1000 / elapsedMs );
+}
+
+
+TEST_CASE( "Known transaction index is written while its keys are visited", "[known-tx-index]" ) {
+    boost::random::mt19937 gen;
+    boost::random::uniform_int_distribution<> ubyte( 0, 255 );
+
+    const uint64_t txCount = 4 * KNOWN_TRANSACTIONS_HISTORY;
+
+    vector< ptr< Transaction > > transactions;
+    set< uint64_t > allKeys;
+    for ( uint64_t i = 0; i < txCount; i++ ) {
+        transactions.push_back( Transaction::createRandomSample( 64, gen, ubyte ) );
+        uint64_t key;
+        memcpy( &key, transactions.back()->getPartialHash()->data(), sizeof( key ) );
+        allKeys.insert( key );
+    }
+
+    KnownTransactionIndex index( KNOWN_TRANSACTIONS_HISTORY, MAX_KNOWN_TRANSACTIONS_TOTAL_SIZE );
+
+    for ( uint64_t i = 0; i < KNOWN_TRANSACTIONS_HISTORY; i++ ) {
+        REQUIRE( index.put( transactions[i] ) );
+    }
+
+    // the writer evicts and rebuilds while the visitor is still running, and must not wait for it
+    future< void > writer;
+    bool writerFinished = false;
+    uint64_t visited = 0;
+    uint64_t foreignKeys = 0;
+
+    index.forEachKey( [&]( uint64_t _key ) {
+        if ( visited++ == 0 ) {
+            writer = async( launch::async, [&]() {
+                for ( uint64_t i = KNOWN_TRANSACTIONS_HISTORY; i < txCount; i++ ) {
+                    index.put( transactions[i] );
+                }
+            } );
+            writerFinished = writer.wait_for( chrono::seconds( 60 ) ) == future_status::ready;
+        }
+        if ( allKeys.count( _key ) == 0 )
+            foreignKeys++;
+    } );
+
+    writer.get();
+
+    REQUIRE( writerFinished );
+    REQUIRE( visited > 0 );
+    REQUIRE( foreignKeys == 0 );
+    REQUIRE( index.getCount() == KNOWN_TRANSACTIONS_HISTORY );
+
+    visited = 0;
+    index.forEachKey( [&]( uint64_t ) { visited++; } );
+    REQUIRE( visited == KNOWN_TRANSACTIONS_HISTORY );
+}
+
+
+TEST_CASE( "Load generator samples follow their distributions", "[load-generator]" ) {
+    boost::random::mt19937_64 rng( 7 );
+
+    const uint64_t samples = 200000;
+
+    vector< double > exponential;
+    vector< double > lognormal;
+    uint64_t uniformMin = UINT64_MAX;
+    uint64_t uniformMax = 0;
+    double uniformSum = 0;
+
+    for ( uint64_t i = 0; i < samples; i++ ) {
+        exponential.push_back( LoadGenerator::sampleExponential( rng(), 500 ) );
+        lognormal.push_back( LoadGenerator::sampleLognormal( rng(), 1000, 0.5 ) );
+        auto uniform = LoadGenerator::sampleUniform( rng(), 100, 199 );
+        uniformMin = min( uniformMin, uniform );
+        uniformMax = max( uniformMax, uniform );
+        uniformSum += uniform;
+    }
+
+    double mean = 0;
+    for ( auto&& value : exponential ) {
+        REQUIRE( value > 0 );
+        mean += value;
+    }
+    mean /= samples;
+    REQUIRE( mean == Approx( 1.0 / 500 ).epsilon( 0.02 ) );
+
+    sort( lognormal.begin(), lognormal.end() );
+    REQUIRE( lognormal[samples / 2] == Approx( 1000 ).epsilon( 0.02 ) );
+    // the 84th percentile of a lognormal is one sigma above the median
+    REQUIRE( lognormal[samples * 8413 / 10000] == Approx( 1000 * exp( 0.5 ) ).epsilon( 0.02 ) );
+
+    REQUIRE( uniformMin == 100 );
+    REQUIRE( uniformMax == 199 );
+    REQUIRE( uniformSum / samples == Approx( 149.5 ).epsilon( 0.01 ) );
+
+    // the samples do not depend on the standard library, so the values are fixed
+    REQUIRE( LoadGenerator::toOpenUnitInterval( 0 ) > 0 );
+    REQUIRE( LoadGenerator::toOpenUnitInterval( UINT64_MAX ) < 1 );
+    REQUIRE( LoadGenerator::inverseNormalCdf( 0.5 ) == Approx( 0 ).margin( 1e-9 ) );
+    REQUIRE( LoadGenerator::inverseNormalCdf( 0.975 ) == Approx( 1.959964 ).epsilon( 1e-6 ) );
+    REQUIRE( LoadGenerator::inverseNormalCdf( 0.001 ) == Approx( -3.090232 ).epsilon( 1e-6 ) );
+}
+
+
+TEST_CASE( "Adaptive block assembler converges to the target block time", "[block-assembler]" ) {
+    const uint64_t targetMs = 1000;
+    const uint64_t maxTransactions = 10000;
+
+    // the simulated chain spends 200 ms per block in consensus, 0.5 ms per transaction in the
+    // EVM and pushes 50 bytes per transaction at 0.2 ms per kilobyte after a 20 ms round trip
+    auto blockTimeMs = []( uint64_t _transactions ) {
+        return 220 + _transactions * ( 0.5 + 50 * 0.0002 );
+    };
+
+    AdaptiveBlockAssembler assembler( targetMs, maxTransactions, 0 );
+
+    assembler.proposalPushed( 1, 100, 20 );
+
+    uint64_t nowMs = 1000000;
+    AdaptiveBlockAssembler::Decision decision;
+
+    for ( int i = 0; i < 60; i++ ) {
+        decision = assembler.decide( targetMs, maxTransactions );
+        auto transactions = decision.maxTransactions;
+        assembler.proposalAssembled( transactions, transactions * 100, decision.waitMs, true );
+        assembler.proposalPushed(
+            transactions, transactions * 50, ( uint64_t ) ( 20 + transactions * 50 * 0.0002 ) );
+        nowMs += ( uint64_t ) blockTimeMs( transactions ) + decision.waitMs;
+        assembler.blockCommitted(
+            transactions, transactions * 100, ( uint64_t ) ( transactions * 0.5 ), nowMs );
+    }
+
+    REQUIRE( decision.waitMs == 0 );
+    REQUIRE( blockTimeMs( decision.maxTransactions ) <= targetMs * 1.05 );
+    REQUIRE( blockTimeMs( decision.maxTransactions ) >= targetMs * 0.9 );
+}
+
+
+TEST_CASE( "Adaptive block assembler changes the limit at most twice per block",
+    "[block-assembler]" ) {
+    const uint64_t maxTransactions = 10000;
+
+    AdaptiveBlockAssembler assembler( 1000, maxTransactions, 0 );
+
+    uint64_t nowMs = 1000000;
+
+    // nothing is measured yet
+    REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == maxTransactions );
+
+    SECTION( "The limit halves at most" ) {
+        // 100 ms per transaction would fit 10 transactions
+        assembler.blockCommitted( 100, 10000, 10000, nowMs );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 5000 );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 2500 );
+    }
+
+    SECTION( "The limit doubles at most while the blocks are full" ) {
+        assembler.blockCommitted( 100, 10000, 100, nowMs++ );
+        for ( int i = 0; i < 4; i++ ) {
+            assembler.decide( 1000, maxTransactions );
+        }
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 1000 );
+
+        // the transactions became almost free
+        for ( int i = 0; i < 40; i++ ) {
+            assembler.blockCommitted( 1000, 100000, 0, nowMs++ );
+        }
+
+        assembler.proposalAssembled( 1000, 100000, 0, true );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 2000 );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 4000 );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == 8000 );
+        REQUIRE( assembler.decide( 1000, maxTransactions ).maxTransactions == maxTransactions );
+    }
+
+    SECTION( "The limit does not grow while the blocks are not full" ) {
+        assembler.blockCommitted( 100, 10000, 100, nowMs++ );
+        for ( int i = 0; i < 4; i++ ) {
+            assembler.decide( 1000, maxTransactions );
+        }
+
+        for ( int i = 0; i < 40; i++ ) {
+            assembler.blockCommitted( 500, 50000, 0, nowMs++ );
+        }
+
+        assembler.proposalAssembled( 500, 50000, 0, false );
+        REQUIRE( assembler.decide( 1000, 500 ).maxTransactions == 1000 );
+        REQUIRE( assembler.decide( 1000, 500 ).maxTransactions == 1000 );
+    }
+}
+
+
+TEST_CASE( "Adaptive block assembler does not wait on a saturated queue", "[block-assembler]" ) {
+    const uint64_t maxTransactions = 1000;
+
+    AdaptiveBlockAssembler assembler( 1000, maxTransactions, 0 );
+
+    // 0.1 ms per transaction leaves 900 ms to wait for a full block
+    assembler.blockCommitted( 1000, 100000, 100, 1000000 );
+
+    auto decision = assembler.decide( 5000, 10 );
+    REQUIRE( decision.maxTransactions == maxTransactions );
+    REQUIRE( decision.waitMs == 900 );
+
+    // the wait is capped by the empty block interval
+    REQUIRE( assembler.decide( 300, 10 ).waitMs == 300 );
+
+    assembler.proposalAssembled( maxTransactions, 100000, 0, true );
+    REQUIRE( assembler.decide( 5000, maxTransactions ).waitMs == 0 );
+
+    REQUIRE( assembler.getStatus()["queueDepth"] == maxTransactions );
+}
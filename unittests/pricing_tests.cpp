@@ -0,0 +1,72 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include "datastructures/BlockValueRing.h"
+
+
+TEST_CASE( "Recent block values are read while they are written", "[block-value-ring]" ) {
+    const uint64_t capacity = 64;
+    const uint64_t blockCount = 200000;
+    const uint64_t readerCount = 4;
+
+    BlockValueRing ring( capacity );
+
+    // the value of a block is derived from its id, so a torn read shows up as a mismatch
+    auto valueOf = []( uint64_t _blockID ) {
+        return ( u256( _blockID ) << 192 ) + ( u256( _blockID ) << 64 ) + _blockID * 3;
+    };
+
+    u256 value;
+    REQUIRE_FALSE( ring.get( 1, value ) );
+
+    ring.put( 1, valueOf( 1 ) );
+    REQUIRE( ring.get( 1, value ) );
+    REQUIRE( value == valueOf( 1 ) );
+
+    // overwritten by the block that maps to the same slot
+    ring.put( 1 + capacity, valueOf( 1 + capacity ) );
+    REQUIRE_FALSE( ring.get( 1, value ) );
+
+    atomic< uint64_t > lastWritten = 1 + capacity;
+    atomic< uint64_t > mismatches = 0;
+    atomic< uint64_t > hits = 0;
+    vector< thread > readers;
+
+    for ( uint64_t r = 0; r < readerCount; r++ ) {
+        readers.emplace_back( [&]() {
+            u256 v;
+            while ( lastWritten < blockCount ) {
+                auto blockID = lastWritten.load();
+                for ( uint64_t i = 0; i < capacity / 2; i++ ) {
+                    if ( ring.get( blockID - i, v ) ) {
+                        hits++;
+                        if ( v != valueOf( blockID - i ) )
+                            mismatches++;
+                    }
+                }
+            }
+        } );
+    }
+
+    for ( uint64_t blockID = 2 + capacity; blockID <= blockCount; blockID++ ) {
+        ring.put( blockID, valueOf( blockID ) );
+        lastWritten = blockID;
+    }
+
+    for ( auto&& reader : readers ) {
+        reader.join();
+    }
+
+    REQUIRE( mismatches == 0 );
+    REQUIRE( hits > 0 );
+
+    // the ring holds exactly the last capacity blocks
+    for ( uint64_t blockID = blockCount - capacity + 1; blockID <= blockCount; blockID++ ) {
+        REQUIRE( ring.get( blockID, value ) );
+        REQUIRE( value == valueOf( blockID ) );
+    }
+
+    REQUIRE_FALSE( ring.get( blockCount - capacity, value ) );
+    REQUIRE_FALSE( ring.get( blockCount + 1, value ) );
+}
@@ -0,0 +1,145 @@
+//
+// Created by kladko on 19.10.22.
+//
+
+#include "threads/TimerWheel.h"
+#include "utils/Time.h"
+
+
+// fire times of timers by index, 0 if a timer has not fired
+class TimerFirings {
+public:
+    mutex lock;
+    condition_variable cond;
+    map< uint64_t, uint64_t > fireTimesMs;
+
+    function< void() > record( uint64_t _index ) {
+        return [this, _index]() {
+            lock_guard< mutex > guard( lock );
+            fireTimesMs[_index] = Time::getCurrentTimeMs();
+            cond.notify_all();
+        };
+    }
+
+    bool waitFor( uint64_t _count, uint64_t _timeoutMs ) {
+        unique_lock< mutex > guard( lock );
+        return cond.wait_for( guard, chrono::milliseconds( _timeoutMs ),
+            [this, _count]() { return fireTimesMs.size() >= _count; } );
+    }
+
+    bool hasFired( uint64_t _index ) {
+        lock_guard< mutex > guard( lock );
+        return fireTimesMs.count( _index ) > 0;
+    }
+};
+
+
+TEST_CASE( "Timers fire at their deadlines across wheel levels", "[timer-wheel]" ) {
+    auto& wheel = TimerWheel::getShared();
+
+    TimerFirings firings;
+
+    auto now = Time::getCurrentTimeMs();
+
+    // level 0 slots, level 1 slots of 64ms, a level 2 slot of 4096ms, and a past deadline
+    vector< uint64_t > deadlines = { now + 5, now + 63, now + 64, now + 130, now + 1000,
+        now + 4200, now - 1000 };
+
+    for ( uint64_t i = 0; i < deadlines.size(); i++ ) {
+        wheel.schedule( deadlines.at( i ), firings.record( i ) );
+    }
+
+    REQUIRE( firings.waitFor( deadlines.size(), 30000 ) );
+
+    lock_guard< mutex > guard( firings.lock );
+
+    for ( uint64_t i = 0; i < deadlines.size(); i++ ) {
+        auto firedMs = firings.fireTimesMs.at( i );
+        // never early, and not later than the test machine can be expected to be
+        REQUIRE( firedMs >= deadlines.at( i ) );
+        REQUIRE( firedMs <= max( deadlines.at( i ), now ) + 1000 );
+    }
+
+    // timers fire in deadline order
+    REQUIRE( firings.fireTimesMs.at( 6 ) <= firings.fireTimesMs.at( 0 ) );
+    for ( uint64_t i = 1; i < 6; i++ ) {
+        REQUIRE( firings.fireTimesMs.at( i - 1 ) <= firings.fireTimesMs.at( i ) );
+    }
+}
+
+
+TEST_CASE( "Cancelled timers do not fire", "[timer-wheel]" ) {
+    auto& wheel = TimerWheel::getShared();
+
+    TimerFirings firings;
+
+    auto now = Time::getCurrentTimeMs();
+
+    auto pending = wheel.getPendingCount();
+
+    auto cancelled = wheel.schedule( now + 100, firings.record( 0 ) );
+    auto farCancelled = wheel.schedule( now + 5000, firings.record( 1 ) );
+    auto kept = wheel.schedule( now + 200, firings.record( 2 ) );
+
+    REQUIRE( wheel.getPendingCount() >= pending + 3 );
+
+    REQUIRE( wheel.cancel( cancelled ) );
+    REQUIRE( wheel.cancel( farCancelled ) );
+
+    // cancelling twice does nothing
+    REQUIRE( !wheel.cancel( cancelled ) );
+
+    REQUIRE( firings.waitFor( 1, 30000 ) );
+    REQUIRE( firings.hasFired( 2 ) );
+
+    // the cancelled timer would have fired before the kept one
+    usleep( 200 * 1000 );
+    REQUIRE( !firings.hasFired( 0 ) );
+    REQUIRE( !firings.hasFired( 1 ) );
+
+    // the callback has run
+    REQUIRE( !wheel.cancel( kept ) );
+}
+
+
+TEST_CASE( "Cancel waits for a running callback", "[timer-wheel]" ) {
+    auto& wheel = TimerWheel::getShared();
+
+    atomic< bool > started = false;
+    atomic< bool > finished = false;
+
+    auto timerId = wheel.schedule( Time::getCurrentTimeMs(), [&]() {
+        started = true;
+        usleep( 300 * 1000 );
+        finished = true;
+    } );
+
+    auto deadlineMs = Time::getCurrentTimeMs() + 30000;
+    while ( !started && Time::getCurrentTimeMs() < deadlineMs ) {
+        usleep( 1000 );
+    }
+    REQUIRE( started );
+
+    // the callback has started, so it is not cancelled, but it has finished on return
+    REQUIRE( !wheel.cancel( timerId ) );
+    REQUIRE( finished );
+}
+
+
+TEST_CASE( "Callbacks can schedule and cancel timers", "[timer-wheel]" ) {
+    auto& wheel = TimerWheel::getShared();
+
+    TimerFirings firings;
+
+    atomic< uint64_t > selfId = 0;
+    atomic< bool > selfCancelResult = true;
+
+    // a callback that reschedules itself, as periodic sweeps do, and cancels its own timer
+    selfId = wheel.schedule( Time::getCurrentTimeMs() + 10, [&]() {
+        selfCancelResult = wheel.cancel( selfId );
+        wheel.schedule( Time::getCurrentTimeMs() + 10, firings.record( 0 ) );
+    } );
+
+    REQUIRE( firings.waitFor( 1, 30000 ) );
+    REQUIRE( !selfCancelResult );
+}